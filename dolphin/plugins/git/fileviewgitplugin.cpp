@@ -55,7 +55,8 @@ FileViewGitPlugin::FileViewGitPlugin(QObject *parent, const QList<QVariant> &arg
     m_addaction(nullptr),
     m_removeaction(nullptr),
     m_commitaction(nullptr),
-    m_commitdialog(nullptr)
+    m_commitdialog(nullptr),
+    m_gitstatusespatched(false)
 {
     Q_UNUSED(args);
 
@@ -108,13 +109,28 @@ QString FileViewGitPlugin::fileName() const
 
 bool FileViewGitPlugin::beginRetrieval(const QString &directory)
 {
+    const QByteArray directorybytes = QFile::encodeName(directory);
+    if (m_gitrepo && m_gitstatusespatched) {
+        // the statuses were updated for the items changed by the plugin itself, no need to
+        // query the whole directory again
+        QByteArray retrievaldirectory = directorybytes.mid(m_directory.size());
+        while (retrievaldirectory.endsWith('/')) {
+            retrievaldirectory.chop(1);
+        }
+        if (directorybytes.startsWith(m_directory) && retrievaldirectory == m_retrievaldirectory) {
+            kDebug() << "Reusing statuses of" << directory;
+            m_gitstatusespatched = false;
+            return true;
+        }
+    }
+    m_gitstatusespatched = false;
+
     if (m_gitrepo) {
         kDebug() << "Done with" << m_directory;
         git_repository_free(m_gitrepo);
         m_gitrepo = nullptr;
     }
     m_directory.clear();
-    const QByteArray directorybytes = QFile::encodeName(directory);
     // NOTE: git_repository_open_ext() will look for .git in parent directories
     const int gitresult = git_repository_open_ext(&m_gitrepo, directorybytes.constData(), 0 , NULL);
     if (gitresult != GIT_OK) {
@@ -124,6 +140,13 @@ bool FileViewGitPlugin::beginRetrieval(const QString &directory)
         return false;
     }
     m_directory = git_repository_workdir(m_gitrepo);
+    m_retrievaldirectory = directorybytes.mid(m_directory.size());
+    while (m_retrievaldirectory.endsWith('/')) {
+        m_retrievaldirectory.chop(1);
+    }
+    if (!updateGitStatuses()) {
+        return false;
+    }
     kDebug() << "Initialized" << directory;
     return true;
 }
@@ -138,48 +161,32 @@ KVersionControlPlugin::ItemVersion FileViewGitPlugin::itemVersion(const KFileIte
         kWarning() << "Not initialized" << m_directory;
         return KVersionControlPlugin::UnversionedVersion;
     }
-    if (item.isDir()) {
-        // git_status_file() cannot get the status of directories
-        return KVersionControlPlugin::NormalVersion;
-    }
-    const QByteArray gitfile = getGitFile(item, m_directory);
-    unsigned int gitstatusflags = 0;
-    const int gitresult = git_status_file(&gitstatusflags, m_gitrepo, gitfile.constData());
-    if (gitresult != GIT_OK) {
-        kWarning() << "Could not get status" << gitfile << FileViewGitPlugin::getGitError();
-        return KVersionControlPlugin::UnversionedVersion;
-    }
-    if (gitstatusflags & GIT_STATUS_INDEX_NEW) {
-        kDebug() << "New staged file" << item;
-        return KVersionControlPlugin::AddedVersion;
-    }
-    if (gitstatusflags & GIT_STATUS_INDEX_MODIFIED) {
-        kDebug() << "Modified staged file" << item;
-        return KVersionControlPlugin::LocallyModifiedVersion;
-    }
-    if (gitstatusflags & GIT_STATUS_INDEX_DELETED) {
-        kDebug() << "Deleted staged file" << item;
-        return KVersionControlPlugin::RemovedVersion;
+    QByteArray gitfile = getGitFile(item, m_directory);
+    QMutexLocker locker(&m_gitstatusesmutex);
+    QHash<QByteArray, unsigned int>::const_iterator it = m_gitstatuses.constFind(gitfile);
+    if (it != m_gitstatuses.constEnd()) {
+        return FileViewGitPlugin::gitStatusVersion(it.value());
     }
-    if (gitstatusflags & GIT_STATUS_WT_NEW) {
-        kDebug() << "New unstaged file" << item;
-        return KVersionControlPlugin::AddedVersion;
-    }
-    if (gitstatusflags & GIT_STATUS_WT_MODIFIED) {
-        kDebug() << "Modified unstaged file" << item;
+    if (item.isDir()) {
+        it = m_gitdirstatuses.constFind(gitfile);
+        if (it == m_gitdirstatuses.constEnd()) {
+            return KVersionControlPlugin::NormalVersion;
+        }
+        if (it.value() & GIT_STATUS_CONFLICTED) {
+            return KVersionControlPlugin::ConflictingVersion;
+        }
         return KVersionControlPlugin::LocallyModifiedVersion;
     }
-    if (gitstatusflags & GIT_STATUS_WT_DELETED) {
-        kDebug() << "Deleted unstaged file" << item;
-        return KVersionControlPlugin::RemovedVersion;
-    }
-    if (gitstatusflags & GIT_STATUS_IGNORED) {
-        kDebug() << "Ignored file" << item;
-        return KVersionControlPlugin::IgnoredVersion;
-    }
-    if (gitstatusflags & GIT_STATUS_CONFLICTED) {
-        kDebug() << "Conflicting file" << item;
-        return KVersionControlPlugin::ConflictingVersion;
+    // untracked and ignored directories are not recursed into, the status of their content is
+    // the status of the directory
+    int gitslash = gitfile.lastIndexOf('/');
+    while (gitslash > 0) {
+        gitfile.truncate(gitslash);
+        it = m_gitstatuses.constFind(gitfile);
+        if (it != m_gitstatuses.constEnd()) {
+            return FileViewGitPlugin::gitStatusVersion(it.value());
+        }
+        gitslash = gitfile.lastIndexOf('/');
     }
     return KVersionControlPlugin::NormalVersion;
 }
@@ -461,6 +468,35 @@ int FileViewGitPlugin::gitDiffCallback(const git_diff_delta *delta,
     return GIT_OK;
 }
 
+KVersionControlPlugin::ItemVersion FileViewGitPlugin::gitStatusVersion(const unsigned int gitstatusflags)
+{
+    if (gitstatusflags & GIT_STATUS_INDEX_NEW) {
+        return KVersionControlPlugin::AddedVersion;
+    }
+    if (gitstatusflags & GIT_STATUS_INDEX_MODIFIED) {
+        return KVersionControlPlugin::LocallyModifiedVersion;
+    }
+    if (gitstatusflags & GIT_STATUS_INDEX_DELETED) {
+        return KVersionControlPlugin::RemovedVersion;
+    }
+    if (gitstatusflags & GIT_STATUS_WT_NEW) {
+        return KVersionControlPlugin::AddedVersion;
+    }
+    if (gitstatusflags & GIT_STATUS_WT_MODIFIED) {
+        return KVersionControlPlugin::LocallyModifiedVersion;
+    }
+    if (gitstatusflags & GIT_STATUS_WT_DELETED) {
+        return KVersionControlPlugin::RemovedVersion;
+    }
+    if (gitstatusflags & GIT_STATUS_IGNORED) {
+        return KVersionControlPlugin::IgnoredVersion;
+    }
+    if (gitstatusflags & GIT_STATUS_CONFLICTED) {
+        return KVersionControlPlugin::ConflictingVersion;
+    }
+    return KVersionControlPlugin::NormalVersion;
+}
+
 QByteArray FileViewGitPlugin::getGitError()
 {
     const git_error* giterror = git_error_last();
@@ -470,6 +506,133 @@ QByteArray FileViewGitPlugin::getGitError()
     return QByteArray(giterror->message);
 }
 
+bool FileViewGitPlugin::updateGitStatuses()
+{
+    QMutexLocker locker(&m_gitstatusesmutex);
+    m_gitstatuses.clear();
+    m_gitdirstatuses.clear();
+
+    git_status_options gitstatusoptions;
+    int gitresult = git_status_options_init(&gitstatusoptions, GIT_STATUS_OPTIONS_VERSION);
+    if (gitresult != GIT_OK) {
+        const QByteArray giterror = FileViewGitPlugin::getGitError();
+        kWarning() << "Could not initialize status options" << m_directory << giterror;
+        return false;
+    }
+    gitstatusoptions.show = GIT_STATUS_SHOW_INDEX_AND_WORKDIR;
+    gitstatusoptions.flags = GIT_STATUS_OPT_INCLUDE_UNTRACKED | GIT_STATUS_OPT_INCLUDE_IGNORED
+        | GIT_STATUS_OPT_DISABLE_PATHSPEC_MATCH;
+    // NOTE: the pathspec matches the directory and everything below it, for the top-level
+    // directory of the repository no pathspec is used
+    char* gitpathspecstrings[1] = { m_retrievaldirectory.data() };
+    if (!m_retrievaldirectory.isEmpty()) {
+        gitstatusoptions.pathspec.strings = gitpathspecstrings;
+        gitstatusoptions.pathspec.count = 1;
+    }
+
+    git_status_list* gitstatuslist = nullptr;
+    gitresult = git_status_list_new(&gitstatuslist, m_gitrepo, &gitstatusoptions);
+    if (gitresult != GIT_OK) {
+        const QByteArray giterror = FileViewGitPlugin::getGitError();
+        kWarning() << "Could not get directory status" << m_directory << m_retrievaldirectory << giterror;
+        emit errorMessage(QString::fromLocal8Bit(giterror.constData(), giterror.size()));
+        return false;
+    }
+
+    const size_t gitstatuscount = git_status_list_entrycount(gitstatuslist);
+    m_gitstatuses.reserve(gitstatuscount);
+    for (size_t i = 0; i < gitstatuscount; i++) {
+        const git_status_entry* gitstatusentry = git_status_byindex(gitstatuslist, i);
+        if (!gitstatusentry || gitstatusentry->status == GIT_STATUS_CURRENT) {
+            continue;
+        }
+        const git_diff_delta* gitdelta = gitstatusentry->index_to_workdir;
+        if (!gitdelta) {
+            gitdelta = gitstatusentry->head_to_index;
+        }
+        if (!gitdelta) {
+            continue;
+        }
+        QByteArray gitpath(gitdelta->new_file.path ? gitdelta->new_file.path : gitdelta->old_file.path);
+        if (gitpath.endsWith('/')) {
+            // untracked or ignored directory
+            gitpath.chop(1);
+        }
+        m_gitstatuses[gitpath] |= gitstatusentry->status;
+        // ignored content does not make the directory ignored
+        const unsigned int gitdirstatus = (gitstatusentry->status & ~GIT_STATUS_IGNORED);
+        const QByteArray gitdirchild = gitDirectoryChild(gitpath);
+        if (gitdirstatus != 0 && !gitdirchild.isEmpty()) {
+            m_gitdirstatuses[gitdirchild] |= gitdirstatus;
+        }
+    }
+    git_status_list_free(gitstatuslist);
+
+    kDebug() << "Got status of" << m_gitstatuses.size() << "paths in" << m_directory << m_retrievaldirectory;
+    return true;
+}
+
+// updates the statuses of items without querying the whole directory
+void FileViewGitPlugin::patchGitStatuses(const KFileItemList &items)
+{
+    QMutexLocker locker(&m_gitstatusesmutex);
+    QList<QByteArray> gitdirchildren;
+    foreach (const KFileItem &item, items) {
+        const QByteArray gitfile = getGitFile(item, m_directory);
+        unsigned int gitstatusflags = 0;
+        const int gitresult = git_status_file(&gitstatusflags, m_gitrepo, gitfile.constData());
+        if (gitresult != GIT_OK) {
+            kWarning() << "Could not get status" << gitfile << FileViewGitPlugin::getGitError();
+            return;
+        }
+        if (gitstatusflags == GIT_STATUS_CURRENT) {
+            m_gitstatuses.remove(gitfile);
+        } else {
+            m_gitstatuses.insert(gitfile, gitstatusflags);
+        }
+        const QByteArray gitdirchild = gitDirectoryChild(gitfile);
+        if (!gitdirchild.isEmpty() && !gitdirchildren.contains(gitdirchild)) {
+            gitdirchildren.append(gitdirchild);
+        }
+    }
+
+    foreach (const QByteArray &gitdirchild, gitdirchildren) {
+        const QByteArray gitdirprefix = gitdirchild + '/';
+        unsigned int gitdirstatus = 0;
+        QHash<QByteArray, unsigned int>::const_iterator it = m_gitstatuses.constBegin();
+        while (it != m_gitstatuses.constEnd()) {
+            if (it.key().startsWith(gitdirprefix)) {
+                gitdirstatus |= (it.value() & ~GIT_STATUS_IGNORED);
+            }
+            it++;
+        }
+        if (gitdirstatus == 0) {
+            m_gitdirstatuses.remove(gitdirchild);
+        } else {
+            m_gitdirstatuses.insert(gitdirchild, gitdirstatus);
+        }
+    }
+    m_gitstatusespatched = true;
+}
+
+// returns the direct sub-directory of the retrieval directory the path is in, if any
+QByteArray FileViewGitPlugin::gitDirectoryChild(const QByteArray &gitpath) const
+{
+    int gitprefixsize = 0;
+    if (!m_retrievaldirectory.isEmpty()) {
+        if (!gitpath.startsWith(m_retrievaldirectory) || gitpath.size() <= m_retrievaldirectory.size()
+            || gitpath.at(m_retrievaldirectory.size()) != '/') {
+            return QByteArray();
+        }
+        gitprefixsize = m_retrievaldirectory.size() + 1;
+    }
+    const int gitslash = gitpath.indexOf('/', gitprefixsize);
+    if (gitslash <= gitprefixsize) {
+        return QByteArray();
+    }
+    return gitpath.left(gitslash);
+}
+
 void FileViewGitPlugin::slotAdd()
 {
     Q_ASSERT(!m_actionitems.isEmpty());
@@ -509,6 +672,8 @@ void FileViewGitPlugin::slotAdd()
     emit operationCompletedMessage(i18n("Done"));
     git_index_free(gitindex);
 
+    patchGitStatuses(m_actionitems);
+
     emit itemVersionsChanged();
 }
 
@@ -551,6 +716,8 @@ void FileViewGitPlugin::slotRemove()
     emit operationCompletedMessage(i18n("Done"));
     git_index_free(gitindex);
 
+    patchGitStatuses(m_actionitems);
+
     emit itemVersionsChanged();
 }
 
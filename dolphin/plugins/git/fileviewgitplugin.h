@@ -24,6 +24,8 @@
 #include <kfileitem.h>
 #include <kversioncontrolplugin.h>
 #include <QPointer>
+#include <QHash>
+#include <QMutex>
 
 #include <git2/repository.h>
 #include <git2/diff.h>
@@ -55,6 +57,7 @@ public:
                                void *payload);
 
     static QByteArray getGitError();
+    static KVersionControlPlugin::ItemVersion gitStatusVersion(const unsigned int gitstatusflags);
 
 private Q_SLOTS:
     void slotAdd();
@@ -63,6 +66,10 @@ private Q_SLOTS:
     void slotCommitFinished(const int result);
 
 private:
+    bool updateGitStatuses();
+    void patchGitStatuses(const KFileItemList &items);
+    QByteArray gitDirectoryChild(const QByteArray &gitpath) const;
+
     QByteArray m_directory;
     git_repository* m_gitrepo;
     QAction* m_addaction;
@@ -70,6 +77,14 @@ private:
     QAction* m_commitaction;
     mutable KFileItemList m_actionitems;
     QPointer<GitCommitDialog> m_commitdialog;
+    QByteArray m_retrievaldirectory;
+    // status of every non-current path below the retrieval directory, obtained by a single
+    // git_status_list_new() pass. untracked and ignored directories are not recursed into
+    QHash<QByteArray, unsigned int> m_gitstatuses;
+    // aggregated status of the direct sub-directories of the retrieval directory
+    QHash<QByteArray, unsigned int> m_gitdirstatuses;
+    bool m_gitstatusespatched;
+    mutable QMutex m_gitstatusesmutex;
 };
 
 #endif // FILEVIEWGITPLUGIN_H
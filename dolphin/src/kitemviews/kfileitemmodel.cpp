@@ -475,10 +475,20 @@ QSet<QByteArray> KFileItemModel::roles() const
 
 void KFileItemModel::setNameFilter(const QString& nameFilter)
 {
-    if (m_filter.pattern() != nameFilter) {
+    const QString previousNameFilter = m_filter.pattern();
+    if (previousNameFilter != nameFilter) {
         dispatchPendingItemsToInsert();
         m_filter.setPattern(nameFilter);
-        applyFilters();
+
+        // When typing in the filter bar the new pattern mostly extends or
+        // shortens the previous one, so only a part of the items must be checked.
+        if (KFileItemModelFilter::patternImplies(nameFilter, previousNameFilter)) {
+            applyFilters(CheckVisibleItems);
+        } else if (KFileItemModelFilter::patternImplies(previousNameFilter, nameFilter)) {
+            applyFilters(CheckFilteredItems);
+        } else {
+            applyFilters();
+        }
     }
 }
 
@@ -502,24 +512,30 @@ QStringList KFileItemModel::mimeTypeFilters() const
 }
 
 
-void KFileItemModel::applyFilters()
+void KFileItemModel::applyFilters(ApplyFiltersBehavior behavior)
 {
-    // Check which shown items from m_itemData must get
-    // hidden and hence moved to m_filteredItems.
-    QVector<int> newFilteredIndexes;
+    if (behavior != CheckFilteredItems) {
+        // Check which shown items from m_itemData must get
+        // hidden and hence moved to m_filteredItems.
+        QVector<int> newFilteredIndexes;
 
-    const int itemCount = m_itemData.count();
-    for (int index = 0; index < itemCount; ++index) {
-        ItemData* itemData = m_itemData.at(index);
-        const KFileItem item = itemData->item;
-        if (!m_filter.matches(item)) {
-            newFilteredIndexes.append(index);
-            m_filteredItems.insert(item, itemData);
+        const int itemCount = m_itemData.count();
+        for (int index = 0; index < itemCount; ++index) {
+            ItemData* itemData = m_itemData.at(index);
+            const KFileItem item = itemData->item;
+            if (!m_filter.matches(item)) {
+                newFilteredIndexes.append(index);
+                m_filteredItems.insert(item, itemData);
+            }
         }
+
+        const KItemRangeList removedRanges = KItemRangeList::fromSortedContainer(newFilteredIndexes);
+        removeItems(removedRanges, KeepItemData);
     }
 
-    const KItemRangeList removedRanges = KItemRangeList::fromSortedContainer(newFilteredIndexes);
-    removeItems(removedRanges, KeepItemData);
+    if (behavior == CheckVisibleItems) {
+        return;
+    }
 
     // Check which hidden items from m_filteredItems should
     // get visible again and hence removed from m_filteredItems.
@@ -275,6 +275,12 @@ private:
         DeleteItemData
     };
 
+    enum ApplyFiltersBehavior {
+        CheckAllItems,
+        CheckVisibleItems,  // Filters have been narrowed, hidden items stay hidden.
+        CheckFilteredItems  // Filters have been widened, visible items stay visible.
+    };
+
     void insertItems(QList<ItemData*>& items);
     void removeItems(const KItemRangeList& itemRanges, RemoveItemsBehavior behavior);
 
@@ -373,7 +379,7 @@ private:
     /**
      * Applies the filters set through @ref setNameFilter and @ref setMimeTypeFilters.
      */
-    void applyFilters();
+    void applyFilters(ApplyFiltersBehavior behavior = CheckAllItems);
 
     /**
      * Maps the QByteArray-roles to RoleTypes and provides translation- and
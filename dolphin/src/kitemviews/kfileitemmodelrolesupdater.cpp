@@ -29,6 +29,8 @@
 #include <KServiceTypeTrader>
 #include <KIO/JobUiDelegate>
 #include <KIO/PreviewJob>
+#include <KLocale>
+#include <konq_metadatacache.h>
 
 #include "private/kdirectorycontentscounter.h"
 
@@ -815,7 +817,7 @@ void KFileItemModelRolesUpdater::applySortRole(int index)
     const KFileItem item = m_model->fileItem(index);
 
     if (m_model->sortRole() == "type") {
-        data.insert("type", item.mimeComment());
+        data.insert("type", mimeComment(item));
     } else if (m_model->sortRole() == "size" && item.isLocalFile() && item.isDir()) {
         const QString path = item.localPath();
         data.insert("size", m_directoryContentsCounter->countDirectoryContentsSynchronously(path));
@@ -861,7 +863,7 @@ bool KFileItemModelRolesUpdater::applyResolvedRoles(int index, ResolveHint hint)
             data = rolesData(item);
         }
 
-        data.insert("iconName", item.iconName());
+        data.insert("iconName", iconName(item));
 
         if (m_clearPreviews) {
             data.insert("iconPixmap", QPixmap());
@@ -896,7 +898,7 @@ QHash<QByteArray, QVariant> KFileItemModelRolesUpdater::rolesData(const KFileIte
     }
 
     if (m_roles.contains("type")) {
-        data.insert("type", item.mimeComment());
+        data.insert("type", mimeComment(item));
     }
 
     data.insert("iconOverlays", item.overlays());
@@ -904,6 +906,42 @@ QHash<QByteArray, QVariant> KFileItemModelRolesUpdater::rolesData(const KFileIte
     return data;
 }
 
+QString KFileItemModelRolesUpdater::iconName(const KFileItem& item) const
+{
+    // The icon of a directory also depends on its .directory file
+    if (!item.mimeTypePtr().isNull() || item.isDir() || !item.isLocalFile()) {
+        return item.iconName();
+    }
+
+    const QString path = item.localPath();
+    const QVariant cachedIconName = KonqMetaDataCache::self()->value(path, "dolphin-iconName");
+    if (cachedIconName.isValid()) {
+        return cachedIconName.toString();
+    }
+
+    const QString iconName = item.iconName();
+    KonqMetaDataCache::self()->setValue(path, "dolphin-iconName", iconName);
+    return iconName;
+}
+
+QString KFileItemModelRolesUpdater::mimeComment(const KFileItem& item) const
+{
+    if (!item.mimeTypePtr().isNull() || item.isDir() || !item.isLocalFile()) {
+        return item.mimeComment();
+    }
+
+    const QString path = item.localPath();
+    const QByteArray role = "dolphin-type/" + KGlobal::locale()->language().toLatin1();
+    const QVariant cachedComment = KonqMetaDataCache::self()->value(path, role);
+    if (cachedComment.isValid()) {
+        return cachedComment.toString();
+    }
+
+    const QString comment = item.mimeComment();
+    KonqMetaDataCache::self()->setValue(path, role, comment);
+    return comment;
+}
+
 void KFileItemModelRolesUpdater::updateAllPreviews()
 {
     if (m_state == Paused) {
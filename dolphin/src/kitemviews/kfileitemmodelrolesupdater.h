@@ -230,6 +230,14 @@ private:
     bool applyResolvedRoles(int index, ResolveHint hint);
     QHash<QByteArray, QVariant> rolesData(const KFileItem& item);
 
+    /**
+     * @return Icon name and mimetype comment of the item. Determining the
+     *         mimetype of a local file requires reading it, so for unchanged
+     *         files the values are taken from the KonqMetaDataCache.
+     */
+    QString iconName(const KFileItem& item) const;
+    QString mimeComment(const KFileItem& item) const;
+
     /**
      * @return The number of items of the path \a path.
      */
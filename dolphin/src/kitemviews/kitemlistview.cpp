@@ -424,9 +424,9 @@ int KItemListView::lastVisibleIndex() const
     return m_layouter->lastVisibleIndex();
 }
 
-void KItemListView::calculateItemSizeHints(QVector<qreal>& logicalHeightHints, qreal& logicalWidthHint) const
+void KItemListView::calculateItemSizeHints(QVector<qreal>& logicalHeightHints, qreal& logicalWidthHint, int index, int count) const
 {
-    widgetCreator()->calculateItemSizeHints(logicalHeightHints, logicalWidthHint, this);
+    widgetCreator()->calculateItemSizeHints(logicalHeightHints, logicalWidthHint, this, index, count);
 }
 
 QRectF KItemListView::itemRect(int index) const
@@ -686,6 +686,7 @@ void KItemListView::setItemSize(const QSizeF& size)
     }
 
     m_sizeHintResolver->clearCache();
+    m_layouter->markAsDirty();
     doLayout(animate ? Animation : NoAnimation);
     onItemSizeChanged(size, previousSize);
 }
@@ -1187,7 +1188,7 @@ void KItemListView::slotItemsChanged(const KItemRangeList& itemRanges,
 
         if (updateSizeHints) {
             m_sizeHintResolver->itemsChanged(index, count, roles);
-            m_layouter->markAsDirty();
+            m_layouter->markItemsAsDirty(index, count);
 
             if (!m_layoutTimer->isActive()) {
                 m_layoutTimer->start();
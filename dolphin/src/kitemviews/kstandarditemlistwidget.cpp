@@ -181,19 +181,19 @@ KStandardItemListWidgetInformant::~KStandardItemListWidgetInformant()
 {
 }
 
-void KStandardItemListWidgetInformant::calculateItemSizeHints(QVector<qreal>& logicalHeightHints, qreal& logicalWidthHint, const KItemListView* view) const
+void KStandardItemListWidgetInformant::calculateItemSizeHints(QVector<qreal>& logicalHeightHints, qreal& logicalWidthHint, const KItemListView* view, int index, int count) const
 {
     switch (static_cast<const KStandardItemListView*>(view)->itemLayout()) {
     case KStandardItemListView::IconsLayout:
-        calculateIconsLayoutItemSizeHints(logicalHeightHints, logicalWidthHint, view);
+        calculateIconsLayoutItemSizeHints(logicalHeightHints, logicalWidthHint, view, index, count);
         break;
 
     case KStandardItemListView::CompactLayout:
-        calculateCompactLayoutItemSizeHints(logicalHeightHints, logicalWidthHint, view);
+        calculateCompactLayoutItemSizeHints(logicalHeightHints, logicalWidthHint, view, index, count);
         break;
 
     case KStandardItemListView::DetailsLayout:
-        calculateDetailsLayoutItemSizeHints(logicalHeightHints, logicalWidthHint, view);
+        calculateDetailsLayoutItemSizeHints(logicalHeightHints, logicalWidthHint, view, index, count);
         break;
 
     default:
@@ -249,7 +249,7 @@ QFont KStandardItemListWidgetInformant::customizedFontForLinks(const QFont& base
     return baseFont;
 }
 
-void KStandardItemListWidgetInformant::calculateIconsLayoutItemSizeHints(QVector<qreal>& logicalHeightHints, qreal& logicalWidthHint, const KItemListView* view) const
+void KStandardItemListWidgetInformant::calculateIconsLayoutItemSizeHints(QVector<qreal>& logicalHeightHints, qreal& logicalWidthHint, const KItemListView* view, int index, int count) const
 {
     const KItemListStyleOption& option = view->styleOption();
     const QFont& normalFont = option.font;
@@ -265,7 +265,8 @@ void KStandardItemListWidgetInformant::calculateIconsLayoutItemSizeHints(QVector
     QTextOption textOption(Qt::AlignHCenter);
     textOption.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
 
-    for (int index = 0; index < logicalHeightHints.count(); ++index) {
+    const int endIndex = index + count;
+    for (; index < endIndex; ++index) {
         if (logicalHeightHints.at(index) > 0.0) {
             continue;
         }
@@ -303,7 +304,7 @@ void KStandardItemListWidgetInformant::calculateIconsLayoutItemSizeHints(QVector
     logicalWidthHint = itemWidth;
 }
 
-void KStandardItemListWidgetInformant::calculateCompactLayoutItemSizeHints(QVector<qreal>& logicalHeightHints, qreal& logicalWidthHint, const KItemListView* view) const
+void KStandardItemListWidgetInformant::calculateCompactLayoutItemSizeHints(QVector<qreal>& logicalHeightHints, qreal& logicalWidthHint, const KItemListView* view, int index, int count) const
 {
     const KItemListStyleOption& option = view->styleOption();
     const QFontMetrics& normalFontMetrics = option.fontMetrics;
@@ -317,7 +318,8 @@ void KStandardItemListWidgetInformant::calculateCompactLayoutItemSizeHints(QVect
 
     const QFontMetrics linkFontMetrics(customizedFontForLinks(option.font));
 
-    for (int index = 0; index < logicalHeightHints.count(); ++index) {
+    const int endIndex = index + count;
+    for (; index < endIndex; ++index) {
         if (logicalHeightHints.at(index) > 0.0) {
             continue;
         }
@@ -351,11 +353,11 @@ void KStandardItemListWidgetInformant::calculateCompactLayoutItemSizeHints(QVect
     logicalWidthHint = height;
 }
 
-void KStandardItemListWidgetInformant::calculateDetailsLayoutItemSizeHints(QVector<qreal>& logicalHeightHints, qreal& logicalWidthHint, const KItemListView* view) const
+void KStandardItemListWidgetInformant::calculateDetailsLayoutItemSizeHints(QVector<qreal>& logicalHeightHints, qreal& logicalWidthHint, const KItemListView* view, int index, int count) const
 {
     const KItemListStyleOption& option = view->styleOption();
     const qreal height = option.padding * 2 + qMax(option.iconSize, option.fontMetrics.height());
-    logicalHeightHints.fill(height);
+    qFill(logicalHeightHints.begin() + index, logicalHeightHints.begin() + index + count, height);
     logicalWidthHint = -1.0;
 }
 
@@ -24,6 +24,7 @@
 #include <kitemviews/kfileitemmodel.h>
 
 #include <KDirWatch>
+#include <konq_metadatacache.h>
 #include <QThread>
 
 KDirectoryContentsCounter::KDirectoryContentsCounter(KFileItemModel* model, QObject* parent) :
@@ -81,37 +82,39 @@ KDirectoryContentsCounter::~KDirectoryContentsCounter()
 
 void KDirectoryContentsCounter::addDirectory(const QString& path)
 {
+    const QVariant count = KonqMetaDataCache::self()->value(path, cacheRole(options()));
+    if (count.isValid()) {
+        watchDirectory(path);
+        emit result(path, count.toInt());
+        return;
+    }
+
     startWorker(path);
 }
 
 int KDirectoryContentsCounter::countDirectoryContentsSynchronously(const QString& path)
 {
-    if (!m_dirWatcher->contains(path)) {
-        m_dirWatcher->addDir(path);
-        m_watchedDirs.insert(path);
-    }
+    watchDirectory(path);
 
-    KDirectoryContentsCounterWorker::Options options;
+    const KDirectoryContentsCounterWorker::Options countOptions = options();
+    const QByteArray role = cacheRole(countOptions);
 
-    if (m_model->showHiddenFiles()) {
-        options |= KDirectoryContentsCounterWorker::CountHiddenFiles;
+    const QVariant cachedCount = KonqMetaDataCache::self()->value(path, role);
+    if (cachedCount.isValid()) {
+        return cachedCount.toInt();
     }
 
-    if (m_model->showDirectoriesOnly()) {
-        options |= KDirectoryContentsCounterWorker::CountDirectoriesOnly;
-    }
-
-    return KDirectoryContentsCounterWorker::subItemsCount(path, options);
+    const int count = KDirectoryContentsCounterWorker::subItemsCount(path, countOptions);
+    KonqMetaDataCache::self()->setValue(path, role, count);
+    return count;
 }
 
 void KDirectoryContentsCounter::slotResult(const QString& path, int count)
 {
     m_workerIsBusy = false;
 
-    if (!m_dirWatcher->contains(path)) {
-        m_dirWatcher->addDir(path);
-        m_watchedDirs.insert(path);
-    }
+    watchDirectory(path);
+    KonqMetaDataCache::self()->setValue(path, cacheRole(options()), count);
 
     if (!m_queue.isEmpty()) {
         startWorker(m_queue.dequeue());
@@ -165,19 +168,37 @@ void KDirectoryContentsCounter::startWorker(const QString& path)
     if (m_workerIsBusy) {
         m_queue.enqueue(path);
     } else {
-        KDirectoryContentsCounterWorker::Options options;
+        emit requestDirectoryContentsCount(path, options());
+        m_workerIsBusy = true;
+    }
+}
 
-        if (m_model->showHiddenFiles()) {
-            options |= KDirectoryContentsCounterWorker::CountHiddenFiles;
-        }
+void KDirectoryContentsCounter::watchDirectory(const QString& path)
+{
+    if (!m_dirWatcher->contains(path)) {
+        m_dirWatcher->addDir(path);
+        m_watchedDirs.insert(path);
+    }
+}
 
-        if (m_model->showDirectoriesOnly()) {
-            options |= KDirectoryContentsCounterWorker::CountDirectoriesOnly;
-        }
+KDirectoryContentsCounterWorker::Options KDirectoryContentsCounter::options() const
+{
+    KDirectoryContentsCounterWorker::Options options;
 
-        emit requestDirectoryContentsCount(path, options);
-        m_workerIsBusy = true;
+    if (m_model->showHiddenFiles()) {
+        options |= KDirectoryContentsCounterWorker::CountHiddenFiles;
+    }
+
+    if (m_model->showDirectoriesOnly()) {
+        options |= KDirectoryContentsCounterWorker::CountDirectoriesOnly;
     }
+
+    return options;
+}
+
+QByteArray KDirectoryContentsCounter::cacheRole(KDirectoryContentsCounterWorker::Options options)
+{
+    return QByteArray("dolphin-count/") + QByteArray::number(int(options));
 }
 
 QThread* KDirectoryContentsCounter::m_workerThread = 0;
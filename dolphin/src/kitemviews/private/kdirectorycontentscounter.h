@@ -45,6 +45,9 @@ public:
      *
      * The directory \a path is watched for changes, and the signal is emitted
      * again if a change occurs.
+     *
+     * If the count of the unchanged directory is stored in the
+     * KonqMetaDataCache already, the signal is emitted immediately.
      */
     void addDirectory(const QString& path);
 
@@ -72,6 +75,14 @@ private slots:
 
 private:
     void startWorker(const QString& path);
+    void watchDirectory(const QString& path);
+    KDirectoryContentsCounterWorker::Options options() const;
+
+    /**
+     * @return Role of the count in the KonqMetaDataCache, which
+     *         depends on the options for counting.
+     */
+    static QByteArray cacheRole(KDirectoryContentsCounterWorker::Options options);
 
 private:
     KFileItemModel* m_model;
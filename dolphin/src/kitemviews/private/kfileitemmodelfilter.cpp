@@ -23,9 +23,33 @@
 #include <KFileItem>
 #include <QRegExp>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+    inline ushort toLower(ushort ch)
+    {
+        if (ch < 128) {
+            return (ch >= 'A' && ch <= 'Z') ? ch + ('a' - 'A') : ch;
+        }
+        return QChar(ch).toLower().unicode();
+    }
+
+    inline bool matchesAt(const ushort* text, const ushort* lowerCasePattern, int length)
+    {
+        for (int i = 0; i < length; ++i) {
+            if (toLower(text[i]) != lowerCasePattern[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
 
 KFileItemModelFilter::KFileItemModelFilter() :
-    m_useRegExp(false),
+    m_useGlob(false),
+    m_glob(),
     m_regExp(0),
     m_lowerCasePattern(),
     m_pattern()
@@ -41,12 +65,10 @@ KFileItemModelFilter::~KFileItemModelFilter()
 void KFileItemModelFilter::setPattern(const QString& filter)
 {
     m_pattern = filter;
-    m_lowerCasePattern = filter.toLower();
+    m_lowerCasePattern = lowerCasePattern(filter);
 
-    m_useRegExp = filter.contains('*') ||
-                  filter.contains('?') ||
-                  filter.contains('[');
-    if (m_useRegExp) {
+    m_useGlob = isWildcardPattern(filter);
+    if (m_useGlob && !m_glob.setPattern(filter)) {
         if (!m_regExp) {
             m_regExp = new QRegExp();
             m_regExp->setCaseSensitivity(Qt::CaseInsensitive);
@@ -54,6 +76,9 @@ void KFileItemModelFilter::setPattern(const QString& filter)
             m_regExp->setPatternSyntax(QRegExp::WildcardUnix);
         }
         m_regExp->setPattern(filter);
+    } else {
+        delete m_regExp;
+        m_regExp = 0;
     }
 }
 
@@ -62,6 +87,19 @@ QString KFileItemModelFilter::pattern() const
     return m_pattern;
 }
 
+bool KFileItemModelFilter::patternImplies(const QString& pattern, const QString& otherPattern)
+{
+    if (otherPattern.isEmpty()) {
+        return true;
+    }
+
+    if (isWildcardPattern(pattern) || isWildcardPattern(otherPattern)) {
+        return pattern == otherPattern;
+    }
+
+    return lowerCasePattern(pattern).contains(lowerCasePattern(otherPattern));
+}
+
 void KFileItemModelFilter::setMimeTypes(const QStringList& types)
 {
     m_mimeTypes = types;
@@ -103,10 +141,10 @@ bool KFileItemModelFilter::matches(const KFileItem& item) const
 
 bool KFileItemModelFilter::matchesPattern(const KFileItem& item) const
 {
-    if (m_useRegExp) {
-        return m_regExp->exactMatch(item.text());
+    if (m_useGlob) {
+        return m_regExp ? m_regExp->exactMatch(item.text()) : m_glob.exactMatch(item.text());
     } else {
-        return item.text().toLower().contains(m_lowerCasePattern);
+        return containsPattern(item.text());
     }
 }
 
@@ -120,3 +158,72 @@ bool KFileItemModelFilter::matchesType(const KFileItem& item) const
 
     return m_mimeTypes.isEmpty();
 }
+
+bool KFileItemModelFilter::containsPattern(const QString& text) const
+{
+    const int patternLength = m_lowerCasePattern.length();
+    const int lastIndex = text.length() - patternLength;
+    if (lastIndex < 0) {
+        return false;
+    }
+
+    const ushort* data = text.utf16();
+    const ushort* pattern = m_lowerCasePattern.utf16();
+    const ushort first = pattern[0];
+    int index = 0;
+
+#ifdef __SSE2__
+    if (first < 128) {
+        // Look for candidates of the first pattern character in blocks of 8
+        // characters. Characters beyond ASCII are candidates as well, as some
+        // of them are lowercased to ASCII (e.g. the Kelvin sign to 'k').
+        const ushort upper = (first >= 'a' && first <= 'z') ? first - ('a' - 'A') : first;
+        const __m128i lowerFirst = _mm_set1_epi16(first);
+        const __m128i upperFirst = _mm_set1_epi16(upper);
+        const __m128i nonAsciiBits = _mm_set1_epi16(static_cast<short>(0xff80));
+        const __m128i zero = _mm_setzero_si128();
+        for (; index + 8 <= lastIndex + 1; index += 8) {
+            const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+            const __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(chars, nonAsciiBits), zero);
+            const __m128i candidates = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(chars, lowerFirst),
+                                                                 _mm_cmpeq_epi16(chars, upperFirst)),
+                                                    _mm_andnot_si128(ascii, _mm_cmpeq_epi16(zero, zero)));
+            // Each character sets 2 bits of the mask
+            int mask = _mm_movemask_epi8(candidates);
+            while (mask) {
+                const int bit = __builtin_ctz(mask);
+                if (matchesAt(data + index + bit / 2, pattern, patternLength)) {
+                    return true;
+                }
+                mask &= ~(3 << bit);
+            }
+        }
+    }
+#endif
+
+    for (; index <= lastIndex; ++index) {
+        if (toLower(data[index]) == first && matchesAt(data + index, pattern, patternLength)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+QString KFileItemModelFilter::lowerCasePattern(const QString& pattern)
+{
+    QString lowerCasePattern = pattern;
+    const int length = lowerCasePattern.length();
+    ushort* data = reinterpret_cast<ushort*>(lowerCasePattern.data());
+    for (int i = 0; i < length; ++i) {
+        data[i] = toLower(data[i]);
+    }
+    return lowerCasePattern;
+}
+
+bool KFileItemModelFilter::isWildcardPattern(const QString& pattern)
+{
+    return pattern.contains('*') ||
+           pattern.contains('?') ||
+           pattern.contains('[');
+}
@@ -24,8 +24,10 @@
 #include <dolphinprivate_export.h>
 #include <QStringList>
 
+#include <kitemviews/private/kfileitemmodelglobmatcher.h>
+
 class KFileItem;
-#include <QRegExp>
+class QRegExp;
 
 /**
  * @brief Allows to check whether an item of the KFileItemModel
@@ -46,11 +48,19 @@ public:
      * Sets the pattern that is used for a comparison with the item
      * in KFileItemModelFilter::matches(). Per default the pattern
      * defines a sub-string. As soon as the pattern contains at least
-     * a '*', '?' or '[' the pattern represents a regular expression.
+     * a '*', '?' or '[' the pattern represents a wildcard expression.
      */
     void setPattern(const QString& pattern);
     QString pattern() const;
 
+    /**
+     * @return True if each item matching with @p pattern is known to
+     *         match with @p otherPattern too, e.g. because the substring
+     *         @p pattern contains the substring @p otherPattern. Allows
+     *         to check only a part of the items when the pattern changes.
+     */
+    static bool patternImplies(const QString& pattern, const QString& otherPattern);
+
     /**
      * Set the list of mimetypes that are used for comparison with the
      * item in KFileItemModelFilter::matchesMimeType.
@@ -80,9 +90,23 @@ private:
      */
     bool matchesType(const KFileItem& item) const;
 
-    bool m_useRegExp;           // If true, m_regExp is used for filtering,
+    /**
+     * @return True if text contains m_lowerCasePattern, ignoring the case.
+     */
+    bool containsPattern(const QString& text) const;
+
+    /**
+     * @return Pattern with all characters converted to lowercase
+     *         one by one, as done by containsPattern() for the text.
+     */
+    static QString lowerCasePattern(const QString& pattern);
+
+    static bool isWildcardPattern(const QString& pattern);
+
+    bool m_useGlob;             // If true, m_glob or m_regExp is used for filtering,
                                 // otherwise m_lowerCaseFilter is used.
-    QRegExp* m_regExp;
+    KFileItemModelGlobMatcher m_glob;
+    QRegExp* m_regExp;          // Only used if m_glob cannot compile the pattern.
     QString m_lowerCasePattern; // Lowercase version of m_filter for
                                 // faster comparison in matches().
     QString m_pattern;          // Property set by setPattern().
@@ -0,0 +1,258 @@
+/*  This file is part of the KDE project
+    Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License version 2, as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#include "kfileitemmodelglobmatcher.h"
+
+namespace {
+    // The positions of a state are stored as bits of a quint64,
+    // the last position is the accepting one.
+    const int MaxTokens = 63;
+
+    // Limits for the lazily built automaton, it is rebuilt from
+    // scratch if a pattern creates more states or transitions.
+    const int MaxStates = 1024;
+    const int MaxOtherTransitions = 65536;
+}
+
+KFileItemModelGlobMatcher::KFileItemModelGlobMatcher() :
+    m_tokens(),
+    m_acceptPosition(1),
+    m_states(),
+    m_stateIndexes(),
+    m_asciiTransitions(),
+    m_otherTransitions()
+{
+    resetStates();
+}
+
+bool KFileItemModelGlobMatcher::setPattern(const QString& pattern)
+{
+    m_tokens.clear();
+
+    const int length = pattern.length();
+    int index = 0;
+    while (index < length) {
+        Token token;
+        token.type = LiteralToken;
+        token.ch = 0;
+        token.negated = false;
+
+        const QChar ch = pattern.at(index);
+        if (ch == QLatin1Char('*')) {
+            ++index;
+            if (!m_tokens.isEmpty() && m_tokens.last().type == AnyStringToken) {
+                // "**" is equal to "*"
+                continue;
+            }
+            token.type = AnyStringToken;
+        } else if (ch == QLatin1Char('?')) {
+            token.type = AnyCharToken;
+            ++index;
+        } else {
+            bool isCharSet = false;
+            if (ch == QLatin1Char('[')) {
+                int setIndex = index + 1;
+                if (setIndex < length && (pattern.at(setIndex) == QLatin1Char('!') ||
+                                          pattern.at(setIndex) == QLatin1Char('^'))) {
+                    token.negated = true;
+                    ++setIndex;
+                }
+
+                // A ']' directly after the opening bracket is part of the set
+                const int firstSetIndex = setIndex;
+                while (setIndex < length && (pattern.at(setIndex) != QLatin1Char(']') || setIndex == firstSetIndex)) {
+                    ushort from = pattern.at(setIndex).unicode();
+                    if (from == '\\' && setIndex + 1 < length) {
+                        ++setIndex;
+                        from = pattern.at(setIndex).unicode();
+                    }
+
+                    ushort to = from;
+                    if (setIndex + 2 < length &&
+                        pattern.at(setIndex + 1) == QLatin1Char('-') &&
+                        pattern.at(setIndex + 2) != QLatin1Char(']')) {
+                        to = pattern.at(setIndex + 2).unicode();
+                        setIndex += 2;
+                    }
+                    token.ranges.append(qMakePair(from, to));
+                    ++setIndex;
+                }
+
+                // An unterminated set is taken literally
+                if (setIndex < length) {
+                    isCharSet = true;
+                    token.type = CharSetToken;
+                    index = setIndex + 1;
+                } else {
+                    token.negated = false;
+                    token.ranges.clear();
+                }
+            }
+
+            if (!isCharSet) {
+                if (ch == QLatin1Char('\\') && index + 1 < length) {
+                    ++index;
+                }
+                token.ch = pattern.at(index).toLower().unicode();
+                ++index;
+            }
+        }
+
+        m_tokens.append(token);
+        if (m_tokens.count() > MaxTokens) {
+            m_tokens.clear();
+            return false;
+        }
+    }
+
+    m_acceptPosition = quint64(1) << m_tokens.count();
+    resetStates();
+    return true;
+}
+
+bool KFileItemModelGlobMatcher::exactMatch(const QString& text) const
+{
+    if (m_states.count() > MaxStates || m_otherTransitions.count() > MaxOtherTransitions) {
+        resetStates();
+    }
+
+    int state = 1;
+    const ushort* ch = text.utf16();
+    const ushort* end = ch + text.length();
+    for (; ch != end; ++ch) {
+        state = transition(state, *ch);
+        if (state == 0) {
+            return false;
+        }
+    }
+
+    return (m_states.at(state) & m_acceptPosition) != 0;
+}
+
+bool KFileItemModelGlobMatcher::charSetContains(const Token& token, ushort ch) const
+{
+    const ushort lower = QChar(ch).toLower().unicode();
+    const ushort upper = QChar(ch).toUpper().unicode();
+
+    bool contains = false;
+    const int count = token.ranges.count();
+    for (int i = 0; i < count && !contains; ++i) {
+        const QPair<ushort, ushort>& range = token.ranges.at(i);
+        contains = (ch >= range.first && ch <= range.second) ||
+                   (lower >= range.first && lower <= range.second) ||
+                   (upper >= range.first && upper <= range.second);
+    }
+
+    return contains != token.negated;
+}
+
+quint64 KFileItemModelGlobMatcher::closure(quint64 positions) const
+{
+    // A '*' may match an empty string, so the position after it is
+    // reached as well. Going forward also covers "*?*"-like chains.
+    const int count = m_tokens.count();
+    for (int i = 0; i < count; ++i) {
+        if ((positions & (quint64(1) << i)) && m_tokens.at(i).type == AnyStringToken) {
+            positions |= quint64(1) << (i + 1);
+        }
+    }
+    return positions;
+}
+
+quint64 KFileItemModelGlobMatcher::step(quint64 positions, ushort ch) const
+{
+    const ushort lower = QChar(ch).toLower().unicode();
+
+    quint64 nextPositions = 0;
+    const int count = m_tokens.count();
+    for (int i = 0; i < count; ++i) {
+        if (!(positions & (quint64(1) << i))) {
+            continue;
+        }
+
+        const Token& token = m_tokens.at(i);
+        switch (token.type) {
+        case LiteralToken:
+            if (token.ch == lower) {
+                nextPositions |= quint64(1) << (i + 1);
+            }
+            break;
+        case AnyCharToken:
+            nextPositions |= quint64(1) << (i + 1);
+            break;
+        case AnyStringToken:
+            nextPositions |= quint64(1) << i;
+            break;
+        case CharSetToken:
+            if (charSetContains(token, ch)) {
+                nextPositions |= quint64(1) << (i + 1);
+            }
+            break;
+        }
+    }
+
+    return closure(nextPositions);
+}
+
+int KFileItemModelGlobMatcher::stateIndex(quint64 positions) const
+{
+    QHash<quint64, int>::const_iterator it = m_stateIndexes.constFind(positions);
+    if (it != m_stateIndexes.constEnd()) {
+        return it.value();
+    }
+
+    const int index = m_states.count();
+    m_states.append(positions);
+    m_stateIndexes.insert(positions, index);
+    m_asciiTransitions.insert(m_asciiTransitions.count(), 128, -1);
+    return index;
+}
+
+int KFileItemModelGlobMatcher::transition(int state, ushort ch) const
+{
+    if (ch < 128) {
+        const int transitionIndex = state * 128 + ch;
+        int nextState = m_asciiTransitions.at(transitionIndex);
+        if (nextState < 0) {
+            nextState = stateIndex(step(m_states.at(state), ch));
+            m_asciiTransitions[transitionIndex] = nextState;
+        }
+        return nextState;
+    }
+
+    const quint32 key = (quint32(state) << 16) | ch;
+    QHash<quint32, int>::const_iterator it = m_otherTransitions.constFind(key);
+    if (it != m_otherTransitions.constEnd()) {
+        return it.value();
+    }
+
+    const int nextState = stateIndex(step(m_states.at(state), ch));
+    m_otherTransitions.insert(key, nextState);
+    return nextState;
+}
+
+void KFileItemModelGlobMatcher::resetStates() const
+{
+    m_states.clear();
+    m_stateIndexes.clear();
+    m_asciiTransitions.clear();
+    m_otherTransitions.clear();
+
+    stateIndex(0);
+    stateIndex(closure(1));
+}
@@ -0,0 +1,91 @@
+/*  This file is part of the KDE project
+    Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License version 2, as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KFILEITEMMODELGLOBMATCHER_H
+#define KFILEITEMMODELGLOBMATCHER_H
+
+#include <dolphinprivate_export.h>
+
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Case insensitive matcher for wildcard patterns.
+ *
+ * Supports the syntax of QRegExp::WildcardUnix: '*', '?', character
+ * sets like "[a-z]" or "[!0-9]" and escaping with '\'. The pattern is
+ * compiled into tokens, which are turned into a deterministic automaton
+ * while matching: each state is the set of pattern positions that may
+ * have been reached, and transitions are computed once per state and
+ * character. Matching a text hence costs one table lookup per character
+ * after the first few items have been checked.
+ */
+class DOLPHINPRIVATE_EXPORT KFileItemModelGlobMatcher
+{
+public:
+    KFileItemModelGlobMatcher();
+
+    /**
+     * Compiles the pattern.
+     * @return False if the pattern has too many tokens to be compiled,
+     *         in this case exactMatch() may not be used.
+     */
+    bool setPattern(const QString& pattern);
+
+    /**
+     * @return True if the whole text matches with the pattern.
+     */
+    bool exactMatch(const QString& text) const;
+
+private:
+    enum TokenType {
+        LiteralToken,
+        AnyCharToken,
+        AnyStringToken,
+        CharSetToken
+    };
+
+    struct Token
+    {
+        TokenType type;
+        ushort ch;                              // Lowercase character of a LiteralToken.
+        bool negated;                           // True for "[!...]" and "[^...]".
+        QVector<QPair<ushort, ushort> > ranges; // Characters of a CharSetToken.
+    };
+
+    bool charSetContains(const Token& token, ushort ch) const;
+    quint64 closure(quint64 positions) const;
+    quint64 step(quint64 positions, ushort ch) const;
+    int stateIndex(quint64 positions) const;
+    int transition(int state, ushort ch) const;
+    void resetStates() const;
+
+    QVector<Token> m_tokens;
+    quint64 m_acceptPosition;
+
+    // Lazily built automaton. Index 0 is the dead state without
+    // any positions, index 1 the start state.
+    mutable QVector<quint64> m_states;
+    mutable QHash<quint64, int> m_stateIndexes;
+    mutable QVector<int> m_asciiTransitions;        // 128 entries per state, -1 if unknown.
+    mutable QHash<quint32, int> m_otherTransitions; // Key is (state << 16) | character.
+};
+
+#endif
@@ -21,6 +21,9 @@
 
 #include <kitemviews/kitemlistview.h>
 
+// Number of items the sizehints are calculated for at once
+static const int s_blockSize = 512;
+
 KItemListSizeHintResolver::KItemListSizeHintResolver(const KItemListView* itemListView) :
     m_itemListView(itemListView),
     m_logicalHeightHintCache(),
@@ -35,7 +38,9 @@ KItemListSizeHintResolver::~KItemListSizeHintResolver()
 
 QSizeF KItemListSizeHintResolver::sizeHint(int index)
 {
-    updateCache();
+    if (m_needsResolving || m_logicalHeightHintCache.at(index) <= 0.0) {
+        resolveBlock(index);
+    }
     return QSizeF(m_logicalWidthHint, m_logicalHeightHintCache.at(index));
 }
 
@@ -148,7 +153,16 @@ void KItemListSizeHintResolver::clearCache()
 void KItemListSizeHintResolver::updateCache()
 {
     if (m_needsResolving) {
-        m_itemListView->calculateItemSizeHints(m_logicalHeightHintCache, m_logicalWidthHint);
+        m_itemListView->calculateItemSizeHints(m_logicalHeightHintCache, m_logicalWidthHint,
+                                               0, m_logicalHeightHintCache.count());
         m_needsResolving = false;
     }
 }
+
+void KItemListSizeHintResolver::resolveBlock(int index)
+{
+    const int firstIndex = index - (index % s_blockSize);
+    const int count = qMin(s_blockSize, m_logicalHeightHintCache.count() - firstIndex);
+    m_itemListView->calculateItemSizeHints(m_logicalHeightHintCache, m_logicalWidthHint, firstIndex, count);
+    m_needsResolving = false;
+}
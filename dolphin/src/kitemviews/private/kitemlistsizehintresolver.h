@@ -30,6 +30,9 @@ class KItemListView;
 
 /**
  * @brief Calculates and caches the sizehints of items in KItemListView.
+ *
+ * The sizehints are calculated on demand in blocks of items, so that only
+ * the items that are actually laid out pay for the calculation.
  */
 class DOLPHINPRIVATE_EXPORT KItemListSizeHintResolver
 {
@@ -47,6 +50,8 @@ public:
     void updateCache();
 
 private:
+    void resolveBlock(int index);
+
     const KItemListView* m_itemListView;
     mutable QVector<qreal> m_logicalHeightHintCache;
     mutable qreal m_logicalWidthHint;
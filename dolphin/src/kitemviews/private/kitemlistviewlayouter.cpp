@@ -24,11 +24,17 @@
 
 #include <KDebug>
 
+#include <QtAlgorithms>
+
 // #define KITEMLISTVIEWLAYOUTER_DEBUG
 
+// Number of rows whose heights are resolved at once
+static const int s_rowChunkSize = 256;
+
 KItemListViewLayouter::KItemListViewLayouter(KItemListSizeHintResolver* sizeHintResolver, QObject* parent) :
     QObject(parent),
     m_dirty(true),
+    m_columnsDirty(true),
     m_visibleIndexesDirty(true),
     m_scrollOrientation(Qt::Vertical),
     m_size(),
@@ -38,7 +44,6 @@ KItemListViewLayouter::KItemListViewLayouter(KItemListSizeHintResolver* sizeHint
     m_model(0),
     m_sizeHintResolver(sizeHintResolver),
     m_scrollOffset(0),
-    m_maximumScrollOffset(0),
     m_itemOffset(0),
     m_maximumItemOffset(0),
     m_firstVisibleIndex(-1),
@@ -46,12 +51,23 @@ KItemListViewLayouter::KItemListViewLayouter(KItemListSizeHintResolver* sizeHint
     m_columnWidth(0),
     m_xPosInc(0),
     m_columnCount(0),
-    m_rowOffsets(),
     m_columnOffsets(),
     m_groupItemIndexes(),
     m_groupHeaderHeight(0),
     m_groupHeaderMargin(0),
-    m_itemInfos()
+    m_grouped(false),
+    m_itemCount(0),
+    m_rowCount(0),
+    m_rowsOffset(0),
+    m_rowMargin(0),
+    m_minimumRowHeight(0),
+    m_segmentFirstIndexes(),
+    m_segmentFirstRows(),
+    m_segmentSpacings(),
+    m_rowExtents(),
+    m_rowExtentsTree(),
+    m_resolvedChunks(),
+    m_firstUnresolvedChunk(0)
 {
     Q_ASSERT(m_sizeHintResolver);
 }
@@ -76,12 +92,14 @@ Qt::Orientation KItemListViewLayouter::scrollOrientation() const
 void KItemListViewLayouter::setSize(const QSizeF& size)
 {
     if (m_size != size) {
+        // The heights of the rows stay valid as long as the number of columns
+        // does not change, see doLayout()
         if (m_scrollOrientation == Qt::Vertical) {
             if (m_size.width() != size.width()) {
-                m_dirty = true;
+                m_columnsDirty = true;
             }
         } else if (m_size.height() != size.height()) {
-            m_dirty = true;
+            m_columnsDirty = true;
         }
 
         m_size = size;
@@ -97,8 +115,17 @@ QSizeF KItemListViewLayouter::size() const
 void KItemListViewLayouter::setItemSize(const QSizeF& size)
 {
     if (m_itemSize != size) {
+        // Only the columns depend on the logical width of the items, e.g.
+        // the Details View adjusts the item width on each resize
+        const bool logicalHeightChanged = (m_scrollOrientation == Qt::Vertical)
+                                          ? (m_itemSize.height() != size.height())
+                                          : (m_itemSize.width() != size.width());
+        if (logicalHeightChanged) {
+            m_dirty = true;
+        } else {
+            m_columnsDirty = true;
+        }
         m_itemSize = size;
-        m_dirty = true;
     }
 }
 
@@ -175,7 +202,13 @@ qreal KItemListViewLayouter::scrollOffset() const
 qreal KItemListViewLayouter::maximumScrollOffset() const
 {
     const_cast<KItemListViewLayouter*>(this)->doLayout();
-    return m_maximumScrollOffset;
+    if (m_rowCount == 0) {
+        return 0;
+    }
+
+    // Rows below the visible area that have not been resolved yet
+    // contribute their minimum height
+    return m_rowsOffset + rowExtentsSum(m_rowCount);
 }
 
 void KItemListViewLayouter::setItemOffset(qreal offset)
@@ -225,14 +258,17 @@ int KItemListViewLayouter::lastVisibleIndex() const
 QRectF KItemListViewLayouter::itemRect(int index) const
 {
     const_cast<KItemListViewLayouter*>(this)->doLayout();
-    if (index < 0 || index >= m_itemInfos.count()) {
+    if (index < 0 || index >= m_itemCount) {
         return QRectF();
     }
 
+    const int row = logicalRow(index);
+    const_cast<KItemListViewLayouter*>(this)->resolveRows(row);
+
     QSizeF sizeHint = m_sizeHintResolver->sizeHint(index);
 
-    const qreal x = m_columnOffsets.at(m_itemInfos.at(index).column);
-    const qreal y = m_rowOffsets.at(m_itemInfos.at(index).row);
+    const qreal x = m_columnOffsets.at(logicalColumn(index));
+    const qreal y = rowOffset(row);
 
     if (m_scrollOrientation == Qt::Horizontal) {
         // Rotate the logical direction which is always vertical by 90°
@@ -272,17 +308,12 @@ QRectF KItemListViewLayouter::groupHeaderRect(int index) const
         pos.ry() = 0;
 
         // Determine the maximum width used in the current column. As the
-        // scroll-direction is Qt::Horizontal and m_itemRects is accessed
+        // scroll-direction is Qt::Horizontal and the logical rows are used
         // directly, the logical height represents the visual width, and
         // the logical row represents the column.
         qreal headerWidth = minimumGroupHeaderWidth();
-        const int row = m_itemInfos[index].row;
-        const int maxIndex = m_itemInfos.count() - 1;
+        const int maxIndex = rowLastIndex(logicalRow(index));
         while (index <= maxIndex) {
-            if (m_itemInfos[index].row != row) {
-                break;
-            }
-
             const qreal itemWidth = (m_scrollOrientation == Qt::Vertical)
                                      ? m_sizeHintResolver->sizeHint(index).width()
                                      : m_sizeHintResolver->sizeHint(index).height();
@@ -302,25 +333,25 @@ QRectF KItemListViewLayouter::groupHeaderRect(int index) const
 int KItemListViewLayouter::itemColumn(int index) const
 {
     const_cast<KItemListViewLayouter*>(this)->doLayout();
-    if (index < 0 || index >= m_itemInfos.count()) {
+    if (index < 0 || index >= m_itemCount) {
         return -1;
     }
 
     return (m_scrollOrientation == Qt::Vertical)
-            ? m_itemInfos[index].column
-            : m_itemInfos[index].row;
+            ? logicalColumn(index)
+            : logicalRow(index);
 }
 
 int KItemListViewLayouter::itemRow(int index) const
 {
     const_cast<KItemListViewLayouter*>(this)->doLayout();
-    if (index < 0 || index >= m_itemInfos.count()) {
+    if (index < 0 || index >= m_itemCount) {
         return -1;
     }
 
     return (m_scrollOrientation == Qt::Vertical)
-            ? m_itemInfos[index].row
-            : m_itemInfos[index].column;
+            ? logicalRow(index)
+            : logicalColumn(index);
 }
 
 int KItemListViewLayouter::maximumVisibleItems() const
@@ -348,180 +379,223 @@ void KItemListViewLayouter::markAsDirty()
     m_dirty = true;
 }
 
+void KItemListViewLayouter::markItemsAsDirty(int index, int count)
+{
+    if (m_dirty || m_columnsDirty) {
+        // The rows get resolved again anyway
+        return;
+    }
+
+    if (index < 0 || count <= 0 || index + count > m_itemCount) {
+        m_dirty = true;
+        return;
+    }
+
+    const int firstChunk = logicalRow(index) / s_rowChunkSize;
+    const int lastChunk = logicalRow(index + count - 1) / s_rowChunkSize;
+    for (int chunk = firstChunk; chunk <= lastChunk; ++chunk) {
+        if (!m_resolvedChunks.at(chunk)) {
+            continue;
+        }
+
+        const int lastRow = qMin((chunk + 1) * s_rowChunkSize, m_rowCount);
+        for (int row = chunk * s_rowChunkSize; row < lastRow; ++row) {
+            setRowExtent(row, estimatedRowExtent(row));
+        }
+        m_resolvedChunks[chunk] = false;
+    }
+
+    m_firstUnresolvedChunk = qMin(m_firstUnresolvedChunk, firstChunk);
+    m_visibleIndexesDirty = true;
+}
 
 #ifndef QT_NO_DEBUG
     bool KItemListViewLayouter::isDirty()
     {
-        return m_dirty;
+        return m_dirty || m_columnsDirty;
     }
 #endif
 
 void KItemListViewLayouter::doLayout()
 {
-    if (m_dirty) {
+    if (m_dirty || m_columnsDirty) {
 #ifdef KITEMLISTVIEWLAYOUTER_DEBUG
         QElapsedTimer timer;
         timer.start();
 #endif
         m_visibleIndexesDirty = true;
 
-        QSizeF itemSize = m_itemSize;
-        QSizeF itemMargin = m_itemMargin;
-        QSizeF size = m_size;
-
-        const bool grouped = createGroupHeaders();
-
-        const bool horizontalScrolling = (m_scrollOrientation == Qt::Horizontal);
-        if (horizontalScrolling) {
-            // Flip everything so that the layout logically can work like having
-            // a vertical scrolling
-            itemSize.transpose();
-            itemMargin.transpose();
-            size.transpose();
-
-            if (grouped) {
-                // In the horizontal scrolling case all groups are aligned
-                // at the top, which decreases the available height. For the
-                // flipped data this means that the width must be decreased.
-                size.rwidth() -= m_groupHeaderHeight;
-            }
+        if (m_dirty) {
+            m_grouped = createGroupHeaders();
+            m_itemCount = m_model->count();
         }
 
-        m_columnWidth = itemSize.width() + itemMargin.width();
-        const qreal widthForColumns = size.width() - itemMargin.width();
-        m_columnCount = qMax(1, int(widthForColumns / m_columnWidth));
-        m_xPosInc = itemMargin.width();
-
-        const int itemCount = m_model->count();
-        if (itemCount > m_columnCount && m_columnWidth >= 32) {
-            // Apply the unused width equally to each column
-            const qreal unusedWidth = widthForColumns - m_columnCount * m_columnWidth;
-            if (unusedWidth > 0) {
-                const qreal columnInc = unusedWidth / (m_columnCount + 1);
-                m_columnWidth += columnInc;
-                m_xPosInc += columnInc;
-            }
+        // The rows only need to be laid out again if the number of columns
+        // changes, e.g. resizing the Details View does not require it
+        const int previousColumnCount = m_columnCount;
+        updateColumns();
+        if (m_dirty || m_columnCount != previousColumnCount) {
+            updateRows();
         }
 
-        m_itemInfos.resize(itemCount);
+#ifdef KITEMLISTVIEWLAYOUTER_DEBUG
+        kDebug() << "[TIME] doLayout() for " << m_model->count() << "items:" << timer.elapsed();
+#endif
+        m_dirty = false;
+        m_columnsDirty = false;
+    }
 
-        // Calculate the offset of each column, i.e., the x-coordinate where the column starts.
-        m_columnOffsets.resize(m_columnCount);
-        qreal currentOffset = m_xPosInc;
+    updateVisibleIndexes();
+}
 
-        if (grouped && horizontalScrolling) {
-            // All group headers will always be aligned on the top and not
-            // flipped like the other properties.
-            currentOffset += m_groupHeaderHeight;
-        }
+void KItemListViewLayouter::updateColumns()
+{
+    QSizeF itemSize = m_itemSize;
+    QSizeF itemMargin = m_itemMargin;
+    QSizeF size = m_size;
+
+    const bool horizontalScrolling = (m_scrollOrientation == Qt::Horizontal);
+    if (horizontalScrolling) {
+        // Flip everything so that the layout logically can work like having
+        // a vertical scrolling
+        itemSize.transpose();
+        itemMargin.transpose();
+        size.transpose();
 
-        for (int column = 0; column < m_columnCount; ++column) {
-            m_columnOffsets[column] = currentOffset;
-            currentOffset += m_columnWidth;
+        if (m_grouped) {
+            // In the horizontal scrolling case all groups are aligned
+            // at the top, which decreases the available height. For the
+            // flipped data this means that the width must be decreased.
+            size.rwidth() -= m_groupHeaderHeight;
         }
+    }
 
-        // Prepare the QVector which stores the y-coordinate for each new row.
-        int numberOfRows = (itemCount + m_columnCount - 1) / m_columnCount;
-        if (grouped && m_columnCount > 1) {
-            // In the worst case, a new row will be started for every group.
-            // We could calculate the exact number of rows now to prevent that we reserve
-            // too much memory, but the code required to do that might need much more
-            // memory than it would save in the average case.
-            numberOfRows += m_groupItemIndexes.count();
+    m_columnWidth = itemSize.width() + itemMargin.width();
+    const qreal widthForColumns = size.width() - itemMargin.width();
+    m_columnCount = qMax(1, int(widthForColumns / m_columnWidth));
+    m_xPosInc = itemMargin.width();
+
+    if (m_itemCount > m_columnCount && m_columnWidth >= 32) {
+        // Apply the unused width equally to each column
+        const qreal unusedWidth = widthForColumns - m_columnCount * m_columnWidth;
+        if (unusedWidth > 0) {
+            const qreal columnInc = unusedWidth / (m_columnCount + 1);
+            m_columnWidth += columnInc;
+            m_xPosInc += columnInc;
         }
-        m_rowOffsets.resize(numberOfRows);
-
-        qreal y = m_headerHeight + itemMargin.height();
-        int row = 0;
-
-        int index = 0;
-        while (index < itemCount) {
-            qreal maxItemHeight = itemSize.height();
-
-            if (grouped) {
-                if (m_groupItemIndexes.contains(index)) {
-                    // The item is the first item of a group.
-                    // Increase the y-position to provide space
-                    // for the group header.
-                    if (index > 0) {
-                        // Only add a margin if there has been added another
-                        // group already before
-                        y += m_groupHeaderMargin;
-                    } else if (!horizontalScrolling) {
-                        // The first group header should be aligned on top
-                        y -= itemMargin.height();
-                    }
-
-                    if (!horizontalScrolling) {
-                        y += m_groupHeaderHeight;
-                    }
-                }
+    }
+
+    // Calculate the offset of each column, i.e., the x-coordinate where the column starts.
+    m_columnOffsets.resize(m_columnCount);
+    qreal currentOffset = m_xPosInc;
+
+    if (m_grouped && horizontalScrolling) {
+        // All group headers will always be aligned on the top and not
+        // flipped like the other properties.
+        currentOffset += m_groupHeaderHeight;
+    }
+
+    for (int column = 0; column < m_columnCount; ++column) {
+        m_columnOffsets[column] = currentOffset;
+        currentOffset += m_columnWidth;
+    }
+
+    m_rowsOffset = m_headerHeight + itemMargin.height();
+    m_rowMargin = itemMargin.height();
+    m_minimumRowHeight = itemSize.height();
+    if (m_grouped && horizontalScrolling) {
+        // When grouping is enabled in the horizontal mode, the header alignment
+        // looks like this:
+        //   Header-1 Header-2 Header-3
+        //   Item 1   Item 4   Item 7
+        //   Item 2   Item 5   Item 8
+        //   Item 3   Item 6   Item 9
+        // In this case the row height represents the column-width. We don't
+        // check the content of the header in the layouter to determine the required
+        // width, hence assure that at least a minimal width of 15 characters is given
+        // (in average a character requires the halve width of the font height).
+        //
+        // TODO: Let the group headers provide a minimum width and respect this width here
+        m_minimumRowHeight = qMax(m_minimumRowHeight, minimumGroupHeaderWidth());
+    }
+
+    if (m_itemCount > 0) {
+        m_maximumItemOffset = m_columnCount * m_columnWidth;
+    } else {
+        m_maximumItemOffset = 0;
+    }
+}
+
+void KItemListViewLayouter::updateRows()
+{
+    const bool horizontalScrolling = (m_scrollOrientation == Qt::Horizontal);
+
+    // Split the items into segments, each group starts a new row
+    m_segmentFirstIndexes.clear();
+    m_segmentFirstRows.clear();
+    m_segmentSpacings.clear();
+    if (m_itemCount > 0 && (!m_grouped || !m_groupItemIndexes.contains(0))) {
+        m_segmentFirstIndexes.append(0);
+    }
+    if (m_grouped) {
+        const QList<QPair<int, QVariant> > groups = m_model->groups();
+        for (int i = 0; i < groups.count(); ++i) {
+            const int firstItemIndex = groups.at(i).first;
+            if (firstItemIndex >= 0 && firstItemIndex < m_itemCount
+                && (m_segmentFirstIndexes.isEmpty() || firstItemIndex > m_segmentFirstIndexes.last())) {
+                m_segmentFirstIndexes.append(firstItemIndex);
             }
+        }
+    }
 
-            m_rowOffsets[row] = y;
-
-            int column = 0;
-            while (index < itemCount && column < m_columnCount) {
-                qreal requiredItemHeight = itemSize.height();
-                const QSizeF sizeHint = m_sizeHintResolver->sizeHint(index);
-                const qreal sizeHintHeight = sizeHint.height();
-                if (sizeHintHeight > requiredItemHeight) {
-                    requiredItemHeight = sizeHintHeight;
-                }
-
-                ItemInfo& itemInfo = m_itemInfos[index];
-                itemInfo.column = column;
-                itemInfo.row = row;
-
-                if (grouped && horizontalScrolling) {
-                    // When grouping is enabled in the horizontal mode, the header alignment
-                    // looks like this:
-                    //   Header-1 Header-2 Header-3
-                    //   Item 1   Item 4   Item 7
-                    //   Item 2   Item 5   Item 8
-                    //   Item 3   Item 6   Item 9
-                    // In this case 'requiredItemHeight' represents the column-width. We don't
-                    // check the content of the header in the layouter to determine the required
-                    // width, hence assure that at least a minimal width of 15 characters is given
-                    // (in average a character requires the halve width of the font height).
-                    //
-                    // TODO: Let the group headers provide a minimum width and respect this width here
-                    const qreal headerWidth = minimumGroupHeaderWidth();
-                    if (requiredItemHeight < headerWidth) {
-                        requiredItemHeight = headerWidth;
-                    }
-                }
-
-                maxItemHeight = qMax(maxItemHeight, requiredItemHeight);
-                ++index;
-                ++column;
-
-                if (grouped && m_groupItemIndexes.contains(index)) {
-                    // The item represents the first index of a group
-                    // and must aligned in the first column
-                    break;
-                }
+    m_rowCount = 0;
+    const int segmentCount = m_segmentFirstIndexes.count();
+    m_segmentFirstRows.resize(segmentCount);
+    m_segmentSpacings.resize(segmentCount);
+    for (int segment = 0; segment < segmentCount; ++segment) {
+        const int firstIndex = m_segmentFirstIndexes.at(segment);
+        const int nextIndex = (segment + 1 < segmentCount) ? m_segmentFirstIndexes.at(segment + 1) : m_itemCount;
+
+        qreal spacing = 0;
+        if (m_grouped && m_groupItemIndexes.contains(firstIndex)) {
+            // The item is the first item of a group.
+            // Increase the y-position to provide space
+            // for the group header.
+            if (firstIndex > 0) {
+                // Only add a margin if there has been added another
+                // group already before
+                spacing += m_groupHeaderMargin;
+            } else if (!horizontalScrolling) {
+                // The first group header should be aligned on top
+                spacing -= m_rowMargin;
             }
 
-            y += maxItemHeight + itemMargin.height();
-            ++row;
+            if (!horizontalScrolling) {
+                spacing += m_groupHeaderHeight;
+            }
         }
 
-        if (itemCount > 0) {
-            m_maximumScrollOffset = y;
-            m_maximumItemOffset = m_columnCount * m_columnWidth;
-        } else {
-            m_maximumScrollOffset = 0;
-            m_maximumItemOffset = 0;
-        }
+        m_segmentFirstRows[segment] = m_rowCount;
+        m_segmentSpacings[segment] = spacing;
+        m_rowCount += (nextIndex - firstIndex + m_columnCount - 1) / m_columnCount;
+    }
 
-#ifdef KITEMLISTVIEWLAYOUTER_DEBUG
-        kDebug() << "[TIME] doLayout() for " << m_model->count() << "items:" << timer.elapsed();
-#endif
-        m_dirty = false;
+    // All rows start with their minimum height, the Fenwick tree can be built in linear time
+    m_rowExtents.resize(m_rowCount);
+    m_rowExtentsTree.resize(m_rowCount);
+    for (int row = 0; row < m_rowCount; ++row) {
+        m_rowExtents[row] = estimatedRowExtent(row);
+        m_rowExtentsTree[row] = m_rowExtents[row];
+    }
+    for (int row = 0; row < m_rowCount; ++row) {
+        const int parent = (row | (row + 1));
+        if (parent < m_rowCount) {
+            m_rowExtentsTree[parent] += m_rowExtentsTree[row];
+        }
     }
 
-    updateVisibleIndexes();
+    m_resolvedChunks.fill(false, (m_rowCount + s_rowChunkSize - 1) / s_rowChunkSize);
+    m_firstUnresolvedChunk = 0;
 }
 
 void KItemListViewLayouter::updateVisibleIndexes()
@@ -532,65 +606,41 @@ void KItemListViewLayouter::updateVisibleIndexes()
 
     Q_ASSERT(!m_dirty);
 
-    if (m_model->count() <= 0) {
+    if (m_itemCount <= 0 || m_rowCount <= 0) {
         m_firstVisibleIndex = -1;
         m_lastVisibleIndex = -1;
         m_visibleIndexesDirty = false;
         return;
     }
 
-    const int maxIndex = m_model->count() - 1;
-
-    // Calculate the first visible index that is fully visible
-    int min = 0;
-    int max = maxIndex;
-    int mid = 0;
-    do {
-        mid = (min + max) / 2;
-        if (m_rowOffsets.at(m_itemInfos[mid].row) < m_scrollOffset) {
-            min = mid + 1;
-        } else {
-            max = mid - 1;
-        }
-    } while (min <= max);
-
-    if (mid > 0) {
-        // Include the row before the first fully visible index, as it might
-        // be partly visible
-        if (m_rowOffsets.at(m_itemInfos[mid].row) >= m_scrollOffset) {
-            --mid;
-            Q_ASSERT(m_rowOffsets.at(m_itemInfos[mid].row) < m_scrollOffset);
-        }
-
-        const int firstVisibleRow = m_itemInfos[mid].row;
-        while (mid > 0 && m_itemInfos[mid - 1].row == firstVisibleRow) {
-            --mid;
-        }
-    }
-    m_firstVisibleIndex = mid;
-
-    // Calculate the last visible index that is (at least partly) visible
+    // Calculate the last row that is (at least partly) visible
     const int visibleHeight = (m_scrollOrientation == Qt::Horizontal) ? m_size.width() : m_size.height();
     qreal bottom = m_scrollOffset + visibleHeight;
     if (m_model->groupedSorting()) {
         bottom += m_groupHeaderHeight;
     }
 
-    min = m_firstVisibleIndex;
-    max = maxIndex;
-    do {
-        mid = (min + max) / 2;
-        if (m_rowOffsets.at(m_itemInfos[mid].row) <= bottom) {
-            min = mid + 1;
-        } else {
-            max = mid - 1;
-        }
-    } while (min <= max);
+    // Resolve the rows up to the last visible one. Resolving can only increase
+    // the height of rows, so the last visible row can only move up and the
+    // loop ends at the latest after the second iteration.
+    int lastVisibleRow = qMax(findRow(bottom, false) - 1, 0);
+    while (lastVisibleRow / s_rowChunkSize >= m_firstUnresolvedChunk) {
+        resolveRows(lastVisibleRow);
+        lastVisibleRow = qMax(findRow(bottom, false) - 1, 0);
+    }
 
-    while (mid > 0 && m_rowOffsets.at(m_itemInfos[mid].row) > bottom) {
-        --mid;
+    // Calculate the first visible row and include the row before the first
+    // fully visible row, as it might be partly visible
+    int firstVisibleRow = findRow(m_scrollOffset, true);
+    if (firstVisibleRow >= m_rowCount) {
+        firstVisibleRow = m_rowCount - 1;
+    } else if (firstVisibleRow > 0) {
+        --firstVisibleRow;
     }
-    m_lastVisibleIndex = mid;
+    lastVisibleRow = qMax(lastVisibleRow, firstVisibleRow);
+
+    m_firstVisibleIndex = rowFirstIndex(firstVisibleRow);
+    m_lastVisibleIndex = rowLastIndex(lastVisibleRow);
 
     m_visibleIndexesDirty = false;
 }
@@ -616,6 +666,141 @@ bool KItemListViewLayouter::createGroupHeaders()
     return true;
 }
 
+int KItemListViewLayouter::itemSegment(int index) const
+{
+    const QVector<int>::const_iterator it = qUpperBound(m_segmentFirstIndexes.constBegin(),
+                                                        m_segmentFirstIndexes.constEnd(),
+                                                        index);
+    return (it - m_segmentFirstIndexes.constBegin()) - 1;
+}
+
+int KItemListViewLayouter::rowSegment(int row) const
+{
+    const QVector<int>::const_iterator it = qUpperBound(m_segmentFirstRows.constBegin(),
+                                                        m_segmentFirstRows.constEnd(),
+                                                        row);
+    return (it - m_segmentFirstRows.constBegin()) - 1;
+}
+
+int KItemListViewLayouter::logicalRow(int index) const
+{
+    const int segment = itemSegment(index);
+    return m_segmentFirstRows.at(segment) + (index - m_segmentFirstIndexes.at(segment)) / m_columnCount;
+}
+
+int KItemListViewLayouter::logicalColumn(int index) const
+{
+    const int segment = itemSegment(index);
+    return (index - m_segmentFirstIndexes.at(segment)) % m_columnCount;
+}
+
+int KItemListViewLayouter::rowFirstIndex(int row) const
+{
+    const int segment = rowSegment(row);
+    return m_segmentFirstIndexes.at(segment) + (row - m_segmentFirstRows.at(segment)) * m_columnCount;
+}
+
+int KItemListViewLayouter::rowLastIndex(int row) const
+{
+    const int segment = rowSegment(row);
+    const int nextIndex = (segment + 1 < m_segmentFirstIndexes.count())
+                          ? m_segmentFirstIndexes.at(segment + 1)
+                          : m_itemCount;
+    return qMin(rowFirstIndex(row) + m_columnCount, nextIndex) - 1;
+}
+
+qreal KItemListViewLayouter::rowOffset(int row) const
+{
+    qreal offset = m_rowsOffset + rowExtentsSum(row);
+    const int segment = rowSegment(row);
+    if (m_segmentFirstRows.at(segment) == row) {
+        offset += m_segmentSpacings.at(segment);
+    }
+    return offset;
+}
+
+int KItemListViewLayouter::findRow(qreal offset, bool inclusive) const
+{
+    int min = 0;
+    int max = m_rowCount;
+    while (min < max) {
+        const int mid = (min + max) / 2;
+        const qreal midOffset = rowOffset(mid);
+        if (inclusive ? (midOffset >= offset) : (midOffset > offset)) {
+            max = mid;
+        } else {
+            min = mid + 1;
+        }
+    }
+    return min;
+}
+
+void KItemListViewLayouter::resolveRows(int row)
+{
+    const int lastChunk = qMin(row / s_rowChunkSize, m_resolvedChunks.count() - 1);
+    while (m_firstUnresolvedChunk <= lastChunk) {
+        if (!m_resolvedChunks.at(m_firstUnresolvedChunk)) {
+            resolveChunk(m_firstUnresolvedChunk);
+        }
+        ++m_firstUnresolvedChunk;
+    }
+    while (m_firstUnresolvedChunk < m_resolvedChunks.count() && m_resolvedChunks.at(m_firstUnresolvedChunk)) {
+        ++m_firstUnresolvedChunk;
+    }
+}
+
+void KItemListViewLayouter::resolveChunk(int chunk)
+{
+    const int lastRow = qMin((chunk + 1) * s_rowChunkSize, m_rowCount);
+    for (int row = chunk * s_rowChunkSize; row < lastRow; ++row) {
+        qreal maxItemHeight = m_minimumRowHeight;
+        const int lastIndex = rowLastIndex(row);
+        for (int index = rowFirstIndex(row); index <= lastIndex; ++index) {
+            const qreal sizeHintHeight = m_sizeHintResolver->sizeHint(index).height();
+            if (sizeHintHeight > maxItemHeight) {
+                maxItemHeight = sizeHintHeight;
+            }
+        }
+
+        const qreal extent = estimatedRowExtent(row) - m_minimumRowHeight + maxItemHeight;
+        setRowExtent(row, extent);
+    }
+    m_resolvedChunks[chunk] = true;
+}
+
+qreal KItemListViewLayouter::estimatedRowExtent(int row) const
+{
+    qreal extent = m_minimumRowHeight + m_rowMargin;
+    const int segment = rowSegment(row);
+    if (m_segmentFirstRows.at(segment) == row) {
+        extent += m_segmentSpacings.at(segment);
+    }
+    return extent;
+}
+
+void KItemListViewLayouter::setRowExtent(int row, qreal extent)
+{
+    const double delta = extent - m_rowExtents.at(row);
+    if (delta == 0) {
+        return;
+    }
+
+    m_rowExtents[row] = extent;
+    for (int i = row; i < m_rowCount; i |= (i + 1)) {
+        m_rowExtentsTree[i] += delta;
+    }
+}
+
+double KItemListViewLayouter::rowExtentsSum(int row) const
+{
+    // Sum of the extents of the rows 0 to row - 1
+    double sum = 0;
+    for (int i = row - 1; i >= 0; i = (i & (i + 1)) - 1) {
+        sum += m_rowExtentsTree.at(i);
+    }
+    return sum;
+}
+
 qreal KItemListViewLayouter::minimumGroupHeaderWidth() const
 {
     return 100;
@@ -44,6 +44,13 @@ class KItemListSizeHintResolver;
  * marking the layouter as dirty (see markAsDirty()). This means that
  * changing properties of the layouter is not expensive, only the
  * first read of a property can get expensive.
+ *
+ * The rows are not laid out all at once: the position of an item is derived
+ * from its index and the groups, the heights of the rows are resolved in chunks
+ * only up to the last row that is accessed. Rows that have not been resolved
+ * yet are assumed to have the minimum height. The row offsets are kept in a
+ * Fenwick tree, so that resolving or invalidating a chunk does not require to
+ * update the offsets of all following rows.
  */
 class DOLPHINPRIVATE_EXPORT KItemListViewLayouter : public QObject
 {
@@ -162,6 +169,12 @@ public:
      */
     void markAsDirty();
 
+    /**
+     * Marks the size of the items in the range \a index to \a index + \a count - 1
+     * as dirty. Only the chunks of rows containing these items get resolved again.
+     */
+    void markItemsAsDirty(int index, int count);
+
     inline int columnCount() const
     {
         return m_columnCount;
@@ -178,9 +191,41 @@ public:
 
 private:
     void doLayout();
+    void updateColumns();
+    void updateRows();
     void updateVisibleIndexes();
     bool createGroupHeaders();
 
+    /**
+     * @return Index of the segment of rows containing the item with the index \a index.
+     *         A segment starts with the first item or with the first item of a group.
+     */
+    int itemSegment(int index) const;
+    int rowSegment(int row) const;
+    int logicalRow(int index) const;
+    int logicalColumn(int index) const;
+    int rowFirstIndex(int row) const;
+    int rowLastIndex(int row) const;
+
+    /**
+     * @return The logical y-position of the row \a row. Rows that are not resolved
+     *         yet are assumed to have the minimum height.
+     */
+    qreal rowOffset(int row) const;
+
+    /**
+     * @return The first row with a logical y-position greater than \a offset or,
+     *         if \a inclusive is true, greater or equal than \a offset. The row
+     *         count is returned if there is no such row.
+     */
+    int findRow(qreal offset, bool inclusive) const;
+
+    void resolveRows(int row);
+    void resolveChunk(int chunk);
+    qreal estimatedRowExtent(int row) const;
+    void setRowExtent(int row, qreal extent);
+    double rowExtentsSum(int row) const;
+
     /**
      * @return Minimum width of group headers when grouping is enabled in the horizontal
      *         alignment mode. The header alignment is done like this:
@@ -193,6 +238,7 @@ private:
 
 private:
     bool m_dirty;
+    bool m_columnsDirty;
     bool m_visibleIndexesDirty;
 
     Qt::Orientation m_scrollOrientation;
@@ -205,7 +251,6 @@ private:
     KItemListSizeHintResolver* m_sizeHintResolver;
 
     qreal m_scrollOffset;
-    qreal m_maximumScrollOffset;
 
     qreal m_itemOffset;
     qreal m_maximumItemOffset;
@@ -217,7 +262,6 @@ private:
     qreal m_xPosInc;
     int m_columnCount;
 
-    QVector<qreal> m_rowOffsets;
     QVector<qreal> m_columnOffsets;
 
     // Stores all item indexes that are the first item of a group.
@@ -225,12 +269,28 @@ private:
     QSet<int> m_groupItemIndexes;
     qreal m_groupHeaderHeight;
     qreal m_groupHeaderMargin;
-
-    struct ItemInfo {
-        int column;
-        int row;
-    };
-    QVector<ItemInfo> m_itemInfos;
+    bool m_grouped;
+
+    int m_itemCount;
+    int m_rowCount;
+    // Logical y-position of the first row
+    qreal m_rowsOffset;
+    qreal m_rowMargin;
+    qreal m_minimumRowHeight;
+
+    // The first index, the first row and the group header spacing
+    // above the first row of each segment
+    QVector<int> m_segmentFirstIndexes;
+    QVector<int> m_segmentFirstRows;
+    QVector<qreal> m_segmentSpacings;
+
+    // Logical height of each row including the margin and the group header
+    // spacing. The sums are kept in a Fenwick tree, with double precision
+    // as the sum for millions of rows exceeds what a float can represent.
+    QVector<double> m_rowExtents;
+    QVector<double> m_rowExtentsTree;
+    QVector<bool> m_resolvedChunks;
+    int m_firstUnresolvedChunk;
 
     friend class KItemListControllerTest;
 };
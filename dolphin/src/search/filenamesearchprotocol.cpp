@@ -18,17 +18,21 @@
  ***************************************************************************/
 
 #include "filenamesearchprotocol.h"
+#include "filenamesearchwalker.h"
 
 #include <KComponentData>
 #include <KDirLister>
 #include <KFileItem>
 #include <KIO/NetAccess>
 #include <KIO/Job>
+#include <KMimeType>
 #include <KUrl>
+#include <KUser>
 #include <ktemporaryfile.h>
 
 #include <QCoreApplication>
 #include <QEventLoop>
+#include <QHash>
 #include <QRegExp>
 #include <QTextStream>
 
@@ -81,6 +85,13 @@ void FileNameSearchProtocol::listDir(const KUrl &url)
     QString checkType = url.queryItemValue("checkType");
 
     QString search = url.queryItemValue("search");
+    if (directory.isLocalFile()) {
+        searchLocalDirectory(directory, search, literal, caseSensitive, checkContent, checkType);
+        cleanup();
+        finished();
+        return;
+    }
+
     if (!search.isEmpty() && literal) {
         search = QRegExp::escape(search);
     }
@@ -89,6 +100,21 @@ void FileNameSearchProtocol::listDir(const KUrl &url)
         m_regExp = new QRegExp(search, caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
     }
 
+    // Search the sub-directories as well, like searchLocalDirectory() does
+    QList<KUrl> pendingDirs;
+    pendingDirs.append(directory);
+    while (!pendingDirs.isEmpty()) {
+        searchDirectory(pendingDirs.takeLast(), checkContent, checkType, pendingDirs);
+    }
+    listEntry(KIO::UDSEntry(), true);
+
+    cleanup();
+    finished();
+}
+
+void FileNameSearchProtocol::searchDirectory(const KUrl &directory, bool checkContent, const QString &checkType,
+                                             QList<KUrl> &pendingDirs)
+{
     // Get all items of the directory
     KDirLister *dirLister = new KDirLister();
     dirLister->setAutoUpdate(false);
@@ -101,7 +127,6 @@ void FileNameSearchProtocol::listDir(const KUrl &url)
     eventLoop.exec();
 
     // Visualize all items that match the search pattern
-    QList<KUrl> pendingDirs;
     const KFileItemList items = dirLister->items();
     foreach (const KFileItem& item, items) {
         bool addItem = false;
@@ -127,14 +152,94 @@ void FileNameSearchProtocol::listDir(const KUrl &url)
             entry.insert(KIO::UDSEntry::UDS_MIME_TYPE, item.mimetype());
             listEntry(entry, false);
         }
+
+        // Symbolic links are not followed, which also prevents endless loops
+        if (item.isDir() && !item.isLink()) {
+            const QString path = item.url().path();
+            if (path != QLatin1String("/dev") && path != QLatin1String("/proc") && path != QLatin1String("/sys")) {
+                pendingDirs.append(item.url());
+            }
+        }
     }
-    listEntry(KIO::UDSEntry(), true);
 
     delete dirLister;
     dirLister = 0;
+}
 
-    cleanup();
-    finished();
+void FileNameSearchProtocol::searchLocalDirectory(const KUrl &directory, const QString &search,
+                                                  bool literal, bool caseSensitive, bool checkContent,
+                                                  const QString &checkType)
+{
+    FileNameSearchWalker walker(search, literal, caseSensitive, checkContent);
+    walker.start(QFile::encodeName(directory.toLocalFile()));
+
+    const QStringList checkTypes = checkType.split(QLatin1Char(';'), QString::SkipEmptyParts);
+    QHash<uid_t, QString> userNames;
+    QHash<gid_t, QString> groupNames;
+    QList<FileNameSearchMatch> matches;
+    KIO::UDSEntryList entries;
+    while (walker.takeMatches(matches)) {
+        foreach (const FileNameSearchMatch &match, matches) {
+            const QString path = QFile::decodeName(match.path);
+            const KUrl url(path);
+            // The type is detected from the name only, unless that is not enough to tell
+            // it. The content is read only for files matching by content, which have been
+            // read already, and for files the name of which has no known extension.
+            KMimeType::Ptr mime = KMimeType::findByUrl(url, match.statBuffer.st_mode, true);
+            if (S_ISREG(match.statBuffer.st_mode) && (match.contentMatch || mime->isDefault())) {
+                mime = KMimeType::findByUrl(url, match.statBuffer.st_mode, false);
+            }
+            if (match.contentMatch) {
+                if (!mime->is(QLatin1String("text/plain"))) {
+                    continue;
+                }
+            } else if (!checkTypes.isEmpty()) {
+                bool addItem = false;
+                foreach (const QString &t, checkTypes) {
+                    if (mime->is(t)) {
+                        addItem = true;
+                        break;
+                    }
+                }
+                if (!addItem) {
+                    continue;
+                }
+            }
+
+            const uid_t uid = match.statBuffer.st_uid;
+            if (!userNames.contains(uid)) {
+                userNames.insert(uid, KUser(uid).loginName());
+            }
+            const gid_t gid = match.statBuffer.st_gid;
+            if (!groupNames.contains(gid)) {
+                groupNames.insert(gid, KUserGroup(gid).name());
+            }
+
+            KIO::UDSEntry entry;
+            entry.insert(KIO::UDSEntry::UDS_NAME, url.fileName());
+            entry.insert(KIO::UDSEntry::UDS_DISPLAY_NAME, url.fileName());
+            entry.insert(KIO::UDSEntry::UDS_URL, url.url());
+            entry.insert(KIO::UDSEntry::UDS_LOCAL_PATH, path);
+            entry.insert(KIO::UDSEntry::UDS_FILE_TYPE, match.statBuffer.st_mode & S_IFMT);
+            entry.insert(KIO::UDSEntry::UDS_ACCESS, match.statBuffer.st_mode & 07777);
+            entry.insert(KIO::UDSEntry::UDS_SIZE, static_cast<qlonglong>(match.statBuffer.st_size));
+            entry.insert(KIO::UDSEntry::UDS_MODIFICATION_TIME, static_cast<qlonglong>(match.statBuffer.st_mtime));
+            entry.insert(KIO::UDSEntry::UDS_ACCESS_TIME, static_cast<qlonglong>(match.statBuffer.st_atime));
+            entry.insert(KIO::UDSEntry::UDS_USER, userNames.value(uid));
+            entry.insert(KIO::UDSEntry::UDS_GROUP, groupNames.value(gid));
+            entry.insert(KIO::UDSEntry::UDS_MIME_TYPE, mime->name());
+            if (!match.linkDest.isEmpty()) {
+                entry.insert(KIO::UDSEntry::UDS_LINK_DEST, QFile::decodeName(match.linkDest));
+            }
+            entries.append(entry);
+        }
+
+        if (!entries.isEmpty()) {
+            listEntries(entries);
+            entries.clear();
+        }
+    }
+    listEntry(KIO::UDSEntry(), true);
 }
 
 bool FileNameSearchProtocol::contentContainsPattern(const KUrl& fileName) const
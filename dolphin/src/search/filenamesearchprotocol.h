@@ -22,6 +22,7 @@
 
 #include <kio/slavebase.h>
 
+#include <QList>
 #include <QRegExp>
 #include <QSet>
 
@@ -35,6 +36,11 @@ class KUrl;
  * The directory where the searching is started is defined in the "url" query
  * item. If the query item "checkContent" is set to "yes", all files with
  * a text MIME type will be checked for the content.
+ *
+ * The directory is searched together with its sub-directories. Hidden items
+ * are skipped and symbolic links to directories are not followed. Local
+ * directories are searched by FileNameSearchWalker, other directories are
+ * listed via KDirLister one after another.
  */
 class FileNameSearchProtocol : public KIO::SlaveBase
 {
@@ -46,6 +52,21 @@ public:
     void listDir(const KUrl &url) final;
 
 private:
+    /**
+     * Searches the local directory \a directory and its sub-directories,
+     * the matching items are listed in batches.
+     */
+    void searchLocalDirectory(const KUrl &directory, const QString &search,
+                              bool literal, bool caseSensitive, bool checkContent,
+                              const QString &checkType);
+
+    /**
+     * Lists the items of the remote directory \a directory which match, its
+     * sub-directories are appended to \a pendingDirs.
+     */
+    void searchDirectory(const KUrl &directory, bool checkContent, const QString &checkType,
+                         QList<KUrl> &pendingDirs);
+
     /**
      * @return True, if the pattern m_searchPattern is part of
      *         the file \a fileName.
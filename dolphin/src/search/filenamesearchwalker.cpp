@@ -0,0 +1,453 @@
+/*  This file is part of the KDE project
+    Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License version 2, as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#include "filenamesearchwalker.h"
+
+#include <QFile>
+
+#include <sys/mman.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+
+// maximum number of open directory descriptors kept in the queue, deeper directories are
+// opened by path when they are taken from the queue
+static const int s_maxQueuedFds = 256;
+// number of matches after which the waiting protocol is woken up
+static const int s_matchesBatchSize = 100;
+// time in milliseconds to wait for a full batch of matches before delivering fewer
+static const int s_matchesBatchTimeout = 200;
+// size of the data checked for NUL characters, files containing such are considered binary
+static const size_t s_binaryCheckSize = 4096;
+
+static inline char asciiLower(const char c)
+{
+    if (c >= 'A' && c <= 'Z') {
+        return (c + ('a' - 'A'));
+    }
+    return c;
+}
+
+static inline bool isPseudoFilesystem(const QByteArray &path)
+{
+    // Don't try to iterate the pseudo filesystem directories of Linux
+    return (path == "/dev" || path == "/proc" || path == "/sys");
+}
+
+FileNameSearchThread::FileNameSearchThread(FileNameSearchWalker *walker)
+    : QThread(),
+    m_walker(walker)
+{
+}
+
+void FileNameSearchThread::run()
+{
+    m_walker->walk();
+}
+
+FileNameSearchWalker::FileNameSearchWalker(const QString &pattern, bool literal, bool caseSensitive, bool checkContent)
+    : m_checkContent(checkContent),
+    m_caseSensitive(caseSensitive),
+    m_contentLiteralOnly(false),
+    m_pendingDirectories(0),
+    m_queuedFds(0),
+    m_cancelled(false)
+{
+    if (pattern.isEmpty()) {
+        return;
+    }
+
+    m_regExp = QRegExp(literal ? QRegExp::escape(pattern) : pattern,
+                       caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+    if (!m_checkContent) {
+        return;
+    }
+
+    if (literal) {
+        m_contentLiteral = pattern.toLocal8Bit();
+        m_contentLiteralOnly = true;
+    } else {
+        m_contentLiteral = FileNameSearchWalker::requiredLiteral(pattern);
+    }
+    // the content can be compared case-insensitive only if the literal is ASCII, a line
+    // decoded from the content is checked via the regular expression otherwise
+    if (!m_caseSensitive) {
+        for (int i = 0; i < m_contentLiteral.size(); i++) {
+            if (static_cast<uchar>(m_contentLiteral.at(i)) >= 0x80) {
+                m_contentLiteral.clear();
+                m_contentLiteralOnly = false;
+                break;
+            }
+        }
+    }
+    // a line break can not be matched by a line
+    if (m_contentLiteral.contains('\n') || m_contentLiteral.contains('\r')) {
+        m_contentLiteral.clear();
+        m_contentLiteralOnly = false;
+    }
+}
+
+FileNameSearchWalker::~FileNameSearchWalker()
+{
+    m_mutex.lock();
+    m_cancelled = true;
+    m_directoriesCondition.wakeAll();
+    m_mutex.unlock();
+
+    foreach (FileNameSearchThread* thread, m_threads) {
+        thread->wait();
+        delete thread;
+    }
+
+    foreach (const PendingDirectory &pending, m_directories) {
+        if (pending.first != -1) {
+            ::close(pending.first);
+        }
+    }
+}
+
+void FileNameSearchWalker::start(const QByteArray &directory)
+{
+    Q_ASSERT(m_threads.isEmpty());
+
+    const int fd = ::open(directory.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1) {
+        return;
+    }
+
+    m_directories.append(PendingDirectory(fd, directory));
+    m_queuedFds.ref();
+    m_pendingDirectories = 1;
+
+    const int threadCount = qMax(QThread::idealThreadCount(), 1);
+    for (int i = 0; i < threadCount; i++) {
+        FileNameSearchThread* thread = new FileNameSearchThread(this);
+        m_threads.append(thread);
+        thread->start();
+    }
+}
+
+bool FileNameSearchWalker::takeMatches(QList<FileNameSearchMatch> &matches)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_matches.size() < s_matchesBatchSize && m_pendingDirectories > 0) {
+        if (!m_matchesCondition.wait(&m_mutex, s_matchesBatchTimeout) && !m_matches.isEmpty()) {
+            break;
+        }
+    }
+    matches.clear();
+    matches.swap(m_matches);
+    return (!matches.isEmpty() || m_pendingDirectories > 0);
+}
+
+void FileNameSearchWalker::walk()
+{
+    // QRegExp stores the state of the last match, each thread needs its own
+    QRegExp regExp(m_regExp);
+    QList<FileNameSearchMatch> matches;
+    QList<PendingDirectory> directories;
+
+    QMutexLocker locker(&m_mutex);
+    while (true) {
+        while (m_directories.isEmpty() && m_pendingDirectories > 0 && !m_cancelled) {
+            m_directoriesCondition.wait(&m_mutex);
+        }
+        if (m_directories.isEmpty() || m_cancelled) {
+            break;
+        }
+        // depth-first, keeps the queue short
+        const PendingDirectory pending = m_directories.takeLast();
+        locker.unlock();
+
+        int fd = pending.first;
+        if (fd != -1) {
+            m_queuedFds.deref();
+        } else {
+            fd = ::open(pending.second.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        }
+        if (fd != -1) {
+            scanDirectory(fd, pending.second, regExp, matches, directories);
+        }
+
+        locker.relock();
+        m_directories.append(directories);
+        m_pendingDirectories += (directories.size() - 1);
+        m_matches.append(matches);
+        if (!directories.isEmpty() || m_pendingDirectories == 0) {
+            m_directoriesCondition.wakeAll();
+        }
+        if (m_matches.size() >= s_matchesBatchSize || m_pendingDirectories == 0) {
+            m_matchesCondition.wakeAll();
+        }
+        directories.clear();
+        matches.clear();
+    }
+}
+
+void FileNameSearchWalker::scanDirectory(int fd, const QByteArray &path, QRegExp &regExp,
+                                         QList<FileNameSearchMatch> &matches,
+                                         QList<PendingDirectory> &directories)
+{
+    DIR* dir = ::fdopendir(fd);
+    if (!dir) {
+        ::close(fd);
+        return;
+    }
+    const int dirFd = ::dirfd(dir);
+
+    QByteArray pathPrefix(path);
+    if (!pathPrefix.endsWith('/')) {
+        pathPrefix.append('/');
+    }
+
+    struct dirent* dirEntry = nullptr;
+    while ((dirEntry = ::readdir(dir))) {
+        const char* name = dirEntry->d_name;
+        // hidden items are skipped, as by KDirLister
+        if (name[0] == '.') {
+            continue;
+        }
+
+        bool isDir = false;
+#if defined(DT_UNKNOWN)
+        if (dirEntry->d_type != DT_UNKNOWN) {
+            isDir = (dirEntry->d_type == DT_DIR);
+        } else
+#endif
+        {
+            struct stat statBuffer;
+            if (::fstatat(dirFd, name, &statBuffer, AT_SYMLINK_NOFOLLOW) == -1) {
+                continue;
+            }
+            isDir = S_ISDIR(statBuffer.st_mode);
+        }
+
+        const QByteArray childPath = pathPrefix + name;
+        if (isDir && !isPseudoFilesystem(childPath)) {
+            int childFd = -1;
+            if (int(m_queuedFds) < s_maxQueuedFds) {
+                childFd = ::openat(dirFd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+                if (childFd != -1) {
+                    m_queuedFds.ref();
+                }
+            }
+            directories.append(PendingDirectory(childFd, childPath));
+        }
+
+        const bool nameMatch = (regExp.isEmpty() || QFile::decodeName(name).contains(regExp));
+        bool contentMatch = false;
+        if (!nameMatch && m_checkContent && !isDir) {
+            contentMatch = contentContainsPattern(dirFd, name, regExp);
+        }
+        if (!nameMatch && !contentMatch) {
+            continue;
+        }
+
+        FileNameSearchMatch match;
+        if (::fstatat(dirFd, name, &match.statBuffer, AT_SYMLINK_NOFOLLOW) == -1) {
+            continue;
+        }
+        if (S_ISLNK(match.statBuffer.st_mode)) {
+            char linkBuffer[PATH_MAX];
+            const ssize_t linkSize = ::readlinkat(dirFd, name, linkBuffer, sizeof(linkBuffer));
+            if (linkSize > 0) {
+                match.linkDest = QByteArray(linkBuffer, linkSize);
+            }
+            // the type and the permissions are those of the link target, if it exists
+            struct stat targetBuffer;
+            if (::fstatat(dirFd, name, &targetBuffer, 0) == 0) {
+                match.statBuffer = targetBuffer;
+            }
+        }
+        match.path = childPath;
+        match.contentMatch = contentMatch;
+        matches.append(match);
+    }
+    ::closedir(dir);
+}
+
+bool FileNameSearchWalker::contentContainsPattern(int dirFd, const char *name, QRegExp &regExp) const
+{
+    const int fd = ::openat(dirFd, name, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat statBuffer;
+    if (::fstat(fd, &statBuffer) == -1 || !S_ISREG(statBuffer.st_mode) || statBuffer.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    const size_t size = statBuffer.st_size;
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+#if defined(MADV_SEQUENTIAL)
+    ::madvise(mapped, size, MADV_SEQUENTIAL);
+#endif
+    const char* data = static_cast<const char*>(mapped);
+
+    bool result = false;
+    if (::memchr(data, '\0', qMin(size, s_binaryCheckSize))) {
+        // binary file
+        result = false;
+    } else if (!m_contentLiteral.isEmpty() && !containsLiteral(data, size, m_contentLiteral)) {
+        result = false;
+    } else if (m_contentLiteralOnly) {
+        result = true;
+    } else {
+        const char* dataEnd = data + size;
+        const char* line = data;
+        while (line < dataEnd) {
+            const char* lineEnd = static_cast<const char*>(::memchr(line, '\n', dataEnd - line));
+            if (!lineEnd) {
+                lineEnd = dataEnd;
+            }
+            int lineSize = (lineEnd - line);
+            if (lineSize > 0 && line[lineSize - 1] == '\r') {
+                lineSize--;
+            }
+            if (regExp.indexIn(QString::fromLocal8Bit(line, lineSize)) != -1) {
+                result = true;
+                break;
+            }
+            line = lineEnd + 1;
+        }
+    }
+
+    ::munmap(mapped, size);
+    return result;
+}
+
+bool FileNameSearchWalker::containsLiteral(const char *data, size_t size, const QByteArray &literal) const
+{
+    const size_t literalSize = literal.size();
+    if (literalSize > size) {
+        return false;
+    }
+    if (m_caseSensitive) {
+        return (::memmem(data, size, literal.constData(), literalSize) != nullptr);
+    }
+
+    const char* literalData = literal.constData();
+    const char firstLower = asciiLower(literalData[0]);
+    const size_t lastOffset = (size - literalSize);
+    for (size_t i = 0; i <= lastOffset; i++) {
+        if (asciiLower(data[i]) != firstLower) {
+            continue;
+        }
+        size_t j = 1;
+        while (j < literalSize && asciiLower(data[i + j]) == asciiLower(literalData[j])) {
+            j++;
+        }
+        if (j == literalSize) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QByteArray FileNameSearchWalker::requiredLiteral(const QString &pattern)
+{
+    // with alternations and groups any part may be optional
+    if (pattern.contains(QLatin1Char('|')) || pattern.contains(QLatin1Char('('))) {
+        return QByteArray();
+    }
+
+    QString result;
+    QString current;
+    const int patternSize = pattern.size();
+    int i = 0;
+    while (i < patternSize) {
+        QChar c = pattern.at(i);
+        bool isLiteral = false;
+        if (c == QLatin1Char('\\')) {
+            if ((i + 1) >= patternSize) {
+                break;
+            }
+            // escaped letters and digits are classes, assertions or back-references
+            const QChar escaped = pattern.at(i + 1);
+            if (escaped == QLatin1Char('x') || escaped == QLatin1Char('0')) {
+                // the length of hexadecimal and octal escapes varies, the characters
+                // following them can not be told apart from their digits
+                return QByteArray();
+            }
+            if (!escaped.isLetterOrNumber()) {
+                c = escaped;
+                isLiteral = true;
+            }
+            i += 2;
+        } else if (c == QLatin1Char('[')) {
+            i++;
+            if (i < patternSize && pattern.at(i) == QLatin1Char('^')) {
+                i++;
+            }
+            if (i < patternSize && pattern.at(i) == QLatin1Char(']')) {
+                i++;
+            }
+            while (i < patternSize && pattern.at(i) != QLatin1Char(']')) {
+                if (pattern.at(i) == QLatin1Char('\\')) {
+                    i++;
+                }
+                i++;
+            }
+            i++;
+        } else if (c == QLatin1Char('{')) {
+            while (i < patternSize && pattern.at(i) != QLatin1Char('}')) {
+                i++;
+            }
+            i++;
+        } else if (c == QLatin1Char('.') || c == QLatin1Char('^') || c == QLatin1Char('$')
+                   || c == QLatin1Char('*') || c == QLatin1Char('+') || c == QLatin1Char('?')) {
+            i++;
+        } else {
+            isLiteral = true;
+            i++;
+        }
+
+        bool endsRun = !isLiteral;
+        if (isLiteral && i < patternSize) {
+            const QChar quantifier = pattern.at(i);
+            if (quantifier == QLatin1Char('*') || quantifier == QLatin1Char('?') || quantifier == QLatin1Char('{')) {
+                // the character is optional or its count is unknown
+                isLiteral = false;
+                endsRun = true;
+            } else if (quantifier == QLatin1Char('+')) {
+                // the character is required once but the run can not continue past it
+                endsRun = true;
+            }
+        }
+        if (isLiteral) {
+            current.append(c);
+        }
+        if (endsRun) {
+            if (current.size() > result.size()) {
+                result = current;
+            }
+            current.clear();
+        }
+    }
+    if (current.size() > result.size()) {
+        result = current;
+    }
+    return result.toLocal8Bit();
+}
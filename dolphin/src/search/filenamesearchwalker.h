@@ -0,0 +1,127 @@
+/*  This file is part of the KDE project
+    Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License version 2, as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#ifndef FILENAMESEARCHWALKER_H
+#define FILENAMESEARCHWALKER_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QRegExp>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <sys/stat.h>
+
+class FileNameSearchWalker;
+
+/**
+ * @brief Item found by FileNameSearchWalker.
+ */
+struct FileNameSearchMatch
+{
+    QByteArray path;
+    QByteArray linkDest;
+    struct stat statBuffer;
+    /** True if only the content of the file matches the pattern. */
+    bool contentMatch;
+};
+
+/**
+ * @brief Thread walking directories on behalf of FileNameSearchWalker.
+ */
+class FileNameSearchThread : public QThread
+{
+public:
+    explicit FileNameSearchThread(FileNameSearchWalker *walker);
+
+protected:
+    void run() final;
+
+private:
+    FileNameSearchWalker* m_walker;
+};
+
+/**
+ * @brief Searches a local directory tree for names and content matching a pattern.
+ *
+ * The directories are read via openat() and fdopendir() by several threads sharing a
+ * queue of pending directories. Hidden files and directories are skipped, symbolic links
+ * to directories are not followed. If checkContent is enabled the content of regular
+ * files not matching by name is mapped into memory and checked for the pattern. Literal
+ * patterns, or a literal part every match of the regular expression must contain, are
+ * searched for in the raw data before any line is decoded.
+ *
+ * The matches are collected via takeMatches() which blocks until there are some.
+ */
+class FileNameSearchWalker
+{
+public:
+    FileNameSearchWalker(const QString &pattern, bool literal, bool caseSensitive, bool checkContent);
+    ~FileNameSearchWalker();
+
+    void start(const QByteArray &directory);
+
+    /**
+     * Blocks until matches are available or the search is done.
+     * @return False if the search is done and there are no more matches.
+     */
+    bool takeMatches(QList<FileNameSearchMatch> &matches);
+
+    /**
+     * @return The longest run of characters every match of the regular
+     *         expression \a pattern contains, empty if there is none.
+     */
+    static QByteArray requiredLiteral(const QString &pattern);
+
+private:
+    friend class FileNameSearchThread;
+
+    typedef QPair<int, QByteArray> PendingDirectory;
+
+    void walk();
+    void scanDirectory(int fd, const QByteArray &path, QRegExp &regExp,
+                       QList<FileNameSearchMatch> &matches,
+                       QList<PendingDirectory> &directories);
+    bool contentContainsPattern(int dirFd, const char *name, QRegExp &regExp) const;
+    bool containsLiteral(const char *data, size_t size, const QByteArray &literal) const;
+
+    QRegExp m_regExp;
+    bool m_checkContent;
+    bool m_caseSensitive;
+    // searched for in the raw content, either the whole pattern or a part of it
+    QByteArray m_contentLiteral;
+    // true if a match of m_contentLiteral is a match of the pattern
+    bool m_contentLiteralOnly;
+
+    QList<FileNameSearchThread*> m_threads;
+    QMutex m_mutex;
+    QWaitCondition m_directoriesCondition;
+    QWaitCondition m_matchesCondition;
+    QList<PendingDirectory> m_directories;
+    // number of directories queued or being read
+    int m_pendingDirectories;
+    // number of directory descriptors held by the queue
+    QAtomicInt m_queuedFds;
+    bool m_cancelled;
+    QList<FileNameSearchMatch> m_matches;
+};
+
+#endif
@@ -0,0 +1,147 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Ivailo Monev <xakepa10@gmail.com>               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA            *
+ ***************************************************************************/
+
+#include <qtest_kde.h>
+
+#include "search/filenamesearchwalker.h"
+#include "testdir.h"
+
+#include <QFile>
+
+class FileNameSearchWalkerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void testRequiredLiteral_data();
+    void testRequiredLiteral();
+    void testSearch_data();
+    void testSearch();
+
+private:
+    QStringList search(const QString &pattern, bool literal, bool caseSensitive, bool checkContent);
+
+    TestDir* m_testDir;
+};
+
+void FileNameSearchWalkerTest::init()
+{
+    m_testDir = new TestDir();
+    m_testDir->createFile("alpha.txt", "nothing to see");
+    m_testDir->createFile("README", "the Needle is here\n");
+    m_testDir->createFile("sub/beta.txt", "first line\nsecond needle line\n");
+    m_testDir->createFile("sub/deeper/gamma.log", "needle");
+    m_testDir->createFile("sub/binary.dat", QByteArray("needle\0binary", 13));
+    m_testDir->createFile(".hidden/needle.txt", "needle");
+    m_testDir->createFile("sub/.needle", "needle");
+    m_testDir->createDir("empty");
+}
+
+void FileNameSearchWalkerTest::cleanup()
+{
+    delete m_testDir;
+    m_testDir = 0;
+}
+
+void FileNameSearchWalkerTest::testRequiredLiteral_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<QByteArray>("literal");
+
+    QTest::newRow("plain") << "needle" << QByteArray("needle");
+    QTest::newRow("wildcard") << "ne.dle" << QByteArray("dle");
+    QTest::newRow("optional") << "needles?" << QByteArray("needle");
+    QTest::newRow("repeated") << "nee+dle" << QByteArray("nee");
+    QTest::newRow("class") << "[a-z]+needle[0-9]" << QByteArray("needle");
+    QTest::newRow("escaped") << "a\\.b\\.c" << QByteArray("a.b.c");
+    QTest::newRow("class escape") << "foo\\sbarbaz" << QByteArray("barbaz");
+    QTest::newRow("hexadecimal escape") << "\\x41bcdef" << QByteArray();
+    QTest::newRow("octal escape") << "\\0101bcdef" << QByteArray();
+    QTest::newRow("alternation") << "needle|pin" << QByteArray();
+    QTest::newRow("group") << "(needle)" << QByteArray();
+}
+
+void FileNameSearchWalkerTest::testRequiredLiteral()
+{
+    QFETCH(QString, pattern);
+    QFETCH(QByteArray, literal);
+
+    QCOMPARE(FileNameSearchWalker::requiredLiteral(pattern), literal);
+}
+
+void FileNameSearchWalkerTest::testSearch_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<bool>("literal");
+    QTest::addColumn<bool>("caseSensitive");
+    QTest::addColumn<bool>("checkContent");
+    QTest::addColumn<QStringList>("expected");
+
+    QTest::newRow("names") << "txt" << true << false << false
+        << (QStringList() << "alpha.txt" << "sub/beta.txt");
+    QTest::newRow("directories") << "sub" << true << false << false
+        << (QStringList() << "sub");
+    QTest::newRow("everything") << QString() << true << false << false
+        << (QStringList() << "README" << "alpha.txt" << "empty" << "sub" << "sub/beta.txt"
+                          << "sub/binary.dat" << "sub/deeper" << "sub/deeper/gamma.log");
+    QTest::newRow("content") << "needle" << true << false << true
+        << (QStringList() << "README" << "sub/beta.txt" << "sub/deeper/gamma.log");
+    QTest::newRow("content, case sensitive") << "Needle" << true << true << true
+        << (QStringList() << "README");
+    QTest::newRow("content, regular expression") << "sec.nd ne+dle" << false << false << true
+        << (QStringList() << "sub/beta.txt");
+    QTest::newRow("content, no literal") << "(first|third) line" << false << false << true
+        << (QStringList() << "sub/beta.txt");
+}
+
+void FileNameSearchWalkerTest::testSearch()
+{
+    QFETCH(QString, pattern);
+    QFETCH(bool, literal);
+    QFETCH(bool, caseSensitive);
+    QFETCH(bool, checkContent);
+    QFETCH(QStringList, expected);
+
+    QCOMPARE(search(pattern, literal, caseSensitive, checkContent), expected);
+}
+
+QStringList FileNameSearchWalkerTest::search(const QString &pattern, bool literal, bool caseSensitive, bool checkContent)
+{
+    FileNameSearchWalker walker(pattern, literal, caseSensitive, checkContent);
+    walker.start(QFile::encodeName(m_testDir->name()));
+
+    const QString prefix = m_testDir->name();
+    QStringList paths;
+    QList<FileNameSearchMatch> matches;
+    while (walker.takeMatches(matches)) {
+        foreach (const FileNameSearchMatch &match, matches) {
+            const QString path = QFile::decodeName(match.path);
+            paths.append(path.startsWith(prefix) ? path.mid(prefix.length()) : path);
+        }
+    }
+    paths.sort();
+    return paths;
+}
+
+QTEST_KDEMAIN(FileNameSearchWalkerTest, NoGUI)
+
+#include "filenamesearchwalkertest.moc"
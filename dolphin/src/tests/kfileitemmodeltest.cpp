@@ -472,6 +472,30 @@ void KFileItemModelTest::testNameFilter()
     m_model->setNameFilter("bC"); // Shows "Abc" and "Bcd"
     QCOMPARE(m_model->count(), 2);
 
+    m_model->setNameFilter("c"); // Shows "Abc", "Bcd" and "Cde"
+    QCOMPARE(m_model->count(), 3);
+
+    m_model->setNameFilter("cd"); // Shows "Bcd" and "Cde"
+    QCOMPARE(m_model->count(), 2);
+
+    m_model->setNameFilter("c"); // Shows again "Abc", "Bcd" and "Cde"
+    QCOMPARE(m_model->count(), 3);
+
+    m_model->setNameFilter("a?"); // Shows "A1" and "A2"
+    QCOMPARE(m_model->count(), 2);
+
+    m_model->setNameFilter("[ab]*"); // Shows "A1", "A2", "Abc" and "Bcd"
+    QCOMPARE(m_model->count(), 4);
+
+    m_model->setNameFilter("[!a]*"); // Shows "Bcd" and "Cde"
+    QCOMPARE(m_model->count(), 2);
+
+    m_model->setNameFilter("*D*"); // Shows "Bcd" and "Cde"
+    QCOMPARE(m_model->count(), 2);
+
+    m_model->setNameFilter("*[0-9]"); // Shows "A1" and "A2"
+    QCOMPARE(m_model->count(), 2);
+
     m_model->setNameFilter(QString()); // Shows again all items
     QCOMPARE(m_model->count(), 5);
 }
@@ -0,0 +1,107 @@
+/*  This file is part of the KDE project
+    Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License version 2, as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#include <qtest_kde.h>
+
+#include "kitemviews/kitemlistcontainer.h"
+#include "kitemviews/kitemlistcontroller.h"
+#include "kitemviews/kstandarditem.h"
+#include "kitemviews/kstandarditemlistview.h"
+#include "kitemviews/kstandarditemmodel.h"
+
+Q_DECLARE_METATYPE(KStandardItemListView::ItemLayout);
+
+class KItemListViewLayouterBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void resizeView_data();
+    void resizeView();
+
+private:
+    KStandardItemModel* m_model;
+    KStandardItemListView* m_view;
+    KItemListContainer* m_container;
+};
+
+void KItemListViewLayouterBenchmark::initTestCase()
+{
+    m_model = new KStandardItemModel();
+    for (int i = 0; i < 1000000; ++i) {
+        m_model->appendItem(new KStandardItem(QString::fromLatin1("Item %1").arg(i)));
+    }
+
+    m_view = new KStandardItemListView();
+    KItemListController* controller = new KItemListController(m_model, m_view, this);
+    m_container = new KItemListContainer(controller);
+    m_container->resize(800, 600);
+    m_container->show();
+    QTest::qWaitForWindowShown(m_container);
+}
+
+void KItemListViewLayouterBenchmark::cleanupTestCase()
+{
+    delete m_container;
+    m_container = 0;
+}
+
+void KItemListViewLayouterBenchmark::resizeView_data()
+{
+    QTest::addColumn<KStandardItemListView::ItemLayout>("layout");
+    QTest::addColumn<qreal>("scrollOffset");
+
+    QTest::newRow("Details, top") << KStandardItemListView::DetailsLayout << qreal(0);
+    QTest::newRow("Details, middle") << KStandardItemListView::DetailsLayout << qreal(-1);
+    QTest::newRow("Icons, top") << KStandardItemListView::IconsLayout << qreal(0);
+    QTest::newRow("Icons, middle") << KStandardItemListView::IconsLayout << qreal(-1);
+}
+
+/**
+ * Resizes the view showing one million items, a negative scroll
+ * offset scrolls to the middle of the items before.
+ */
+void KItemListViewLayouterBenchmark::resizeView()
+{
+    QFETCH(KStandardItemListView::ItemLayout, layout);
+    QFETCH(qreal, scrollOffset);
+
+    m_view->setItemLayout(layout);
+    m_view->setScrollOffset(0);
+    m_view->setGeometry(QRectF(0, 0, 800, 600));
+    QCOMPARE(m_view->firstVisibleIndex(), 0);
+
+    if (scrollOffset < 0) {
+        m_view->setScrollOffset(m_view->itemRect(m_model->count() / 2).top());
+        QVERIFY(m_view->firstVisibleIndex() > 0);
+    }
+
+    qreal width = 800;
+    QBENCHMARK {
+        width = (width == 800) ? 1000 : 800;
+        m_view->setGeometry(QRectF(0, 0, width, 600));
+        QVERIFY(m_view->lastVisibleIndex() >= m_view->firstVisibleIndex());
+    }
+}
+
+QTEST_KDEMAIN(KItemListViewLayouterBenchmark, GUI)
+
+#include "kitemlistviewlayouterbenchmark.moc"
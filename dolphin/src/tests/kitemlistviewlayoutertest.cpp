@@ -0,0 +1,138 @@
+/*  This file is part of the KDE project
+    Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License version 2, as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#include <qtest_kde.h>
+
+#include "kitemviews/kitemlistcontainer.h"
+#include "kitemviews/kitemlistcontroller.h"
+#include "kitemviews/kstandarditem.h"
+#include "kitemviews/kstandarditemlistview.h"
+#include "kitemviews/kstandarditemmodel.h"
+
+Q_DECLARE_METATYPE(KStandardItemListView::ItemLayout);
+
+class KItemListViewLayouterTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void init();
+
+    void testEmptyModel();
+    void testRowExtents_data();
+    void testRowExtents();
+
+private:
+    KStandardItemModel* m_model;
+    KStandardItemListView* m_view;
+    KItemListContainer* m_container;
+};
+
+void KItemListViewLayouterTest::initTestCase()
+{
+    m_model = new KStandardItemModel();
+    m_view = new KStandardItemListView();
+    KItemListController* controller = new KItemListController(m_model, m_view, this);
+    m_container = new KItemListContainer(controller);
+    m_container->resize(800, 600);
+    m_container->show();
+    QTest::qWaitForWindowShown(m_container);
+}
+
+void KItemListViewLayouterTest::cleanupTestCase()
+{
+    delete m_container;
+    m_container = 0;
+}
+
+void KItemListViewLayouterTest::init()
+{
+    m_model->clear();
+    m_view->setScrollOffset(0);
+    m_view->setGeometry(QRectF(0, 0, 800, 600));
+}
+
+void KItemListViewLayouterTest::testEmptyModel()
+{
+    QCOMPARE(m_model->count(), 0);
+    QCOMPARE(m_view->maximumScrollOffset(), qreal(0));
+    QCOMPARE(m_view->firstVisibleIndex(), -1);
+    QCOMPARE(m_view->lastVisibleIndex(), -1);
+}
+
+void KItemListViewLayouterTest::testRowExtents_data()
+{
+    QTest::addColumn<KStandardItemListView::ItemLayout>("layout");
+
+    QTest::newRow("Details") << KStandardItemListView::DetailsLayout;
+    QTest::newRow("Icons") << KStandardItemListView::IconsLayout;
+}
+
+/**
+ * Walks through rows that are laid out in several chunks and checks that
+ * the rows do not overlap and that the maximum scroll offset, which is estimated
+ * before all rows are resolved, ends right after the last row.
+ */
+void KItemListViewLayouterTest::testRowExtents()
+{
+    QFETCH(KStandardItemListView::ItemLayout, layout);
+
+    m_view->setItemLayout(layout);
+    for (int i = 0; i < 5000; ++i) {
+        m_model->appendItem(new KStandardItem(QString::fromLatin1("Item %1").arg(i)));
+    }
+
+    const qreal estimatedMaximum = m_view->maximumScrollOffset();
+    QVERIFY(estimatedMaximum > 0);
+
+    int rowCount = 1;
+    qreal previousRowTop = 0;
+    qreal rowTop = m_view->itemRect(0).top();
+    qreal rowBottom = m_view->itemRect(0).bottom();
+    for (int i = 1; i < m_model->count(); ++i) {
+        const QRectF rect = m_view->itemRect(i);
+        if (rect.top() != rowTop) {
+            QVERIFY(rect.top() > rowTop);
+            QVERIFY(rect.top() >= rowBottom);
+            previousRowTop = rowTop;
+            rowTop = rect.top();
+            rowBottom = rect.bottom();
+            ++rowCount;
+        } else {
+            rowBottom = qMax(rowBottom, rect.bottom());
+        }
+    }
+    // More rows than the layouter resolves in one chunk
+    QVERIFY(rowCount > 256);
+
+    // All rows are resolved now, the last two rows have the same extent
+    const qreal maximum = m_view->maximumScrollOffset();
+    QVERIFY(maximum >= estimatedMaximum);
+    QVERIFY(maximum >= rowBottom);
+    QCOMPARE(maximum, rowTop + (rowTop - previousRowTop));
+
+    m_view->setScrollOffset(maximum - m_view->size().height());
+    QCOMPARE(m_view->lastVisibleIndex(), m_model->count() - 1);
+}
+
+QTEST_KDEMAIN(KItemListViewLayouterTest, GUI)
+
+#include "kitemlistviewlayoutertest.moc"
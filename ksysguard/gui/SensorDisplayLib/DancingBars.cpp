@@ -40,6 +40,7 @@ DancingBars::DancingBars( QWidget *parent, const QString &title, SharedSettings
   : KSGRD::SensorDisplay( parent, title, workSheetSettings)
 {
   mBars = 0;
+  setUseSubscriptions( true );
   mFlags = QBitArray( 100 );
   mFlags.fill( false );
 
@@ -19,12 +19,14 @@
 
 */
 
+#include <QtCore/QDateTime>
 #include <QtXml/qdom.h>
 #include <QtGui/QImage>
 #include <QtGui/QToolTip>
 #include <QtGui/QVBoxLayout>
 #include <QtGui/QHBoxLayout>
 #include <QtGui/QLabel>
+#include <QtGui/QScrollBar>
 #include <QtGui/qevent.h>
 
 
@@ -39,6 +41,7 @@
 #include "StyleEngine.h"
 
 #include "FancyPlotterSettings.h"
+#include "SensorHistory.h"
 
 #include "FancyPlotter.h"
 
@@ -161,6 +164,10 @@ FancyPlotter::FancyPlotter( QWidget* parent,
     mUseManualRange = false;
     mNumAnswers = 0;
     mLabelsWidget = NULL;
+    mHistory = NULL;
+    mRecordHistory = false;
+    mHistoryDirty = true;
+    setUseSubscriptions(true);
 
     //The unicode character 0x25CF is a big filled in circle.  We would prefer to use this in the tooltip.
     //However it's maybe possible that the font used to draw the tooltip won't have it.  So we fall back to a 
@@ -185,6 +192,12 @@ FancyPlotter::FancyPlotter( QWidget* parent,
     layout->addWidget(mHeading);
     layout->addWidget(mPlotter);
 
+    mHistoryScrollBar = new QScrollBar(Qt::Horizontal, this);
+    mHistoryScrollBar->setRange(0, 0);
+    mHistoryScrollBar->hide();
+    layout->addWidget(mHistoryScrollBar);
+    connect(mHistoryScrollBar, SIGNAL(valueChanged(int)), this, SLOT(historyScrolled(int)));
+
     /* Create a set of labels underneath the graph. */
     mLabelsWidget = new QWidget;
     layout->addWidget(mLabelsWidget);
@@ -214,6 +227,7 @@ FancyPlotter::FancyPlotter( QWidget* parent,
 
 FancyPlotter::~FancyPlotter()
 {
+    delete mHistory;
 }
 
 void FancyPlotter::setTitle( const QString &title ) { //virtual
@@ -260,6 +274,7 @@ void FancyPlotter::configureSettings()
     mSettingsDialog->setRangeUnits( mUnit );
 
     mSettingsDialog->setStackBeams( mPlotter->stackGraph() );
+    mSettingsDialog->setRecordHistory( mRecordHistory );
 
     bool hasIntegerRange = true;
     SensorModelEntry::List list;
@@ -325,6 +340,7 @@ void FancyPlotter::applySettings() {
 
     mPlotter->setShowAxis( mSettingsDialog->showAxis() );
     mPlotter->setStackGraph( mSettingsDialog->stackBeams() );
+    setRecordHistory( mSettingsDialog->recordHistory() );
 
     QFont font;
     font.setPointSize( mSettingsDialog->fontSize() );
@@ -374,6 +390,7 @@ void FancyPlotter::reorderBeams(const QList<int> & orderOfBeams)
         int oldIndex = orderOfBeams.at(newIndex);
         mLabelLayout->addItem(labelsInOldOrder.at(oldIndex));
     }
+    mHistoryDirty = true;
 
     for ( int i = 0; i < sensors().count(); ++i ) {
         FPSensorProperties *sensor = static_cast<FPSensorProperties *>(sensors().at(i));
@@ -420,6 +437,7 @@ bool FancyPlotter::addSensor( const QString &hostName, const QString &name,
 
 
     registerSensor( new FPSensorProperties( hostName, name, type, title, color, regexpName, beamId, summationName ) );
+    mHistoryDirty = true;
 
     /* To differentiate between answers from value requests and info
      * requests we add 100 to the beam index for info requests. */
@@ -452,6 +470,7 @@ bool FancyPlotter::removeBeam( uint beamId )
     QWidget *label = (static_cast<QWidgetItem *>(mLabelLayout->takeAt( beamId )))->widget();
     mLabelLayout->removeWidget(label);
     delete label;
+    mHistoryDirty = true;
 
     mSensorReportedMax = 0;
     mSensorReportedMin = 0;
@@ -558,7 +577,10 @@ void FancyPlotter::sendDataToPlotter( )
         }
         while((uint)mSampleBuf.count() < mBeams)
             mSampleBuf.append(mPlotter->lastValue(mSampleBuf.count())); //we might have sensors missing so set their values to the previously known value
-        mPlotter->addSample( mSampleBuf );
+        if(mRecordHistory)
+            recordHistory();
+        if(!isShowingHistory())
+            mPlotter->addSample( mSampleBuf );
         if(isVisible()) {
             if(QToolTip::isVisible() && (qApp->topLevelAt(QCursor::pos()) == window()) && mPlotter->geometry().contains(mPlotter->mapFromGlobal( QCursor::pos() ))) {
                 setTooltip();
@@ -601,8 +623,84 @@ void FancyPlotter::sendDataToPlotter( )
     }
     mSampleBuf.clear();
 }
+void FancyPlotter::setRecordHistory( bool record )
+{
+    if(mRecordHistory == record)
+        return;
+    mRecordHistory = record;
+    if(!record) {
+        if(isShowingHistory())
+            mPlotter->clearSamples();
+        delete mHistory;
+        mHistory = NULL;
+        mHistoryDirty = true;
+        mHistoryScrollBar->blockSignals(true);
+        mHistoryScrollBar->setRange(0, 0);
+        mHistoryScrollBar->blockSignals(false);
+    }
+    mHistoryScrollBar->setVisible(record);
+}
+void FancyPlotter::recordHistory()
+{
+    if(mHistoryDirty) {
+        if(isShowingHistory())
+            mPlotter->clearSamples();
+        delete mHistory;
+        //The history is kept per set of sensors, so that it can be found again after a restart
+        QStringList names;
+        for ( int i = 0; i < sensors().count(); ++i ) {
+            FPSensorProperties *sensor = static_cast<FPSensorProperties *>(sensors().at(i));
+            names << QString("%1:%2:%3").arg(sensor->hostName())
+                .arg(sensor->regExpName().isEmpty() ? sensor->name() : sensor->regExpName())
+                .arg(sensor->beamId);
+        }
+        mHistory = new SensorHistory(SensorHistory::fileName(names));
+        mHistoryDirty = false;
+        mHistoryScrollBar->blockSignals(true);
+        mHistoryScrollBar->setRange(0, 0);
+        mHistoryScrollBar->blockSignals(false);
+    }
+    if(!mHistory->isValid())
+        return;
+
+    mHistory->append(QDateTime::currentMSecsSinceEpoch(), mSampleBuf);
+
+    //Keep showing the newest samples, unless the user has scrolled back
+    bool showingNewest = !isShowingHistory();
+    mHistoryScrollBar->blockSignals(true);
+    mHistoryScrollBar->setRange(0, (mHistory->lastTime() - mHistory->firstTime()) / 1000);
+    //The range is in seconds, a page is the time the samples shown by the plotter span
+    int visibleSamples = mPlotter->width() / qMax(1, mPlotter->horizontalScale());
+    int sampleInterval = updateInterval() > 0 ? updateInterval() : 1000;
+    mHistoryScrollBar->setPageStep(qMax(1, int(qint64(visibleSamples) * sampleInterval / 1000)));
+    if(showingNewest)
+        mHistoryScrollBar->setValue(mHistoryScrollBar->maximum());
+    mHistoryScrollBar->blockSignals(false);
+}
+bool FancyPlotter::isShowingHistory() const
+{
+    return mHistory && mHistoryScrollBar->value() < mHistoryScrollBar->maximum();
+}
+void FancyPlotter::historyScrolled( int value )
+{
+    if(!mHistory)
+        return;
+    //Replace the samples with the ones recorded up to the selected time.  Only the samples that fit into the
+    //plotter are read from the history.  When scrolled to the end, the plotter continues with the new samples.
+    qint64 time = mHistory->lastTime();
+    if(value < mHistoryScrollBar->maximum())
+        time = mHistory->firstTime() + qint64(value) * 1000;
+    int count = mPlotter->width() / qMax(1, mPlotter->horizontalScale()) + 2;
+    mPlotter->clearSamples();
+    foreach(const SensorHistory::Sample &sample, mHistory->samples(time, count)) {
+        if(sample.values.count() == mPlotter->numBeams())
+            mPlotter->addSample(sample.values);
+    }
+}
 void FancyPlotter::timerTick() //virtual
 {
+    if(subscribed())
+        return; //the values are pushed by the hosts, see answerReceived()
     if(mNumAnswers < sensors().count())
         sendDataToPlotter(); //we haven't received enough answers yet, but plot what we do have
     mNumAnswers = 0;
@@ -671,6 +769,18 @@ void FancyPlotter::answerReceived( int id, const QList<QByteArray> &answerlist )
         if(id >= sensors().count())
             return;  //just ignore if we get a result for an invalid sensor
         FPSensorProperties *sensor = static_cast<FPSensorProperties *>(sensors().at(id));
+        if(subscribed()) {
+            //There is no timer tick ending a round of answers.  A second answer of a sensor starts the next one,
+            //so plot what we have if a sensor stopped answering
+            if(mAnswered.size() != sensors().count())
+                mAnswered.resize(sensors().count());
+            if(mAnswered.testBit(id)) {
+                sendDataToPlotter();
+                mNumAnswers = 0;
+                mAnswered.fill(false);
+            }
+            mAnswered.setBit(id);
+        }
         int beamId = sensor->beamId;
         double value = answer.toDouble();
         while(beamId > mSampleBuf.count())
@@ -685,8 +795,13 @@ void FancyPlotter::answerReceived( int id, const QList<QByteArray> &answerlist )
         /* We received something, so the sensor is probably ok. */
         sensorError( id, false );
 
-        if(++mNumAnswers == sensors().count())
+        if(++mNumAnswers == sensors().count()) {
             sendDataToPlotter(); //we have received all the answers so start plotting
+            if(subscribed()) {
+                mNumAnswers = 0;
+                mAnswered.fill(false);
+            }
+        }
     } else if ( id >= 100 && id < 200 ) {
         if( (id - 100) >= sensors().count())
             return;  //just ignore if we get a result for an invalid sensor
@@ -777,6 +892,7 @@ bool FancyPlotter::restoreSettings( QDomElement &element )
 
     mPlotter->setShowHorizontalLines( element.attribute( "hLines", "1" ).toUInt() );
     mPlotter->setStackGraph( element.attribute("stacked", "0").toInt());
+    setRecordHistory( element.attribute("history", "0").toInt() );
 
     if(version >= 1) {
         mPlotter->setShowAxis( element.attribute( "labels", "1" ).toUInt() );
@@ -846,6 +962,8 @@ bool FancyPlotter::saveSettings( QDomDocument &doc, QDomElement &element)
 
     element.setAttribute( "stacked", mPlotter->stackGraph() );
 
+    element.setAttribute( "history", mRecordHistory );
+
     element.setAttribute( "version", 1 );
     element.setAttribute( "labels", mPlotter->showAxis() );
     element.setAttribute( "fontSize", mPlotter->font().pointSize() );
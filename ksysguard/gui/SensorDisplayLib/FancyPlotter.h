@@ -23,6 +23,7 @@
 #define KSG_FANCYPLOTTER_H
 
 #include <SensorDisplay.h>
+#include <QBitArray>
 #include <QList>
 #include <klocalizedstring.h>
 
@@ -33,6 +34,8 @@ class FancyPlotterSettings;
 class SensorToAdd;
 class FancyPlotterLabel;
 class KSignalPlotter;
+class SensorHistory;
+class QScrollBar;
 
 class FPSensorProperties : public KSGRD::SensorProperties
 {
@@ -92,6 +95,7 @@ class FancyPlotter : public KSGRD::SensorDisplay
     void settingsFinished();
     void applySettings();
     void plotterAxisScaleChanged();
+    void historyScrolled( int value );
 
   protected:
     /** When we receive a timer tick, draw the beams and request new information to update the beams*/
@@ -103,9 +107,15 @@ class FancyPlotter : public KSGRD::SensorDisplay
 
   private:
     void sendDataToPlotter();
+    void setRecordHistory( bool record );
+    /** Adds the current samples to the history, creating it first if the sensors have changed */
+    void recordHistory();
+    bool isShowingHistory() const;
     uint mBeams;
     
     int mNumAnswers;
+    /** The sensors which have answered in the current period, only used if the values are pushed by the hosts */
+    QBitArray mAnswered;
     /** When we talk to the sensor, it tells us a range.  Record the max here.  equals 0 until we have an answer from it */
     double mSensorReportedMax;
     /** When we talk to the sensor, it tells us a range.  Record the min here.  equals 0 until we have an answer from it */
@@ -139,6 +149,14 @@ class FancyPlotter : public KSGRD::SensorDisplay
     /** True if we will override the values from ksysguardd with user-specified values. */
     bool mUseManualRange;
     QWidget *mLabelsWidget;
+
+    /** The recorded samples, NULL unless mRecordHistory is true and samples have been received */
+    SensorHistory *mHistory;
+    bool mRecordHistory;
+    /** True if the sensors have changed, so that the samples go to a different history */
+    bool mHistoryDirty;
+    /** Scrolls back through the history, in seconds since the oldest sample.  At the maximum the newest samples are shown. */
+    QScrollBar *mHistoryScrollBar;
 };
 
 #endif
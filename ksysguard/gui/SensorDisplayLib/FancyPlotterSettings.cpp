@@ -79,7 +79,11 @@ FancyPlotterSettings::FancyPlotterSettings( QWidget* parent, bool locked )
   mStackBeams->setWhatsThis( i18n("The beams are stacked on top of each other, and the area is drawn filled in. So if one beam has a value of 2 and another beam has a value of 3, the first beam will be drawn at value 2 and the other beam drawn at 2+3=5.") );
   pageLayout->addWidget( mStackBeams, 1, 0,1,2);
 
-  pageLayout->setRowStretch( 2, 1 );
+  mRecordHistory = new QCheckBox( i18n("Record the history of the sensors"), page);
+  mRecordHistory->setWhatsThis( i18n("The values of the sensors are saved to disk, so that they can be looked at again later on by scrolling back in time with the scroll bar below the graph. At most 16 MiB are used for each display.") );
+  pageLayout->addWidget( mRecordHistory, 2, 0,1,2);
+
+  pageLayout->setRowStretch( 3, 1 );
 
   // Scales page
   page = new QFrame();
@@ -280,6 +284,13 @@ void FancyPlotterSettings::setStackBeams( bool stack )
 bool FancyPlotterSettings::stackBeams() const {
   return mStackBeams->isChecked();
 }
+void FancyPlotterSettings::setRecordHistory( bool record )
+{
+  mRecordHistory->setChecked(record);
+}
+bool FancyPlotterSettings::recordHistory() const {
+  return mRecordHistory->isChecked();
+}
 void FancyPlotterSettings::moveUpSensor()
 {
   mModel->moveUpSensor(mView->selectionModel()->currentIndex());
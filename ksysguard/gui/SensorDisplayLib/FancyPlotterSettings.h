@@ -83,6 +83,9 @@ class FancyPlotterSettings : public KPageDialog
     void setStackBeams( bool stack );
     bool stackBeams() const;
 
+    void setRecordHistory( bool record );
+    bool recordHistory() const;
+
     void setSensors( const SensorModelEntry::List &list );
     SensorModelEntry::List sensors() const;
     QList<int> order() const;
@@ -122,6 +125,7 @@ class FancyPlotterSettings : public KPageDialog
     QPushButton *mMoveUpButton;
     QPushButton *mMoveDownButton;
     QCheckBox *mStackBeams;
+    QCheckBox *mRecordHistory;
 
 
     QTreeView *mView;
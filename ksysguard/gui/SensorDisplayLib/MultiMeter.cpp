@@ -38,6 +38,7 @@ MultiMeter::MultiMeter(QWidget* parent, const QString& title, SharedSettings *wo
   : KSGRD::SensorDisplay(parent, title, workSheetSettings)
 {
   setShowUnit( true );
+  setUseSubscriptions( true );
   mLowerLimit = mUpperLimit = 0.0;
   mLowerLimitActive = mUpperLimitActive = false;
 
@@ -28,6 +28,7 @@
 #include <QPixmap>
 #include <QEvent>
 #include <QtGui/qevent.h>
+#include <QtCore/QTimer>
 
 #include <kapplication.h>
 #include <kiconloader.h>
@@ -62,6 +63,9 @@ SensorDisplay::SensorDisplay( QWidget *parent, const QString &title, SharedSetti
 
   mShowUnit = false;
   mTimerId = NONE;
+  mUpdateInterval = 0;
+  mUseSubscriptions = false;
+  mSubscriptionUpdatePending = false;
   mErrorIndicator = 0;
   mPlotterWdg = 0;
 
@@ -81,6 +85,9 @@ SensorDisplay::~SensorDisplay()
 {
   if ( SensorMgr != 0 )
     SensorMgr->disconnectClient( this );
+  // disconnectClient() has removed the subscriptions already
+  mUseSubscriptions = false;
+  mSubscribedHosts.clear();
 
   if ( mTimerId > 0 )
     killTimer( mTimerId );
@@ -91,15 +98,20 @@ SensorDisplay::~SensorDisplay()
 void SensorDisplay::registerSensor( SensorProperties *sp )
 {
   mSensors.append( sp );
+  scheduleSubscriptionUpdate();
 }
 
 void SensorDisplay::unregisterSensor( uint pos )
 {
   delete mSensors.takeAt( pos );
+  scheduleSubscriptionUpdate();
 }
 
 void SensorDisplay::timerTick()
 {
+  if ( subscribed() )
+    return;
+
   int i = 0;
 
   foreach( SensorProperties *s, mSensors) {
@@ -162,6 +174,77 @@ void SensorDisplay::sendRequest( const QString &hostName,
   }
 }
 
+void SensorDisplay::setUpdateInterval( int interval )
+{
+  if ( interval == mUpdateInterval )
+    return;
+
+  mUpdateInterval = interval;
+  scheduleSubscriptionUpdate();
+}
+
+int SensorDisplay::updateInterval() const
+{
+  return mUpdateInterval;
+}
+
+void SensorDisplay::setUseSubscriptions( bool value )
+{
+  if ( value == mUseSubscriptions )
+    return;
+
+  mUseSubscriptions = value;
+  if ( mUseSubscriptions ) {
+    // The subscriptions are lost together with the connection to the host
+    connect( SensorMgr, SIGNAL(hostAdded(KSGRD::SensorAgent*,QString)),
+             SLOT(scheduleSubscriptionUpdate()) );
+    connect( SensorMgr, SIGNAL(hostConnectionLost(QString)),
+             SLOT(scheduleSubscriptionUpdate()) );
+  } else {
+    disconnect( SensorMgr, 0, this, SLOT(scheduleSubscriptionUpdate()) );
+  }
+  scheduleSubscriptionUpdate();
+}
+
+bool SensorDisplay::subscribed() const
+{
+  return mUseSubscriptions && mUpdateInterval > 0;
+}
+
+void SensorDisplay::scheduleSubscriptionUpdate()
+{
+  if ( mSubscriptionUpdatePending || ( !subscribed() && mSubscribedHosts.isEmpty() ) )
+    return;
+
+  /* Sensors are usually added one after another, all of them are
+   * subscribed at once so that their values arrive together. */
+  mSubscriptionUpdatePending = true;
+  QTimer::singleShot( 0, this, SLOT(updateSubscriptions()) );
+}
+
+void SensorDisplay::updateSubscriptions()
+{
+  mSubscriptionUpdatePending = false;
+  unsubscribeSensors();
+  if ( !subscribed() )
+    return;
+
+  int i = 0;
+  foreach( SensorProperties *s, mSensors ) {
+    if ( !SensorMgr->subscribe( s->hostName(), s->name(), (SensorClient*)this, i, mUpdateInterval ) )
+      sensorError( i, true );
+    mSubscribedHosts.append( s->hostName() );
+    ++i;
+  }
+}
+
+void SensorDisplay::unsubscribeSensors()
+{
+  for ( int i = 0; i < mSubscribedHosts.count(); ++i )
+    SensorMgr->unsubscribe( mSubscribedHosts.at( i ), (SensorClient*)this, i );
+  mSubscribedHosts.clear();
+}
+
 void SensorDisplay::sensorError( int sensorId, bool err )
 {
   if ( sensorId >= (int)mSensors.count() || sensorId < 0 )
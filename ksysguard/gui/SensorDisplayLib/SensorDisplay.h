@@ -24,6 +24,7 @@
 
 #include <QtCore/QEvent>
 #include <QtCore/QPointer>
+#include <QtCore/QStringList>
 #include <QtGui/QLabel>
 #include <QtGui/QWidget>
 
@@ -146,6 +147,15 @@ class SensorDisplay : public QWidget, public SensorClient
      */
     void sendRequest( const QString &hostName, const QString &cmd, int id );
 
+    /**
+      Sets the interval in milliseconds in which the display is updated,
+      0 if it is updated only when timerTick() is called. Displays using
+      subscriptions have the values of their sensors pushed in this
+      interval instead of requesting them on each timerTick().
+     */
+    void setUpdateInterval( int interval );
+    int updateInterval() const;
+
     /**
       Returns whether the display provides a settings dialog.
       This method should be reimplemented in the derived class.
@@ -240,18 +250,41 @@ class SensorDisplay : public QWidget, public SensorClient
 
     bool timerOn() const;
 
+    /**
+      Enables delivering the values of the sensors via subscriptions,
+      see SensorManager::subscribe(). The values are delivered to
+      answerReceived() with the position of the sensor as id, like the
+      answers of the requests sent by timerTick().
+     */
+    void setUseSubscriptions( bool value );
+
+    /**
+      Returns whether the values of the sensors are pushed by the hosts,
+      in which case timerTick() does not request them.
+     */
+    bool subscribed() const;
+
     QList<SensorProperties *> &sensors();
 
     SharedSettings *mSharedSettings;
 
+  private Q_SLOTS:
+    void scheduleSubscriptionUpdate();
+    void updateSubscriptions();
+
   private:
     void updateWhatsThis();
+    void unsubscribeSensors();
 
     bool mShowUnit;
     bool mUseGlobalUpdateInterval;
 
     int mTimerId;
     int mUpdateInterval;
+    bool mUseSubscriptions;
+    bool mSubscriptionUpdatePending;
+    /// The hosts of the subscribed sensors, by the id of the subscription
+    QStringList mSubscribedHosts;
 
     QList<SensorProperties *> mSensors;
 
@@ -0,0 +1,567 @@
+/*
+    KSysGuard, the KDE System Guard
+
+    Copyright (c) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+
+#include <kdebug.h>
+#include <kstandarddirs.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include "SensorHistory.h"
+
+/* Every block starts with a header of this size: the magic, the size of
+ * the data following the header, the number of columns and samples, and
+ * the time of the first and the last sample. */
+#define BLOCK_MAGIC 0x4B534831 // "KSH1"
+#define BLOCK_HEADER_SIZE 28
+#define BLOCK_SAMPLES 120
+
+/* Number of histories of the same set of sensors that can be recorded at
+ * the same time, e.g. by two displays of the same sensors. */
+#define MAXIMUM_INSTANCES 16
+
+namespace {
+
+class BitWriter
+{
+  public:
+    BitWriter() : mFreeBits(0) {}
+
+    void write( quint64 value, int bits )
+    {
+        while ( bits > 0 ) {
+            if ( mFreeBits == 0 ) {
+                mData.append( char(0) );
+                mFreeBits = 8;
+            }
+            const int count = qMin( bits, mFreeBits );
+            const quint64 chunk = ( value >> ( bits - count ) ) & ( ( quint64(1) << count ) - 1 );
+            char &byte = mData[ mData.size() - 1 ];
+            byte = char( uchar(byte) | ( chunk << ( mFreeBits - count ) ) );
+            mFreeBits -= count;
+            bits -= count;
+        }
+    }
+
+    const QByteArray &data() const { return mData; }
+
+  private:
+    QByteArray mData;
+    int mFreeBits;
+};
+
+class BitReader
+{
+  public:
+    BitReader( const char *data, int size ) : mData(data), mBits(qint64(size) * 8), mPosition(0) {}
+
+    bool read( quint64 &value, int bits )
+    {
+        if ( mPosition + bits > mBits )
+            return false;
+        value = 0;
+        while ( bits > 0 ) {
+            const int bitInByte = mPosition % 8;
+            const int count = qMin( bits, 8 - bitInByte );
+            const uchar byte = mData[ mPosition / 8 ];
+            value = ( value << count ) | ( ( byte >> ( 8 - bitInByte - count ) ) & ( ( 1 << count ) - 1 ) );
+            mPosition += count;
+            bits -= count;
+        }
+        return true;
+    }
+
+  private:
+    const char *mData;
+    qint64 mBits;
+    qint64 mPosition;
+};
+
+int leadingZeros( quint64 value )
+{
+    int count = 0;
+    for ( quint64 mask = quint64(1) << 63; mask && !( value & mask ); mask >>= 1 )
+        ++count;
+    return count;
+}
+
+int trailingZeros( quint64 value )
+{
+    int count = 0;
+    for ( ; count < 64 && !( value & 1 ); value >>= 1 )
+        ++count;
+    return count;
+}
+
+/* The time stamps are stored as the difference between the current and the
+ * previous delta, using less bits the smaller the difference is.  With a
+ * regular update interval most samples only need a single bit. */
+QByteArray encodeTimes( const QVector<qint64> &times )
+{
+    BitWriter writer;
+    qint64 previousTime = 0;
+    qint64 previousDelta = 0;
+    for ( int i = 0; i < times.count(); ++i ) {
+        if ( i == 0 ) {
+            writer.write( times.at( i ), 64 );
+        } else {
+            const qint64 delta = times.at( i ) - previousTime;
+            const qint64 deltaOfDelta = delta - previousDelta;
+            if ( deltaOfDelta == 0 ) {
+                writer.write( 0, 1 );
+            } else if ( deltaOfDelta >= -63 && deltaOfDelta <= 64 ) {
+                writer.write( 2, 2 );
+                writer.write( deltaOfDelta + 63, 7 );
+            } else if ( deltaOfDelta >= -255 && deltaOfDelta <= 256 ) {
+                writer.write( 6, 3 );
+                writer.write( deltaOfDelta + 255, 9 );
+            } else if ( deltaOfDelta >= -2047 && deltaOfDelta <= 2048 ) {
+                writer.write( 14, 4 );
+                writer.write( deltaOfDelta + 2047, 12 );
+            } else {
+                writer.write( 15, 4 );
+                writer.write( deltaOfDelta, 64 );
+            }
+            previousDelta = delta;
+        }
+        previousTime = times.at( i );
+    }
+    return writer.data();
+}
+
+bool decodeTimes( const char *data, int size, int count, QVector<qint64> &times )
+{
+    BitReader reader( data, size );
+    qint64 previousTime = 0;
+    qint64 previousDelta = 0;
+    quint64 bits;
+    for ( int i = 0; i < count; ++i ) {
+        if ( i == 0 ) {
+            if ( !reader.read( bits, 64 ) )
+                return false;
+            previousTime = bits;
+        } else {
+            // Count the leading one bits of the prefix, there are at most 4
+            int prefix = 0;
+            while ( prefix < 4 ) {
+                if ( !reader.read( bits, 1 ) )
+                    return false;
+                if ( !bits )
+                    break;
+                ++prefix;
+            }
+            qint64 deltaOfDelta = 0;
+            switch ( prefix ) {
+                case 0:
+                    break;
+                case 1:
+                    if ( !reader.read( bits, 7 ) )
+                        return false;
+                    deltaOfDelta = qint64(bits) - 63;
+                    break;
+                case 2:
+                    if ( !reader.read( bits, 9 ) )
+                        return false;
+                    deltaOfDelta = qint64(bits) - 255;
+                    break;
+                case 3:
+                    if ( !reader.read( bits, 12 ) )
+                        return false;
+                    deltaOfDelta = qint64(bits) - 2047;
+                    break;
+                default:
+                    if ( !reader.read( bits, 64 ) )
+                        return false;
+                    deltaOfDelta = bits;
+                    break;
+            }
+            previousDelta += deltaOfDelta;
+            previousTime += previousDelta;
+        }
+        times.append( previousTime );
+    }
+    return true;
+}
+
+quint64 doubleToBits( double value )
+{
+    quint64 bits;
+    memcpy( &bits, &value, sizeof( bits ) );
+    return bits;
+}
+
+double bitsToDouble( quint64 bits )
+{
+    double value;
+    memcpy( &value, &bits, sizeof( value ) );
+    return value;
+}
+
+/* The values are stored as the XOR with the previous value.  Values of a
+ * sensor usually change only in a few bits in the middle, so only those are
+ * written, reusing the position of the previous ones if they fit. */
+QByteArray encodeValues( const QVector< QList<qreal> > &samples, int column )
+{
+    BitWriter writer;
+    quint64 previous = 0;
+    int previousLeading = -1;
+    int previousTrailing = 0;
+    for ( int i = 0; i < samples.count(); ++i ) {
+        const quint64 bits = doubleToBits( samples.at( i ).at( column ) );
+        if ( i == 0 ) {
+            writer.write( bits, 64 );
+        } else {
+            const quint64 xorValue = bits ^ previous;
+            if ( xorValue == 0 ) {
+                writer.write( 0, 1 );
+            } else {
+                const int leading = qMin( leadingZeros( xorValue ), 31 );
+                const int trailing = trailingZeros( xorValue );
+                if ( previousLeading != -1 && leading >= previousLeading && trailing >= previousTrailing ) {
+                    writer.write( 2, 2 );
+                    writer.write( xorValue >> previousTrailing, 64 - previousLeading - previousTrailing );
+                } else {
+                    const int meaningful = 64 - leading - trailing;
+                    writer.write( 3, 2 );
+                    writer.write( leading, 5 );
+                    writer.write( meaningful - 1, 6 );
+                    writer.write( xorValue >> trailing, meaningful );
+                    previousLeading = leading;
+                    previousTrailing = trailing;
+                }
+            }
+        }
+        previous = bits;
+    }
+    return writer.data();
+}
+
+bool decodeValues( const char *data, int size, int count, QVector<double> &values )
+{
+    BitReader reader( data, size );
+    quint64 previous = 0;
+    int previousLeading = -1;
+    int previousTrailing = 0;
+    quint64 bits;
+    for ( int i = 0; i < count; ++i ) {
+        if ( i == 0 ) {
+            if ( !reader.read( previous, 64 ) )
+                return false;
+        } else {
+            if ( !reader.read( bits, 1 ) )
+                return false;
+            if ( bits ) {
+                if ( !reader.read( bits, 1 ) )
+                    return false;
+                if ( bits ) {
+                    quint64 leading;
+                    quint64 meaningful;
+                    if ( !reader.read( leading, 5 ) || !reader.read( meaningful, 6 ) )
+                        return false;
+                    previousLeading = leading;
+                    previousTrailing = 64 - previousLeading - ( meaningful + 1 );
+                    if ( previousTrailing < 0 )
+                        return false;
+                } else if ( previousLeading == -1 ) {
+                    return false;
+                }
+                if ( !reader.read( bits, 64 - previousLeading - previousTrailing ) )
+                    return false;
+                previous ^= bits << previousTrailing;
+            }
+        }
+        values.append( bitsToDouble( previous ) );
+    }
+    return true;
+}
+
+}
+
+SensorHistory::SensorHistory( const QString &fileName, qint64 maximumSize )
+  : mMaximumSize( maximumSize ), mLockFd( -1 )
+{
+    // The files are locked for as long as they are used, the history of
+    // another display of the same sensors is stored next to them
+    for ( int i = 0; i < MAXIMUM_INSTANCES && mLockFd == -1; ++i ) {
+        mFileName = i == 0 ? fileName : QString( "%1-%2" ).arg( fileName ).arg( i );
+        const QByteArray lockFile = QFile::encodeName( mFileName + ".lock" );
+        mLockFd = ::open( lockFile.constData(), O_RDWR | O_CREAT | O_CLOEXEC, 0600 );
+        if ( mLockFd == -1 ) {
+            kDebug(1215) << "Could not open" << lockFile << strerror( errno );
+            return;
+        }
+        if ( ::flock( mLockFd, LOCK_EX | LOCK_NB ) == -1 ) {
+            ::close( mLockFd );
+            mLockFd = -1;
+        }
+    }
+    if ( mLockFd == -1 ) {
+        kDebug(1215) << "Too many histories of" << fileName;
+        return;
+    }
+
+    scanFile( 0 );
+    scanFile( 1 );
+
+    mFile.setFileName( filePath( 1 ) );
+    if ( !mFile.open( QIODevice::WriteOnly | QIODevice::Append ) )
+        kDebug(1215) << "Could not open" << mFile.fileName() << mFile.errorString();
+}
+
+SensorHistory::~SensorHistory()
+{
+    flush();
+    mFile.close();
+    if ( mLockFd != -1 )
+        ::close( mLockFd );
+}
+
+QString SensorHistory::fileName( const QStringList &sensors )
+{
+    const QByteArray hash = QCryptographicHash::hash( sensors.join( "\n" ).toUtf8(), QCryptographicHash::Md5 ).toHex();
+    return KStandardDirs::locateLocal( "data", "ksysguard/history/" + QString::fromLatin1( hash ) );
+}
+
+bool SensorHistory::isValid() const
+{
+    return mFile.isOpen();
+}
+
+void SensorHistory::append( qint64 time, const QList<qreal> &values )
+{
+    if ( !mPendingValues.isEmpty() && mPendingValues.first().count() != values.count() )
+        writeBlock();
+
+    mPendingTimes.append( time );
+    mPendingValues.append( values );
+    if ( mPendingTimes.count() >= BLOCK_SAMPLES )
+        writeBlock();
+}
+
+void SensorHistory::flush()
+{
+    writeBlock();
+}
+
+qint64 SensorHistory::firstTime() const
+{
+    if ( !mBlocks.isEmpty() )
+        return mBlocks.first().firstTime;
+    if ( !mPendingTimes.isEmpty() )
+        return mPendingTimes.first();
+    return -1;
+}
+
+qint64 SensorHistory::lastTime() const
+{
+    if ( !mPendingTimes.isEmpty() )
+        return mPendingTimes.last();
+    if ( !mBlocks.isEmpty() )
+        return mBlocks.last().lastTime;
+    return -1;
+}
+
+QList<SensorHistory::Sample> SensorHistory::samples( qint64 time, int count ) const
+{
+    QList<Sample> result;
+
+    // The pending samples are the newest ones, then walk back through the blocks
+    for ( int i = mPendingTimes.count() - 1; i >= 0 && result.count() < count; --i ) {
+        if ( mPendingTimes.at( i ) > time )
+            continue;
+        Sample sample;
+        sample.time = mPendingTimes.at( i );
+        sample.values = mPendingValues.at( i );
+        result.prepend( sample );
+    }
+
+    for ( int i = mBlocks.count() - 1; i >= 0 && result.count() < count; --i ) {
+        const Block &block = mBlocks.at( i );
+        if ( block.firstTime > time )
+            continue;
+        QList<Sample> blockSamples;
+        if ( !readBlock( block, blockSamples ) )
+            continue;
+        for ( int j = blockSamples.count() - 1; j >= 0 && result.count() < count; --j ) {
+            if ( blockSamples.at( j ).time <= time )
+                result.prepend( blockSamples.at( j ) );
+        }
+    }
+
+    return result;
+}
+
+QString SensorHistory::filePath( int file ) const
+{
+    return file == 0 ? mFileName + ".old" : mFileName;
+}
+
+void SensorHistory::scanFile( int file )
+{
+    QFile input( filePath( file ) );
+    if ( !input.open( QIODevice::ReadOnly ) )
+        return;
+
+    // Only the headers are read, the data of the blocks is skipped
+    const qint64 size = input.size();
+    qint64 offset = 0;
+    while ( offset + BLOCK_HEADER_SIZE <= size ) {
+        input.seek( offset );
+        QDataStream stream( &input );
+        quint32 magic, dataSize;
+        quint16 columns, count;
+        Block block;
+        stream >> magic >> dataSize >> columns >> count >> block.firstTime >> block.lastTime;
+        if ( stream.status() != QDataStream::Ok || magic != BLOCK_MAGIC ||
+             offset + BLOCK_HEADER_SIZE + dataSize > size )
+            break;
+        block.file = file;
+        block.offset = offset;
+        mBlocks.append( block );
+        offset += BLOCK_HEADER_SIZE + dataSize;
+    }
+    input.close();
+
+    if ( offset != size ) {
+        // Most likely the last block has not been written completely, drop it
+        kDebug(1215) << "Dropping the end of" << input.fileName() << "from offset" << offset;
+        QFile::resize( input.fileName(), offset );
+    }
+}
+
+void SensorHistory::writeBlock()
+{
+    if ( mPendingTimes.isEmpty() )
+        return;
+
+    if ( mFile.isOpen() ) {
+        QByteArray data;
+        QDataStream stream( &data, QIODevice::WriteOnly );
+        const int columns = mPendingValues.first().count();
+        const QByteArray times = encodeTimes( mPendingTimes );
+        stream << quint32( times.size() );
+        stream.writeRawData( times.constData(), times.size() );
+        for ( int column = 0; column < columns; ++column ) {
+            const QByteArray values = encodeValues( mPendingValues, column );
+            stream << quint32( values.size() );
+            stream.writeRawData( values.constData(), values.size() );
+        }
+
+        QByteArray header;
+        QDataStream headerStream( &header, QIODevice::WriteOnly );
+        headerStream << quint32( BLOCK_MAGIC ) << quint32( data.size() ) << quint16( columns )
+                     << quint16( mPendingTimes.count() ) << mPendingTimes.first() << mPendingTimes.last();
+
+        Block block;
+        block.file = 1;
+        block.offset = mFile.size();
+        block.firstTime = mPendingTimes.first();
+        block.lastTime = mPendingTimes.last();
+        if ( mFile.write( header + data ) == header.size() + data.size() && mFile.flush() ) {
+            mBlocks.append( block );
+        } else {
+            kDebug(1215) << "Could not write to" << mFile.fileName() << mFile.errorString();
+            mFile.close();
+            QFile::resize( filePath( 1 ), block.offset );
+            mFile.open( QIODevice::WriteOnly | QIODevice::Append );
+        }
+    }
+
+    mPendingTimes.clear();
+    mPendingValues.clear();
+
+    if ( mFile.size() > mMaximumSize / 2 )
+        rotate();
+}
+
+void SensorHistory::rotate()
+{
+    mFile.close();
+    QFile::remove( filePath( 0 ) );
+    QFile::rename( filePath( 1 ), filePath( 0 ) );
+
+    QVector<Block> blocks;
+    foreach ( Block block, mBlocks ) {
+        if ( block.file == 1 ) {
+            block.file = 0;
+            blocks.append( block );
+        }
+    }
+    mBlocks = blocks;
+
+    if ( !mFile.open( QIODevice::WriteOnly | QIODevice::Append ) )
+        kDebug(1215) << "Could not open" << mFile.fileName() << mFile.errorString();
+}
+
+bool SensorHistory::readBlock( const Block &block, QList<Sample> &samples ) const
+{
+    QFile input( filePath( block.file ) );
+    if ( !input.open( QIODevice::ReadOnly ) || !input.seek( block.offset ) )
+        return false;
+
+    QDataStream stream( &input );
+    quint32 magic, dataSize;
+    quint16 columns, count;
+    qint64 firstTime, lastTime;
+    stream >> magic >> dataSize >> columns >> count >> firstTime >> lastTime;
+    if ( stream.status() != QDataStream::Ok || magic != BLOCK_MAGIC )
+        return false;
+
+    const QByteArray data = input.read( dataSize );
+    if ( data.size() != int( dataSize ) )
+        return false;
+
+    // Every column is prefixed with its size
+    const char *position = data.constData();
+    const char *end = position + data.size();
+    QVector<qint64> times;
+    QVector< QVector<double> > values( columns );
+    for ( int column = -1; column < columns; ++column ) {
+        if ( end - position < 4 )
+            return false;
+        const uchar *sizeBytes = reinterpret_cast<const uchar *>( position );
+        const quint32 size = ( quint32( sizeBytes[0] ) << 24 ) | ( quint32( sizeBytes[1] ) << 16 ) |
+                             ( quint32( sizeBytes[2] ) << 8 ) | quint32( sizeBytes[3] );
+        position += 4;
+        if ( quint32( end - position ) < size )
+            return false;
+        const bool decoded = column == -1 ? decodeTimes( position, size, count, times )
+                                          : decodeValues( position, size, count, values[ column ] );
+        if ( !decoded )
+            return false;
+        position += size;
+    }
+
+    for ( int i = 0; i < count; ++i ) {
+        Sample sample;
+        sample.time = times.at( i );
+        for ( int column = 0; column < columns; ++column )
+            sample.values.append( values.at( column ).at( i ) );
+        samples.append( sample );
+    }
+    return true;
+}
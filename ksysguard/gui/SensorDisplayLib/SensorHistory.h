@@ -0,0 +1,129 @@
+/*
+    KSysGuard, the KDE System Guard
+
+    Copyright (c) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+#ifndef KSG_SENSORHISTORY_H
+#define KSG_SENSORHISTORY_H
+
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+/**
+  Records the samples of a set of sensors, so that they can be looked at
+  again later on.
+
+  The samples are collected into blocks, which are appended to a file once
+  they are full.  Inside of a block the data is stored by column: the time
+  stamps are compressed by storing the difference between the deltas of
+  consecutive time stamps, and the values of every sensor by storing the
+  bits that changed compared to the previous value.  For sensors that are
+  sampled at a regular interval this takes a few bytes per sample.
+
+  When the file reaches half of the maximum size it is renamed, replacing
+  the previous one, and a new file is started.  Reading only decodes the
+  blocks in the requested range, so the files never need to be loaded
+  completely.
+ */
+class SensorHistory
+{
+  public:
+    class Sample
+    {
+      public:
+        qint64 time; ///< Milliseconds since the epoch
+        QList<qreal> values;
+    };
+
+    /**
+      Opens the history stored in @p fileName, using at most @p maximumSize
+      bytes of disk space.  The files are locked while the history is open,
+      if they are in use already a numbered file next to them is used.
+     */
+    explicit SensorHistory( const QString &fileName, qint64 maximumSize = 16 * 1024 * 1024 );
+    ~SensorHistory();
+
+    /**
+      @return The file to store the history of the given sensors in.
+     */
+    static QString fileName( const QStringList &sensors );
+
+    /**
+      @return True if the history file could be opened.
+     */
+    bool isValid() const;
+
+    /**
+      Adds a sample taken at @p time milliseconds since the epoch.  If the
+      number of values is different to the previous sample, a new block is
+      started.
+     */
+    void append( qint64 time, const QList<qreal> &values );
+
+    /**
+      Writes the samples that do not fill a whole block yet.
+     */
+    void flush();
+
+    /**
+      @return The time of the oldest sample, or -1 if there are none.
+     */
+    qint64 firstTime() const;
+
+    /**
+      @return The time of the newest sample, or -1 if there are none.
+     */
+    qint64 lastTime() const;
+
+    /**
+      @return Up to @p count samples, the newest of which has been taken
+      at @p time or before.  The oldest sample comes first.
+     */
+    QList<Sample> samples( qint64 time, int count ) const;
+
+  private:
+    class Block
+    {
+      public:
+        int file;
+        qint64 offset;
+        qint64 firstTime;
+        qint64 lastTime;
+    };
+
+    void scanFile( int file );
+    void writeBlock();
+    void rotate();
+    bool readBlock( const Block &block, QList<Sample> &samples ) const;
+    QString filePath( int file ) const;
+
+    QString mFileName;
+    qint64 mMaximumSize;
+    int mLockFd;
+    QFile mFile;
+    QVector<Block> mBlocks; ///< The blocks of the previous file followed by the ones of the current file
+
+    QVector<qint64> mPendingTimes; ///< Samples which do not fill a block yet
+    QVector< QList<qreal> > mPendingValues;
+};
+
+#endif
@@ -353,6 +353,7 @@ KSGRD::SensorDisplay* WorkSheet::insertDisplay( DisplayType displayType, QString
     }
     newDisplay->applyStyle();
     connect(&mTimer, SIGNAL(timeout()), newDisplay, SLOT(timerTick()));
+    newDisplay->setUpdateInterval( mTimer.isActive() ? mTimer.interval() : 0 );
     replaceDisplay( row, column, newDisplay, rowSpan, columnSpan );
     return newDisplay;
 }
@@ -792,6 +793,12 @@ void WorkSheet::setUpdateInterval( float secs)
         mTimer.setInterval(secs*1000);
         mTimer.start();
     }
+
+    // Displays using subscriptions have their values pushed in this interval
+    if (!mGridLayout)
+        return;
+    for (int i = 0; i < mGridLayout->count(); i++)
+        static_cast<KSGRD::SensorDisplay*>(mGridLayout->itemAt(i)->widget())->setUpdateInterval( mTimer.isActive() ? mTimer.interval() : 0 );
 }
 float WorkSheet::updateInterval() const
 {
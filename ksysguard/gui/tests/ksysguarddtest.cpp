@@ -285,6 +285,52 @@ void TestKsysguardd::testQueueing()
     }
 
 }
+void TestKsysguardd::testSubscriptions()
+{
+    //Subscribe to a request, check that the answers keep arriving with the subscribed id until unsubscribed
+
+    delete client; //Start with a new client
+    client = new SensorClientTest;
+
+    const int id = 42;
+    const int N = 5;
+    bool success = manager.subscribe("", "monitors", client, id, 100);
+    QVERIFY(success);
+
+    //A request sent in between is answered with its own id
+    success = manager.sendRequest("", "monitors", client, id + 1);
+    QVERIFY(success);
+
+    int timeout = 300; //Wait up to 30 seconds
+    while( client->answers.count() < N + 1 && !client->isSensorLost && timeout--)
+        QTest::qWait(100);
+    QVERIFY(!client->isSensorLost);
+    QVERIFY(client->answers.count() >= N + 1);
+
+    int subscribedAnswers = 0;
+    int requestedAnswers = 0;
+    foreach(const Answer &answer, client->answers) {
+        QVERIFY(!answer.answer.isEmpty());
+        if(answer.id == id)
+            subscribedAnswers++;
+        else if(answer.id == id + 1)
+            requestedAnswers++;
+        else
+            QFAIL("Answer with an unknown id");
+    }
+    QVERIFY(subscribedAnswers >= N);
+    QCOMPARE(requestedAnswers, 1);
+
+    manager.unsubscribe("", client, id);
+    //An answer may have been pushed before the daemon received the unsubscription
+    QTest::qWait(300);
+    const int count = client->answers.count();
+    QTest::qWait(500);
+    QCOMPARE(client->answers.count(), count);
+
+    QCOMPARE(hostConnectionLostSpy->count(), 0);
+}
+
 QTEST_MAIN(TestKsysguardd)
 
 
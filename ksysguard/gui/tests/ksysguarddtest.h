@@ -22,6 +22,7 @@ class TestKsysguardd : public QObject
         void testFormatting_data();
         void testFormatting();
         void testQueueing();
+        void testSubscriptions();
     private:
         KSGRD::SensorManager manager;
         SensorClientTest *client;
@@ -0,0 +1,179 @@
+/*
+    KSysGuard, the KDE System Guard
+
+    Copyright (c) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+#include <qtest_kde.h>
+
+#include <ktempdir.h>
+#include "SensorHistory.h"
+#include "sensorhistorytest.h"
+
+#include <QFile>
+
+#include <limits>
+
+#include "moc_sensorhistorytest.cpp"
+
+QTEST_KDEMAIN(SensorHistoryTest, NoGUI)
+
+static QList<qreal> values(qreal first, qreal second)
+{
+    QList<qreal> result;
+    result << first << second;
+    return result;
+}
+
+void SensorHistoryTest::init()
+{
+    m_tempDir = new KTempDir();
+}
+
+void SensorHistoryTest::cleanup()
+{
+    delete m_tempDir;
+    m_tempDir = 0;
+}
+
+void SensorHistoryTest::testRoundTrip()
+{
+    SensorHistory history(m_tempDir->name() + "history");
+    QVERIFY(history.isValid());
+    QCOMPARE(history.firstTime(), qint64(-1));
+    QCOMPARE(history.lastTime(), qint64(-1));
+
+    // Irregular intervals, large jumps and values that do not compress well
+    const qint64 times[] = { 1000, 3000, 5000, 7000, 7001, 9500, 100000, 100250, 4000000000LL, 4000002000LL };
+    const qreal first[] = { 0, 0, 1.5, 1.5, -3.25, 1e300, 42, 0.1, 1e-300, 7 };
+    const int count = sizeof(times) / sizeof(times[0]);
+    for (int i = 0; i < count; ++i)
+        history.append(times[i], values(first[i], i % 3 ? qreal(i) : std::numeric_limits<qreal>::quiet_NaN()));
+    history.flush();
+
+    const QList<SensorHistory::Sample> samples = history.samples(times[count - 1], count);
+    QCOMPARE(samples.count(), count);
+    for (int i = 0; i < count; ++i) {
+        QCOMPARE(samples.at(i).time, times[i]);
+        QCOMPARE(samples.at(i).values.count(), 2);
+        QCOMPARE(samples.at(i).values.at(0), first[i]);
+        if (i % 3)
+            QCOMPARE(samples.at(i).values.at(1), qreal(i));
+        else
+            QVERIFY(samples.at(i).values.at(1) != samples.at(i).values.at(1));
+    }
+}
+
+void SensorHistoryTest::testReopen()
+{
+    {
+        SensorHistory history(m_tempDir->name() + "history");
+        for (int i = 0; i < 1000; ++i)
+            history.append(i * 1000, values(i, i % 10));
+    }
+
+    // A regular interval needs a few bytes per sample
+    QVERIFY(QFile(m_tempDir->name() + "history").size() < 1000 * 8);
+
+    // An incomplete block at the end is dropped
+    {
+        QFile file(m_tempDir->name() + "history");
+        QVERIFY(file.open(QIODevice::Append));
+        file.write("KSH1", 4);
+    }
+
+    SensorHistory history(m_tempDir->name() + "history");
+    QCOMPARE(history.firstTime(), qint64(0));
+    QCOMPARE(history.lastTime(), qint64(999000));
+    history.append(1000000, values(1000, 0));
+    const QList<SensorHistory::Sample> samples = history.samples(1000000, 3);
+    QCOMPARE(samples.count(), 3);
+    QCOMPARE(samples.at(0).time, qint64(998000));
+    QCOMPARE(samples.at(1).values, values(999, 9));
+    QCOMPARE(samples.at(2).values, values(1000, 0));
+}
+
+void SensorHistoryTest::testSamples()
+{
+    SensorHistory history(m_tempDir->name() + "history");
+    for (int i = 0; i < 500; ++i)
+        history.append(i * 1000, values(i, -i));
+
+    // The newest sample returned is the one at or before the given time
+    QList<SensorHistory::Sample> samples = history.samples(250500, 10);
+    QCOMPARE(samples.count(), 10);
+    QCOMPARE(samples.first().time, qint64(241000));
+    QCOMPARE(samples.last().time, qint64(250000));
+    QCOMPARE(samples.last().values, values(250, -250));
+
+    samples = history.samples(2000, 10);
+    QCOMPARE(samples.count(), 3);
+    QCOMPARE(samples.first().time, qint64(0));
+
+    QVERIFY(history.samples(-1, 10).isEmpty());
+}
+
+void SensorHistoryTest::testRotation()
+{
+    const qint64 maximumSize = 16 * 1024;
+    SensorHistory history(m_tempDir->name() + "history", maximumSize);
+    for (int i = 0; i < 100000; ++i)
+        history.append(i * 1000 + (i % 7), values(i * 0.37, i % 13));
+    history.flush();
+
+    const qint64 size = QFile(m_tempDir->name() + "history").size() + QFile(m_tempDir->name() + "history.old").size();
+    QVERIFY(size <= maximumSize + 4096);
+
+    // The oldest samples are gone, the newest ones are still there
+    QVERIFY(history.firstTime() > 0);
+    QCOMPARE(history.lastTime(), qint64(99999 * 1000 + (99999 % 7)));
+    const QList<SensorHistory::Sample> samples = history.samples(history.lastTime(), 1);
+    QCOMPARE(samples.count(), 1);
+    QCOMPARE(samples.first().values, values(99999 * 0.37, 99999 % 13));
+}
+
+void SensorHistoryTest::testConcurrentHistories()
+{
+    // Two displays of the same sensors do not write into the same file
+    {
+        SensorHistory first(m_tempDir->name() + "history");
+        SensorHistory second(m_tempDir->name() + "history");
+        QVERIFY(first.isValid());
+        QVERIFY(second.isValid());
+        for (int i = 0; i < 300; ++i) {
+            first.append(i * 1000, values(i, 1));
+            second.append(i * 1000 + 500, values(i, 2));
+        }
+        first.flush();
+        second.flush();
+
+        QList<SensorHistory::Sample> samples = first.samples(first.lastTime(), 300);
+        QCOMPARE(samples.count(), 300);
+        foreach (const SensorHistory::Sample &sample, samples)
+            QCOMPARE(sample.values.at(1), qreal(1));
+        samples = second.samples(second.lastTime(), 300);
+        QCOMPARE(samples.count(), 300);
+        foreach (const SensorHistory::Sample &sample, samples)
+            QCOMPARE(sample.values.at(1), qreal(2));
+    }
+
+    // Once closed, the history of the first display is found again
+    SensorHistory history(m_tempDir->name() + "history");
+    QCOMPARE(history.firstTime(), qint64(0));
+    QCOMPARE(history.lastTime(), qint64(299000));
+}
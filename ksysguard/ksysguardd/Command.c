@@ -32,16 +32,26 @@
 
 #include "Command.h"
 
-typedef struct {
+/* Initial number of buckets of the command hash table, must be a power of 2 */
+#define COMMANDHASHSIZE	256
+
+typedef struct Command {
   char* command;
   cmdExecutor ex;
   char* type;
   int isMonitor;
   int isLegacy;
   struct SensorModul* sm;
+  unsigned int hash;
+  struct Command* nextInBucket;
 } Command;
 
+/* The list keeps the order of registration for the 'monitors' command,
+ * the hash table is used to look up the commands. */
 static CONTAINER CommandList;
+static Command** CommandHash = 0;
+static unsigned int CommandHashSize = 0;
+static unsigned int CommandCount = 0;
 static sigset_t SignalSet;
 
 void command_cleanup( void* v );
@@ -58,6 +68,104 @@ void command_cleanup( void* v )
   }
 }
 
+static unsigned int hashCommand( const char* command, size_t length )
+{
+  /* FNV-1a */
+  unsigned int hash = 2166136261u;
+  size_t i;
+
+  for ( i = 0; i < length; i++ ) {
+    hash ^= (unsigned char)command[ i ];
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+static void appendToBucket( Command** table, unsigned int size, Command* cmd )
+{
+  /* Append to keep the first registered command winning on duplicates */
+  Command** bucket = &table[ cmd->hash & ( size - 1 ) ];
+
+  while ( *bucket )
+    bucket = &(*bucket)->nextInBucket;
+
+  cmd->nextInBucket = 0;
+  *bucket = cmd;
+}
+
+static int insertCommand( Command* cmd )
+{
+  if ( ( CommandCount + 1 ) * 4 > CommandHashSize * 3 ) {
+    unsigned int size = CommandHashSize ? CommandHashSize * 2 : COMMANDHASHSIZE;
+    Command** table = (Command**)calloc( size, sizeof( Command* ) );
+    unsigned int i;
+
+    if ( !table )
+      return -1;
+
+    for ( i = 0; i < CommandHashSize; i++ ) {
+      Command* c = CommandHash[ i ];
+      while ( c ) {
+        Command* next = c->nextInBucket;
+        appendToBucket( table, size, c );
+        c = next;
+      }
+    }
+
+    free( CommandHash );
+    CommandHash = table;
+    CommandHashSize = size;
+  }
+
+  cmd->hash = hashCommand( cmd->command, strlen( cmd->command ) );
+  appendToBucket( CommandHash, CommandHashSize, cmd );
+  CommandCount++;
+
+  return 0;
+}
+
+static void takeCommand( Command* cmd )
+{
+  Command** bucket = &CommandHash[ cmd->hash & ( CommandHashSize - 1 ) ];
+
+  while ( *bucket && *bucket != cmd )
+    bucket = &(*bucket)->nextInBucket;
+
+  if ( *bucket ) {
+    *bucket = cmd->nextInBucket;
+    CommandCount--;
+  }
+}
+
+static Command* findCommand( const char* command, size_t length )
+{
+  Command* cmd;
+  unsigned int hash;
+
+  if ( !CommandHash )
+    return 0;
+
+  hash = hashCommand( command, length );
+  for ( cmd = CommandHash[ hash & ( CommandHashSize - 1 ) ]; cmd; cmd = cmd->nextInBucket ) {
+    if ( cmd->hash == hash && strncmp( cmd->command, command, length ) == 0 && cmd->command[ length ] == 0 )
+      return cmd;
+  }
+
+  return 0;
+}
+
+static void addCommand( Command* cmd )
+{
+  if ( insertCommand( cmd ) < 0 ) {
+    print_error("Out of memory");
+    command_cleanup( cmd );
+    return;
+  }
+
+  push_ctnr( CommandList, cmd );
+}
+
 /*
 ================================ public part =================================
 */
@@ -116,6 +224,7 @@ void initCommand( void )
   sigaddset( &SignalSet, SIGALRM );
 
   registerCommand( "monitors", printMonitors );
+  registerCommand( "multi", exMulti );
   /* registerCommand( "test", printTest ); */
 
   if ( RunAsDaemon == 0 )
@@ -125,6 +234,11 @@ void initCommand( void )
 void exitCommand( void )
 {
   destr_ctnr( CommandList, command_cleanup );
+
+  free( CommandHash );
+  CommandHash = 0;
+  CommandHashSize = 0;
+  CommandCount = 0;
 }
 
 void registerCommand( const char* command, cmdExecutor ex )
@@ -139,7 +253,9 @@ void registerCommand( const char* command, cmdExecutor ex )
   cmd->type = 0;
   cmd->ex = ex;
   cmd->isMonitor = 0;
-  push_ctnr( CommandList, cmd );
+  cmd->isLegacy = 0;
+  cmd->sm = 0;
+  addCommand( cmd );
   ReconfigureFlag = 1;
 }
 
@@ -149,6 +265,7 @@ void removeCommand( const char* command )
 
   for ( cmd = first_ctnr( CommandList ); cmd; cmd = next_ctnr( CommandList ) ) {
     if ( cmd->command && strcmp( cmd->command, command ) == 0 ) {
+      takeCommand( cmd );
       remove_ctnr( CommandList );
       free( cmd->command );
       if ( cmd->type )
@@ -190,7 +307,7 @@ void registerAnyMonitor( const char* command, const char* type, cmdExecutor ex,
   cmd->isMonitor = 1;
   cmd->isLegacy = isLegacy;
   cmd->sm = sm;
-  push_ctnr( CommandList, cmd );
+  addCommand( cmd );
 
   cmd = (Command*)malloc( sizeof( Command ) );
   if(!cmd ) {
@@ -210,9 +327,10 @@ void registerAnyMonitor( const char* command, const char* type, cmdExecutor ex,
   cmd->command[ strlen( command ) + 1 ] = '\0';
   cmd->ex = iq;
   cmd->isMonitor = 0;
+  cmd->isLegacy = isLegacy;
   cmd->sm = sm;
   cmd->type = 0;
-  push_ctnr( CommandList, cmd );
+  addCommand( cmd );
 }
 
 void registerMonitor( const char* command, const char* type, cmdExecutor ex,
@@ -258,28 +376,27 @@ void executeCommand( const char* command )
       return; /* No command give at all */
   int lengthOfCommand = i;
 
-  for ( cmd = first_ctnr( CommandList ); cmd; cmd = next_ctnr( CommandList ) ) {
-    if ( strncmp( cmd->command, command, lengthOfCommand ) == 0 && cmd->command[lengthOfCommand] == 0) {
-      if ( cmd->isMonitor && cmd->sm->updateCommand != NULL) {
-        struct timeval currentTime;
-        gettimeofday(&currentTime,NULL);
-        unsigned long long timeCentiSeconds = (unsigned long long)currentTime.tv_sec * 10 + currentTime.tv_usec / 100000;
-        if ( timeCentiSeconds - cmd->sm->timeCentiSeconds >= UPDATEINTERVAL ) {
-          cmd->sm->timeCentiSeconds = timeCentiSeconds;
-          cmd->sm->updateCommand();
-        }
+  cmd = findCommand( command, lengthOfCommand );
+  if ( cmd ) {
+    if ( cmd->isMonitor && cmd->sm->updateCommand != NULL) {
+      struct timeval currentTime;
+      gettimeofday(&currentTime,NULL);
+      unsigned long long timeCentiSeconds = (unsigned long long)currentTime.tv_sec * 10 + currentTime.tv_usec / 100000;
+      if ( timeCentiSeconds - cmd->sm->timeCentiSeconds >= UPDATEINTERVAL ) {
+        cmd->sm->timeCentiSeconds = timeCentiSeconds;
+        cmd->sm->updateCommand();
       }
+    }
 
-      (*(cmd->ex))( command );
+    (*(cmd->ex))( command );
 
-      if ( ReconfigureFlag ) {
-        ReconfigureFlag = 0;
-        print_error( "RECONFIGURE" );
-      }
-
-      fflush( CurrentClient );
-      return;
+    if ( ReconfigureFlag ) {
+      ReconfigureFlag = 0;
+      print_error( "RECONFIGURE" );
     }
+
+    fflush( CurrentClient );
+    return;
   }
 
   if ( CurrentClient ) {
@@ -305,17 +422,48 @@ void printMonitors( const char *c )
 
 void printTest( const char* c )
 {
-  Command* cmd;
+  const char* command = c + strlen( "test " );
 
-  for ( cmd = first_ctnr( CommandList ); cmd; cmd = next_ctnr( CommandList ) ) {
-    if ( strcmp( cmd->command, c + strlen( "test " ) ) == 0 ) {
-      output( "1\n" );
-      fflush( CurrentClient );
-      return;
+  output( findCommand( command, strlen( command ) ) ? "1\n" : "0\n" );
+  fflush( CurrentClient );
+}
+
+void exMulti( const char* cmd )
+{
+  const char* query = cmd + strlen( "multi" );
+  char* buf = 0;
+  size_t bufSize = 0;
+
+  if ( *query == ' ' || *query == '\t' )
+    query++;
+
+  /* Every query is answered, even an empty or unknown one, so the
+   * front end can assign the answers by their position. */
+  while ( *query ) {
+    const char* end = strchr( query, '\t' );
+    size_t length = end ? (size_t)( end - query ) : strlen( query );
+
+    if ( length + 1 > bufSize ) {
+      char* newBuf = (char*)realloc( buf, length + 1 );
+      if ( !newBuf ) {
+        print_error( "Out of memory" );
+        break;
+      }
+      buf = newBuf;
+      bufSize = length + 1;
     }
+
+    memcpy( buf, query, length );
+    buf[ length ] = '\0';
+    executeCommand( buf );
+    output( "\035\n" );
+
+    query += length;
+    if ( *query )
+      query++;
   }
 
-  output( "0\n" );
+  free( buf );
   fflush( CurrentClient );
 }
 
@@ -136,4 +136,11 @@ void printTest( const char* cmd );
 
 void exQuit( const char* cmd );
 
+/**
+  Executes the tab separated queries following "multi " one after
+  another. Each answer is terminated by a line containing only the
+  ASCII group separator '\035'.
+ */
+void exMulti( const char* cmd );
+
 #endif
@@ -10,6 +10,7 @@ SET(LIBKSYSGUARDD_SOURCES
     Linux/Memory.c
     Linux/netdev.c
     Linux/netstat.c
+    Linux/procfile.c
     Linux/ProcessList.c
     Linux/stat.c
     Linux/softraid.c
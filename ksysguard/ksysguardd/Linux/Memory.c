@@ -18,22 +18,13 @@
 
 */
 
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <unistd.h>
-#include <stdlib.h>
-#include <stdio.h>
-#include <string.h>
-
 #include "Command.h"
 #include "ksysguardd.h"
+#include "procfile.h"
 
 #include "Memory.h"
 
-#define MEMINFOBUFSIZE (2 * 1024)
-
-static char MemInfoBuf[ MEMINFOBUFSIZE ];
+static ProcFile MemInfoFile = PROCFILE_INIT( "/proc/meminfo" );
 static int MemDirty = 1;
 
 static unsigned long long Total = 0;
@@ -46,22 +37,26 @@ static unsigned long long STotal = 0;
 static unsigned long long SFree = 0;
 static unsigned long long SUsed = 0;
 
-static void scan_one( const char* buff, const char *key, unsigned long long* val )
-{   
-  int o;
-  char *b = strstr( buff, key );
-  if ( b )  
-    o = sscanf( b + strlen( key ), ": %llu", val );
-}
-
 static void processMemInfo()
 {
-  scan_one( MemInfoBuf, "MemTotal", &Total );
-  scan_one( MemInfoBuf, "MemFree", &MFree );
-  scan_one( MemInfoBuf, "Buffers", &Buffers );
-  scan_one( MemInfoBuf, "Cached", &Cached );
-  scan_one( MemInfoBuf, "SwapTotal", &STotal );
-  scan_one( MemInfoBuf, "SwapFree", &SFree );
+  const char* line;
+  const char* p;
+
+  for ( line = procFileData( &MemInfoFile ); *line; line = nextLine( line ) ) {
+    if ( ( p = matchKey( line, "MemTotal:" ) ) )
+      Total = parseULL( &p );
+    else if ( ( p = matchKey( line, "MemFree:" ) ) )
+      MFree = parseULL( &p );
+    else if ( ( p = matchKey( line, "Buffers:" ) ) )
+      Buffers = parseULL( &p );
+    else if ( ( p = matchKey( line, "Cached:" ) ) )
+      Cached = parseULL( &p );
+    else if ( ( p = matchKey( line, "SwapTotal:" ) ) )
+      STotal = parseULL( &p );
+    else if ( ( p = matchKey( line, "SwapFree:" ) ) )
+      SFree = parseULL( &p );
+  }
+
   Used = Total - MFree;
   Appl = ( Used - ( Buffers + Cached ) );
 
@@ -97,6 +92,7 @@ void initMemory( struct SensorModul* sm )
 
 void exitMemory( void )
 {
+  closeProcFile( &MemInfoFile );
 }
 
 int updateMemory( void )
@@ -129,25 +125,13 @@ int updateMemory( void )
     ReverseMaps:    103458
    */
 
-  int fd;
-  size_t n;
-
-  if ( ( fd = open( "/proc/meminfo", O_RDONLY ) ) < 0 ) {
-    print_error( "Cannot open \'/proc/meminfo\'!\n"
+  if ( readProcFile( &MemInfoFile ) <= 0 ) {
+    print_error( "Cannot read \'/proc/meminfo\'!\n"
                  "The kernel needs to be compiled with support\n"
                  "for /proc file system enabled!\n" );
     return -1;
   }
 
-  n = read( fd, MemInfoBuf, MEMINFOBUFSIZE - 1 );
-  if ( n == MEMINFOBUFSIZE - 1 || n <= 0 ) {
-    log_error( "Internal buffer too small to read \'/proc/meminfo\'" );
-    close( fd );
-    return -1;
-  }
-
-  close( fd );
-  MemInfoBuf[ n ] = '\0';
   MemDirty = 1;
 
   return 0;
@@ -35,11 +35,11 @@
 #include "PWUIDCache.h"
 #include "ccont.h"
 #include "ksysguardd.h"
+#include "procfile.h"
 
 #include "ProcessList.h"
 
 #define BUFSIZE 1024
-#define TAGSIZE 32
 
 #ifndef bool
 #define bool char
@@ -145,18 +145,31 @@ static void validateStr( char* str )
     strcpy( str, " " );
 }
 
+/* Copies the first word at p into str, which can hold size characters */
+static void copyWord( const char* p, char* str, size_t size )
+{
+  size_t i = 0;
+
+  while ( *p == ' ' || *p == '\t' )
+    ++p;
+  while ( i < size - 1 && *p && *p != ' ' && *p != '\t' && *p != '\n' )
+    str[ i++ ] = *p++;
+  str[ i ] = '\0';
+}
+
 static bool getProcess( int pid, ProcessInfo *ps )
 {
-  FILE* fd;
   char buf[ BUFSIZE ];
-  char tag[ TAGSIZE ];
-  char format[ 32 ];
-  char tagformat[ 32 ];
+  char data[ 4 * BUFSIZE ];
+  const char* line;
+  const char* p;
   const char* uName;
   char status;
+  long long fields[ 21 ];
+  ssize_t n;
 
   snprintf( buf, BUFSIZE - 1, "/proc/%d/status", pid );
-  if ( ( fd = fopen( buf, "r" ) ) == 0 ) {
+  if ( readProcFileOnce( buf, data, sizeof( data ) ) < 0 ) {
     /* process has terminated in the mean time */
     return false;
   }
@@ -164,44 +177,47 @@ static bool getProcess( int pid, ProcessInfo *ps )
   ps->gid = 0;
   ps->tracerpid = -1;
   
-  sprintf( format, "%%%d[^\n]\n", (int)sizeof( buf ) - 1 );
-  sprintf( tagformat, "%%%ds", (int)sizeof( tag ) - 1 );
-  for ( ;; ) {
-    if ( fscanf( fd, format, buf ) != 1 )
-      break;
-    buf[ sizeof( buf ) - 1 ] = '\0';
-    sscanf( buf, tagformat, tag );
-    tag[ sizeof( tag ) - 1 ] = '\0';
-    if ( strcmp( tag, "Name:" ) == 0 ) {
-      sscanf( buf, "%*s %63s", ps->name );
+  for ( line = data; *line; line = nextLine( line ) ) {
+    if ( ( p = matchKey( line, "Name:" ) ) ) {
+      copyWord( p, ps->name, sizeof( ps->name ) );
       validateStr( ps->name );
-    } else if ( strcmp( tag, "Uid:" ) == 0 ) {
-      sscanf( buf, "%*s %d %*d %*d %*d", (int*)&ps->uid );
-    } else if ( strcmp( tag, "Gid:" ) == 0 ) {
-      sscanf( buf, "%*s %d %*d %*d %*d", (int*)&ps->gid );
-    } else if ( strcmp( tag, "TracerPid:" ) == 0 ) {
-      sscanf( buf, "%*s %d", (int*)&ps->tracerpid );
+    } else if ( ( p = matchKey( line, "Uid:" ) ) ) {
+      ps->uid = parseLL( &p );
+    } else if ( ( p = matchKey( line, "Gid:" ) ) ) {
+      ps->gid = parseLL( &p );
+    } else if ( ( p = matchKey( line, "TracerPid:" ) ) ) {
+      ps->tracerpid = parseLL( &p );
       if (ps->tracerpid == 0)
           ps->tracerpid = -1; /* ksysguard uses -1 to indicate no tracerpid, but linux uses 0 */
     }
   }
 
-  if ( fclose( fd ) )
-    return false;
-
   snprintf( buf, BUFSIZE - 1, "/proc/%d/stat", pid );
   buf[ BUFSIZE - 1 ] = '\0';
-  if ( ( fd = fopen( buf, "r" ) ) == 0 )
+  if ( readProcFileOnce( buf, data, sizeof( data ) ) < 0 )
     return false;
-  int ttyNo;
-  if ( fscanf( fd, "%*d %*s %c %d %*d %*d %d %*d %*u %*u %*u %*u %*u %lu %lu"
-                   "%*d %*d %*d %d %*u %*u %*d %lu %lu",
-                   &status, (int*)&ps->ppid, &ttyNo,
-                   &ps->userTime, &ps->sysTime, &ps->niceLevel, &ps->vmSize,
-                   &ps->vmRss) != 8 ) {
-    fclose( fd );
+
+  /* The name may contain blanks and parentheses, the fields start after the
+   * last ')'. The third field is the status, followed by ppid, pgrp, session,
+   * tty_nr, tpgid, flags, minflt, cminflt, majflt, cmajflt, utime, stime,
+   * cutime, cstime, priority, nice, num_threads, itrealvalue, starttime,
+   * vsize and rss. */
+  p = strrchr( data, ')' );
+  if ( !p )
     return false;
-  }
+  for ( ++p; *p == ' '; ++p )
+    ;
+  status = *p;
+  if ( status == '\0' || parseLLs( p + 1, fields, 21 ) != 21 )
+    return false;
+  ps->ppid = fields[ 0 ];
+  int ttyNo = fields[ 3 ];
+  ps->userTime = fields[ 10 ];
+  ps->sysTime = fields[ 11 ];
+  ps->niceLevel = fields[ 15 ];
+  ps->vmSize = fields[ 19 ];
+  ps->vmRss = fields[ 20 ];
+
   if (ps->ppid == 0) /* ksysguard uses -1 to indicate no parent, but linux uses 0 */
       ps->ppid = -1;
   int major = ttyNo >> 8;
@@ -229,20 +245,15 @@ static bool getProcess( int pid, ProcessInfo *ps )
   ps->vmRss = ps->vmRss * sysconf(_SC_PAGESIZE) / 1024; /*convert to KiB*/
   ps->vmSize /= 1024; /* convert to KiB */
 
-  if ( fclose( fd ) )
-    return false;
-
   snprintf( buf, BUFSIZE - 1, "/proc/%d/statm", pid );
   buf[ BUFSIZE - 1 ] = '\0';
   ps->vmURss = -1;
-  if ( ( fd = fopen( buf, "r" ) ) != 0 )  {
-    unsigned long shared;
-    if ( fscanf( fd, "%*d %*u %lu",
-                   &shared)==1) {
+  if ( readProcFileOnce( buf, data, sizeof( data ) ) >= 0 )  {
+    unsigned long long statm[ 3 ];
+    if ( parseULLs( data, statm, 3 ) == 3 ) {
       /* we use the rss - shared  to find the amount of memory just this app uses */
-      ps->vmURss = ps->vmRss - (shared * sysconf(_SC_PAGESIZE) / 1024);
+      ps->vmURss = ps->vmRss - (statm[ 2 ] * sysconf(_SC_PAGESIZE) / 1024);
     }
-    fclose( fd );
   }
 
 
@@ -264,16 +275,16 @@ static bool getProcess( int pid, ProcessInfo *ps )
 
 
   snprintf( buf, BUFSIZE - 1, "/proc/%d/cmdline", pid );
-  if ( ( fd = fopen( buf, "r" ) ) == 0 )
+  /* The arguments are separated by '\0' and the last one is terminated by
+   * it, so the whole buffer is used up to n. */
+  if ( ( n = readProcFileOnce( buf, ps->cmdline, sizeof( ps->cmdline ) - 2 ) ) < 0 )
     return false;
 
-  ps->cmdline[ 0 ] = '\0';
-
   unsigned int processNameStartPosition = 0;
   unsigned int firstZeroPosition = -1U;
  
-  unsigned int i =0;
-  while( (ps->cmdline[i] = fgetc(fd)) != EOF && i < sizeof(ps->cmdline)-3) {
+  unsigned int i;
+  for ( i = 0; i < (unsigned int)n; i++ ) {
     if(ps->cmdline[i] == '\0')
     {
       ps->cmdline[i] = ' ';
@@ -282,12 +293,13 @@ static bool getProcess( int pid, ProcessInfo *ps )
     }
     if(ps->cmdline[i] == '/' && firstZeroPosition == -1U)
       processNameStartPosition = i + 1;
-    i++;
   }
 
   if(firstZeroPosition != -1U)
   {
     unsigned int processNameLength = firstZeroPosition - processNameStartPosition;
+    if ( processNameLength >= sizeof( ps->name ) )
+      processNameLength = sizeof( ps->name ) - 1;
     memcpy(ps->name, ps->cmdline + processNameStartPosition, processNameLength);
     ps->name[processNameLength] = '\0';
   }
@@ -300,8 +312,6 @@ static bool getProcess( int pid, ProcessInfo *ps )
   }
 
   validateStr( ps->cmdline );
-  if ( fclose( fd ) )
-    return false;
 
   /* find out user name with the process uid */
   uName = getCachedPWUID( ps->uid );
@@ -18,18 +18,13 @@
 
 */
 
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <unistd.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#include <ctype.h>
-#include <time.h>
 
 #include "Command.h"
 #include "ksysguardd.h"
+#include "procfile.h"
 
 #include "cpuinfo.h"
 
@@ -40,17 +35,26 @@ static int numCores = 0; /* Total # of cores */
 static int HighNumCores = 0; /* Highest # of cores ever seen */
 static float* Clocks = 0; /* Array with one entry per core */
 
-#define CPUINFOBUFSIZE (32 * 1024)
-static char CpuInfoBuf[ CPUINFOBUFSIZE ];
+static ProcFile CpuInfoFile = PROCFILE_INIT( "/proc/cpuinfo" );
 static int CpuDirty = 0;
 static struct SensorModul *CpuInfoSM;
 
+/* Returns the value of a "tag<blanks>: value" line, 0 if the line has another tag */
+static const char* cpuInfoValue( const char* line, const char* tag )
+{
+    const char* p = matchKey( line, tag );
+
+    if ( !p )
+        return 0;
+    while ( *p == ' ' || *p == '\t' )
+        ++p;
+    return *p == ':' ? p + 1 : 0;
+}
+
 static void processCpuInfo( void )
 {
-    char format[ 32 ];
-    char tag[ 32 ];
-    char value[ 256 ];
-    char* cibp = CpuInfoBuf;
+    const char* line;
+    const char* value;
 
     /* coreUniqueId is not per processor; it is a counter of the number of cores encountered
      * by the parse thus far */
@@ -63,48 +67,31 @@ static void processCpuInfo( void )
     if ( !CpuInfoOK )
         return;
 
-    sprintf( format, "%%%d[^:]: %%%d[^\n]\n", (int)sizeof( tag ) - 1,
-            (int)sizeof( value ) - 1 );
-
-    while ( sscanf( cibp, format, tag, value ) == 2 ) {
-        char* p;
-
-        tag[ sizeof( tag ) - 1 ] = '\0';
-        value[ sizeof( value ) - 1 ] = '\0';
-
-        /* remove trailing whitespaces */
-        p = tag + strlen( tag ) - 1;
-        /* remove trailing whitespaces */
-        while ( ( *p == ' ' || *p == '\t' ) && p > tag )
-            *p-- = '\0';
+    for ( line = procFileData( &CpuInfoFile ); *line; line = nextLine( line ) ) {
+        if ( ( value = cpuInfoValue( line, "processor" ) ) ) {
+            coreUniqueId = (int)parseULL( &value );
+            if ( coreUniqueId >= HighNumCores ) {
+                /* Found a new processor core. Maybe even a new processor. (We'll check later) */
+                char cmdName[ 24 ];
 
-        if ( strcmp( tag, "processor" ) == 0 ) {
-            if ( sscanf( value, "%d", &coreUniqueId ) == 1 ) {
-                if ( coreUniqueId >= HighNumCores ) {
-                    /* Found a new processor core. Maybe even a new processor. (We'll check later) */
-                    char cmdName[ 24 ];
+                /* Each core has a clock speed. Allocate one per core found. */
+                Clocks = (float*) realloc( Clocks, (coreUniqueId+1) * sizeof( float ) );
+                memset(Clocks + HighNumCores, 0, (coreUniqueId +1 - HighNumCores) * sizeof( float ));
 
-                    /* Each core has a clock speed. Allocate one per core found. */
-                    Clocks = (float*) realloc( Clocks, (coreUniqueId+1) * sizeof( float ) );
-                    memset(Clocks + HighNumCores, 0, (coreUniqueId +1 - HighNumCores) * sizeof( float ));
+                HighNumCores = coreUniqueId + 1;
 
-                    HighNumCores = coreUniqueId + 1;
-
-                    snprintf( cmdName, sizeof( cmdName ) - 1, "cpu/cpu%d/clock", coreUniqueId );
-                    registerMonitor( cmdName, "float", printCPUxClock, printCPUxClockInfo,
-                            CpuInfoSM );
-                }
+                snprintf( cmdName, sizeof( cmdName ) - 1, "cpu/cpu%d/clock", coreUniqueId );
+                registerMonitor( cmdName, "float", printCPUxClock, printCPUxClockInfo,
+                        CpuInfoSM );
             }
-        } else if ( strcmp( tag, "cpu MHz" ) == 0 ) {
+        } else if ( ( value = cpuInfoValue( line, "cpu MHz" ) ) ) {
             if (HighNumCores > coreUniqueId) {
                 /* The if statement above *should* always be true, but there's no harm in being safe. */
-                sscanf( value, "%f", &Clocks[ coreUniqueId ] );
+                Clocks[ coreUniqueId ] = (float)parseDecimal( &value );
             }
-        } else if ( strcmp( tag, "core id" ) == 0 ) {
+        } else if ( ( value = cpuInfoValue( line, "core id" ) ) ) {
             /* the core id is per processor */
-            int curCore;
-
-            if ( (sscanf( value, "%d", &curCore ) == 1) && curCore == 0 ) {
+            if ( parseULL( &value ) == 0 ) {
                 /* core id is back at 0. We just found a new processor. */
                 numProcessors++;
 
@@ -112,12 +99,6 @@ static void processCpuInfo( void )
                     HighNumProcessors = numProcessors;
             }
         }
-        /* Move cibp to beginning of next line, if there is one. */
-        cibp = strchr( cibp, '\n' );
-        if ( cibp )
-            cibp++;
-        else
-            cibp = CpuInfoBuf + strlen( CpuInfoBuf );
     }
 
     numCores = coreUniqueId + 1;
@@ -150,50 +131,26 @@ void initCpuInfo( struct SensorModul* sm )
 void exitCpuInfo( void )
 {
     CpuInfoOK = -1;
+    closeProcFile( &CpuInfoFile );
 
     free( Clocks );
 }
 
 int updateCpuInfo( void )
 {
-    size_t n;
-    int fd;
-
     if ( CpuInfoOK < 0 )
         return -1;
 
-    if ( ( fd = open( "/proc/cpuinfo", O_RDONLY ) ) < 0 ) {
+    if ( readProcFile( &CpuInfoFile ) <= 0 ) {
         if ( CpuInfoOK != 0 )
-            print_error( "Cannot open file \'/proc/cpuinfo\'!\n"
+            print_error( "Cannot read file \'/proc/cpuinfo\'!\n"
                     "The kernel needs to be compiled with support\n"
                     "for /proc file system enabled!\n" );
         CpuInfoOK = -1;
         return -1;
     }
 
-    n = 0;
-    for(;;) {
-        ssize_t len = read( fd, CpuInfoBuf + n, CPUINFOBUFSIZE - 1 - n );
-        if( len < 0 ) {
-            print_error( "Failed to read file \'/proc/cpuinfo\'!\n" );
-            CpuInfoOK = -1;
-            close( fd );
-            return -1;
-        }
-        n += len;
-        if( len == 0 ) /* reading finished */
-            break;
-        if( n == CPUINFOBUFSIZE - 1 ) {
-            log_error( "Internal buffer too small to read \'/proc/cpuinfo\'" );
-            CpuInfoOK = 0;
-            close( fd );
-            return -1;
-        }
-    }
-
-    close( fd );
     CpuInfoOK = 1;
-    CpuInfoBuf[ n ] = '\0';
     CpuDirty = 1;
 
     return 0;
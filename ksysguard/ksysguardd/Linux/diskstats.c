@@ -25,24 +25,16 @@
 #include <sys/time.h> /* for gettimeofday */
 #include <string.h> /* for strcmp and memset */
 #include <stdlib.h> /* for malloc */
-
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <unistd.h>
-#include <ctype.h>
+#include <stdio.h>
 
 #include "Command.h"
 #include "ksysguardd.h"
+#include "procfile.h"
 
 #include "diskstats.h"
 
-#define DISKSTATSBUFSIZE (32 * 1024)
 #define DISKDEVNAMELEN 21
 
-#define STRINGIFY(x) #x
-#define TOSTRING(x) STRINGIFY(x)
-
 typedef struct
 {
 	unsigned long delta;
@@ -87,6 +79,8 @@ static DiskIOInfo* DiskIO = 0;
 
 static int DiskDirty = 0;
 
+static ProcFile DiskstatsFile = PROCFILE_INIT( "/proc/diskstats" );
+
 static void cleanup26DiskList( void );
 static int process26DiskIO( const char* buf );
 
@@ -98,6 +92,7 @@ void initDiskstats( struct SensorModul* sm ) {
 void exitDiskstats( void ) {
 	free( DiskLoad );
 	DiskLoad = 0;
+	closeProcFile( &DiskstatsFile );
 }
 
 int updateDiskstats( void ) {
@@ -105,21 +100,15 @@ int updateDiskstats( void ) {
     return 0;
 }
 void processDiskstats( void ) {
+	const char* line;
 
-    char buf[1024];
-    FILE *file = NULL;
-
-    gettimeofday( &currSampling, 0 );
+	gettimeofday( &currSampling, 0 );
 	/* Process values from /proc/diskstats (Linux >= 2.6.x) */
-	if ( ( file = fopen( "/proc/diskstats", "r" ) ) == NULL )
-		return; /* unable to open file. disable this module. */
-
+	if ( readProcFile( &DiskstatsFile ) < 0 )
+		return; /* unable to read file. disable this module. */
 
-	/* Process values from /proc/diskstats (Linux >= 2.6.x) */
-	while (fgets(buf, sizeof(buf) - 1, file) != NULL) {
-		process26DiskIO(buf);
-	}
-	fclose( file );
+	for ( line = procFileData( &DiskstatsFile ); *line; line = nextLine( line ) )
+		process26DiskIO( line );
 
 	/* save exact time interval between this and the last read of /proc/diskstats */
 	DisktimeInterval = currSampling.tv_sec - lastSampling.tv_sec +
@@ -145,10 +134,13 @@ static int process26DiskIO( const char* buf ) {
 	int                      major, minor;
 	char                     devname[DISKDEVNAMELEN];
 	memset(devname, 0, sizeof(devname) * sizeof(char));
+	const char*              p = buf;
+	const char*              name;
+	unsigned long long       values[ 11 ];
 	unsigned long            total,
-				rio, rmrg, rblk, rtim,
-				wio, wmrg, wblk, wtim,
-				ioqueue, iotim, iotimw;
+				rio, rblk, rtim,
+				wio, wblk, wtim,
+				ioqueue;
 	DiskIOInfo               *ptr = DiskIO;
 	DiskIOInfo               *last = 0;
 	char                     sensorName[128];
@@ -191,24 +183,39 @@ static int process26DiskIO( const char* buf ) {
 		I/O completion time and the backlog that may be accumulating.
 	*/
 
-	switch (sscanf(buf, "%d %d %" TOSTRING(DISKDEVNAMELEN) "s %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu",
-		&major, &minor, devname,
-		&rio, &rmrg, &rblk, &rtim,
-		&wio, &wmrg, &wblk, &wtim,
-		&ioqueue, &iotim, &iotimw))
+	major = parseULL( &p );
+	minor = parseULL( &p );
+	name = skipField( p );
+	while ( *p == ' ' || *p == '\t' )
+		p++;
+	if ( name == p )
+		return -1;
+	memcpy( devname, p, ( name - p < DISKDEVNAMELEN ) ? name - p : DISKDEVNAMELEN - 1 );
+
+	switch ( parseULLs( name, values, 11 ) )
 	{
-	case 7:
+	case 4:
 		/* Partition stats entry */
 		/* Adjust read fields rio rmrg rblk rtim -> rio rblk wio wblk */
-		wblk = rtim;
-		wio = rblk;
-		rblk = rmrg;
+		rio = values[ 0 ];
+		rblk = values[ 1 ];
+		wio = values[ 2 ];
+		wblk = values[ 3 ];
+		rtim = wtim = ioqueue = 0;
 	
 		total = rio + wio;
 	
 		break;
-	case 14:
+	case 11:
 		/* Disk stats entry */
+		rio = values[ 0 ];
+		rblk = values[ 2 ];
+		rtim = values[ 3 ];
+		wio = values[ 4 ];
+		wblk = values[ 6 ];
+		wtim = values[ 7 ];
+		ioqueue = values[ 8 ];
+
 		total = rio + wio;
 	
 		break;
@@ -254,7 +261,7 @@ static int process26DiskIO( const char* buf ) {
 		ptr = (DiskIOInfo*)malloc( sizeof( DiskIOInfo ) );
 		ptr->major = major;
 		ptr->minor = minor;
-		ptr->devname = devname;
+		ptr->devname = strdup( devname );
 		ptr->total.delta = 0;
 		ptr->total.old = total;
 		ptr->rio.delta = 0;
@@ -379,6 +386,7 @@ static void cleanup26DiskList( void ) {
 				last = 0;
 			}
 			
+			free ( ptr->devname );
 			free ( ptr );
 			ptr = newPtr;
 		}
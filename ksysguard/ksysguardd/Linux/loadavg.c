@@ -18,27 +18,25 @@
 
 */
 
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <unistd.h>
-#include <stdio.h>
-
 #include "ksysguardd.h"
 #include "Command.h"
+#include "procfile.h"
 
 #include "loadavg.h"
 
 static int LoadAvgOK = 0;
 static double LoadAvg1, LoadAvg5, LoadAvg15;
 
-#define LOADAVGBUFSIZE 128
-static char LoadAvgBuf[ LOADAVGBUFSIZE ];
+static ProcFile LoadAvgFile = PROCFILE_INIT( "/proc/loadavg" );
 static int LoadDirty = 0;
 
 static void processLoadAvg( void )
 {
-  sscanf( LoadAvgBuf, "%lf %lf %lf", &LoadAvg1, &LoadAvg5, &LoadAvg15 );
+  const char* p = procFileData( &LoadAvgFile );
+
+  LoadAvg1 = parseDecimal( &p );
+  LoadAvg5 = parseDecimal( &p );
+  LoadAvg15 = parseDecimal( &p );
   LoadDirty = 0;
 }
 
@@ -67,34 +65,22 @@ void initLoadAvg( struct SensorModul* sm )
 void exitLoadAvg( void )
 {
   LoadAvgOK = -1;
+  closeProcFile( &LoadAvgFile );
 }
 
 int updateLoadAvg( void )
 {
-  size_t n;
-  int fd;
-
   if ( LoadAvgOK < 0 )
     return -1;
 
-  if ( ( fd = open( "/proc/loadavg", O_RDONLY ) ) < 0 ) {
+  if ( readProcFile( &LoadAvgFile ) <= 0 ) {
     if ( LoadAvgOK != 0 )
-      print_error( "Cannot open file \'/proc/loadavg\'!\n"
+      print_error( "Cannot read file \'/proc/loadavg\'!\n"
                    "The kernel needs to be compiled with support\n"
                    "for /proc file system enabled!\n" );
     return -1;
   }
 
-  n = read( fd, LoadAvgBuf, LOADAVGBUFSIZE - 1 );
-  if ( n == LOADAVGBUFSIZE - 1 || n <= 0 ) {
-    log_error( "Internal buffer too small to read \'/proc/loadavg\'" );
-
-    close( fd );
-    return -1;
-  }
-
-  close( fd );
-  LoadAvgBuf[ n ] = '\0';
   LoadDirty = 1;
 
   return 0;
@@ -20,16 +20,13 @@
 
 #include <config-workspace.h>
 
-#include <sys/types.h>
-#include <sys/stat.h>
 #include <sys/time.h>
-#include <fcntl.h>
-#include <unistd.h>
 #include <stdio.h>
 #include <string.h>
 
 #include "Command.h"
 #include "ksysguardd.h"
+#include "procfile.h"
 
 #include "netdev.h"
 
@@ -115,8 +112,11 @@ signed long long a;
   a( misc, "wifi/misc", "Invalid Misc Packets", "", 1, 1) \
   a( beacon, "wifi/beacon", "Missed Beacon", "", 1, 1)
 
-#define SETZERO( a, b, c, d, e, f ) \
-a = 0;
+#define GETVALUE( a, b, c, d, e, f ) \
+a = values[ n++ ];
+
+#define SETMEMBERVALUE( a, b, c, d, e, f ) \
+NetDevs[ i ].a = values[ n++ ];
 
 #define SETMEMBERZERO( a, b, c, d, e, f ) \
 NetDevs[ i ].a = 0; \
@@ -146,9 +146,8 @@ static struct timeval lastSampling;
 static struct timeval currSampling;
 static struct SensorModul* NetDevSM;
 
-#define NETDEVBUFSIZE 4096
-static char NetDevBuf[ NETDEVBUFSIZE ];
-static char NetDevWifiBuf[ NETDEVBUFSIZE ];
+static ProcFile NetDevFile = PROCFILE_INIT( "/proc/net/dev" );
+static ProcFile NetDevWifiFile = PROCFILE_INIT( "/proc/net/wireless" );
 static int NetDevCnt = 0;
 static int NetDirty = 0;
 static long OldHash = 0;
@@ -161,100 +160,106 @@ void processNetDev( void );
 FORALL( DECLAREFUNC )
 FORALLWIFI( DECLAREFUNC )
 
-static int processNetDev_( void )
+/* Stores the interface name of line into name and returns the position
+ * after the ':', or 0 if line does not describe an interface. */
+static const char* parseDevName( const char* line, char* name, size_t size )
 {
-  int i, j;
-  char format[ 32 ];
-  char devFormat[ 16 ];
-  char buf[ 1024 ];
-  char tag[ 64 ];
-  char* netDevBufP = NetDevBuf;
-  char* netDevWifiBufP = NetDevWifiBuf;
-
-  sprintf( format, "%%%d[^\n]\n", (int)sizeof( buf ) - 1 );
-  sprintf( devFormat, "%%%ds", (int)sizeof( tag ) - 1 );
+  const char* end;
+  size_t length;
+
+  while ( *line == ' ' || *line == '\t' )
+    ++line;
+  for ( end = line; *end && *end != '\n' && *end != ':'; ++end )
+    ;
+  if ( *end != ':' || end == line )
+    return 0;
+
+  length = end - line;
+  if ( length >= size )
+    length = size - 1;
+  memcpy( name, line, length );
+  name[ length ] = '\0';
+
+  return end + 1;
+}
 
-  /*Update the values for the wifi interfaces if there is a /proc/net/wireless file*/
-  if (*netDevBufP != '\0') {
-		/* skip 2 first lines */
-		for (i = 0; i < 2; i++) {
-			sscanf(netDevBufP, format, buf);
-			buf[sizeof(buf) - 1] = '\0';
-			netDevBufP += strlen(buf) + 1; /* move netDevBufP to next line */
-		}
-
-		for (i = 0; sscanf(netDevBufP, format, buf) == 1; ++i) {
-			buf[sizeof(buf) - 1] = '\0';
-			netDevBufP += strlen(buf) + 1; /* move netDevBufP to next line */
-
-			if (sscanf(buf, devFormat, tag)) {
-				char* pos = strchr(tag, ':');
-				if (pos) {
-					FORALL( DEFVARS );
-					*pos = '\0';
-					FORALL( SETZERO );
-					sscanf(strchr(buf, ':') + 1, "%llu %llu %llu %llu %llu %llu %llu %llu "
-  					                "%llu %llu %llu %llu %llu %llu %llu %llu",
-                                    &recBytes, &recPacks, &recErrs, &recDrop, &recFifo,
-                                    &recFrame, &recCompressed, &recMulticast,
-                                    &sentBytes, &sentPacks, &sentErrs, &sentDrop,
-                                    &sentFifo, &sentColls, &sentCarrier, &sentCompressed);
-
-					if (i >= NetDevCnt || strcmp(NetDevs[i].name, tag) != 0) {
-						/* The network device configuration has changed. We
-						 * need to reconfigure the netdev module. */
-						return -1;
-					} else {
-						FORALL( CALC );
-						if (!NetDevs[i].isWifi)
-							NetDevs[i].oldInitialised = 1;
-					}
-				}
-			}
-		}
-		if ( i != NetDevCnt )
-		   return -1;
-	}
+/* The link quality and the levels in /proc/net/wireless are followed by a
+ * '.', the status in front of them is not used. */
+static void parseWifiValues( const char* p, signed long long* values )
+{
+  int n;
 
+  p = skipField( p );
+  for ( n = 0; n < 9; ++n ) {
+    values[ n ] = parseLL( &p );
+    if ( *p == '.' )
+      ++p;
+  }
+}
 
+static int processNetDev_( void )
+{
+  int i, n;
+  char tag[ 32 ];
+  const char* line;
+  const char* p;
+
+  if ( NetDevFile.length > 0 ) {
+    /* skip 2 first lines */
+    line = nextLine( nextLine( procFileData( &NetDevFile ) ) );
+
+    for ( i = 0; *line; line = nextLine( line ) ) {
+      if ( ( p = parseDevName( line, tag, sizeof( tag ) ) ) ) {
+        unsigned long long values[ 16 ] = { 0 };
+        FORALL( DEFVARS );
+
+        parseULLs( p, values, 16 );
+        n = 0;
+        FORALL( GETVALUE );
+
+        if ( i >= NetDevCnt || strcmp( NetDevs[ i ].name, tag ) != 0 ) {
+          /* The network device configuration has changed. We
+           * need to reconfigure the netdev module. */
+          return -1;
+        } else {
+          FORALL( CALC );
+          if ( !NetDevs[ i ].isWifi )
+            NetDevs[ i ].oldInitialised = 1;
+        }
+        ++i;
+      }
+    }
+    if ( i != NetDevCnt )
+      return -1;
+  }
 
   /*Update the values for the wifi interfaces if there is a /proc/net/wireless file*/
-  if (*netDevWifiBufP != '\0') {
-
-		/* skip 2 first lines */
-		for (i = 0; i < 2; i++) {
-			sscanf(netDevWifiBufP, format, buf);
-			buf[sizeof(buf) - 1] = '\0';
-			netDevWifiBufP += strlen(buf) + 1; /* move netDevWifiBufP to next line */
-		}
-
-		for (j = 0; sscanf(netDevWifiBufP, format, buf) == 1; ++j) {
-			buf[sizeof(buf) - 1] = '\0';
-			netDevWifiBufP += strlen(buf) + 1; /* move netDevWifiBufP to next line */
-
-			if (sscanf(buf, devFormat, tag)) {
-				char* pos = strchr(tag, ':');
-				if (pos) {
-					FORALLWIFI( DEFWIFIVARS );
-					*pos = '\0';
-
-					for (i = 0; i < NetDevCnt; ++i) { /*find the corresponding interface*/
-						if (strcmp(tag, NetDevs[i].name) == 0) {
-							break;
-						}
-					}
-				    unsigned int wifiStatus;
-				    sscanf(strchr(buf, ':') + 1, " %d %lli. %lli. %lli. %lli %lli %lli %lli %lli %lli",
-                           &wifiStatus, &linkQuality, &signalLevel, &noiseLevel, &nwid,
-                           &RxCrypt, &frag, &retry, &misc, &beacon);
-					signalLevel -= 256; /*the units are dBm*/
-					noiseLevel -= 256;
-					FORALLWIFI( CALC );
-					NetDevs[i].oldInitialised = 1;
-				}
-			}
-		}
-	}
+  if ( NetDevWifiFile.length > 0 ) {
+    /* skip 2 first lines */
+    line = nextLine( nextLine( procFileData( &NetDevWifiFile ) ) );
+
+    for ( ; *line; line = nextLine( line ) ) {
+      if ( ( p = parseDevName( line, tag, sizeof( tag ) ) ) ) {
+        signed long long values[ 9 ] = { 0 };
+        FORALLWIFI( DEFWIFIVARS );
+
+        for ( i = 0; i < NetDevCnt; ++i ) { /*find the corresponding interface*/
+          if ( strcmp( tag, NetDevs[ i ].name ) == 0 )
+            break;
+        }
+        if ( i == NetDevCnt )
+          continue;
+
+        parseWifiValues( p, values );
+        n = 0;
+        FORALLWIFI( GETVALUE );
+        signalLevel -= 256; /*the units are dBm*/
+        noiseLevel -= 256;
+        FORALLWIFI( CALC );
+        NetDevs[ i ].oldInitialised = 1;
+      }
+    }
+  }
 
   /* save exact time inverval between this and the last read of
    * /proc/net/dev */
@@ -292,86 +297,60 @@ void processNetDev( void )
 
 void initNetDev( struct SensorModul* sm )
 {
-  int i, j;
-  char format[ 32 ];
-  char devFormat[ 16 ];
-  char buf[ 1024 ];
-  char tag[ 64 ];
-  char* netDevBufP = NetDevBuf;
-  char* netDevWifiBufP = NetDevWifiBuf;
+  int i, n;
+  char tag[ 32 ];
+  const char* line;
+  const char* p;
 
   NetDevSM = sm;
 
   if ( updateNetDev() < 0 )
     return;
 
-  sprintf( format, "%%%d[^\n]\n", (int)sizeof( buf ) - 1 );
-  sprintf( devFormat, "%%%ds", (int)sizeof( tag ) - 1 );
-
   /* skip 2 first lines */
-  for ( i = 0; i < 2; i++ ) {
-    sscanf( netDevBufP, format, buf );
-    buf[ sizeof( buf ) - 1 ] = '\0';
-    netDevBufP += strlen( buf ) + 1;  /* move netDevBufP to next line */
-  }
+  line = nextLine( nextLine( procFileData( &NetDevFile ) ) );
 
-  for ( i = 0; sscanf( netDevBufP, format, buf ) == 1; ++i ) {
-    buf[ sizeof( buf ) - 1 ] = '\0';
-    netDevBufP += strlen( buf ) + 1;  /* move netDevBufP to next line */
+  for ( ; *line && NetDevCnt < MAXNETDEVS; line = nextLine( line ) ) {
+    if ( ( p = parseDevName( line, tag, sizeof( tag ) ) ) ) {
+      unsigned long long values[ 16 ] = { 0 };
+      char mon[ MON_SIZE ];
 
-    NetDevs[i].oldInitialised = 0;
-    if ( sscanf( buf, devFormat, tag ) ) {
-      char* pos = strchr( tag, ':' );
+      i = NetDevCnt;
+      NetDevs[ i ].oldInitialised = 0;
+      NetDevs[ i ].isWifi = 0;
       FORALL( SETMEMBERZERO );
-      if ( pos ) {
-        char mon[ MON_SIZE ];
-        *pos = '\0';
-        strncpy( NetDevs[ i ].name, tag, sizeof( NetDevs[ i ].name ) );
-        NetDevs[ i ].name[ sizeof( NetDevs[ i ].name )-1] = 0;
-        FORALL( REGISTERSENSOR );
-        sscanf( pos + 1, "%lli %lli %lli %lli %lli %lli %lli %lli"
-                "%lli %lli %lli %lli %lli %lli %lli %lli",
-                &NetDevs[ i ].recBytes, &NetDevs[ i ].recPacks,
-                &NetDevs[ i ].recErrs, &NetDevs[ i ].recDrop,
-                &NetDevs[ i ].recFifo, &NetDevs[ i ].recFrame,
-                &NetDevs[ i ].recCompressed, &NetDevs[ i ].recMulticast,
-                &NetDevs[ i ].sentBytes, &NetDevs[ i ].sentPacks,
-                &NetDevs[ i ].sentErrs, &NetDevs[ i ].sentDrop,
-                &NetDevs[ i ].sentFifo, &NetDevs[ i ].sentColls,
-                &NetDevs[ i ].sentCarrier, &NetDevs[ i ].sentCompressed );
-        NetDevCnt++;
-	}
+      strncpy( NetDevs[ i ].name, tag, sizeof( NetDevs[ i ].name ) );
+      NetDevs[ i ].name[ sizeof( NetDevs[ i ].name )-1] = 0;
+      FORALL( REGISTERSENSOR );
+
+      parseULLs( p, values, 16 );
+      n = 0;
+      FORALL( SETMEMBERVALUE );
+      NetDevCnt++;
     }
   }
 
   /* detect the wifi interfaces*/
   /* skip 2 first lines */
-  for ( i = 0; i < 2; i++ ) {
-    sscanf( netDevWifiBufP, format, buf );
-    buf[ sizeof( buf ) - 1 ] = '\0';
-    netDevWifiBufP += strlen( buf ) + 1;  /* move netDevWifiBufP to next line */
-  }
-
-  for ( j = 0; sscanf( netDevWifiBufP, format, buf ) == 1; ++j ) {
-    buf[ sizeof( buf ) - 1 ] = '\0';
-    netDevWifiBufP += strlen( buf ) + 1;  /* move netDevWifiBufP to next line */
-
-    if ( sscanf( buf, devFormat, tag ) ) {
-      char * pos = strchr( tag, ':' );
-      if ( pos ) {
-        char mon[ MON_SIZE ];
-        *pos = '\0';
-       /*find and tag the corresponding NetDev as wifi enabled.
-        At the end of the loop,  i is the index of the device.
-        This variable i is used in some macro */
-       for (i = 0 ; i < NetDevCnt ; ++i){
-           if ( strcmp(tag,NetDevs[ i ].name)==0){
-               NetDevs[ i ].isWifi = 1;
-               break;
-           }
+  line = nextLine( nextLine( procFileData( &NetDevWifiFile ) ) );
+
+  for ( ; *line; line = nextLine( line ) ) {
+    if ( ( p = parseDevName( line, tag, sizeof( tag ) ) ) ) {
+      char mon[ MON_SIZE ];
+
+      /*find and tag the corresponding NetDev as wifi enabled.
+       At the end of the loop,  i is the index of the device.
+       This variable i is used in some macro */
+      for ( i = 0; i < NetDevCnt; ++i ) {
+        if ( strcmp( tag, NetDevs[ i ].name ) == 0 ) {
+          NetDevs[ i ].isWifi = 1;
+          break;
         }
-        FORALLWIFI( REGISTERSENSOR );
       }
+      if ( i == NetDevCnt )
+        continue;
+
+      FORALLWIFI( REGISTERSENSOR );
       FORALLWIFI( SETMEMBERZERO );  /* the variable i must point to the corrrect NetDevs[i]*/
     }
   }
@@ -391,6 +370,9 @@ void exitNetDev( void )
        FORALLWIFI( UNREGISTERSENSOR );
   }
   NetDevCnt = 0;
+
+  closeProcFile( &NetDevFile );
+  closeProcFile( &NetDevWifiFile );
 }
 
 int updateNetDev( void )
@@ -404,50 +386,30 @@ int updateNetDev( void )
     eth0:123648812  655251    0    0    0     0          0         0 246847871  889636    0    0    0     0       0          0
 	*/
 
-  size_t n;
-  int fd;
   long hash;
-  char* p;
+  const char* p;
 
-  if ((fd = open("/proc/net/dev", O_RDONLY)) > 0) {
-    n = read(fd, NetDevBuf, NETDEVBUFSIZE - 1);
-    if (n == NETDEVBUFSIZE - 1 || n <= 0) {
-      log_error("Internal buffer too small to read \'/proc/net/dev\'");
-      close(fd);
-      return -1;
-    }
+  if ( readProcFile( &NetDevFile ) <= 0 )
+    return -1;
 
-    gettimeofday(&currSampling, 0);
-    close(fd);
-    NetDevBuf[n] = '\0';
-
-    /* Calculate hash over the first 7 characters of each line starting
-     * after the first newline. This will detect whether any interfaces
-     * have either appeared or disappeared. */
-    for (p = NetDevBuf, hash = 0; *p; ++p)
-      if (*p == '\n')
-        for (++p; *p && *p != ':' && *p != '|'; ++p)
-          hash = ((hash << 6) + *p) % 390389;
-
-    if (OldHash != 0 && OldHash != hash) {
-      print_error("RECONFIGURE");
-      CheckSetupFlag = 1;
-    }
-    OldHash = hash;
-  }
+  gettimeofday( &currSampling, 0 );
 
-  /* We read the information about the wifi from /proc/net/wireless and store it into NetDevWifiBuf */
-  if ( ( fd = open( "/proc/net/wireless", O_RDONLY ) ) < 0 ) {
-    /* /proc/net/wireless may not exist on some machines. */
-    NetDevWifiBuf[0]='\0';
-  } else if ( ( n = read( fd, NetDevWifiBuf, NETDEVBUFSIZE - 1 ) ) == NETDEVBUFSIZE - 1 ) {
-    log_error( "Internal buffer too small to read \'/proc/net/wireless\'" );
-    close( fd );
-    return -1;
-  } else {
-	close( fd );
-	NetDevWifiBuf[ n ] = '\0';
+  /* Calculate hash over the first 7 characters of each line starting
+   * after the first newline. This will detect whether any interfaces
+   * have either appeared or disappeared. */
+  for ( p = procFileData( &NetDevFile ), hash = 0; ( p = strchr( p, '\n' ) ); )
+    for ( ++p; *p && *p != ':' && *p != '|'; ++p )
+      hash = ( ( hash << 6 ) + *p ) % 390389;
+
+  if ( OldHash != 0 && OldHash != hash ) {
+    print_error( "RECONFIGURE" );
+    CheckSetupFlag = 1;
   }
+  OldHash = hash;
+
+  /* We read the information about the wifi from /proc/net/wireless. It may
+   * not exist on some machines, the buffer is empty then. */
+  readProcFile( &NetDevWifiFile );
   NetDirty = 1;
 
   return 0;
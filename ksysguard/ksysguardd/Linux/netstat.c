@@ -30,6 +30,7 @@
 #include "ksysguardd.h"
 #include "Command.h"
 #include "ccont.h"
+#include "procfile.h"
 #include "netstat.h"
 
 static CONTAINER TcpSocketList = 0;
@@ -42,6 +43,11 @@ static int num_udp = 0;
 static int num_unix = 0;
 static int num_raw = 0;
 
+static ProcFile TcpFile = PROCFILE_INIT( "/proc/net/tcp" );
+static ProcFile UdpFile = PROCFILE_INIT( "/proc/net/udp" );
+static ProcFile UnixFile = PROCFILE_INIT( "/proc/net/unix" );
+static ProcFile RawFile = PROCFILE_INIT( "/proc/net/raw" );
+
 typedef struct {
 	char local_addr[128];
 	char local_port[128];
@@ -62,7 +68,6 @@ typedef struct {
 char *get_serv_name(int port, const char *proto);
 char *get_host_name(int addr);
 char *get_proto_name(int number);
-int get_num_sockets(FILE *netstat);
 void printSocketInfo(SocketInfo* socket_info);
 
 static time_t TcpUdpRaw_timeStamp = 0;
@@ -163,14 +168,33 @@ char *get_proto_name(int number)
 	return (char *)buffer;
 }
 
-int get_num_sockets(FILE *netstat)
+/* Returns the number of sockets listed in file, the first line is the header */
+static int get_num_sockets(ProcFile *file)
 {
-	char line[1024];
+	const char *p;
 	int line_count = 0;
-	while (fgets(line, 1024, netstat) != NULL)
+
+	if (readProcFile(file) < 0)
+		return 0;
+
+	for (p = procFileData(file); *p; p = nextLine(p))
 		line_count++;
 
-	return line_count - 1;
+	return line_count > 0 ? line_count - 1 : 0;
+}
+
+/* Copies the line at p into line, so that sscanf() can not go past its end */
+static const char *copyLine(const char *p, char *line, size_t size)
+{
+	const char *end = nextLine(p);
+	size_t length = end - p;
+
+	if (length >= size)
+		length = size - 1;
+	memcpy(line, p, length);
+	line[length] = 0;
+
+	return end;
 }
 
 void printSocketInfo(SocketInfo* socket_info)
@@ -191,29 +215,23 @@ void printSocketInfo(SocketInfo* socket_info)
 void
 initNetStat(struct SensorModul* sm)
 {
-	FILE *netstat;
-	
-	if ((netstat = fopen("/proc/net/tcp", "r")) != NULL) {
+	if (readProcFile(&TcpFile) >= 0) {
 		registerMonitor("network/sockets/tcp/count", "integer", printNetStat, printNetStatInfo, sm);
         /* This monitor takes _way_ too much time (up to a minute, or more) since it does DNS lookups
            Hide the monitor, leaving it there for backwards compatibility */
 		registerLegacyMonitor("network/sockets/tcp/list", "listview", printNetStatTcpUdpRaw, printNetStatTcpUdpRawInfo, sm);
-		fclose(netstat);
 	}
-	if ((netstat = fopen("/proc/net/udp", "r")) != NULL) {
+	if (readProcFile(&UdpFile) >= 0) {
 		registerMonitor("network/sockets/udp/count", "integer", printNetStat, printNetStatInfo, sm);
 		registerMonitor("network/sockets/udp/list", "listview", printNetStatTcpUdpRaw, printNetStatTcpUdpRawInfo, sm);
-		fclose(netstat);
 	}
-	if ((netstat = fopen("/proc/net/unix", "r")) != NULL) {
+	if (readProcFile(&UnixFile) >= 0) {
 		registerMonitor("network/sockets/unix/count", "integer", printNetStat, printNetStatInfo, sm);
 		registerMonitor("network/sockets/unix/list", "listview", printNetStatUnix, printNetStatUnixInfo, sm);
-		fclose(netstat);
 	}
-	if ((netstat = fopen("/proc/net/raw", "r")) != NULL) {
+	if (readProcFile(&RawFile) >= 0) {
 		registerMonitor("network/sockets/raw/count", "integer", printNetStat, printNetStatInfo, sm);
 		registerMonitor("network/sockets/raw/list", "listview", printNetStatTcpUdpRaw, printNetStatTcpUdpRawInfo, sm);
-		fclose(netstat);
 	}
 
 	TcpSocketList = new_ctnr();
@@ -229,31 +247,20 @@ exitNetStat(void)
 	destr_ctnr(UdpSocketList, free);
 	destr_ctnr(RawSocketList, free);
 	destr_ctnr(UnixSocketList, free);
+
+	closeProcFile(&TcpFile);
+	closeProcFile(&UdpFile);
+	closeProcFile(&UnixFile);
+	closeProcFile(&RawFile);
 }
 
 int
 updateNetStat(void)
 {
-	FILE *netstat;
-
-	if ((netstat = fopen("/proc/net/tcp", "r")) != NULL) {
-		num_tcp = get_num_sockets(netstat);
-		fclose(netstat);
-	}
-
-	if ((netstat = fopen("/proc/net/udp", "r")) != NULL) {
-		num_udp = get_num_sockets(netstat);
-		fclose(netstat);
-	}
-
-	if ((netstat = fopen("/proc/net/unix", "r")) != NULL) {
-		num_unix = get_num_sockets(netstat);
-		fclose(netstat);
-	}
-	if ((netstat = fopen("/proc/net/raw", "r")) != NULL) {
-		num_raw = get_num_sockets(netstat);
-		fclose(netstat);
-	}
+	num_tcp = get_num_sockets(&TcpFile);
+	num_udp = get_num_sockets(&UdpFile);
+	num_unix = get_num_sockets(&UnixFile);
+	num_raw = get_num_sockets(&RawFile);
 
 	NetStat_timeStamp = time(0);
 	return 0;
@@ -262,7 +269,8 @@ updateNetStat(void)
 int
 updateNetStatTcpUdpRaw(const char *cmd)
 {
-	FILE *netstat;
+	ProcFile *netstat;
+	const char *p;
 	char buffer[1024];
 	unsigned int local_addr, local_port;
 	unsigned int remote_addr, remote_port;
@@ -271,15 +279,15 @@ updateNetStatTcpUdpRaw(const char *cmd)
 	SocketInfo *socket_info;
 
 	if (strstr(cmd, "tcp")) {
-		snprintf(buffer, sizeof(buffer), "/proc/net/tcp");
+		netstat = &TcpFile;
 		empty_ctnr(TcpSocketList);
 	}
         else if (strstr(cmd, "udp")) {
-		snprintf(buffer, sizeof(buffer), "/proc/net/udp");
+		netstat = &UdpFile;
 		empty_ctnr(UdpSocketList);
 	}
         else if (strstr(cmd, "raw")) {
-		snprintf(buffer, sizeof(buffer), "/proc/net/raw");
+		netstat = &RawFile;
 		empty_ctnr(RawSocketList);
 	}
         else {
@@ -287,14 +295,15 @@ updateNetStatTcpUdpRaw(const char *cmd)
 		return -1;
         }
 
-	if ((netstat = fopen(buffer, "r")) == NULL) {
-		print_error("Cannot open \'%s\'!\n"
+	if (readProcFile(netstat) < 0) {
+		print_error("Cannot read \'%s\'!\n"
 		   "The kernel needs to be compiled with support\n"
-		   "for /proc file system enabled!\n", buffer);
+		   "for /proc file system enabled!\n", netstat->name);
 		return -1;
 	}
 
-	while (fgets(buffer, sizeof(buffer), netstat) != NULL) {
+	for (p = procFileData(netstat); *p; ) {
+		p = copyLine(p, buffer, sizeof(buffer));
 		if (buffer[0] != 0) {
 			int matches = sscanf(buffer, "%*d: %x:%x %x:%x %x %*x:%*x %*x:%*x %d",
                     &local_addr, &local_port,
@@ -352,7 +361,6 @@ updateNetStatTcpUdpRaw(const char *cmd)
 			}
 		}
 	}
-	fclose(netstat);
 	TcpUdpRaw_timeStamp = time(0);
 
 	return 0;
@@ -361,14 +369,14 @@ updateNetStatTcpUdpRaw(const char *cmd)
 int
 updateNetStatUnix(void)
 {
-	FILE *file;
+	const char *p;
 	char buffer[1024];
 	char path[256];
 	int ref_count, type, state, inode;
 	UnixInfo *unix_info;
 
-	if ((file = fopen("/proc/net/unix", "r")) == NULL) {
-		print_error("Cannot open \'/proc/net/unix\'!\n"
+	if (readProcFile(&UnixFile) < 0) {
+		print_error("Cannot read \'/proc/net/unix\'!\n"
 		   "The kernel needs to be compiled with support\n"
 		   "for /proc file system enabled!\n");
 		return -1;
@@ -376,7 +384,8 @@ updateNetStatUnix(void)
 
 	empty_ctnr(UnixSocketList);
 
-	while (fgets(buffer, sizeof(buffer), file) != NULL) {
+	for (p = procFileData(&UnixFile); *p; ) {
+		p = copyLine(p, buffer, sizeof(buffer));
 		if(buffer[0] != 0) {
             buffer[1023] = 0;
 			int matches = sscanf(buffer, "%*x: %d %*d %*d %d %d %d %255s",
@@ -401,7 +410,6 @@ updateNetStatUnix(void)
 			push_ctnr(UnixSocketList, unix_info);
 		}
 	}
-	fclose(file);
 	Unix_timeStamp = time(0);
 
 	return 0;
@@ -0,0 +1,251 @@
+/*
+    KSysGuard, the KDE System Guard
+
+    Copyright (c) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of version 2 of the GNU General Public
+    License as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "procfile.h"
+
+#define PROCFILEBUFSIZE 4096
+
+#define ISBLANK( c ) ( ( c ) == ' ' || ( c ) == '\t' )
+#define ISDIGIT( c ) ( ( c ) >= '0' && ( c ) <= '9' )
+
+static ssize_t failed( ProcFile* file )
+{
+  if ( file->fd >= 0 ) {
+    close( file->fd );
+    file->fd = -1;
+  }
+  file->length = 0;
+  if ( file->buffer )
+    file->buffer[ 0 ] = '\0';
+
+  return -1;
+}
+
+ssize_t readProcFile( ProcFile* file )
+{
+  ssize_t n;
+
+  if ( file->fd < 0 ) {
+    file->fd = open( file->name, O_RDONLY | O_CLOEXEC );
+    if ( file->fd < 0 )
+      return failed( file );
+  }
+
+  if ( !file->buffer ) {
+    file->buffer = (char*)malloc( PROCFILEBUFSIZE );
+    if ( !file->buffer )
+      return failed( file );
+    file->size = PROCFILEBUFSIZE;
+  }
+
+  /* The files in /proc are generated on every read, so reading them
+   * again from the start gives the current values without reopening. */
+  file->length = 0;
+  for ( ;; ) {
+    n = pread( file->fd, file->buffer + file->length,
+               file->size - 1 - file->length, file->length );
+    if ( n < 0 ) {
+      if ( errno == EINTR )
+        continue;
+      return failed( file );
+    }
+    if ( n == 0 )
+      break;
+
+    file->length += n;
+    if ( file->length == file->size - 1 ) {
+      char* buffer = (char*)realloc( file->buffer, file->size * 2 );
+      if ( !buffer )
+        return failed( file );
+      file->buffer = buffer;
+      file->size *= 2;
+    }
+  }
+  file->buffer[ file->length ] = '\0';
+
+  return file->length;
+}
+
+void closeProcFile( ProcFile* file )
+{
+  if ( file->fd >= 0 )
+    close( file->fd );
+  file->fd = -1;
+
+  free( file->buffer );
+  file->buffer = 0;
+  file->size = 0;
+  file->length = 0;
+}
+
+const char* procFileData( const ProcFile* file )
+{
+  return file->buffer ? file->buffer : "";
+}
+
+ssize_t readProcFileOnce( const char* name, char* buffer, size_t size )
+{
+  size_t length = 0;
+  ssize_t n;
+  int fd;
+
+  if ( size == 0 || ( fd = open( name, O_RDONLY | O_CLOEXEC ) ) < 0 )
+    return -1;
+
+  while ( length < size - 1 ) {
+    n = read( fd, buffer + length, size - 1 - length );
+    if ( n < 0 ) {
+      if ( errno == EINTR )
+        continue;
+      close( fd );
+      return -1;
+    }
+    if ( n == 0 )
+      break;
+    length += n;
+  }
+
+  close( fd );
+  buffer[ length ] = '\0';
+
+  return length;
+}
+
+unsigned long long parseULL( const char** p )
+{
+  const char* s = *p;
+  unsigned long long value = 0;
+
+  while ( ISBLANK( *s ) )
+    ++s;
+  while ( ISDIGIT( *s ) )
+    value = value * 10 + ( *s++ - '0' );
+
+  *p = s;
+  return value;
+}
+
+long long parseLL( const char** p )
+{
+  const char* s = *p;
+  int negative = 0;
+  long long value;
+
+  while ( ISBLANK( *s ) )
+    ++s;
+  if ( *s == '-' ) {
+    negative = 1;
+    ++s;
+  } else if ( *s == '+' )
+    ++s;
+
+  value = (long long)parseULL( &s );
+  *p = s;
+
+  return negative ? -value : value;
+}
+
+double parseDecimal( const char** p )
+{
+  const char* s = *p;
+  double value, scale = 0.1;
+  int negative;
+
+  while ( ISBLANK( *s ) )
+    ++s;
+  negative = ( *s == '-' );
+  if ( negative )
+    ++s;
+
+  value = (double)parseULL( &s );
+  if ( *s == '.' ) {
+    for ( ++s; ISDIGIT( *s ); ++s ) {
+      value += ( *s - '0' ) * scale;
+      scale /= 10;
+    }
+  }
+
+  *p = s;
+  return negative ? -value : value;
+}
+
+int parseULLs( const char* p, unsigned long long* values, int count )
+{
+  int n;
+
+  for ( n = 0; n < count; ++n ) {
+    while ( ISBLANK( *p ) )
+      ++p;
+    if ( !ISDIGIT( *p ) )
+      break;
+    values[ n ] = parseULL( &p );
+  }
+
+  return n;
+}
+
+int parseLLs( const char* p, long long* values, int count )
+{
+  int n;
+
+  for ( n = 0; n < count; ++n ) {
+    while ( ISBLANK( *p ) )
+      ++p;
+    if ( !ISDIGIT( *p ) && !( ( *p == '-' || *p == '+' ) && ISDIGIT( p[ 1 ] ) ) )
+      break;
+    values[ n ] = parseLL( &p );
+  }
+
+  return n;
+}
+
+const char* skipField( const char* p )
+{
+  while ( ISBLANK( *p ) )
+    ++p;
+  while ( *p && *p != '\n' && !ISBLANK( *p ) )
+    ++p;
+
+  return p;
+}
+
+const char* nextLine( const char* p )
+{
+  const char* end = strchr( p, '\n' );
+
+  return end ? end + 1 : p + strlen( p );
+}
+
+const char* matchKey( const char* line, const char* key )
+{
+  while ( *key )
+    if ( *line++ != *key++ )
+      return 0;
+
+  return line;
+}
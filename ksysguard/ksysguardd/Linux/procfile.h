@@ -0,0 +1,84 @@
+/*
+    KSysGuard, the KDE System Guard
+
+    Copyright (c) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of version 2 of the GNU General Public
+    License as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+#ifndef KSG_PROCFILE_H
+#define KSG_PROCFILE_H
+
+#include <sys/types.h>
+
+/**
+  A file in /proc that is read over and over again. The file is opened
+  once and kept open, every read starts at offset 0 and goes into a
+  buffer that only grows when the file does.
+ */
+typedef struct {
+  const char* name;
+  int fd;
+  char* buffer;
+  size_t size;
+  size_t length;
+} ProcFile;
+
+#define PROCFILE_INIT( name ) { name, -1, 0, 0, 0 }
+
+/**
+  Read the whole file into file->buffer and terminate it with a '\0'.
+  Returns the number of bytes read or -1 if the file cannot be read, in
+  which case the buffer is emptied.
+ */
+ssize_t readProcFile( ProcFile* file );
+void closeProcFile( ProcFile* file );
+
+/**
+  Returns the contents of the last successful read, or an empty string.
+ */
+const char* procFileData( const ProcFile* file );
+
+/**
+  Read a file which is only read once, e.g. /proc/<pid>/stat, into
+  buffer. At most size - 1 bytes are read and a '\0' is appended.
+  Returns the number of bytes read or -1.
+ */
+ssize_t readProcFileOnce( const char* name, char* buffer, size_t size );
+
+/**
+  The parsers skip leading blanks, parse a number and move *p past it.
+  Parsing never goes past the end of the line.
+ */
+unsigned long long parseULL( const char** p );
+long long parseLL( const char** p );
+/** Parses a number like 0.42 as used in /proc/loadavg */
+double parseDecimal( const char** p );
+
+/**
+  Parse up to count blank separated numbers of the line at p. Returns the
+  number of values found.
+ */
+int parseULLs( const char* p, unsigned long long* values, int count );
+int parseLLs( const char* p, long long* values, int count );
+
+/** Skip the blanks and the following field */
+const char* skipField( const char* p );
+/** Returns the start of the next line, or the terminating '\0' */
+const char* nextLine( const char* p );
+/** Returns the position after key if line starts with key, 0 otherwise */
+const char* matchKey( const char* line, const char* key );
+
+#endif
@@ -19,6 +19,7 @@
 
 #include "Command.h"
 #include "ksysguardd.h"
+#include "procfile.h"
 #include "softraid.h"
 
 #include <string.h> /* for strlen, strcat and strcmp */
@@ -32,7 +33,6 @@
 #include <stdbool.h> /* for bool */
 #include "ccont.h" /* for CONTAINER */
 
-#define MDSTATBUFSIZE (1 * 1024)
 #define MDADMSTATBUFSIZE (2 * 1024)
 #define ARRAYNAMELEN 32
 #define ARRAYNAMELENSTRING "32"
@@ -40,7 +40,7 @@
 static struct SensorModul* StatSM;
 
 static CONTAINER ArrayInfos = 0;
-char mdstatBuf[ MDSTATBUFSIZE ];	/* Buffer for /proc/mdstat */
+static ProcFile MdstatFile = PROCFILE_INIT( "/proc/mdstat" );
 
 typedef struct Disks {
 	char *name;			/* e.g.  hda1 */
@@ -307,27 +307,7 @@ void getMdadmDetail( ArrayInfo* MyArray ) {
 	}
 }
 
-void openMdstatFile() {
-	ssize_t n;
-	int fd;
-
-	mdstatBuf[ 0 ] = '\0';
-	if ( ( fd = open( "/proc/mdstat", O_RDONLY ) ) < 0 )
-		return; /* couldn't open /proc/mdstat */
-	
-	n = read( fd, mdstatBuf, MDSTATBUFSIZE - 1 );
-	close( fd );
-
-	if ( n == MDSTATBUFSIZE - 1 || n <= 0 ) {
-		log_error( "Internal buffer too small to read \'/proc/mdstat\'" );
-
-		return;
-	}
-	
-	mdstatBuf[ n ] = '\0';
-}
-
-ArrayInfo *getOrCreateArrayInfo(char *array_name, int array_name_length) {
+ArrayInfo *getOrCreateArrayInfo(const char *array_name, int array_name_length) {
 	ArrayInfo key;
 	INDEX idx;
 	ArrayInfo* MyArray;
@@ -388,8 +368,8 @@ ArrayInfo *getOrCreateArrayInfo(char *array_name, int array_name_length) {
 }
 
 bool scanForArrays() {
-	char* mdstatBufP;
-	char* current_word;
+	const char* mdstatBufP;
+	const char* current_word;
 	int current_word_length = 0;
 
 	ArrayInfo* MyArray;
@@ -400,9 +380,10 @@ bool scanForArrays() {
 	}
 	MyArray = NULL;
 
-	openMdstatFile();
+	/* A missing /proc/mdstat leaves the data empty, so every array is dead */
+	readProcFile( &MdstatFile );
 
-	current_word = mdstatBufP = mdstatBuf;
+	current_word = mdstatBufP = procFileData( &MdstatFile );
 
 	/* Process values from /proc/mdstat */
 
@@ -616,6 +597,7 @@ void initSoftRaid( struct SensorModul* sm ) {
 }
 
 void exitSoftRaid( void ) {
+	closeProcFile( &MdstatFile );
 	destr_ctnr( ArrayInfos, free );
 }
 
@@ -20,18 +20,14 @@
  * stat.c is used to read from /proc/[pid]/stat
 */
 
-#include <sys/types.h>
-#include <sys/stat.h>
 #include <sys/time.h>
-#include <fcntl.h>
-#include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
 
 #include "Command.h"
 #include "ksysguardd.h"
+#include "procfile.h"
 
 #include "stat.h"
 
@@ -77,22 +73,30 @@ static unsigned int NumOfInts = 0;
 static unsigned long* OldIntr = 0;
 static unsigned long* Intr = 0;
 
+static ProcFile StatFile = PROCFILE_INIT( "/proc/stat" );
+static ProcFile VmStatFile = PROCFILE_INIT( "/proc/vmstat" );
+
 static void updateCPULoad( const char* line, CPULoadInfo* load );
 static void processStat( void );
 
 /**
  * updateCPULoad
  *
- * Parses the total cpu status line from /proc/stat
+ * Parses the ticks of a cpu status line from /proc/stat, line points
+ * right after the tag
  */
 static void updateCPULoad( const char* line, CPULoadInfo* load ) {
+	unsigned long long ticks[ 5 ];
 	unsigned long currUserTicks, currSysTicks, currNiceTicks;
 	unsigned long currIdleTicks, currWaitTicks, totalTicks;
 	
-	if(sscanf( line, "%*s %lu %lu %lu %lu %lu", &currUserTicks, &currNiceTicks,
-		&currSysTicks, &currIdleTicks, &currWaitTicks ) != 5) {
-        return;
-    }
+	if ( parseULLs( line, ticks, 5 ) != 5 )
+		return;
+	currUserTicks = ticks[ 0 ];
+	currNiceTicks = ticks[ 1 ];
+	currSysTicks = ticks[ 2 ];
+	currIdleTicks = ticks[ 3 ];
+	currWaitTicks = ticks[ 4 ];
 	
 	totalTicks = ( currUserTicks - load->userTicks ) +
 		( currSysTicks - load->sysTicks ) +
@@ -118,94 +122,69 @@ static void updateCPULoad( const char* line, CPULoadInfo* load ) {
 }
 
 static void processStat( void ) {
-	char format[ 32 ];
-	char tagFormat[ 16 ];
-	char buf[ 1024 ];
-	char tag[ 32 ];
-	
-	sprintf( format, "%%%d[^\n]\n", (int)sizeof( buf ) - 1 );
-	sprintf( tagFormat, "%%%ds", (int)sizeof( tag ) - 1 );
+	const char* line;
+	const char* p;
 
 	gettimeofday( &currSampling, 0 );
 	StatDirty = 0;
 
-    FILE *stat = fopen("/proc/stat", "r");
-    if(!stat) {
-		print_error( "Cannot open file \'/proc/stat\'!\n"
+	if ( readProcFile( &StatFile ) < 0 ) {
+		print_error( "Cannot read file \'/proc/stat\'!\n"
 				"The kernel needs to be compiled with support\n"
 				"for /proc file system enabled!\n" );
 		return;
-    }
+	}
 
-	while ( fscanf( stat, format, buf ) == 1 ) {
-		buf[ sizeof( buf ) - 1 ] = '\0';
-		sscanf( buf, tagFormat, tag );
-		
-		if ( strcmp( "cpu", tag ) == 0 ) {
+	for ( line = procFileData( &StatFile ); *line; line = nextLine( line ) ) {
+		if ( ( p = matchKey( line, "cpu " ) ) ) {
 			/* Total CPU load */
-			updateCPULoad( buf, &CPULoad );
+			updateCPULoad( p, &CPULoad );
 		}
-		else if ( strncmp( "cpu", tag, 3 ) == 0 ) {
+		else if ( ( p = matchKey( line, "cpu" ) ) ) {
 			/* Load for each SMP CPU */
-			int id;
-			sscanf( tag + 3, "%d", &id );
-			updateCPULoad( buf, &SMPLoad[ id ]  );
+			unsigned long id = parseULL( &p );
+			if ( id < CPUCount )
+				updateCPULoad( p, &SMPLoad[ id ] );
 		}
-		else if ( strcmp( "page", tag ) == 0 ) {
+		else if ( ( p = matchKey( line, "page " ) ) ) {
 			unsigned long v1, v2;
-			sscanf( buf + 5, "%lu %lu", &v1, &v2 );
+			v1 = parseULL( &p );
+			v2 = parseULL( &p );
 			PageIn = v1 - OldPageIn;
 			OldPageIn = v1;
 			PageOut = v2 - OldPageOut;
 			OldPageOut = v2;
 		}
-		else if ( strcmp( "intr", tag ) == 0 ) {
-			unsigned int i = 0;
-			char* p = buf + 5;
+		else if ( ( p = matchKey( line, "intr " ) ) ) {
+			unsigned int i;
 			
 			for ( i = 0; i < NumOfInts; i++ ) {
-				unsigned long val;
-			
-				sscanf( p, "%lu", &val );
+				unsigned long val = parseULL( &p );
 				Intr[ i ] = val - OldIntr[ i ];
 				OldIntr[ i ] = val;
-				while ( *p && *p != ' ' )
-					p++;
-				while ( *p && *p == ' ' )
-					p++;
 			}
-		} else if ( strcmp( "ctxt", tag ) == 0 ) {
-			unsigned long val;
-			
-			sscanf( buf + 5, "%lu", &val );
+		} else if ( ( p = matchKey( line, "ctxt " ) ) ) {
+			unsigned long val = parseULL( &p );
 			Ctxt = val - OldCtxt;
 			OldCtxt = val;
 		}
 	}
-    fclose(stat);
 	
 	/* Read Linux 2.5.x /proc/vmstat */
-    stat = fopen("/proc/vmstat", "r");
-    if(stat) {
-        while ( fscanf( stat, format, buf ) == 1 ) {
-            buf[ sizeof( buf ) - 1 ] = '\0';
-            sscanf( buf, tagFormat, tag );
-
-            if ( strcmp( "pgpgin", tag ) == 0 ) {
-                unsigned long v1;
-                sscanf( buf + 7, "%lu", &v1 );
-                PageIn = v1 - OldPageIn;
-                OldPageIn = v1;
-            }
-            else if ( strcmp( "pgpgout", tag ) == 0 ) {
-                unsigned long v1;
-                sscanf( buf + 7, "%lu", &v1 );
-                PageOut = v1 - OldPageOut;
-                OldPageOut = v1;
-            }
-        }
-        fclose(stat);
-    }
+	if ( readProcFile( &VmStatFile ) >= 0 ) {
+		for ( line = procFileData( &VmStatFile ); *line; line = nextLine( line ) ) {
+			if ( ( p = matchKey( line, "pgpgin " ) ) ) {
+				unsigned long v1 = parseULL( &p );
+				PageIn = v1 - OldPageIn;
+				OldPageIn = v1;
+			}
+			else if ( ( p = matchKey( line, "pgpgout " ) ) ) {
+				unsigned long v1 = parseULL( &p );
+				PageOut = v1 - OldPageOut;
+				OldPageOut = v1;
+			}
+		}
+	}
 	
 	/* save exact time interval between this and the last read of /proc/stat */
 	StatTimeInterval = currSampling.tv_sec - lastSampling.tv_sec +
@@ -249,28 +228,19 @@ void initStat( struct SensorModul* sm ) {
 	* and no disk relevant lines are found in /proc/stat
 	*/
 	
-	char format[ 32 ];
-	char tagFormat[ 16 ];
-	char buf[ 1024 ];
-	char tag[ 32 ];
+	const char* line;
+	const char* p;
 	
 	StatSM = sm;
 	
-	sprintf( format, "%%%d[^\n]\n", (int)sizeof( buf ) - 1 );
-	sprintf( tagFormat, "%%%ds", (int)sizeof( tag ) - 1 );
-
-    FILE *stat = fopen("/proc/stat", "r");
-    if(!stat) {
-		print_error( "Cannot open file \'/proc/stat\'!\n"
+	if ( readProcFile( &StatFile ) < 0 ) {
+		print_error( "Cannot read file \'/proc/stat\'!\n"
 				"The kernel needs to be compiled with support\n"
 				"for /proc file system enabled!\n" );
 		return;
-    }
-	while ( fscanf( stat, format, buf ) == 1 ) {
-		buf[ sizeof( buf ) - 1 ] = '\0';
-		sscanf( buf, tagFormat, tag );
-		
-		if ( strcmp( "cpu", tag ) == 0 ) {
+	}
+	for ( line = procFileData( &StatFile ); *line; line = nextLine( line ) ) {
+		if ( matchKey( line, "cpu " ) ) {
 			/* Total CPU load */
 			registerMonitor( "cpu/system/user", "float", printCPUUser, printCPUUserInfo, StatSM );
 			registerMonitor( "cpu/system/nice", "float", printCPUNice, printCPUNiceInfo, StatSM );
@@ -287,39 +257,39 @@ void initStat( struct SensorModul* sm ) {
 			registerLegacyMonitor( "cpu/idle", "float", printCPUIdle, printCPUIdleInfo, StatSM );
 			registerLegacyMonitor( "cpu/wait", "float", printCPUWait, printCPUWaitInfo, StatSM );
 		}
-		else if ( strncmp( "cpu", tag, 3 ) == 0 ) {
+		else if ( ( p = matchKey( line, "cpu" ) ) ) {
 			char cmdName[ 24 ];
 			/* Load for each SMP CPU */
-			int id;
+			unsigned long id = parseULL( &p );
 			
-			sscanf( tag + 3, "%d", &id );
 			CPUCount++;
-			sprintf( cmdName, "cpu/cpu%d/user", id );
+			sprintf( cmdName, "cpu/cpu%lu/user", id );
 			registerMonitor( cmdName, "float", printCPUxUser, printCPUxUserInfo, StatSM );
-			sprintf( cmdName, "cpu/cpu%d/nice", id );
+			sprintf( cmdName, "cpu/cpu%lu/nice", id );
 			registerMonitor( cmdName, "float", printCPUxNice, printCPUxNiceInfo, StatSM );
-			sprintf( cmdName, "cpu/cpu%d/sys", id );
+			sprintf( cmdName, "cpu/cpu%lu/sys", id );
 			registerMonitor( cmdName, "float", printCPUxSys, printCPUxSysInfo, StatSM );
-			sprintf( cmdName, "cpu/cpu%d/TotalLoad", id );
+			sprintf( cmdName, "cpu/cpu%lu/TotalLoad", id );
 			registerMonitor( cmdName, "float", printCPUxTotalLoad, printCPUxTotalLoadInfo, StatSM );
-			sprintf( cmdName, "cpu/cpu%d/idle", id );
+			sprintf( cmdName, "cpu/cpu%lu/idle", id );
 			registerMonitor( cmdName, "float", printCPUxIdle, printCPUxIdleInfo, StatSM );
-			sprintf( cmdName, "cpu/cpu%d/wait", id );
+			sprintf( cmdName, "cpu/cpu%lu/wait", id );
 			registerMonitor( cmdName, "float", printCPUxWait, printCPUxWaitInfo, StatSM );
 		}
-		else if ( strcmp( "page", tag ) == 0 ) {
-			sscanf( buf + 5, "%lu %lu", &OldPageIn, &OldPageOut );
+		else if ( ( p = matchKey( line, "page " ) ) ) {
+			OldPageIn = parseULL( &p );
+			OldPageOut = parseULL( &p );
 			registerMonitor( "cpu/pageIn", "float", printPageIn, printPageInInfo, StatSM );
 			registerMonitor( "cpu/pageOut", "float", printPageOut, printPageOutInfo, StatSM );
 		}
-		else if ( strcmp( "intr", tag ) == 0 ) {
+		else if ( ( p = matchKey( line, "intr " ) ) ) {
 			unsigned int i;
 			char cmdName[ 32 ];
-			char* p = buf + 5;
+			const char* end = nextLine( p );
 			
 			/* Count the number of listed values in the intr line. */
 			NumOfInts = 0;
-			while ( *p )
+			while ( p < end )
 				if ( *p++ == ' ' )
 					NumOfInts++;
 			
@@ -329,44 +299,33 @@ void initStat( struct SensorModul* sm ) {
 				NumOfInts = 25;
 			OldIntr = (unsigned long*)malloc( NumOfInts * sizeof( unsigned long ) );
 			Intr = (unsigned long*)malloc( NumOfInts * sizeof( unsigned long ) );
-			i = 0;
-			p = buf + 5;
-			for ( i = 0; p && i < NumOfInts; i++ ) {
-				sscanf( p, "%lu", &OldIntr[ i ] );
-				while ( *p && *p != ' ' )
-					p++;
-				while ( *p && *p == ' ' )
-					p++;
+			p = line + 5;
+			for ( i = 0; i < NumOfInts; i++ ) {
+				OldIntr[ i ] = parseULL( &p );
 				sprintf( cmdName, "cpu/interrupts/int%02d", i );
 				registerMonitor( cmdName, "float", printInterruptx, printInterruptxInfo, StatSM );
 			}
 		}
-		else if ( strcmp( "ctxt", tag ) == 0 ) {
-			sscanf( buf + 5, "%lu", &OldCtxt );
+		else if ( ( p = matchKey( line, "ctxt " ) ) ) {
+			OldCtxt = parseULL( &p );
 			registerMonitor( "cpu/context", "float", printCtxt, printCtxtInfo, StatSM );
 		}
 	}
-    fclose(stat);
-
-	stat = fopen("/proc/vmstat", "r");
-    if(!stat) {
-		print_error( "Cannot open file \'/proc/vmstat\'\n");
-    } else {
-        while ( fscanf( stat, format, buf ) == 1 ) {
-            buf[ sizeof( buf ) - 1 ] = '\0';
-            sscanf( buf, tagFormat, tag );
-
-            if ( strcmp( "pgpgin", tag ) == 0 ) {
-                sscanf( buf + 7, "%lu", &OldPageIn );
-                registerMonitor( "cpu/pageIn", "float", printPageIn, printPageInInfo, StatSM );
-            }
-            else if ( strcmp( "pgpgout", tag ) == 0 ) {
-                sscanf( buf + 7, "%lu", &OldPageOut );
-                registerMonitor( "cpu/pageOut", "float", printPageOut, printPageOutInfo, StatSM );
-            }
-        }
-        fclose(stat);
-    }
+
+	if ( readProcFile( &VmStatFile ) < 0 ) {
+		print_error( "Cannot read file \'/proc/vmstat\'\n");
+	} else {
+		for ( line = procFileData( &VmStatFile ); *line; line = nextLine( line ) ) {
+			if ( ( p = matchKey( line, "pgpgin " ) ) ) {
+				OldPageIn = parseULL( &p );
+				registerMonitor( "cpu/pageIn", "float", printPageIn, printPageInInfo, StatSM );
+			}
+			else if ( ( p = matchKey( line, "pgpgout " ) ) ) {
+				OldPageOut = parseULL( &p );
+				registerMonitor( "cpu/pageOut", "float", printPageOut, printPageOutInfo, StatSM );
+			}
+		}
+	}
 	if ( CPUCount > 0 )
 		SMPLoad = (CPULoadInfo*)calloc( CPUCount, sizeof( CPULoadInfo ) );
 	
@@ -384,6 +343,9 @@ void exitStat( void ) {
 	free( Intr );
 	Intr = 0;
 	
+	closeProcFile( &StatFile );
+	closeProcFile( &VmStatFile );
+	
 	removeMonitor("cpu/system/user");
 	removeMonitor("cpu/system/nice");
 	removeMonitor("cpu/system/sys");
@@ -22,71 +22,40 @@
  * This file will read from /proc/uptime.
 */
 
-#include <string.h> /* for strcmp */
-#include <stdlib.h> /* for malloc */
-
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <unistd.h>
-
 #include "Command.h"
 #include "ksysguardd.h"
+#include "procfile.h"
 
 #include "uptime.h"
 
-#define UPTIMEBUFSIZE 64
-
-static char UptimeBuf[ UPTIMEBUFSIZE ];	/* Buffer for /proc/uptime */
+static ProcFile UptimeFile = PROCFILE_INIT( "/proc/uptime" );
 
 static struct SensorModul* StatSM;
 
 void printUptime( const char* cmd );
 void printUptimeInfo( const char* cmd );
-static void openUptimeFile();
 
 void initUptime( struct SensorModul* sm ) {
-	char format[ 32 ];
-	char buf[ 1024 ];
-	char* uptimeBufP;
-
 	StatSM = sm;
 
-	openUptimeFile();
-
-	uptimeBufP = UptimeBuf;
-	sprintf( format, "%%%d[^\n]\n", (int)sizeof( buf ) - 1 );
-
-	/* Process values from /proc/uptime */
-	if (sscanf(uptimeBufP, format, buf) == 1) {
-		buf[sizeof(buf) - 1] = '\0';
+	if ( readProcFile( &UptimeFile ) > 0 )
 		registerMonitor( "system/uptime", "float", printUptime, printUptimeInfo, StatSM );
-	}
 }
 
 void exitUptime( void ) {
-
+	closeProcFile( &UptimeFile );
 }
 
 void printUptime( const char* cmd ) {
 	/* Process values from /proc/uptime */
+	const char* p;
 	(void)cmd;
-	
-	char format[ 32 ];
-	char buf[ 1024 ];
-	char* uptimeBufP = UptimeBuf;
-	float uptime;
-	
-	sprintf( format, "%%%d[^\n]\n", (int)sizeof( buf ) - 1 );
-	
-	openUptimeFile();
-	
-	if (sscanf(uptimeBufP, format, buf) == 1)
-	{
-		buf[sizeof(buf) - 1] = '\0';
-		sscanf( buf, "%f", &uptime );
-		output( "%f\n", uptime );
-	}
+
+	if ( readProcFile( &UptimeFile ) <= 0 )
+		return;
+
+	p = procFileData( &UptimeFile );
+	output( "%f\n", parseDecimal( &p ) );
 }
 
 void printUptimeInfo( const char* cmd ) {
@@ -94,23 +63,3 @@ void printUptimeInfo( const char* cmd ) {
 	
 	output( "System uptime\t0\t0\ts\n" );
 }
-
-static void openUptimeFile() {
-	size_t n;
-	int fd;
-
-	UptimeBuf[ 0 ] = '\0';
-	if ( ( fd = open( "/proc/uptime", O_RDONLY ) ) < 0 )
-		return; /* couldn't open /proc/uptime */
-	
-	n = read( fd, UptimeBuf, UPTIMEBUFSIZE - 1 );
-	close( fd );
-
-	if ( n == UPTIMEBUFSIZE - 1 || n <= 0 ) {
-		log_error( "Internal buffer too small to read \'/proc/uptime\'" );
-
-		return;
-	}
-	
-	UptimeBuf[ n ] = '\0';
-}
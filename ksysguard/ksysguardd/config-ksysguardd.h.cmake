@@ -1 +1,2 @@
 #cmakedefine HAVE_LMSENSORS 1
+#cmakedefine HAVE_SYS_EPOLL_H 1
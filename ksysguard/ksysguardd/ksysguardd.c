@@ -23,6 +23,7 @@
 */
 
 #include <config-workspace.h>
+#include "config-ksysguardd.h"
 #include <ctype.h>
 #include <fcntl.h>
 #include <netdb.h>
@@ -40,24 +41,72 @@
 #include <sys/wait.h>
 #include <unistd.h>
 #include <errno.h>
+#include <poll.h>
+#include <time.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#else
+#include <sys/select.h>
+#endif
 
 #include "modules.h"
 
 #include "ksysguardd.h"
 
-#define CMDBUFSIZE	128
-#define MAX_CLIENTS	100
+/* Maximum length of a command line, "multi" requests can be long */
+#define CMDBUFSIZE	65536
+#define READBUFSIZE	4096
+#define MAX_CLIENTS	1024
+/* Clients that do not read their answers are disconnected */
+#define MAX_PENDING_OUTPUT	( 16 * 1024 * 1024 )
+#define MAX_EVENTS	64
+
+/* Frames of the binary protocol: payload length and tag are 32 bit big endian */
+#define FRAME_HEADER_SIZE	9	/* length, type, tag */
+#define FRAME_QUERY	'Q'
+#define FRAME_SUBSCRIBE	'S'
+#define FRAME_UNSUBSCRIBE	'U'
+#define FRAME_ANSWER	'A'
+#define FRAME_PUSH	'P'
+/* Minimum interval of subscriptions in milliseconds */
+#define MIN_SUBSCRIPTION_INTERVAL	100
+
+typedef struct Subscription {
+  unsigned int tag;
+  long long interval;
+  long long due;
+  char* command;
+  struct Subscription* next;
+} Subscription;
 
 typedef struct {
   int socket;
-  FILE* out;
+  int binary;
+  Subscription* subscriptions;
+  int writeWatched;
+  char* inBuf;
+  size_t inLength;
+  size_t inSize;
+  char* outBuf;
+  size_t outOffset;
+  size_t outLength;
+  size_t outSize;
 } ClientInfo;
 
 static int ServerSocket = 0;
 static ClientInfo ClientList[ MAX_CLIENTS ];
+static ClientInfo StdinClient;
 static int SocketPort = -1;
 static unsigned char BindToAllInterfaces = 0;
-static int CurrentSocket = 0;
+#ifdef HAVE_SYS_EPOLL_H
+static int EpollFd = -1;
+static struct epoll_event Events[ MAX_EVENTS ];
+static int EventCount = 0;
+#else
+static fd_set ReadFds;
+static fd_set WriteFds;
+#endif
+static int StdinReadable = 0;
 static const char LockFile[] = "/var/run/ksysguardd.pid";
 static const char *ConfigFile = KSYSGUARDDRCFILE;
 
@@ -65,7 +114,7 @@ void signalHandler( int sig );
 void makeDaemon( void );
 void resetClientList( void );
 int addClient( int client );
-int delClient( int client );
+int delClient( ClientInfo* client );
 int createServerSocket( void );
 
 /**
@@ -232,41 +281,384 @@ void makeDaemon( void )
   }
 }
 
-static int readCommand( int fd, char* cmdBuf, size_t len )
+static int appendBuffer( char** buf, size_t* length, size_t* size, const char* data, size_t dataLength )
+{
+  if ( *length + dataLength > *size ) {
+    size_t newSize = *size ? *size : 256;
+    char* newBuf;
+
+    while ( newSize < *length + dataLength )
+      newSize *= 2;
+
+    if ( ( newBuf = (char*)realloc( *buf, newSize ) ) == NULL )
+      return -1;
+
+    *buf = newBuf;
+    *size = newSize;
+  }
+
+  memcpy( *buf + *length, data, dataLength );
+  *length += dataLength;
+
+  return 0;
+}
+
+static void setWriteInterest( ClientInfo* client, int enable )
+{
+  if ( client->writeWatched == enable )
+    return;
+
+  client->writeWatched = enable;
+#ifdef HAVE_SYS_EPOLL_H
+  struct epoll_event event;
+  memset( &event, 0, sizeof( event ) );
+  event.events = enable ? ( EPOLLIN | EPOLLOUT ) : EPOLLIN;
+  event.data.ptr = client;
+  if ( epoll_ctl( EpollFd, EPOLL_CTL_MOD, client->socket, &event ) < 0 )
+    log_error( "epoll_ctl()" );
+#endif
+}
+
+/**
+  Sends as much of the pending output of a client as the socket accepts
+  without blocking.
+ */
+static int flushClient( ClientInfo* client )
+{
+  while ( client->outOffset < client->outLength ) {
+    ssize_t count = write( client->socket, client->outBuf + client->outOffset,
+                           client->outLength - client->outOffset );
+    if ( count < 0 ) {
+      if ( errno == EINTR )
+        continue;
+      if ( errno == EAGAIN || errno == EWOULDBLOCK ) {
+        setWriteInterest( client, 1 );
+        return 0;
+      }
+      return -1;
+    }
+
+    client->outOffset += count;
+  }
+
+  client->outOffset = 0;
+  client->outLength = 0;
+  setWriteInterest( client, 0 );
+
+  return 0;
+}
+
+static int sendToClient( ClientInfo* client, const char* data, size_t length )
+{
+  if ( !RunAsDaemon ) {
+    if ( fwrite( data, 1, length, stdout ) != length || fflush( stdout ) != 0 )
+      return -1;
+    return 0;
+  }
+
+  if ( client->outOffset > 0 ) {
+    memmove( client->outBuf, client->outBuf + client->outOffset, client->outLength - client->outOffset );
+    client->outLength -= client->outOffset;
+    client->outOffset = 0;
+  }
+
+  if ( client->outLength + length > MAX_PENDING_OUTPUT ) {
+    log_error( "Client does not read its data, disconnecting it" );
+    return -1;
+  }
+
+  if ( appendBuffer( &client->outBuf, &client->outLength, &client->outSize, data, length ) < 0 ) {
+    log_error( "Out of memory" );
+    return -1;
+  }
+
+  /* Without pending output the data can usually be written right away */
+  return client->writeWatched ? 0 : flushClient( client );
+}
+
+static long long monotonicTime( void )
+{
+  struct timespec now;
+  clock_gettime( CLOCK_MONOTONIC, &now );
+  return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static unsigned int decodeUInt32( const char* data )
+{
+  const unsigned char* p = (const unsigned char*)data;
+  return ( (unsigned int)p[ 0 ] << 24 ) | ( (unsigned int)p[ 1 ] << 16 ) |
+         ( (unsigned int)p[ 2 ] << 8 ) | (unsigned int)p[ 3 ];
+}
+
+static void encodeUInt32( char* data, unsigned int value )
+{
+  data[ 0 ] = (char)( value >> 24 );
+  data[ 1 ] = (char)( value >> 16 );
+  data[ 2 ] = (char)( value >> 8 );
+  data[ 3 ] = (char)value;
+}
+
+/**
+  Runs the command and sends its output as a single frame of the
+  binary protocol.
+ */
+static int sendCommandFrame( ClientInfo* client, char type, unsigned int tag, const char* cmd )
+{
+  static const char header[ FRAME_HEADER_SIZE ] = { 0 };
+  FILE* previousClient = CurrentClient;
+  char* frame = NULL;
+  size_t length = 0;
+  int result;
+
+  if ( ( CurrentClient = open_memstream( &frame, &length ) ) == NULL ) {
+    log_error( "open_memstream()" );
+    CurrentClient = previousClient;
+    return -1;
+  }
+
+  /* The header is filled in once the length of the answer is known */
+  fwrite( header, 1, sizeof( header ), CurrentClient );
+  executeCommand( cmd );
+  fclose( CurrentClient );
+  CurrentClient = previousClient;
+
+  encodeUInt32( frame, length - FRAME_HEADER_SIZE );
+  frame[ 4 ] = type;
+  encodeUInt32( frame + 5, tag );
+
+  result = sendToClient( client, frame, length );
+  free( frame );
+
+  return result;
+}
+
+static void freeSubscription( Subscription* subscription )
+{
+  free( subscription->command );
+  free( subscription );
+}
+
+static void unsubscribe( ClientInfo* client, unsigned int tag )
+{
+  Subscription** subscription = &client->subscriptions;
+
+  while ( *subscription ) {
+    if ( (*subscription)->tag == tag ) {
+      Subscription* next = (*subscription)->next;
+      freeSubscription( *subscription );
+      *subscription = next;
+    } else {
+      subscription = &(*subscription)->next;
+    }
+  }
+}
+
+/**
+  Registers a command that is executed periodically for the client. The
+  payload is the interval in milliseconds and the command separated by a
+  tab. The first answer is pushed right away.
+ */
+static int subscribe( ClientInfo* client, unsigned int tag, const char* payload )
+{
+  Subscription* subscription;
+  const char* cmd = strchr( payload, '\t' );
+  long long interval = atoll( payload );
+
+  if ( !cmd ) {
+    log_error( "Invalid subscription" );
+    return -1;
+  }
+
+  unsubscribe( client, tag );
+
+  if ( ( subscription = (Subscription*)malloc( sizeof( Subscription ) ) ) == NULL ||
+       ( subscription->command = strdup( cmd + 1 ) ) == NULL ) {
+    log_error( "Out of memory" );
+    free( subscription );
+    return -1;
+  }
+
+  subscription->tag = tag;
+  subscription->interval = interval < MIN_SUBSCRIPTION_INTERVAL ? MIN_SUBSCRIPTION_INTERVAL : interval;
+  subscription->due = monotonicTime() + subscription->interval;
+  subscription->next = client->subscriptions;
+  client->subscriptions = subscription;
+
+  return sendCommandFrame( client, FRAME_PUSH, tag, subscription->command );
+}
+
+static int executeFrame( ClientInfo* client, char type, unsigned int tag, const char* data, size_t length )
+{
+  char* payload;
+  int result = 0;
+
+  if ( ( payload = (char*)malloc( length + 1 ) ) == NULL ) {
+    log_error( "Out of memory" );
+    return -1;
+  }
+  memcpy( payload, data, length );
+  payload[ length ] = '\0';
+
+  switch ( type ) {
+    case FRAME_QUERY:
+      if ( RunAsDaemon && strncmp( payload, "quit", 4 ) == 0 )
+        result = -1;
+      else
+        result = sendCommandFrame( client, FRAME_ANSWER, tag, payload );
+      break;
+    case FRAME_SUBSCRIBE:
+      result = subscribe( client, tag, payload );
+      break;
+    case FRAME_UNSUBSCRIBE:
+      unsubscribe( client, tag );
+      break;
+    default:
+      log_error( "Unknown frame type %d", type );
+      result = -1;
+  }
+
+  free( payload );
+  return result;
+}
+
+/**
+  Runs the command for the client. In daemon mode the answer is collected
+  in memory and written to the socket without blocking, so a slow client
+  does not stall the others.
+ */
+static int executeClientCommand( ClientInfo* client, const char* cmd )
+{
+  char* answer = NULL;
+  size_t length = 0;
+  int result;
+
+  /* The client asks to switch to the binary protocol after this answer */
+  if ( strcmp( cmd, "binary" ) == 0 ) {
+    static const char ok[] = "OK\nksysguardd> ";
+    client->binary = 1;
+    return sendToClient( client, ok, sizeof( ok ) - 1 );
+  }
+
+  if ( !RunAsDaemon ) {
+    executeCommand( cmd );
+    printf( "ksysguardd> " );
+    fflush( stdout );
+    return 0;
+  }
+
+  if ( strncmp( cmd, "quit", 4 ) == 0 )
+    return -1;
+
+  if ( ( CurrentClient = open_memstream( &answer, &length ) ) == NULL ) {
+    log_error( "open_memstream()" );
+    return -1;
+  }
+
+  executeCommand( cmd );
+  output( "ksysguardd> " );
+  fclose( CurrentClient );
+  CurrentClient = 0;
+
+  result = sendToClient( client, answer, length );
+  free( answer );
+
+  return result;
+}
+
+/**
+  Reads the available data of a client and executes all complete
+  command lines or frames.
+ */
+static int readClientCommands( ClientInfo* client )
 {
-  unsigned int i;
-  char c;
-  for ( i = 0; i < len; ++i )
-  {
-    int result = read( fd, &c, 1 );
-    if (result < 0)
-      return -1; /* Error */
+  char buf[ READBUFSIZE ];
+  size_t start = 0;
+  ssize_t count;
 
-    if (result == 0) {
-      if (i == 0)
-        return -1; /* Connection lost */
+  if ( ( count = read( client->socket, buf, sizeof( buf ) ) ) < 0 ) {
+    if ( errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK )
+      return 0;
+    return -1; /* Error */
+  }
+
+  if ( count == 0 )
+    return -1; /* Connection lost */
+
+  if ( appendBuffer( &client->inBuf, &client->inLength, &client->inSize, buf, count ) < 0 ) {
+    log_error( "Out of memory" );
+    return -1;
+  }
+
+  /* The protocol may change within the data read at once */
+  for ( ;; ) {
+    if ( client->binary ) {
+      const char* frame = client->inBuf + start;
+      size_t length;
+
+      if ( client->inLength - start < FRAME_HEADER_SIZE )
+        break;
 
-      break; /* End of data */
+      if ( ( length = decodeUInt32( frame ) ) > CMDBUFSIZE ) {
+        log_error( "Command too long" );
+        return -1;
+      }
+
+      if ( client->inLength - start < FRAME_HEADER_SIZE + length )
+        break;
+
+      start += FRAME_HEADER_SIZE + length;
+      if ( executeFrame( client, frame[ 4 ], decodeUInt32( frame + 5 ), frame + FRAME_HEADER_SIZE, length ) < 0 )
+        return -1;
+    } else {
+      char* newline = memchr( client->inBuf + start, '\n', client->inLength - start );
+      const char* line = client->inBuf + start;
+
+      if ( !newline )
+        break;
+
+      *newline = '\0';
+      start = newline - client->inBuf + 1;
+
+      if ( executeClientCommand( client, line ) < 0 )
+        return -1;
     }
+  }
 
-    if (c == '\n')
-      break; /* End of line */
+  client->inLength -= start;
+  memmove( client->inBuf, client->inBuf + start, client->inLength );
 
-    cmdBuf[ i ] = c;
+  if ( !client->binary && client->inLength >= CMDBUFSIZE ) {
+    log_error( "Command too long" );
+    return -1;
   }
-  cmdBuf[i] = '\0';
 
-  return i;
+  return 0;
+}
+
+static void initClient( ClientInfo* client, int socket )
+{
+  memset( client, 0, sizeof( ClientInfo ) );
+  client->socket = socket;
+}
+
+static void freeClientBuffers( ClientInfo* client )
+{
+  while ( client->subscriptions ) {
+    Subscription* next = client->subscriptions->next;
+    freeSubscription( client->subscriptions );
+    client->subscriptions = next;
+  }
+  free( client->inBuf );
+  free( client->outBuf );
+  initClient( client, -1 );
 }
 
 void resetClientList( void )
 {
   int i;
 
-  for ( i = 0; i < MAX_CLIENTS; i++ ) {
-    ClientList[ i ].socket = -1;
-    ClientList[ i ].out = 0;
-  }
+  for ( i = 0; i < MAX_CLIENTS; i++ )
+    initClient( &ClientList[ i ], -1 );
 }
 
 /**
@@ -275,47 +667,79 @@ void resetClientList( void )
 int addClient( int client )
 {
   int i;
+  char* welcome = NULL;
+  size_t length = 0;
   FILE* out;
 
+#ifndef HAVE_SYS_EPOLL_H
+  if ( client >= FD_SETSIZE ) {
+    log_error( "Too many clients" );
+    close( client );
+    return -1;
+  }
+#endif
+
   for ( i = 0; i < MAX_CLIENTS; i++ ) {
     if ( ClientList[ i ].socket == -1 ) {
-      ClientList[ i ].socket = client;
-      if ( ( out = fdopen( client, "w+" ) ) == NULL ) {
-        log_error( "fdopen()" );
+      ClientInfo* info = &ClientList[ i ];
+      initClient( info, client );
+
+      /* We use non-blocking IO */
+      fcntl( client, F_SETFL, fcntl( client, F_GETFL ) | O_NONBLOCK );
+
+#ifdef HAVE_SYS_EPOLL_H
+      struct epoll_event event;
+      memset( &event, 0, sizeof( event ) );
+      event.events = EPOLLIN;
+      event.data.ptr = info;
+      if ( epoll_ctl( EpollFd, EPOLL_CTL_ADD, client, &event ) < 0 ) {
+        log_error( "epoll_ctl()" );
+        close( client );
+        info->socket = -1;
+        return -1;
+      }
+#endif
+
+      if ( ( out = open_memstream( &welcome, &length ) ) == NULL ) {
+        log_error( "open_memstream()" );
+        delClient( info );
         return -1;
       }
-      /* We use unbuffered IO */
-      fcntl( fileno( out ), F_SETFL, O_NDELAY );
-      ClientList[ i ].out = out;
       printWelcome( out );
       fprintf( out, "ksysguardd> " );
-      fflush( out );
+      fclose( out );
+
+      if ( sendToClient( info, welcome, length ) < 0 ) {
+        free( welcome );
+        delClient( info );
+        return -1;
+      }
+      free( welcome );
 
       return 0;
     }
   }
 
+  log_error( "Too many clients" );
+  close( client );
   return -1;
 }
 
 /**
   delClient removes a client from the ClientList.
  */
-int delClient( int client )
+int delClient( ClientInfo* client )
 {
-  int i;
+  if ( client->socket == -1 )
+    return -1;
 
-  for ( i = 0; i < MAX_CLIENTS; i++ ) {
-    if ( ClientList[i].socket == client ) {
-      fclose( ClientList[ i ].out );
-      ClientList[ i ].out = 0;
-      close( ClientList[ i ].socket );
-      ClientList[ i ].socket = -1;
-      return 0;
-    }
-  }
+#ifdef HAVE_SYS_EPOLL_H
+  epoll_ctl( EpollFd, EPOLL_CTL_DEL, client->socket, NULL );
+#endif
+  close( client->socket );
+  freeClientBuffers( client );
 
-  return -1;
+  return 0;
 }
 
 int createServerSocket()
@@ -360,40 +784,124 @@ int createServerSocket()
     return -1;
   }
 
-  if ( listen( newSocket, 5 ) < 0 ) {
+  if ( listen( newSocket, SOMAXCONN ) < 0 ) {
     log_error( "listen()" );
     return -1;
   }
 
+  fcntl( newSocket, F_SETFL, fcntl( newSocket, F_GETFL ) | O_NONBLOCK );
+
+#ifdef HAVE_SYS_EPOLL_H
+  struct epoll_event event;
+  memset( &event, 0, sizeof( event ) );
+  event.events = EPOLLIN;
+  event.data.ptr = NULL; /* Identifies the server socket */
+  if ( ( EpollFd = epoll_create1( EPOLL_CLOEXEC ) ) < 0 ||
+       epoll_ctl( EpollFd, EPOLL_CTL_ADD, newSocket, &event ) < 0 ) {
+    log_error( "epoll()" );
+    return -1;
+  }
+#endif
+
   return newSocket;
 }
 
-static int setupSelect( fd_set* fds )
+/**
+  Waits until the server socket or a client socket is ready, or until
+  @p timeout milliseconds have passed. A negative timeout waits forever.
+ */
+static int waitForEvents( int timeout )
 {
+  if ( !RunAsDaemon ) {
+    struct pollfd fd;
+    int ret;
+
+    fd.fd = STDIN_FILENO;
+    fd.events = POLLIN;
+    fd.revents = 0;
+    ret = poll( &fd, 1, timeout );
+    StdinReadable = ( ret > 0 );
+
+    return ret;
+  }
+
+#ifdef HAVE_SYS_EPOLL_H
+  EventCount = epoll_wait( EpollFd, Events, MAX_EVENTS, timeout );
+  return EventCount;
+#else
+  struct timeval tv;
+  int i;
   int highestFD = ServerSocket;
-  FD_ZERO( fds );
-  /**
-    Fill the filedescriptor array with all relevant descriptors. If we
-    not in daemon mode we only need to watch stdin.
-   */
-  if ( RunAsDaemon ) {
-    int i;
-    FD_SET( ServerSocket, fds );
 
-    for ( i = 0; i < MAX_CLIENTS; i++ ) {
-      if ( ClientList[ i ].socket != -1 ) {
-        FD_SET( ClientList[ i ].socket, fds );
-        if ( highestFD < ClientList[ i ].socket )
-          highestFD = ClientList[ i ].socket;
+  FD_ZERO( &ReadFds );
+  FD_ZERO( &WriteFds );
+  FD_SET( ServerSocket, &ReadFds );
+
+  for ( i = 0; i < MAX_CLIENTS; i++ ) {
+    if ( ClientList[ i ].socket != -1 ) {
+      FD_SET( ClientList[ i ].socket, &ReadFds );
+      if ( ClientList[ i ].writeWatched )
+        FD_SET( ClientList[ i ].socket, &WriteFds );
+      if ( highestFD < ClientList[ i ].socket )
+        highestFD = ClientList[ i ].socket;
+    }
+  }
+
+  tv.tv_sec = timeout / 1000;
+  tv.tv_usec = ( timeout % 1000 ) * 1000;
+
+  return select( highestFD + 1, &ReadFds, &WriteFds, NULL, timeout < 0 ? NULL : &tv );
+#endif
+}
+
+static ClientInfo* clientAt( int index )
+{
+  if ( !RunAsDaemon )
+    return ( index == 0 && StdinClient.socket != -1 ) ? &StdinClient : NULL;
+
+  return ClientList[ index ].socket != -1 ? &ClientList[ index ] : NULL;
+}
+
+/**
+  Pushes the answers of all subscriptions that are due.
+  @return the time in milliseconds until the next subscription is due or
+  -1 if there are no subscriptions.
+ */
+static int runSubscriptions( void )
+{
+  long long now = monotonicTime();
+  long long next = -1;
+  int i;
+
+  for ( i = 0; i < MAX_CLIENTS; i++ ) {
+    ClientInfo* client = clientAt( i );
+    Subscription* subscription;
+
+    if ( !client )
+      continue;
+
+    for ( subscription = client->subscriptions; subscription; subscription = subscription->next ) {
+      if ( subscription->due <= now ) {
+        if ( sendCommandFrame( client, FRAME_PUSH, subscription->tag, subscription->command ) < 0 ) {
+          if ( RunAsDaemon )
+            delClient( client );
+          else
+            QuitApp = 1;
+          break;
+        }
+
+        /* Skip missed intervals instead of pushing them all at once */
+        subscription->due += subscription->interval;
+        if ( subscription->due <= now )
+          subscription->due = now + subscription->interval;
       }
+
+      if ( next < 0 || subscription->due - now < next )
+        next = subscription->due - now;
     }
-  } else {
-    FD_SET( STDIN_FILENO, fds );
-    if ( highestFD < STDIN_FILENO )
-      highestFD = STDIN_FILENO;
   }
 
-  return highestFD;
+  return (int)next;
 }
 
 static void checkModules()
@@ -405,55 +913,68 @@ static void checkModules()
       entry->checkCommand();
 }
 
-static void handleSocketTraffic( int socketNo, const fd_set* fds )
+static void acceptClients( void )
+{
+  int clientsocket;
+  struct sockaddr addr;
+  socklen_t addr_len = sizeof( struct sockaddr );
+
+  /* new connections */
+  while ( ( clientsocket = accept( ServerSocket, &addr, &addr_len ) ) >= 0 ) {
+    addClient( clientsocket );
+    addr_len = sizeof( struct sockaddr );
+  }
+
+  if ( errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR )
+    log_error( "accept()" );
+}
+
+static void handleClientEvent( ClientInfo* client, int readable, int writable )
+{
+  if ( writable && flushClient( client ) < 0 ) {
+    delClient( client );
+    return;
+  }
+
+  if ( readable && readClientCommands( client ) < 0 )
+    delClient( client );
+}
+
+static void handleSocketTraffic( void )
 {
-  char cmdBuf[ CMDBUFSIZE ];
+  int acceptPending = 0;
 
   if ( RunAsDaemon ) {
+#ifdef HAVE_SYS_EPOLL_H
     int i;
 
-    if ( FD_ISSET( socketNo, fds ) ) {
-      int clientsocket;
-      struct sockaddr addr;
-      socklen_t addr_len = sizeof( struct sockaddr );
-
-      /* a new connection */
-      if ( ( clientsocket = accept( socketNo, &addr, &addr_len ) ) < 0 ) {
-        log_error( "accept()" );
-        exit( 1 );
-      } else
-        addClient( clientsocket );
+    for ( i = 0; i < EventCount; i++ ) {
+      ClientInfo* client = (ClientInfo*)Events[ i ].data.ptr;
+      if ( client == NULL ) {
+        acceptPending = 1;
+      } else if ( client->socket != -1 ) {
+        handleClientEvent( client, Events[ i ].events & ( EPOLLIN | EPOLLHUP | EPOLLERR ),
+                           Events[ i ].events & EPOLLOUT );
+      }
     }
+#else
+    int i;
 
+    acceptPending = FD_ISSET( ServerSocket, &ReadFds );
     for ( i = 0; i < MAX_CLIENTS; i++ ) {
-      if ( ClientList[ i ].socket != -1 ) {
-        CurrentSocket = ClientList[ i ].socket;
-        if ( FD_ISSET( ClientList[ i ].socket, fds ) ) {
-          ssize_t cnt;
-          if ( ( cnt = readCommand( CurrentSocket, cmdBuf, sizeof( cmdBuf ) - 1 ) ) <= 0 )
-            delClient( CurrentSocket );
-          else {
-            cmdBuf[ cnt ] = '\0';
-            if ( strncmp( cmdBuf, "quit", 4 ) == 0 )
-              delClient( CurrentSocket );
-            else {
-              CurrentClient = ClientList[ i ].out;
-              fflush( stdout );
-              executeCommand( cmdBuf );
-              output( "ksysguardd> " );
-              fflush( CurrentClient );
-            }
-          }
-        }
-      }
-    }
-  } else if ( FD_ISSET( STDIN_FILENO, fds ) ) {
-    if (readCommand( STDIN_FILENO, cmdBuf, sizeof( cmdBuf ) ) < 0) {
-      exit(0);
+      int socket = ClientList[ i ].socket;
+      if ( socket != -1 )
+        handleClientEvent( &ClientList[ i ], FD_ISSET( socket, &ReadFds ), FD_ISSET( socket, &WriteFds ) );
     }
-    executeCommand( cmdBuf );
-    printf( "ksysguardd> " );
-    fflush( stdout );
+#endif
+
+    /* Accept last, so events of a removed client are never applied to a
+       new client in the same slot */
+    if ( acceptPending )
+      acceptClients();
+  } else if ( StdinReadable ) {
+    if ( readClientCommands( &StdinClient ) < 0 )
+      exit( 0 );
   }
 }
 
@@ -539,8 +1060,6 @@ char* escapeString( char* string ) {
 
 int main( int argc, char* argv[] )
 {
-  fd_set fds;
-
   printWelcome( stdout );
 
   if ( processArguments( argc, argv ) < 0 )
@@ -557,6 +1076,9 @@ int main( int argc, char* argv[] )
   if ( RunAsDaemon ) {
     makeDaemon();
 
+    /* Write errors of disconnected clients are handled where they occur */
+    signal(SIGPIPE, SIG_IGN);
+
     if ( ( ServerSocket = createServerSocket() ) < 0 )
       return -1;
     resetClientList();
@@ -565,6 +1087,7 @@ int main( int argc, char* argv[] )
     fflush( stdout );
     CurrentClient = stdout;
     ServerSocket = 0;
+    initClient( &StdinClient, STDIN_FILENO );
   }
 
   struct timeval now;
@@ -572,9 +1095,8 @@ int main( int argc, char* argv[] )
   gettimeofday( &last, NULL );
 
   while ( !QuitApp ) {
-    int highestFD = setupSelect( &fds );
     /* wait for communication or timeouts */
-    int ret = select( highestFD + 1, &fds, NULL, NULL, NULL );
+    int ret = waitForEvents( runSubscriptions() );
     if(ret >= 0) {
         gettimeofday( &now, NULL );
         if ( now.tv_sec - last.tv_sec >= 5 ) { /* 5 second intervals */
@@ -582,7 +1104,7 @@ int main( int argc, char* argv[] )
             checkModules();
             last = now;
         }
-        handleSocketTraffic( ServerSocket, &fds );
+        handleSocketTraffic();
     }
   }
 
@@ -0,0 +1,155 @@
+/*
+    KSysGuard, the KDE System Guard
+
+    Copyright (c) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of version 2 of the GNU General Public
+    License as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+/*
+  Compares the ways the Linux backend of ksysguardd can read the files
+  in /proc it polls on every update:
+
+    stdio    - fopen(), fgets() and sscanf() on every line
+    reopen   - open(), read() and close() with the hand-written parsers
+    procfile - a ProcFile kept open, reread with pread()
+
+  Usage: procfilebenchmark [iterations]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "procfile.h"
+
+#define VALUES 5
+
+static const char* const Files[] = {
+  "/proc/stat",
+  "/proc/vmstat",
+  "/proc/meminfo",
+  "/proc/loadavg",
+  "/proc/net/dev",
+  "/proc/diskstats",
+  0
+};
+
+static unsigned long long Sum = 0;
+
+static double now( void )
+{
+  struct timespec ts;
+
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int readStdio( const char* name )
+{
+  char buf[ 1024 ];
+  char tag[ 64 ];
+  unsigned long long v[ VALUES ];
+  FILE* file;
+
+  if ( ( file = fopen( name, "r" ) ) == NULL )
+    return -1;
+
+  while ( fgets( buf, sizeof( buf ), file ) != NULL ) {
+    if ( sscanf( buf, "%63s %llu %llu %llu %llu %llu", tag, &v[ 0 ], &v[ 1 ],
+                 &v[ 2 ], &v[ 3 ], &v[ 4 ] ) > 1 )
+      Sum += v[ 0 ];
+  }
+  fclose( file );
+
+  return 0;
+}
+
+static void parse( const char* data )
+{
+  unsigned long long v[ VALUES ];
+  const char* line;
+
+  for ( line = data; *line; line = nextLine( line ) ) {
+    if ( parseULLs( skipField( line ), v, VALUES ) > 0 )
+      Sum += v[ 0 ];
+  }
+}
+
+static int readReopen( const char* name )
+{
+  static char buf[ 64 * 1024 ];
+
+  if ( readProcFileOnce( name, buf, sizeof( buf ) ) < 0 )
+    return -1;
+  parse( buf );
+
+  return 0;
+}
+
+static int readProcFileKept( ProcFile* file )
+{
+  if ( readProcFile( file ) < 0 )
+    return -1;
+  parse( procFileData( file ) );
+
+  return 0;
+}
+
+int main( int argc, char* argv[] )
+{
+  int iterations = 10000;
+  int i, j;
+
+  if ( argc > 1 )
+    iterations = atoi( argv[ 1 ] );
+  if ( iterations <= 0 ) {
+    fprintf( stderr, "Usage: %s [iterations]\n", argv[ 0 ] );
+    return 1;
+  }
+
+  printf( "%-18s %12s %12s %12s\n", "file", "stdio ns", "reopen ns", "procfile ns" );
+
+  for ( i = 0; Files[ i ]; ++i ) {
+    ProcFile file = PROCFILE_INIT( Files[ i ] );
+    double start, stdio, reopen, kept;
+
+    if ( readStdio( Files[ i ] ) < 0 ) {
+      printf( "%-18s not available\n", Files[ i ] );
+      continue;
+    }
+
+    start = now();
+    for ( j = 0; j < iterations; ++j )
+      readStdio( Files[ i ] );
+    stdio = ( now() - start ) / iterations;
+
+    start = now();
+    for ( j = 0; j < iterations; ++j )
+      readReopen( Files[ i ] );
+    reopen = ( now() - start ) / iterations;
+
+    start = now();
+    for ( j = 0; j < iterations; ++j )
+      readProcFileKept( &file );
+    kept = ( now() - start ) / iterations;
+    closeProcFile( &file );
+
+    printf( "%-18s %12.0f %12.0f %12.0f\n", Files[ i ], stdio, reopen, kept );
+  }
+
+  /* Keep the parsing from being optimized away */
+  return Sum == 42 ? 2 : 0;
+}
@@ -344,7 +344,7 @@ void Client::updateInputWindow()
     }
 
     if (region.isEmpty()) {
-        m_decoInputExtent.reset();
+        resetInputWindow();
         return;
     }
 
@@ -369,6 +369,7 @@ void Client::updateInputWindow()
         m_decoInputExtent.create(bounds, XCB_WINDOW_CLASS_INPUT_ONLY, mask, values);
         if (mapping_state == Mapped)
             m_decoInputExtent.map();
+        workspace()->clientInputWindowChanged(this, XCB_WINDOW_NONE);
     } else {
         m_decoInputExtent.setGeometry(bounds);
     }
@@ -454,7 +455,16 @@ void Client::destroyDecoration()
             emit geometryShapeChanged(this, oldgeom);
         }
     }
+    resetInputWindow();
+}
+
+void Client::resetInputWindow()
+{
+    if (!m_decoInputExtent.isValid())
+        return;
+    const xcb_window_t oldInputWindow = m_decoInputExtent;
     m_decoInputExtent.reset();
+    workspace()->clientInputWindowChanged(this, oldInputWindow);
 }
 
 bool Client::checkBorderSizes(bool also_resize)
@@ -1781,27 +1791,69 @@ void Client::setClientShown(bool shown)
 
 void Client::getWMHints()
 {
-    XWMHints* hints = XGetWMHints(display(), window());
+    Xcb::Property property = fetchWMHints();
+    readWMHints(property);
+}
+
+// the layout of the WM_HINTS property, see ICCCM 4.1.2.4
+enum {
+    WMHintsFlags = 0,
+    WMHintsInput = 1,
+    WMHintsInitialState = 2,
+    WMHintsWindowGroup = 8,
+    WMHintsElements = 9
+};
+
+Xcb::Property Client::fetchWMHints() const
+{
+    return Xcb::Property(window(), XCB_ATOM_WM_HINTS, XCB_ATOM_WM_HINTS, WMHintsElements);
+}
+
+void Client::readWMHints(Xcb::Property &property)
+{
+    uint32_t count = 0;
+    const uint32_t *hints = property.value<uint32_t>(32, &count);
     input = true;
     m_windowGroup = XCB_WINDOW_NONE;
     urgency = false;
-    if (hints) {
-        if (hints->flags & InputHint)
-            input = hints->input;
-        if (hints->flags & WindowGroupHint)
-            m_windowGroup = hints->window_group;
-        urgency = !!(hints->flags & UrgencyHint);   // Need boolean, it's a uint bitfield
-        XFree((char*)hints);
+    // like Xlib accept the hints of pre-ICCCM clients, which do not have the window group
+    if (hints && count >= WMHintsElements - 1) {
+        const uint32_t flags = hints[WMHintsFlags];
+        if (flags & InputHint)
+            input = hints[WMHintsInput] != 0;
+        if ((flags & WindowGroupHint) && count >= WMHintsElements)
+            m_windowGroup = hints[WMHintsWindowGroup];
+        urgency = !!(flags & UrgencyHint);   // Need boolean, it's a uint bitfield
     }
     checkGroup();
     updateUrgency();
     updateAllowedActions(); // Group affects isMinimizable()
 }
 
+// Whether the client asks to be mapped minimized, accepts the same hints as readWMHints()
+bool Client::readWMHintsIconic(Xcb::Property &property)
+{
+    uint32_t count = 0;
+    const uint32_t *hints = property.value<uint32_t>(32, &count);
+    return hints && count >= WMHintsElements - 1 && (hints[WMHintsFlags] & StateHint)
+        && hints[WMHintsInitialState] == IconicState;
+}
+
 void Client::getMotifHints()
+{
+    Xcb::Property property = fetchMotifHints();
+    readMotifHints(property);
+}
+
+Xcb::Property Client::fetchMotifHints() const
+{
+    return Xcb::Property(m_client, atoms->motif_wm_hints, atoms->motif_wm_hints, 5);
+}
+
+void Client::readMotifHints(Xcb::Property &property)
 {
     bool mgot_noborder, mnoborder, mresize, mmove, mminimize, mmaximize, mclose;
-    Motif::readFlags(m_client, mgot_noborder, mnoborder, mresize, mmove, mminimize, mmaximize, mclose);
+    Motif::readFlags(property, mgot_noborder, mnoborder, mresize, mmove, mminimize, mmaximize, mclose);
     if (mgot_noborder && motif_noborder != mnoborder) {
         motif_noborder = mnoborder;
         // If we just got a hint telling us to hide decorations, we do so.
@@ -1902,17 +1954,27 @@ QPixmap Client::icon(const QSize& size) const
 
 void Client::getWindowProtocols()
 {
-    Atom* p;
-    int i, n;
+    Xcb::Property property = fetchWindowProtocols();
+    readWindowProtocols(property);
+}
 
+Xcb::Property Client::fetchWindowProtocols() const
+{
+    return Xcb::Property(window(), atoms->wm_protocols, XCB_ATOM_ATOM, 1024);
+}
+
+void Client::readWindowProtocols(Xcb::Property &property)
+{
     Pdeletewindow = 0;
     Ptakefocus = 0;
     Ptakeactivity = 0;
     Pcontexthelp = 0;
     Pping = 0;
 
-    if (XGetWMProtocols(display(), window(), &p, &n)) {
-        for (i = 0; i < n; ++i) {
+    uint32_t n = 0;
+    const xcb_atom_t *p = property.value<xcb_atom_t>(32, &n);
+    if (p) {
+        for (uint32_t i = 0; i < n; ++i) {
             if (p[i] == atoms->wm_delete_window)
                 Pdeletewindow = 1;
             else if (p[i] == atoms->wm_take_focus)
@@ -1924,27 +1986,34 @@ void Client::getWindowProtocols()
             else if (p[i] == atoms->net_wm_ping)
                 Pping = 1;
         }
-        if (n > 0)
-            XFree(p);
     }
 }
 
 void Client::getSyncCounter()
+{
+    Xcb::Property property = fetchSyncCounter();
+    readSyncCounter(property);
+}
+
+Xcb::Property Client::fetchSyncCounter() const
+{
+#ifdef HAVE_XSYNC
+    if (Xcb::Extensions::self()->isSyncAvailable())
+        return Xcb::Property(window(), atoms->net_wm_sync_request_counter, XCB_ATOM_CARDINAL, 1);
+#endif
+    return Xcb::Property();
+}
+
+void Client::readSyncCounter(Xcb::Property &property)
 {
 #ifdef HAVE_XSYNC
     if (!Xcb::Extensions::self()->isSyncAvailable())
         return;
 
-    Atom retType;
-    unsigned long nItemRet;
-    unsigned long byteRet;
-    int formatRet;
-    unsigned char* propRet;
-    int ret = XGetWindowProperty(display(), window(), atoms->net_wm_sync_request_counter,
-                                 0, 1, false, XA_CARDINAL, &retType, &formatRet, &nItemRet, &byteRet, &propRet);
-
-    if (ret == Success && formatRet == 32) {
-        syncRequest.counter = *(long*)(propRet);
+    uint32_t count = 0;
+    const uint32_t *counter = property.value<uint32_t>(32, &count);
+    if (counter) {
+        syncRequest.counter = *counter;
         XSyncIntToValue(&syncRequest.value, 0);
         XSyncValue zero;
         XSyncIntToValue(&zero, 0);
@@ -1961,9 +2030,8 @@ void Client::getSyncCounter()
                                           &attrs);
         }
     }
-
-    if (ret == Success)
-        XFree(propRet);
+#else
+    Q_UNUSED(property)
 #endif
 }
 
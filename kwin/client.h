@@ -723,6 +723,8 @@ private:
     void updateFullScreen();
     void getWmNormalHints();
     void getMotifHints();
+    Xcb::Property fetchMotifHints() const;
+    void readMotifHints(Xcb::Property &property);
     void getIcons();
     void fetchName();
     void fetchIconicName();
@@ -737,6 +739,8 @@ private:
     int checkShadeGeometry(int w, int h);
     void blockGeometryUpdates(bool block);
     void getSyncCounter();
+    Xcb::Property fetchSyncCounter() const;
+    void readSyncCounter(Xcb::Property &property);
     void sendSyncRequest();
     bool startMoveResize();
     void finishMoveResize(bool cancel);
@@ -778,6 +782,7 @@ private:
     void checkOffscreenPosition (QRect* geom, const QRect& screenArea);
 
     void updateInputWindow();
+    void resetInputWindow();
 
     bool tabTo(Client *other, bool behind, bool activate);
 
@@ -815,6 +820,8 @@ private:
     int quick_tile_mode;
 
     void readTransient();
+    Xcb::TransientFor fetchTransient() const;
+    void readTransient(Xcb::TransientFor &transientFor);
     xcb_window_t verifyTransientFor(xcb_window_t transient_for, bool set);
     void addTransient(Client* cl);
     void removeTransient(Client* cl);
@@ -857,8 +864,13 @@ private:
     bool blocks_compositing;
     WindowRules client_rules;
     void getWMHints();
+    Xcb::Property fetchWMHints() const;
+    void readWMHints(Xcb::Property &property);
+    static bool readWMHintsIconic(Xcb::Property &property);
     void readIcons();
     void getWindowProtocols();
+    Xcb::Property fetchWindowProtocols() const;
+    void readWindowProtocols(Xcb::Property &property);
     QPixmap icon_pix;
     QPixmap miniicon_pix;
     QPixmap bigicon_pix;
@@ -34,6 +34,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "scene.h"
 #include "scene_xrender.h"
 #include "shadow.h"
+#include "shadowcache.h"
 #include "useractions.h"
 #include "compositingprefs.h"
 #include "xcbutils.h"
@@ -77,6 +78,7 @@ Compositor::Compositor(QObject* workspace)
     , m_finishing(false)
     , m_timeSinceLastVBlank(0)
     , m_scene(NULL)
+    , m_shadowCacheLimit(ShadowCache::DefaultLimit)
 {
     qRegisterMetaType<Compositor::SuspendReason>("Compositor::SuspendReason");
     new CompositingAdaptor(this);
@@ -157,6 +159,13 @@ void Compositor::setup()
     case XRenderCompositing:
         kDebug(1212) << "Initializing XRender compositing";
         m_scene = new SceneXrender(Workspace::self());
+        if (SceneXrender::shadowCache()) {
+            SceneXrender::shadowCache()->setLimit(m_shadowCacheLimit);
+        }
+        connect(m_scene, SIGNAL(windowThumbnailUpdated(KWin::Toplevel*)),
+                SLOT(slotWindowThumbnailChanged(KWin::Toplevel*)));
+        connect(m_scene, SIGNAL(windowThumbnailDiscarded(KWin::Toplevel*)),
+                SLOT(slotWindowThumbnailChanged(KWin::Toplevel*)));
         break;
 #endif
     default:
@@ -175,7 +184,8 @@ void Compositor::setup()
     }
     m_xrrRefreshRate = KWin::currentRefreshRate();
     fpsInterval = options->maxFpsInterval();
-    m_timeSinceLastVBlank = fpsInterval - (options->vBlankTime() + 1); // means "start now" - we don't have even a slight idea when the first vsync will occur
+    m_frameTimings.clear();
+    m_timeSinceLastVBlank = fpsInterval - (idleDelay() + 1); // means "start now" - we don't have even a slight idea when the first vsync will occur
     scheduleRepaint();
     xcb_composite_redirect_subwindows(connection(), rootWindow(), XCB_COMPOSITE_REDIRECT_MANUAL);
     new EffectsHandlerImpl(this, m_scene);   // sets also the 'effects' pointer
@@ -474,7 +484,7 @@ void Compositor::performCompositing()
 
     if (repaints_region.isEmpty() && !windowRepaintsPending()) {
         m_scene->idle();
-        m_timeSinceLastVBlank = fpsInterval - (options->vBlankTime() + 1); // means "start now"
+        m_timeSinceLastVBlank = fpsInterval - (idleDelay() + 1); // means "start now"
         // Note: It would seem here we should undo suspended unredirect, but when scenes need
         // it for some reason, e.g. transformations or translucency, the next pass that does not
         // need this anymore and paints normally will also reset the suspended unredirect.
@@ -499,6 +509,7 @@ void Compositor::performCompositing()
     repaints_region = QRegion();
 
     m_timeSinceLastVBlank = m_scene->paint(repaints, windows);
+    m_frameTimings.add(m_scene->frameTiming(), fpsInterval);
 
     compositeTimer.stop(); // stop here to ensure *we* cause the next repaint schedule - not some effect through m_scene->paint()
 
@@ -553,6 +564,19 @@ void Compositor::setCompositeTimer()
     compositeTimer.start(qMin(waitTime, 250u), this); // force 4fps minimum
 }
 
+// The first paint after being idle waits for the vblank time, so that the damage of the
+// changes which usually follow the first one is painted in the same frame. When painting has
+// been cheap recently, painting an additional frame costs little and the wait is cut down to
+// how long the last frames took to paint, which lowers the latency of the first frame.
+qint64 Compositor::idleDelay() const
+{
+    const qint64 cost = m_frameTimings.predictedCost();
+    if (cost < 0) {
+        return options->vBlankTime();
+    }
+    return qMin(options->vBlankTime(), cost);
+}
+
 bool Compositor::isActive()
 {
     return !m_finishing && hasScene();
@@ -655,6 +679,131 @@ QString Compositor::compositingNotPossibleReason() const
     return CompositingPrefs::compositingNotPossibleReason();
 }
 
+qulonglong Compositor::frames() const
+{
+    return m_frameTimings.frames();
+}
+
+qulonglong Compositor::missedFrames() const
+{
+    return m_frameTimings.missedFrames();
+}
+
+qulonglong Compositor::culledPixels() const
+{
+    return m_frameTimings.culledPixels();
+}
+
+qulonglong Compositor::requests() const
+{
+    return m_frameTimings.requests();
+}
+
+static ShadowCache *shadowCache()
+{
+#ifdef KWIN_BUILD_COMPOSITE
+    return SceneXrender::shadowCache();
+#else
+    return NULL;
+#endif
+}
+
+qlonglong Compositor::shadowCacheSize() const
+{
+    return shadowCache() ? shadowCache()->bytes() : 0;
+}
+
+qlonglong Compositor::shadowCacheLimit() const
+{
+    return m_shadowCacheLimit;
+}
+
+void Compositor::setShadowCacheLimit(qlonglong limit)
+{
+    m_shadowCacheLimit = qMax(qlonglong(0), limit);
+    if (shadowCache()) {
+        shadowCache()->setLimit(m_shadowCacheLimit);
+    }
+}
+
+qulonglong Compositor::shadowCacheHits() const
+{
+    return shadowCache() ? shadowCache()->hits() : 0;
+}
+
+qulonglong Compositor::shadowCacheMisses() const
+{
+    return shadowCache() ? shadowCache()->misses() : 0;
+}
+
+qulonglong Compositor::shadowCacheEvictions() const
+{
+    return shadowCache() ? shadowCache()->evictions() : 0;
+}
+
+QList<int> Compositor::frameTimingHistogram(const QString &stage) const
+{
+    static const char *const stages[] = {
+        "prePaint", "paint", "windows", "postPaint", "present", "total", "slowestWindow"
+    };
+    for (int i = FrameTimings::PrePaintStage; i <= FrameTimings::SlowestWindowStage; ++i) {
+        if (stage == QLatin1String(stages[i])) {
+            return m_frameTimings.histogram(static_cast<FrameTimings::Stage>(i));
+        }
+    }
+    return QList<int>();
+}
+
+void Compositor::resetFrameTimings()
+{
+    m_frameTimings.clear();
+}
+
+qlonglong Compositor::windowPaintTime(qulonglong window) const
+{
+    Toplevel *t = Workspace::self()->findClient(WindowMatchPredicate(window));
+    if (!t) {
+        t = Workspace::self()->findUnmanaged(WindowMatchPredicate(window));
+    }
+    if (!t || !t->effectWindow() || !t->effectWindow()->sceneWindow()) {
+        return -1;
+    }
+    return t->effectWindow()->sceneWindow()->averagePaintTime();
+}
+
+qulonglong Compositor::windowThumbnail(qulonglong window, int width, int height)
+{
+#ifdef KWIN_BUILD_COMPOSITE
+    SceneXrender *scene = qobject_cast<SceneXrender*>(m_scene);
+    if (!scene) {
+        return 0;
+    }
+    Toplevel *t = Workspace::self()->findClient(WindowMatchPredicate(window));
+    if (!t) {
+        t = Workspace::self()->findUnmanaged(WindowMatchPredicate(window));
+    }
+    if (!t) {
+        return 0;
+    }
+    QSize size;
+    xcb_pixmap_t pixmap = XCB_PIXMAP_NONE;
+    if (scene->windowThumbnail(t, QSize(width, height), &size, &pixmap) == XCB_RENDER_PICTURE_NONE) {
+        return 0;
+    }
+    return pixmap;
+#else
+    Q_UNUSED(window);
+    Q_UNUSED(width);
+    Q_UNUSED(height);
+    return 0;
+#endif
+}
+
+void Compositor::slotWindowThumbnailChanged(Toplevel *t)
+{
+    emit windowThumbnailChanged(t->window());
+}
+
 QString Compositor::compositingType() const
 {
     if (!hasScene()) {
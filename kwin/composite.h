@@ -23,6 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define KWIN_COMPOSITE_H
 // KWin
 #include <kwinglobals.h>
+#include "frametimings.h"
 // KDE
 #include <KSelectionOwner>
 // Qt
@@ -60,6 +61,46 @@ class Compositor : public QObject {
      * @li @c xrender XRender
      **/
     Q_PROPERTY(QString compositingType READ compositingType)
+    /**
+     * @brief The number of frames painted since the frame timings were reset.
+     **/
+    Q_PROPERTY(qulonglong frames READ frames)
+    /**
+     * @brief The number of frames which took longer to paint than the interval of the
+     * configured maximum frame rate.
+     **/
+    Q_PROPERTY(qulonglong missedFrames READ missedFrames)
+    /**
+     * @brief The number of window pixels which were not painted because they were hidden
+     * by opaque windows, since the frame timings were reset.
+     **/
+    Q_PROPERTY(qulonglong culledPixels READ culledPixels)
+    /**
+     * @brief The number of X requests sent for the frames painted since the frame timings
+     * were reset.
+     **/
+    Q_PROPERTY(qulonglong requests READ requests)
+    /**
+     * @brief The size in bytes of the shadow pictures shared by the windows, including the
+     * ones no window uses anymore.
+     **/
+    Q_PROPERTY(qlonglong shadowCacheSize READ shadowCacheSize)
+    /**
+     * @brief The size in bytes up to which shadow pictures no window uses anymore are kept.
+     **/
+    Q_PROPERTY(qlonglong shadowCacheLimit READ shadowCacheLimit WRITE setShadowCacheLimit)
+    /**
+     * @brief The number of windows which got the shadow pictures of another window.
+     **/
+    Q_PROPERTY(qulonglong shadowCacheHits READ shadowCacheHits)
+    /**
+     * @brief The number of shadows for which new pictures had to be created.
+     **/
+    Q_PROPERTY(qulonglong shadowCacheMisses READ shadowCacheMisses)
+    /**
+     * @brief The number of unused shadows whose pictures were freed because of the limit.
+     **/
+    Q_PROPERTY(qulonglong shadowCacheEvictions READ shadowCacheEvictions)
 public:
     enum SuspendReason { NoReasonSuspend = 0, UserSuspend = 1<<0, BlockRuleSuspend = 1<<1, ScriptSuspend = 1<<2, AllReasonSuspend = 0xff };
     Q_DECLARE_FLAGS(SuspendReasons, SuspendReason)
@@ -139,6 +180,20 @@ public:
     bool isCompositingPossible() const;
     QString compositingNotPossibleReason() const;
     QString compositingType() const;
+    qulonglong frames() const;
+    qulonglong missedFrames() const;
+    qulonglong culledPixels() const;
+    qulonglong requests() const;
+    qlonglong shadowCacheSize() const;
+    qlonglong shadowCacheLimit() const;
+    void setShadowCacheLimit(qlonglong limit);
+    qulonglong shadowCacheHits() const;
+    qulonglong shadowCacheMisses() const;
+    qulonglong shadowCacheEvictions() const;
+
+    const FrameTimings &frameTimings() const {
+        return m_frameTimings;
+    }
 
 public Q_SLOTS:
     void addRepaintFull();
@@ -206,6 +261,44 @@ public Q_SLOTS:
     // NOTICE this is atm. for script usage *ONLY* and needs to be extended like resume / suspend are
     // if intended to be used from within KWin code!
     Q_SCRIPTABLE void setCompositing(bool active);
+    /**
+     * @brief How many of the recently painted frames spent the given time in @p stage.
+     *
+     * The stage is one of @c prePaint, @c paint, @c windows, @c postPaint, @c present,
+     * @c total or @c slowestWindow, the latter being the longest time spent painting a single
+     * window of each frame. Each entry of the returned list is a bucket of one millisecond,
+     * the last one counts all frames which took longer.
+     *
+     * @param stage The name of the painting stage
+     * @return QList<int> The number of frames per millisecond, empty for an unknown stage
+     **/
+    Q_SCRIPTABLE QList<int> frameTimingHistogram(const QString &stage) const;
+    /**
+     * @brief Forgets the timings of all frames painted so far.
+     **/
+    Q_SCRIPTABLE void resetFrameTimings();
+    /**
+     * @brief How long painting a window took recently.
+     *
+     * @param window The X window of the client or unmanaged window
+     * @return qlonglong The average time in nanoseconds, weighted towards the last frames the
+     * window was painted in, -1 if the window is unknown or has not been painted yet
+     **/
+    Q_SCRIPTABLE qlonglong windowPaintTime(qulonglong window) const;
+    /**
+     * @brief The snapshot of a window scaled down to fit into the given size.
+     *
+     * Taskbars and pagers can show the pixmap instead of scaling the window down themselves.
+     * The pixmap belongs to KWin and must not be freed. Its contents are updated at most ten
+     * times a second, each update is followed by windowThumbnailChanged. The pixmap is freed
+     * when the window is resized or closed, or when nobody asked for it for 30 seconds. Then
+     * windowThumbnailChanged is emitted as well, so the pixmap can be used until that signal
+     * is received and this method has to be called again afterwards.
+     *
+     * @param window The X window of the client or unmanaged window
+     * @return qulonglong The 32 bit pixmap of the snapshot, 0 if there is none
+     **/
+    Q_SCRIPTABLE qulonglong windowThumbnail(qulonglong window, int width, int height);
     /**
      * Actual slot to perform the toggling compositing.
      * That is if the Compositor is suspended it will be resumed and if the Compositor is active
@@ -232,6 +325,13 @@ public Q_SLOTS:
 
 Q_SIGNALS:
     Q_SCRIPTABLE void compositingToggled(bool active);
+    /**
+     * @brief Emitted when the snapshot of a window was updated or freed.
+     *
+     * @param window The X window of the client or unmanaged window
+     * @see windowThumbnail
+     **/
+    Q_SCRIPTABLE void windowThumbnailChanged(qulonglong window);
 
 protected:
     void timerEvent(QTimerEvent *te);
@@ -251,9 +351,11 @@ private Q_SLOTS:
     void delayedCheckUnredirect();
     void slotConfigChanged();
     void deleteUnusedSupportProperties();
+    void slotWindowThumbnailChanged(KWin::Toplevel *t);
 
 private:
     void setCompositeTimer();
+    qint64 idleDelay() const;
     bool windowRepaintsPending() const;
 
     /**
@@ -276,7 +378,9 @@ private:
     bool m_finishing; // finish() sets this variable while shutting down
     bool m_starting; // start() sets this variable while starting
     qint64 m_timeSinceLastVBlank;
+    FrameTimings m_frameTimings;
     Scene *m_scene;
+    qlonglong m_shadowCacheLimit;
 
     KWIN_SINGLETON_VARIABLE(Compositor, s_compositor)
 };
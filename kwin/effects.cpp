@@ -139,6 +139,10 @@ EffectsHandlerImpl::EffectsHandlerImpl(Compositor *compositor, Scene *scene)
 
     Workspace *ws = Workspace::self();
     VirtualDesktopManager *vds = VirtualDesktopManager::self();
+#ifdef KWIN_BUILD_COMPOSITE
+    if (SceneXrender* s = qobject_cast< SceneXrender* >(scene))
+        connect(s, SIGNAL(windowThumbnailUpdated(KWin::Toplevel*)), SLOT(slotWindowThumbnailUpdated(KWin::Toplevel*)));
+#endif
     connect(ws, SIGNAL(currentDesktopChanged(int,KWin::Client*)), SLOT(slotDesktopChanged(int,KWin::Client*)));
     connect(ws, SIGNAL(desktopPresenceChanged(KWin::Client*,int)), SLOT(slotDesktopPresenceChanged(KWin::Client*,int)));
     connect(ws, SIGNAL(clientAdded(KWin::Client*)), this, SLOT(slotClientAdded(KWin::Client*)));
@@ -522,6 +526,14 @@ void EffectsHandlerImpl::slotWindowDamaged(Toplevel* t, const QRect& r)
     emit windowDamaged(t->effectWindow(), r);
 }
 
+void EffectsHandlerImpl::slotWindowThumbnailUpdated(Toplevel* t)
+{
+    if (!t->effectWindow()) {
+        return;
+    }
+    emit windowThumbnailUpdated(t->effectWindow());
+}
+
 void EffectsHandlerImpl::slotGeometryShapeChanged(Toplevel* t, const QRect& old)
 {
     // during late cleanup effectWindow() may be already NULL
@@ -1074,6 +1086,36 @@ unsigned long EffectsHandlerImpl::xrenderBufferPicture()
     return None;
 }
 
+unsigned long EffectsHandlerImpl::windowThumbnail(EffectWindow *w, const QSize &size, QSize *thumbnailSize)
+{
+#ifdef KWIN_BUILD_COMPOSITE
+    if (SceneXrender* s = qobject_cast< SceneXrender* >(m_scene))
+        return s->windowThumbnail(static_cast<EffectWindowImpl*>(w)->window(), size, thumbnailSize);
+#else
+    Q_UNUSED(w)
+    Q_UNUSED(size)
+    Q_UNUSED(thumbnailSize)
+#endif
+    return None;
+}
+
+bool EffectsHandlerImpl::hasWindowThumbnail(EffectWindow *w, const QSize &size) const
+{
+#ifdef KWIN_BUILD_COMPOSITE
+    if (SceneXrender* s = qobject_cast< SceneXrender* >(m_scene))
+        return s->hasWindowThumbnail(static_cast<EffectWindowImpl*>(w)->window(), size);
+#else
+    Q_UNUSED(w)
+    Q_UNUSED(size)
+#endif
+    return false;
+}
+
+QVector<FrameTiming> EffectsHandlerImpl::frameTimings(int count) const
+{
+    return Compositor::self()->frameTimings().timings(count);
+}
+
 void EffectsHandlerImpl::toggleEffect(const QString& name)
 {
     if (isEffectLoaded(name))
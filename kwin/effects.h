@@ -134,6 +134,9 @@ public:
     virtual void unreserveElectricBorder(ElectricBorder border, Effect *effect);
 
     virtual unsigned long xrenderBufferPicture();
+    virtual unsigned long windowThumbnail(EffectWindow *w, const QSize &size, QSize *thumbnailSize);
+    virtual bool hasWindowThumbnail(EffectWindow *w, const QSize &size) const;
+    virtual QVector<FrameTiming> frameTimings(int count) const;
     virtual void reconfigure();
     virtual void registerPropertyType(long atom, bool reg);
     virtual QByteArray readRootProperty(long atom, long type, int format) const;
@@ -204,6 +207,7 @@ protected Q_SLOTS:
     void slotGeometryShapeChanged(KWin::Toplevel *t, const QRect &old);
     void slotPaddingChanged(KWin::Toplevel *t, const QRect &old);
     void slotWindowDamaged(KWin::Toplevel *t, const QRect& r);
+    void slotWindowThumbnailUpdated(KWin::Toplevel *t);
     void slotPropertyNotify(KWin::Toplevel *t, long atom);
     void slotPropertyNotify(long atom);
 
@@ -0,0 +1,418 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2008 Lucas Murray <lmurray@undefinedfire.com>
+Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include "naturallayout.h"
+
+#include <QHash>
+#include <QRegion>
+
+#include <algorithm>
+
+namespace KWin
+{
+
+// the margin kept between two windows
+static const int s_spacing = 5;
+
+static inline QRect withSpacing(const QRect &rect)
+{
+    return rect.adjusted(-s_spacing, -s_spacing, s_spacing, s_spacing);
+}
+
+/**
+ * Buckets the windows by the grid cells their geometry (including the spacing) touches,
+ * so the windows which may overlap a rectangle are found without looking at all of them.
+ * A window has to be removed before its geometry is changed and inserted again afterwards.
+ **/
+class LayoutGrid
+{
+public:
+    explicit LayoutGrid(const QVector<QRect> &rects)
+        : m_rects(rects)
+    {
+        // about one window per cell, windows which are far apart do not share cells
+        qint64 size = 0;
+        foreach (const QRect &rect, rects) {
+            size += (rect.width() + rect.height()) / 2;
+        }
+        m_cellSize = qMax<qint64>(16, rects.isEmpty() ? 0 : size / rects.count());
+        for (int i = 0; i < rects.count(); ++i) {
+            insert(i);
+        }
+    }
+
+    void insert(int window) {
+        const QRect rect = withSpacing(m_rects.at(window));
+        for (int x = cell(rect.left()); x <= cell(rect.right()); ++x) {
+            for (int y = cell(rect.top()); y <= cell(rect.bottom()); ++y) {
+                m_cells[key(x, y)].append(window);
+            }
+        }
+    }
+
+    void remove(int window) {
+        const QRect rect = withSpacing(m_rects.at(window));
+        for (int x = cell(rect.left()); x <= cell(rect.right()); ++x) {
+            for (int y = cell(rect.top()); y <= cell(rect.bottom()); ++y) {
+                Cells::iterator it = m_cells.find(key(x, y));
+                if (it == m_cells.end()) {
+                    continue;
+                }
+                const int index = it->indexOf(window);
+                if (index != -1) {
+                    it->remove(index);
+                }
+                if (it->isEmpty()) {
+                    m_cells.erase(it);
+                }
+            }
+        }
+    }
+
+    // the windows which share a cell with rect, in the order of the windows
+    void candidates(const QRect &rect, QVector<int> *windows) const {
+        windows->clear();
+        for (int x = cell(rect.left()); x <= cell(rect.right()); ++x) {
+            for (int y = cell(rect.top()); y <= cell(rect.bottom()); ++y) {
+                Cells::const_iterator it = m_cells.constFind(key(x, y));
+                if (it != m_cells.constEnd()) {
+                    *windows += *it;
+                }
+            }
+        }
+        qSort(*windows);
+        windows->erase(std::unique(windows->begin(), windows->end()), windows->end());
+    }
+
+private:
+    typedef QHash<quint64, QVector<int> > Cells;
+
+    int cell(int coordinate) const {
+        // rounds towards negative infinity, windows may be left of or above the screen
+        return coordinate >= 0 ? coordinate / m_cellSize : -((-coordinate - 1) / m_cellSize) - 1;
+    }
+    static quint64 key(int x, int y) {
+        return (quint64(quint32(x)) << 32) | quint32(y);
+    }
+
+    const QVector<QRect> &m_rects;
+    int m_cellSize;
+    Cells m_cells;
+};
+
+static bool isOverlappingAny(int window, const QVector<QRect> &targets, const LayoutGrid &grid,
+                             const QRegion &border, QVector<int> *candidates)
+{
+    const QRect target = targets.at(window);
+    if (border.intersects(target))
+        return true;
+    const QRect spaced = withSpacing(target);
+    grid.candidates(spaced, candidates);
+    foreach (int other, *candidates) {
+        if (other != window && spaced.intersects(withSpacing(targets.at(other))))
+            return true;
+    }
+    return false;
+}
+
+static inline int heightForWidth(const QRect &geometry, int width)
+{
+    return int((width / double(geometry.width())) * geometry.height());
+}
+
+NaturalLayout::NaturalLayout()
+    : m_accuracy(20)
+    , m_fillGaps(true)
+{
+}
+
+void NaturalLayout::setAccuracy(int accuracy)
+{
+    if (m_accuracy != accuracy) {
+        m_accuracy = accuracy;
+        clearCache();
+    }
+}
+
+void NaturalLayout::setFillGaps(bool fillGaps)
+{
+    if (m_fillGaps != fillGaps) {
+        m_fillGaps = fillGaps;
+        clearCache();
+    }
+}
+
+QVector<QRect> NaturalLayout::layout(const QVector<QRect> &geometries, const QRect &area)
+{
+    const int index = findCached(geometries, area);
+    if (index != -1) {
+        if (index != 0) {
+            m_cache.move(index, 0);
+        }
+        return m_cache.first().targets;
+    }
+    CachedLayout cached;
+    cached.area = area;
+    cached.geometries = geometries;
+    cached.targets = calculate(geometries, area, m_accuracy, m_fillGaps);
+    m_cache.prepend(cached);
+    if (m_cache.count() > CacheSize) {
+        m_cache.removeLast();
+    }
+    return cached.targets;
+}
+
+bool NaturalLayout::isCached(const QVector<QRect> &geometries, const QRect &area) const
+{
+    return findCached(geometries, area) != -1;
+}
+
+void NaturalLayout::clearCache()
+{
+    m_cache.clear();
+}
+
+int NaturalLayout::findCached(const QVector<QRect> &geometries, const QRect &area) const
+{
+    for (int i = 0; i < m_cache.count(); ++i) {
+        const CachedLayout &cached = m_cache.at(i);
+        if (cached.area == area && cached.geometries == geometries) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+QVector<QRect> NaturalLayout::calculate(const QVector<QRect> &geometries, const QRect &area,
+                                        int accuracy, bool fillGaps)
+{
+    QRect bounds = area;
+    QVector<QRect> targets = geometries;
+    foreach (const QRect &geometry, geometries) {
+        bounds = bounds.united(geometry);
+    }
+    if (targets.isEmpty()) {
+        return targets;
+    }
+
+    // Iterate over all windows, if two overlap push them apart _slightly_ as we try to
+    // brute-force the most optimal positions over many iterations. Only the windows
+    // sharing a grid cell with a window are checked, windows which start to overlap
+    // because of a move later in the same iteration are found in the next one.
+    QVector<int> candidates;
+    {
+        LayoutGrid grid(targets);
+        bool overlap;
+        int iterations = 0;
+        do {
+            overlap = false;
+            for (int w = 0; w < targets.count(); ++w) {
+                grid.candidates(withSpacing(targets.at(w)), &candidates);
+                foreach (int e, candidates) {
+                    if (w == e)
+                        continue;
+                    QRect *target_w = &targets[w];
+                    QRect *target_e = &targets[e];
+                    if (!withSpacing(*target_w).intersects(withSpacing(*target_e)))
+                        continue;
+                    overlap = true;
+                    grid.remove(w);
+                    grid.remove(e);
+
+                    // Determine pushing direction
+                    QPoint diff(target_e->center() - target_w->center());
+                    // Prevent dividing by zero and non-movement
+                    if (diff.x() == 0 && diff.y() == 0)
+                        diff.setX(1);
+                    // Approximate a vector of between 10px and 20px in magnitude in the same direction
+                    diff *= accuracy / double(diff.manhattanLength());
+                    // Move both windows apart
+                    target_w->translate(-diff);
+                    target_e->translate(diff);
+
+                    // Try to keep the bounding rect the same aspect as the screen so that more
+                    // screen real estate is utilised. We do this by splitting the screen into nine
+                    // equal sections, if the window center is in any of the corner sections pull the
+                    // window towards the outer corner. If it is in any of the other edge sections
+                    // alternate between each corner on that edge. We don't want to determine it
+                    // randomly as it will not produce consistant locations when using the filter.
+                    // Only move one window so we don't cause large amounts of unnecessary zooming
+                    // in some situations. We need to do this even when expanding later just in case
+                    // all windows are the same size.
+                    // (We are using an old bounding rect for this, hopefully it doesn't matter)
+                    // The index of the window is used as the preferred direction.
+                    const int direction = w % 4;
+                    int xSection = (target_w->x() - bounds.x()) / (bounds.width() / 3);
+                    int ySection = (target_w->y() - bounds.y()) / (bounds.height() / 3);
+                    diff = QPoint(0, 0);
+                    if (xSection != 1 || ySection != 1) { // Remove this if you want the center to pull as well
+                        if (xSection == 1)
+                            xSection = (direction / 2 ? 2 : 0);
+                        if (ySection == 1)
+                            ySection = (direction % 2 ? 2 : 0);
+                    }
+                    if (xSection == 0 && ySection == 0)
+                        diff = QPoint(bounds.topLeft() - target_w->center());
+                    if (xSection == 2 && ySection == 0)
+                        diff = QPoint(bounds.topRight() - target_w->center());
+                    if (xSection == 2 && ySection == 2)
+                        diff = QPoint(bounds.bottomRight() - target_w->center());
+                    if (xSection == 0 && ySection == 2)
+                        diff = QPoint(bounds.bottomLeft() - target_w->center());
+                    if (diff.x() != 0 || diff.y() != 0) {
+                        diff *= accuracy / double(diff.manhattanLength());
+                        target_w->translate(diff);
+                    }
+
+                    // Update bounding rect
+                    bounds = bounds.united(*target_w);
+                    bounds = bounds.united(*target_e);
+                    grid.insert(w);
+                    grid.insert(e);
+                }
+            }
+        } while (overlap && ++iterations < MaxIterations);
+    }
+
+    // Work out scaling by getting the most top-left and most bottom-right window coords.
+    // The 20's and 10's are so that the windows don't touch the edge of the screen.
+    double scale;
+    if (bounds == area)
+        scale = 1.0; // Don't add borders to the screen
+    else if (area.width() / double(bounds.width()) < area.height() / double(bounds.height()))
+        scale = (area.width() - 20) / double(bounds.width());
+    else
+        scale = (area.height() - 20) / double(bounds.height());
+    // Make bounding rect fill the screen size for later steps
+    bounds = QRect(
+                 bounds.x() - (area.width() - 20 - bounds.width() * scale) / 2 - 10 / scale,
+                 bounds.y() - (area.height() - 20 - bounds.height() * scale) / 2 - 10 / scale,
+                 area.width() / scale,
+                 area.height() / scale
+             );
+
+    // Move all windows back onto the screen and set their scale
+    for (int i = 0; i < targets.count(); ++i) {
+        QRect *target = &targets[i];
+        target->setRect((target->x() - bounds.x()) * scale + area.x(),
+                        (target->y() - bounds.y()) * scale + area.y(),
+                        target->width() * scale,
+                        target->height() * scale
+                        );
+    }
+
+    // Try to fill the gaps by enlarging windows if they have the space
+    if (fillGaps) {
+        // Don't expand onto or over the border
+        QRegion borderRegion(area.adjusted(-200, -200, 200, 200));
+        borderRegion ^= area.adjusted(10 / scale, 10 / scale, -10 / scale, -10 / scale);
+
+        LayoutGrid grid(targets);
+        bool moved;
+        int iterations = 0;
+        do {
+            moved = false;
+            for (int w = 0; w < targets.count(); ++w) {
+                // the window is not in the grid while it grows, so it is not its own candidate
+                grid.remove(w);
+                QRect oldRect;
+                QRect *target = &targets[w];
+                // This may cause some slight distortion if the windows are enlarged a large amount
+                int widthDiff = accuracy;
+                int heightDiff = heightForWidth(geometries.at(w), target->width() + widthDiff) - target->height();
+                int xDiff = widthDiff / 2;  // Also move a bit in the direction of the enlarge, allows the
+                int yDiff = heightDiff / 2; // center windows to be enlarged if there is gaps on the side.
+
+                // Attempt enlarging to the top-right
+                oldRect = *target;
+                target->setRect(target->x() + xDiff,
+                                target->y() - yDiff - heightDiff,
+                                target->width() + widthDiff,
+                                target->height() + heightDiff
+                                );
+                if (isOverlappingAny(w, targets, grid, borderRegion, &candidates))
+                    *target = oldRect;
+                else
+                    moved = true;
+
+                // Attempt enlarging to the bottom-right
+                oldRect = *target;
+                target->setRect(
+                                 target->x() + xDiff,
+                                 target->y() + yDiff,
+                                 target->width() + widthDiff,
+                                 target->height() + heightDiff
+                             );
+                if (isOverlappingAny(w, targets, grid, borderRegion, &candidates))
+                    *target = oldRect;
+                else
+                    moved = true;
+
+                // Attempt enlarging to the bottom-left
+                oldRect = *target;
+                target->setRect(
+                                 target->x() - xDiff - widthDiff,
+                                 target->y() + yDiff,
+                                 target->width() + widthDiff,
+                                 target->height() + heightDiff
+                             );
+                if (isOverlappingAny(w, targets, grid, borderRegion, &candidates))
+                    *target = oldRect;
+                else
+                    moved = true;
+
+                // Attempt enlarging to the top-left
+                oldRect = *target;
+                target->setRect(
+                                 target->x() - xDiff - widthDiff,
+                                 target->y() - yDiff - heightDiff,
+                                 target->width() + widthDiff,
+                                 target->height() + heightDiff
+                             );
+                if (isOverlappingAny(w, targets, grid, borderRegion, &candidates))
+                    *target = oldRect;
+                else
+                    moved = true;
+                grid.insert(w);
+            }
+        } while (moved && ++iterations < MaxIterations);
+
+        // The expanding code above can actually enlarge windows over 1.0/2.0 scale, we don't like this
+        // We can't add this to the loop above as it would cause a never-ending loop so we have to make
+        // do with the less-than-optimal space usage with using this method.
+        for (int i = 0; i < targets.count(); ++i) {
+            const QRect &geometry = geometries.at(i);
+            QRect *target = &targets[i];
+            double scale = target->width() / double(geometry.width());
+            if (scale > 2.0 || (scale > 1.0 && (geometry.width() > 300 || geometry.height() > 300))) {
+                scale = (geometry.width() > 300 || geometry.height() > 300) ? 1.0 : 2.0;
+                target->setRect(
+                                 target->center().x() - int(geometry.width() * scale) / 2,
+                                 target->center().y() - int(geometry.height() * scale) / 2,
+                                 geometry.width() * scale,
+                                 geometry.height() * scale);
+            }
+        }
+    }
+    return targets;
+}
+
+} // namespace
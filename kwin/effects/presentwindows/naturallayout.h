@@ -0,0 +1,95 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef KWIN_NATURALLAYOUT_H
+#define KWIN_NATURALLAYOUT_H
+
+#include <QList>
+#include <QRect>
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * @brief The natural layout of the present windows effect.
+ *
+ * Windows keep their relative positions: overlapping windows are pushed apart until no
+ * two of them overlap anymore, then all of them are scaled to fit into the area. Which
+ * windows overlap is looked up in a grid instead of comparing every window with every
+ * other one, and the number of iterations is bounded.
+ *
+ * The result only depends on the geometries of the windows and the area, so the last
+ * layouts are remembered and presenting the same windows again costs nothing.
+ **/
+class NaturalLayout
+{
+public:
+    enum {
+        MaxIterations = 1000, ///< after that many iterations some windows may still overlap
+        CacheSize = 8
+    };
+    NaturalLayout();
+
+    int accuracy() const;
+    void setAccuracy(int accuracy);
+    bool isFillGaps() const;
+    void setFillGaps(bool fillGaps);
+
+    /**
+     * @returns The target geometries of the windows with @p geometries in @p area, the
+     * order of the windows has to be the same every time to get the same layout.
+     **/
+    QVector<QRect> layout(const QVector<QRect> &geometries, const QRect &area);
+    /**
+     * @returns Whether the layout of @p geometries in @p area is remembered.
+     **/
+    bool isCached(const QVector<QRect> &geometries, const QRect &area) const;
+    void clearCache();
+
+    static QVector<QRect> calculate(const QVector<QRect> &geometries, const QRect &area,
+                                    int accuracy, bool fillGaps);
+
+private:
+    struct CachedLayout {
+        QRect area;
+        QVector<QRect> geometries;
+        QVector<QRect> targets;
+    };
+    int findCached(const QVector<QRect> &geometries, const QRect &area) const;
+
+    int m_accuracy;
+    bool m_fillGaps;
+    QList<CachedLayout> m_cache; ///< most recently used first
+};
+
+inline int NaturalLayout::accuracy() const
+{
+    return m_accuracy;
+}
+
+inline bool NaturalLayout::isFillGaps() const
+{
+    return m_fillGaps;
+}
+
+} // namespace
+
+#endif
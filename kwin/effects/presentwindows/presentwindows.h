@@ -23,6 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define KWIN_PRESENTWINDOWS_H
 
 #include "presentwindows_proxy.h"
+#include "naturallayout.h"
 
 #include <kwineffects.h>
 #include <QKeySequence>
@@ -214,7 +215,6 @@ protected:
     inline int heightForWidth(EffectWindow *w, int width) {
         return int((width / double(w->width())) * w->height());
     }
-    bool isOverlappingAny(EffectWindow *w, const QHash<EffectWindow*, QRect> &targets, const QRegion &border);
 
     // Filter box
     void updateFilterFrame();
@@ -265,6 +265,7 @@ private:
 
     // Grid layout info
     QList<GridSize> m_gridSizes;
+    NaturalLayout m_naturalLayout;
 
     // Filter box
     EffectFrame* m_filterFrame;
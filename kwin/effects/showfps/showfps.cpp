@@ -68,14 +68,14 @@ void ShowFpsEffect::reconfigure(ReconfigureFlags)
     x = ShowFpsConfig::x();
     y = ShowFpsConfig::y();
     if (x == -10000)   // there's no -0 :(
-        x = displayWidth() - 2 * NUM_PAINTS - FPS_WIDTH;
+        x = displayWidth() - 3 * NUM_PAINTS - FPS_WIDTH;
     else if (x < 0)
-        x = displayWidth() - 2 * NUM_PAINTS - FPS_WIDTH - x;
+        x = displayWidth() - 3 * NUM_PAINTS - FPS_WIDTH - x;
     if (y == -10000)
         y = displayHeight() - MAX_TIME;
     else if (y < 0)
         y = displayHeight() - MAX_TIME - y;
-    fps_rect = QRect(x, y, FPS_WIDTH + 2 * NUM_PAINTS, MAX_TIME);
+    fps_rect = QRect(x, y, FPS_WIDTH + 3 * NUM_PAINTS, MAX_TIME);
     m_noBenchmark->setPosition(fps_rect.bottomRight() + QPoint(-6, 6));
 
     int textPosition = ShowFpsConfig::textPosition();
@@ -211,6 +211,9 @@ void ShowFpsEffect::paintXrender(int fps)
     // Paint amount of rendered pixels graph
     paintDrawSizeGraph(x + FPS_WIDTH + MAX_TIME, y);
 
+    // Paint where the compositor spent the time of the last frames
+    paintFrameTimingGraph(x + FPS_WIDTH + 2 * NUM_PAINTS, y);
+
     // Paint FPS numerical value
     if (fpsTextRect.isValid()) {
         QImage textImg(fpsTextImage(fps));
@@ -220,6 +223,71 @@ void ShowFpsEffect::paintXrender(int fps)
         effects->addRepaint(fpsTextRect);
     }
 }
+
+void ShowFpsEffect::paintFrameTimingGraph(int x, int y)
+{
+    // one pixel per 0.25 ms, the most recent frame on the left
+    const qint64 nsPerPixel = 250 * 1000;
+    const QVector<FrameTiming> timings = effects->frameTimings(NUM_PAINTS);
+
+    xcb_pixmap_t pixmap = xcb_generate_id(connection());
+    xcb_create_pixmap(connection(), 32, pixmap, rootWindow(), NUM_PAINTS, MAX_TIME);
+    XRenderPicture p(pixmap, 32);
+    xcb_free_pixmap(connection(), pixmap);
+    xcb_render_color_t col;
+    col.alpha = int(alpha * 0xffff);
+
+    // Draw background
+    col.red = col.green = col.blue = int(alpha * 0xffff);   // white
+    xcb_rectangle_t rect = {0, 0, uint16_t(NUM_PAINTS), uint16_t(MAX_TIME)};
+    xcb_render_fill_rectangles(connection(), XCB_RENDER_PICT_OP_SRC, p, col, 1, &rect);
+
+    // The stages of each frame stacked bottom to top: pre-paint in blue, painting the
+    // windows in green, the rest of painting (the effects) in yellow, post-paint in
+    // magenta and copying to the screen in red
+    for (int i = 0; i < timings.count(); ++i) {
+        const FrameTiming &timing = timings.at(i);
+        const qint64 stages[] = {
+            timing.prePaint,
+            timing.windows,
+            timing.paint - timing.windows,
+            timing.postPaint,
+            timing.present
+        };
+        const quint16 colors[][3] = {
+            { 0, 0, 0xffff },
+            { 0, 0xffff, 0 },
+            { 0xffff, 0xffff, 0 },
+            { 0xffff, 0, 0xffff },
+            { 0xffff, 0, 0 }
+        };
+        int top = MAX_TIME;
+        for (int j = 0; j < 5 && top > 0; ++j) {
+            const int height = qMin<qint64>(qMax<qint64>(stages[j], 0) / nsPerPixel, top);
+            if (height == 0) {
+                continue;
+            }
+            top -= height;
+            col.red = int(alpha * colors[j][0]);
+            col.green = int(alpha * colors[j][1]);
+            col.blue = int(alpha * colors[j][2]);
+            xcb_rectangle_t rect = {int16_t(i), int16_t(top), 1, uint16_t(height)};
+            xcb_render_fill_rectangles(connection(), XCB_RENDER_PICT_OP_SRC, p, col, 1, &rect);
+        }
+    }
+
+    // Then a line every 5 ms
+    col.red = col.green = col.blue = 0;  // black
+    QVector<xcb_rectangle_t> rects;
+    for (int h = 20; h < MAX_TIME; h += 20) {
+        xcb_rectangle_t rect = {0, int16_t(MAX_TIME - h), uint16_t(NUM_PAINTS), 1};
+        rects << rect;
+    }
+    xcb_render_fill_rectangles(connection(), XCB_RENDER_PICT_OP_SRC, p, col, rects.count(), rects.constData());
+
+    xcb_render_composite(connection(), alpha != 1.0 ? XCB_RENDER_PICT_OP_OVER : XCB_RENDER_PICT_OP_SRC, p,
+                         XCB_RENDER_PICTURE_NONE, effects->xrenderBufferPicture(), 0, 0, 0, 0, x, y, NUM_PAINTS, MAX_TIME);
+}
 #endif
 
 void ShowFpsEffect::paintFPSGraph(int x, int y)
@@ -75,6 +75,7 @@ public:
 private:
 #ifdef KWIN_BUILD_COMPOSITE
     void paintXrender(int fps);
+    void paintFrameTimingGraph(int x, int y);
 #endif
     void paintFPSGraph(int x, int y);
     void paintDrawSizeGraph(int x, int y);
@@ -36,6 +36,7 @@ TaskbarThumbnailEffect::TaskbarThumbnailEffect()
     connect(effects, SIGNAL(windowAdded(KWin::EffectWindow*)), this, SLOT(slotWindowAdded(KWin::EffectWindow*)));
     connect(effects, SIGNAL(windowDeleted(KWin::EffectWindow*)), this, SLOT(slotWindowDeleted(KWin::EffectWindow*)));
     connect(effects, SIGNAL(windowDamaged(KWin::EffectWindow*,QRect)), this, SLOT(slotWindowDamaged(KWin::EffectWindow*,QRect)));
+    connect(effects, SIGNAL(windowThumbnailUpdated(KWin::EffectWindow*)), this, SLOT(slotWindowThumbnailUpdated(KWin::EffectWindow*)));
     connect(effects, SIGNAL(propertyNotify(KWin::EffectWindow*,long)), this, SLOT(slotPropertyNotify(KWin::EffectWindow*,long)));
 }
 
@@ -68,12 +69,15 @@ void TaskbarThumbnailEffect::paintWindow(EffectWindow* w, int mask, QRegion regi
             EffectWindow* thumbw = effects->findWindow(thumb.window);
             if (thumbw == NULL)
                 continue;
-            WindowPaintData thumbData(thumbw);
-            thumbData.multiplyOpacity(data.opacity());
             QRect r, thumbRect(thumb.rect);
             thumbRect.translate(w->pos() + QPoint(data.xTranslation(), data.yTranslation()));
             thumbRect.setSize(QSize(thumbRect.width() * data.xScale(), thumbRect.height() * data.yScale())); // QSize has no vector multiplicator... :-(
 
+            // the snapshot is much cheaper than scaling the whole window down
+            if (drawWindowThumbnail(thumbw, thumbRect, Qt::KeepAspectRatio, thumbw->opacity() * data.opacity()))
+                continue;
+            WindowPaintData thumbData(thumbw);
+            thumbData.multiplyOpacity(data.opacity());
             setPositionTransformations(thumbData, r, thumbw, thumbRect, Qt::KeepAspectRatio);
             effects->drawWindow(thumbw, mask, r, thumbData);
         }
@@ -83,7 +87,17 @@ void TaskbarThumbnailEffect::paintWindow(EffectWindow* w, int mask, QRegion regi
 void TaskbarThumbnailEffect::slotWindowDamaged(EffectWindow* w, const QRect& damage)
 {
     Q_UNUSED(damage);
-    // Update the thumbnail if the window was damaged
+    // Update the thumbnail if the window was damaged, unless it is painted from a snapshot
+    foreach (EffectWindow * window, thumbnails.uniqueKeys()) {
+        foreach (const Data & thumb, thumbnails.values(window)) {
+            if (w == effects->findWindow(thumb.window) && !hasSnapshot(w, thumb.rect))
+                window->addRepaint(thumb.rect);
+        }
+    }
+}
+
+void TaskbarThumbnailEffect::slotWindowThumbnailUpdated(EffectWindow* w)
+{
     foreach (EffectWindow * window, thumbnails.uniqueKeys()) {
         foreach (const Data & thumb, thumbnails.values(window)) {
             if (w == effects->findWindow(thumb.window))
@@ -92,6 +106,13 @@ void TaskbarThumbnailEffect::slotWindowDamaged(EffectWindow* w, const QRect& dam
     }
 }
 
+bool TaskbarThumbnailEffect::hasSnapshot(EffectWindow* w, const QRect& rect)
+{
+    QSize size = w->size();
+    size.scale(rect.size(), Qt::KeepAspectRatio);
+    return effects->hasWindowThumbnail(w, size);
+}
+
 void TaskbarThumbnailEffect::slotWindowAdded(EffectWindow* w)
 {
     slotPropertyNotify(w, atom);   // read initial value
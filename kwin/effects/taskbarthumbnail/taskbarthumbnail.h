@@ -44,8 +44,10 @@ public Q_SLOTS:
     void slotWindowAdded(KWin::EffectWindow *w);
     void slotWindowDeleted(KWin::EffectWindow *w);
     void slotWindowDamaged(KWin::EffectWindow* w, const QRect& damage);
+    void slotWindowThumbnailUpdated(KWin::EffectWindow* w);
     void slotPropertyNotify(KWin::EffectWindow *w, long atom);
 private:
+    static bool hasSnapshot(EffectWindow* w, const QRect& rect);
     struct Data {
         Window window; // thumbnail of this window
         QRect rect;
@@ -40,6 +40,7 @@ ThumbnailAsideEffect::ThumbnailAsideEffect()
     connect(effects, SIGNAL(windowClosed(KWin::EffectWindow*)), this, SLOT(slotWindowClosed(KWin::EffectWindow*)));
     connect(effects, SIGNAL(windowGeometryShapeChanged(KWin::EffectWindow*,QRect)), this, SLOT(slotWindowGeometryShapeChanged(KWin::EffectWindow*,QRect)));
     connect(effects, SIGNAL(windowDamaged(KWin::EffectWindow*,QRect)), this, SLOT(slotWindowDamaged(KWin::EffectWindow*,QRect)));
+    connect(effects, SIGNAL(windowThumbnailUpdated(KWin::EffectWindow*)), this, SLOT(slotWindowThumbnailUpdated(KWin::EffectWindow*)));
     reconfigure(ReconfigureAll);
 }
 
@@ -59,6 +60,9 @@ void ThumbnailAsideEffect::paintScreen(int mask, QRegion region, ScreenPaintData
     effects->paintScreen(mask, region, data);
     foreach (const Data & d, windows) {
         if (painted.intersects(d.rect)) {
+            // the snapshot is much cheaper than scaling the whole window down
+            if (drawWindowThumbnail(d.window, d.rect, Qt::KeepAspectRatio, d.window->opacity() * opacity))
+                continue;
             WindowPaintData data(d.window);
             data.multiplyOpacity(opacity);
             QRect region;
@@ -76,6 +80,19 @@ void ThumbnailAsideEffect::paintWindow(EffectWindow *w, int mask, QRegion region
 }
 
 void ThumbnailAsideEffect::slotWindowDamaged(EffectWindow* w, const QRect&)
+{
+    foreach (const Data & d, windows) {
+        if (d.window != w)
+            continue;
+        // a snapshot is repainted when it was updated
+        QSize size = w->size();
+        size.scale(d.rect.size(), Qt::KeepAspectRatio);
+        if (!effects->hasWindowThumbnail(w, size))
+            effects->addRepaint(d.rect);
+    }
+}
+
+void ThumbnailAsideEffect::slotWindowThumbnailUpdated(EffectWindow* w)
 {
     foreach (const Data & d, windows) {
         if (d.window == w)
@@ -67,6 +67,7 @@ private slots:
     void slotWindowClosed(KWin::EffectWindow *w);
     void slotWindowGeometryShapeChanged(KWin::EffectWindow *w, const QRect &old);
     void slotWindowDamaged(KWin::EffectWindow* w, const QRect& damage);
+    void slotWindowThumbnailUpdated(KWin::EffectWindow* w);
     virtual bool isActive() const;
     void repaintAll();
 private:
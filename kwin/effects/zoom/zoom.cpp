@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "zoomconfig.h"
 
 #include <QVector2D>
+#include <QDBusConnection>
 #include <kaction.h>
 #include <kactioncollection.h>
 #include <kstandardaction.h>
@@ -100,12 +101,16 @@ ZoomEffect::ZoomEffect()
     connect(effects, SIGNAL(mouseChanged(QPoint,QPoint,Qt::MouseButtons,Qt::MouseButtons,Qt::KeyboardModifiers,Qt::KeyboardModifiers)),
             this, SLOT(slotMouseChanged(QPoint,QPoint,Qt::MouseButtons,Qt::MouseButtons,Qt::KeyboardModifiers,Qt::KeyboardModifiers)));
 
+    // zooming without the global shortcuts, e.g. for the benchmark
+    QDBusConnection::sessionBus().registerObject("/Effects/Zoom", this, QDBusConnection::ExportScriptableSlots);
+
     source_zoom = -1; // used to trigger initialZoom reading
     reconfigure(ReconfigureAll);
 }
 
 ZoomEffect::~ZoomEffect()
 {
+    QDBusConnection::sessionBus().unregisterObject("/Effects/Zoom");
     // switch off and free resources
     showCursor();
     // Save the zoom value.
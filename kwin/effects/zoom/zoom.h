@@ -37,6 +37,7 @@ class ZoomEffect
     : public Effect
 {
     Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.kde.kwin.Zoom")
     Q_PROPERTY(qreal zoomFactor READ configuredZoomFactor)
     Q_PROPERTY(int mousePointer READ configuredMousePointer)
     Q_PROPERTY(int mouseTracking READ configuredMouseTracking)
@@ -66,11 +67,12 @@ public:
     qreal targetZoom() const {
         return target_zoom;
     }
+public slots:
+    Q_SCRIPTABLE inline void zoomIn() { zoomIn(-1.0); };
+    Q_SCRIPTABLE void zoomOut();
+    Q_SCRIPTABLE void actualSize();
 private slots:
-    inline void zoomIn() { zoomIn(-1.0); };
     void zoomIn(double to);
-    void zoomOut();
-    void actualSize();
     void moveZoomLeft();
     void moveZoomRight();
     void moveZoomUp();
@@ -122,21 +122,16 @@ bool Workspace::workspaceEvent(XEvent * e)
         break;
     };
 
-    if (Client* c = findClient(WindowMatchPredicate(e->xany.window))) {
-        if (c->windowEvent(e))
-            return true;
-    } else if (Client* c = findClient(WrapperIdMatchPredicate(e->xany.window))) {
-        if (c->windowEvent(e))
-            return true;
-    } else if (Client* c = findClient(FrameIdMatchPredicate(e->xany.window))) {
-        if (c->windowEvent(e))
-            return true;
-    } else if (Client *c = findClient(InputIdMatchPredicate(e->xany.window))) {
-        if (c->windowEvent(e))
-            return true;
-    } else if (Unmanaged* c = findUnmanaged(WindowMatchPredicate(e->xany.window))) {
-        if (c->windowEvent(e))
+    // One lookup instead of trying the window, wrapper, frame and input window of every
+    // client and then every unmanaged window
+    WindowIndex::Role role;
+    if (Toplevel* t = m_windowIndex.find(e->xany.window, &role)) {
+        if (role == WindowIndex::UnmanagedRole) {
+            if (static_cast<Unmanaged*>(t)->windowEvent(e))
+                return true;
+        } else if (static_cast<Client*>(t)->windowEvent(e)) {
             return true;
+        }
     } else {
         Window special = findSpecialEventWindow(e);
         if (special != None)
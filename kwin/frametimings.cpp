@@ -0,0 +1,121 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "frametimings.h"
+
+namespace KWin
+{
+
+// the number of recent frames the cost of the next frame is predicted from
+static const int s_predictionFrames = 8;
+
+FrameTimings::FrameTimings()
+    : m_timings(Capacity)
+    , m_next(0)
+    , m_count(0)
+    , m_frames(0)
+    , m_missedFrames(0)
+    , m_culledPixels(0)
+    , m_requests(0)
+{
+}
+
+void FrameTimings::add(const FrameTiming &timing, qint64 interval)
+{
+    m_timings[m_next] = timing;
+    m_next = (m_next + 1) % Capacity;
+    if (m_count < Capacity) {
+        m_count++;
+    }
+    m_frames++;
+    if (timing.total > interval) {
+        m_missedFrames++;
+    }
+    m_culledPixels += timing.culledPixels;
+    m_requests += timing.requests;
+}
+
+void FrameTimings::clear()
+{
+    m_next = 0;
+    m_count = 0;
+    m_frames = 0;
+    m_missedFrames = 0;
+    m_culledPixels = 0;
+    m_requests = 0;
+}
+
+QVector<FrameTiming> FrameTimings::timings(int count) const
+{
+    QVector<FrameTiming> ret;
+    count = qBound(0, count, m_count);
+    ret.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        ret.append(at(i));
+    }
+    return ret;
+}
+
+qint64 FrameTimings::predictedCost() const
+{
+    if (m_count == 0) {
+        return -1;
+    }
+    // the most expensive of the recent frames, a single cheap frame in the middle of an
+    // animation does not mean the next one will be cheap as well
+    qint64 cost = 0;
+    const int count = qMin(m_count, s_predictionFrames);
+    for (int i = 0; i < count; ++i) {
+        cost = qMax(cost, at(i).total);
+    }
+    return cost;
+}
+
+QList<int> FrameTimings::histogram(Stage stage) const
+{
+    QVector<int> buckets(HistogramBuckets, 0);
+    for (int i = 0; i < m_count; ++i) {
+        const qint64 bucket = stageTime(at(i), stage) / (1000 * 1000);
+        buckets[qMin<qint64>(bucket, HistogramBuckets - 1)]++;
+    }
+    return buckets.toList();
+}
+
+qint64 FrameTimings::stageTime(const FrameTiming &timing, Stage stage)
+{
+    switch (stage) {
+    case PrePaintStage:
+        return timing.prePaint;
+    case PaintStage:
+        return timing.paint;
+    case WindowsStage:
+        return timing.windows;
+    case PostPaintStage:
+        return timing.postPaint;
+    case PresentStage:
+        return timing.present;
+    case SlowestWindowStage:
+        return timing.slowestWindow;
+    case TotalStage:
+    default:
+        return timing.total;
+    }
+}
+
+} // namespace
@@ -0,0 +1,140 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_FRAMETIMINGS_H
+#define KWIN_FRAMETIMINGS_H
+
+#include <kwineffects.h>
+
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * @brief Remembers the FrameTiming of the last frames painted by the Compositor.
+ *
+ * The timings are kept in a ring buffer of a fixed size, so adding a frame never allocates.
+ * Besides that the number of frames and the number of frames which took longer than the
+ * interval they were painted for are counted.
+ */
+class FrameTimings
+{
+public:
+    enum Stage {
+        PrePaintStage,
+        PaintStage,
+        WindowsStage,
+        PostPaintStage,
+        PresentStage,
+        TotalStage,
+        SlowestWindowStage ///< the slowest window of each frame
+    };
+    enum {
+        Capacity = 256,
+        HistogramBuckets = 51 ///< one bucket per millisecond and one for everything longer
+    };
+    FrameTimings();
+
+    /**
+     * Adds the @p timing of a frame which should have been painted in @p interval nanoseconds.
+     */
+    void add(const FrameTiming &timing, qint64 interval);
+    void clear();
+
+    /**
+     * @returns The number of remembered frames, at most Capacity.
+     */
+    int count() const;
+    /**
+     * @returns The timing of the @p frame-th last frame, 0 is the most recent one.
+     */
+    const FrameTiming &at(int frame) const;
+    /**
+     * @returns Up to @p count remembered timings, the most recent first.
+     */
+    QVector<FrameTiming> timings(int count) const;
+    /**
+     * @returns How long the next frame is expected to take in nanoseconds, @c -1 if
+     * nothing has been painted yet.
+     */
+    qint64 predictedCost() const;
+    /**
+     * @returns How many of the remembered frames spent the given time in @p stage, in
+     * buckets of one millisecond.
+     */
+    QList<int> histogram(Stage stage) const;
+
+    quint64 frames() const;
+    quint64 missedFrames() const;
+    /**
+     * @returns The number of window pixels the occlusion culling saved from being painted
+     * in all frames.
+     */
+    quint64 culledPixels() const;
+    /**
+     * @returns The number of X requests sent for all frames.
+     */
+    quint64 requests() const;
+
+    static qint64 stageTime(const FrameTiming &timing, Stage stage);
+
+private:
+    QVector<FrameTiming> m_timings;
+    int m_next;
+    int m_count;
+    quint64 m_frames;
+    quint64 m_missedFrames;
+    quint64 m_culledPixels;
+    quint64 m_requests;
+};
+
+inline int FrameTimings::count() const
+{
+    return m_count;
+}
+
+inline const FrameTiming &FrameTimings::at(int frame) const
+{
+    return m_timings.at((m_next - 1 - frame + Capacity) % Capacity);
+}
+
+inline quint64 FrameTimings::frames() const
+{
+    return m_frames;
+}
+
+inline quint64 FrameTimings::missedFrames() const
+{
+    return m_missedFrames;
+}
+
+inline quint64 FrameTimings::culledPixels() const
+{
+    return m_culledPixels;
+}
+
+inline quint64 FrameTimings::requests() const
+{
+    return m_requests;
+}
+
+} // namespace
+
+#endif
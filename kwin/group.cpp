@@ -584,9 +584,19 @@ bool Client::sameAppWindowRoleMatch(const Client* c1, const Client* c2, bool act
 */
 
 void Client::readTransient()
+{
+    Xcb::TransientFor transientFor = fetchTransient();
+    readTransient(transientFor);
+}
+
+Xcb::TransientFor Client::fetchTransient() const
+{
+    return Xcb::TransientFor(window());
+}
+
+void Client::readTransient(Xcb::TransientFor &transientFor)
 {
     TRANSIENCY_CHECK(this);
-    Xcb::TransientFor transientFor(window());
     xcb_window_t new_transient_for_id = XCB_WINDOW_NONE;
     if (transientFor.getTransientFor(&new_transient_for_id)) {
         m_originalTransientForId = new_transient_for_id;
@@ -587,6 +587,35 @@ void Effect::setPositionTransformations(WindowPaintData& data, QRect& region, Ef
     data.setYTranslation(y - w->y());
 }
 
+bool Effect::drawWindowThumbnail(EffectWindow* w, const QRect& r, Qt::AspectRatioMode aspect,
+                                 qreal opacity)
+{
+    QSize size = w->size();
+    size.scale(r.size(), aspect);
+    if (size.isEmpty()) {
+        return true;
+    }
+    QSize thumbnailSize;
+    const xcb_render_picture_t picture = effects->windowThumbnail(w, size, &thumbnailSize);
+    if (picture == XCB_RENDER_PICTURE_NONE) {
+        return false;
+    }
+    // the snapshot is at most twice as large, the filter of it takes care of the rest
+    const xcb_render_transform_t transform = {
+        xcb_render_fixed_t(65536 * thumbnailSize.width() / double(size.width())), 0, 0,
+        0, xcb_render_fixed_t(65536 * thumbnailSize.height() / double(size.height())), 0,
+        0, 0, 65536
+    };
+    const int x = r.x() + (r.width() - size.width()) / 2;
+    const int y = r.y() + (r.height() - size.height()) / 2;
+    xcb_render_set_picture_transform(connection(), picture, transform);
+    xcb_render_composite(connection(), XCB_RENDER_PICT_OP_OVER, picture,
+                         opacity < 1.0 ? xcb_render_picture_t(xRenderBlendPicture(opacity)) : XCB_RENDER_PICTURE_NONE,
+                         effects->xrenderBufferPicture(), 0, 0, 0, 0, x, y, size.width(), size.height());
+    xcb_render_set_picture_transform(connection(), picture, xRenderIdentityTransform());
+    return true;
+}
+
 int Effect::displayWidth()
 {
     return KWin::displayWidth();
@@ -1218,8 +1247,8 @@ PaintClipper::Iterator::Iterator()
 {
 #ifdef KWIN_BUILD_COMPOSITE
     if (clip() && effects->compositingType() == XRenderCompositing) {
-        XFixesRegion region(paintArea());
-        xcb_xfixes_set_picture_clip_region(connection(), effects->xrenderBufferPicture(), region, 0, 0);
+        // every painted window goes through here, so this is kept to a single request
+        xRenderSetPictureClip(effects->xrenderBufferPicture(), paintArea());
     }
 #endif
 }
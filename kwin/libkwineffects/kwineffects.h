@@ -65,6 +65,7 @@ class WindowPrePaintData;
 class WindowPaintData;
 class ScreenPrePaintData;
 class ScreenPaintData;
+class FrameTiming;
 
 typedef QPair< QString, Effect* > EffectPair;
 typedef QList< KWin::EffectWindow* > EffectWindowList;
@@ -165,7 +166,7 @@ X-KDE-Library=kwin4_effect_cooleffect
 
 #define KWIN_EFFECT_API_MAKE_VERSION( major, minor ) (( major ) << 8 | ( minor ))
 #define KWIN_EFFECT_API_VERSION_MAJOR 0
-#define KWIN_EFFECT_API_VERSION_MINOR 224
+#define KWIN_EFFECT_API_VERSION_MINOR 230
 #define KWIN_EFFECT_API_VERSION KWIN_EFFECT_API_MAKE_VERSION( \
         KWIN_EFFECT_API_VERSION_MAJOR, KWIN_EFFECT_API_VERSION_MINOR )
 
@@ -485,6 +486,13 @@ public:
      **/
     static void setPositionTransformations(WindowPaintData& data, QRect& region, EffectWindow* w,
                                            const QRect& r, Qt::AspectRatioMode aspect);
+    /** Helper to paint the snapshot of @p w at the requested geometry, which is much cheaper
+     * than painting the window itself, see EffectsHandler::windowThumbnail().
+     * @returns @c false if there is no snapshot, then the window has to be painted with
+     * setPositionTransformations() and drawWindow()
+     **/
+    static bool drawWindowThumbnail(EffectWindow* w, const QRect& r, Qt::AspectRatioMode aspect,
+                                    qreal opacity);
 
 public Q_SLOTS:
     virtual bool borderActivated(ElectricBorder border);
@@ -731,6 +739,28 @@ public:
 
     CompositingType compositingType() const;
     virtual unsigned long xrenderBufferPicture() = 0;
+    /**
+     * Painting a window as a small thumbnail with drawWindow() scales the whole window in every
+     * frame. Instead KWin keeps downscaled snapshots of the window including its decoration,
+     * which are updated from the damage of the window a few times per second at most.
+     *
+     * @returns The picture of the smallest snapshot of @p w which is at least @p size large,
+     * its size is stored in @p thumbnailSize. @c 0 if there is no such snapshot, e.g. because
+     * @p size is more than half the size of the window, then drawWindow() has to be used.
+     * @see windowThumbnailUpdated
+     **/
+    virtual unsigned long windowThumbnail(EffectWindow *w, const QSize &size, QSize *thumbnailSize) = 0;
+    /**
+     * @returns Whether windowThumbnail() would return a snapshot of @p w which is there already.
+     * Unlike windowThumbnail() this does not create, update or keep the snapshots, e.g. to tell
+     * whether a damage of the window needs a repaint or windowThumbnailUpdated will follow.
+     **/
+    virtual bool hasWindowThumbnail(EffectWindow *w, const QSize &size) const = 0;
+    /**
+     * @returns The timings of up to @p count of the last frames painted by the compositor,
+     * the most recent frame first.
+     **/
+    virtual QVector<FrameTiming> frameTimings(int count) const = 0;
     virtual void reconfigure() = 0;
 
     /**
@@ -981,6 +1011,13 @@ Q_SIGNALS:
      * @since 4.7
      **/
     void windowDamaged(KWin::EffectWindow *w, const QRect &r);
+    /**
+     * Signal emitted when the snapshots of a window were updated, effects painting them have
+     * to repaint.
+     * @param w The window whose snapshots changed
+     * @see windowThumbnail
+     **/
+    void windowThumbnailUpdated(KWin::EffectWindow *w);
     /**
      * Signal emitted when mouse changed.
      * If an effect needs to get updated mouse positions, it needs to first call @link startMousePolling.
@@ -1994,6 +2031,32 @@ public:
     QRegion paint;
 };
 
+/**
+ * @short The time the compositor spent in the stages of painting one frame.
+ *
+ * All times are in nanoseconds. The time spent in the effects is the part of
+ * paint which is not spent in windows.
+ **/
+class KWIN_EXPORT FrameTiming
+{
+public:
+    FrameTiming()
+        : prePaint(0), paint(0), windows(0), windowCount(0), slowestWindow(0), slowestWindowId(0)
+        , culledWindows(0), culledPixels(0), postPaint(0), present(0), total(0), requests(0) {}
+    qint64 prePaint; ///< prePaintScreen() and prePaintWindow() of all windows
+    qint64 paint; ///< paintScreen(), including windows
+    qint64 windows; ///< painting the windows
+    int windowCount; ///< the number of painted windows
+    qint64 slowestWindow; ///< the longest time spent painting a single window
+    WId slowestWindowId; ///< the window which took slowestWindow to paint, 0 if none was painted
+    int culledWindows; ///< the number of windows completely hidden by opaque windows above
+    qint64 culledPixels; ///< the pixels of windows which were not painted because they are hidden
+    qint64 postPaint; ///< postPaintWindow() of all windows and postPaintScreen()
+    qint64 present; ///< copying the frame to the screen and flushing the requests
+    qint64 total; ///< the whole frame
+    quint32 requests; ///< the number of X requests sent for the frame
+};
+
 /**
  * @short Helper class for restricting painting area only to allowed area.
  *
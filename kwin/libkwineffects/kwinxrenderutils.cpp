@@ -25,6 +25,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QPixmap>
 #include <kdebug.h>
 
+#include <string.h>
+
 namespace KWin
 {
 
@@ -67,16 +69,95 @@ XRenderPicture xRenderBlendPicture(double opacity)
 {
     static XRenderPicture s_blendPicture(XCB_RENDER_PICTURE_NONE);
     static xcb_render_color_t s_blendColor = {0, 0, 0, 0};
-    s_blendColor.alpha = uint16_t(opacity * 0xffff);
+    const uint16_t alpha = uint16_t(opacity * 0xffff);
     if (s_blendPicture == XCB_RENDER_PICTURE_NONE) {
+        s_blendColor.alpha = alpha;
         s_blendPicture = xRenderFill(s_blendColor);
-    } else {
+    } else if (s_blendColor.alpha != alpha) {
+        // every window asks for it several times per frame, mostly with the same opacity
+        s_blendColor.alpha = alpha;
         xcb_rectangle_t rect = {0, 0, 1, 1};
         xcb_render_fill_rectangles(connection(), XCB_RENDER_PICT_OP_SRC, s_blendPicture, s_blendColor, 1, &rect);
     }
     return s_blendPicture;
 }
 
+const xcb_render_transform_t &xRenderIdentityTransform()
+{
+    // 1.0 in the 16.16 fixed point format of the Render extension
+    static const xcb_render_fixed_t one = 1 << 16;
+    static const xcb_render_transform_t identity = {
+        one, 0, 0,
+        0, one, 0,
+        0, 0, one
+    };
+    return identity;
+}
+
+void xRenderSetPictureClip(xcb_render_picture_t picture, const QRegion &region)
+{
+    const QVector<QRect> rects = region.rects();
+    QVector<xcb_rectangle_t> xrects(rects.count());
+    for (int i = 0; i < rects.count(); ++i) {
+        const QRect &rect = rects.at(i);
+        xcb_rectangle_t &xrect = xrects[i];
+        xrect.x = rect.x();
+        xrect.y = rect.y();
+        xrect.width = rect.width();
+        xrect.height = rect.height();
+    }
+    xcb_render_set_picture_clip_rectangles(connection(), picture, 0, 0, xrects.count(), xrects.constData());
+}
+
+XRenderPictureState::XRenderPictureState(xcb_render_picture_t picture)
+{
+    setPicture(picture);
+}
+
+void XRenderPictureState::setPicture(xcb_render_picture_t picture)
+{
+    m_picture = picture;
+    m_transformKnown = false;
+    m_filter = NULL;
+    m_repeat = XCB_RENDER_REPEAT_NONE;
+    m_repeatKnown = false;
+}
+
+xcb_render_picture_t XRenderPictureState::picture() const
+{
+    return m_picture;
+}
+
+void XRenderPictureState::setTransform(const xcb_render_transform_t &transform)
+{
+    if (m_transformKnown && memcmp(&m_transform, &transform, sizeof(transform)) == 0) {
+        return;
+    }
+    xcb_render_set_picture_transform(connection(), m_picture, transform);
+    m_transform = transform;
+    m_transformKnown = true;
+}
+
+void XRenderPictureState::setFilter(const char *filter)
+{
+    if (m_filter && qstrcmp(m_filter, filter) == 0) {
+        return;
+    }
+    xcb_render_set_picture_filter(connection(), m_picture, qstrlen(filter), filter, 0, NULL);
+    m_filter = filter;
+}
+
+void XRenderPictureState::setRepeat(uint32_t repeat)
+{
+    if (m_repeatKnown && m_repeat == repeat) {
+        return;
+    }
+    const uint32_t values[] = {repeat};
+    xcb_render_change_picture(connection(), m_picture, XCB_RENDER_CP_REPEAT, values);
+    m_repeat = repeat;
+    m_repeatKnown = true;
+}
+
 static xcb_render_picture_t createPicture(xcb_pixmap_t pix, int depth)
 {
     if (pix == XCB_PIXMAP_NONE)
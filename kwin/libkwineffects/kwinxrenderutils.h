@@ -86,6 +86,40 @@ private:
     xcb_xfixes_region_t m_region;
 };
 
+/**
+ * @short Remembers the transformation, filter and repeat mode of a picture.
+ *
+ * Setting any of them to the value the picture already has does not send a request, so a
+ * picture which is painted the same way in every frame costs no requests for its setup.
+ * The state is only correct as long as the picture is changed through this class.
+ */
+class KWIN_EXPORT XRenderPictureState
+{
+public:
+    explicit XRenderPictureState(xcb_render_picture_t picture = XCB_RENDER_PICTURE_NONE);
+    /**
+     * Starts tracking @p picture, nothing is known about its state yet.
+     */
+    void setPicture(xcb_render_picture_t picture);
+    xcb_render_picture_t picture() const;
+
+    void setTransform(const xcb_render_transform_t &transform);
+    /**
+     * @param filter One of the filter names of the Render extension, e.g. "fast" or "good".
+     * It has to stay valid as long as it is the filter of the picture.
+     */
+    void setFilter(const char *filter);
+    void setRepeat(uint32_t repeat);
+
+private:
+    xcb_render_picture_t m_picture;
+    xcb_render_transform_t m_transform;
+    bool m_transformKnown;
+    const char *m_filter;
+    uint32_t m_repeat;
+    bool m_repeatKnown;
+};
+
 inline
 XRenderPictureData::XRenderPictureData(xcb_render_picture_t pic)
     : picture(pic)
@@ -154,6 +188,15 @@ XFixesRegion::operator xcb_xfixes_region_t()
  * Call and Use, the PixelPicture will stay, but may change it's opacity meanwhile. It's NOT threadsafe either
  */
 KWIN_EXPORT XRenderPicture xRenderBlendPicture(double opacity);
+/**
+ * @returns The identity transformation matrix
+ */
+KWIN_EXPORT const xcb_render_transform_t &xRenderIdentityTransform();
+/**
+ * Clips @p picture to @p region with a single request, going through an XFixesRegion takes
+ * three of them (create, set and destroy).
+ */
+KWIN_EXPORT void xRenderSetPictureClip(xcb_render_picture_t picture, const QRegion &region);
 /**
  * Creates a 1x1 Picture filled with c
  */
@@ -49,6 +49,9 @@ bool Client::manage(xcb_window_t w, bool isMapped)
 {
     StackingUpdatesBlocker stacking_blocker(workspace());
 
+    const quint64 roundTrips = Xcb::roundTrips();
+    const unsigned long firstRequest = XNextRequest(display());
+
     grabXServer();
 
     XWindowAttributes attr;
@@ -66,14 +69,22 @@ bool Client::manage(xcb_window_t w, bool isMapped)
     vis = attr.visual;
     bit_depth = attr.depth;
 
+    // Request all the properties which are read below at once, so that the server is
+    // grabbed for a single round trip instead of one for each property
+    Xcb::Property resourceClassProperty = fetchResourceClass();
+    Xcb::Property windowRoleProperty = fetchWindowRole();
+    Xcb::Property clientLeaderProperty = fetchWmClientLeader();
+    Xcb::Property syncCounterProperty = fetchSyncCounter();
+    Xcb::Property wmHintsProperty = fetchWMHints();
+    Xcb::TransientFor transientForProperty = fetchTransient();
+    Xcb::Property protocolsProperty = fetchWindowProtocols();
+    Xcb::Property motifHintsProperty = fetchMotifHints();
+    Xcb::Property opaqueRegionProperty = fetchWmOpaqueRegion();
+    Xcb::Property skipCloseAnimationProperty = fetchSkipCloseAnimation();
+
     // SELI TODO: Order all these things in some sane manner
 
-    bool init_minimize = false;
-    XWMHints* hints = XGetWMHints(display(), w);
-    if (hints && (hints->flags & StateHint) && hints->initial_state == IconicState)
-        init_minimize = true;
-    if (hints)
-        XFree(hints);
+    bool init_minimize = readWMHintsIconic(wmHintsProperty);
     if (isMapped)
         init_minimize = false; // If it's already mapped, ignore hint
 
@@ -102,11 +113,11 @@ bool Client::manage(xcb_window_t w, bool isMapped)
 
     m_colormap = attr.colormap;
 
-    getResourceClass();
-    getWindowRole();
-    getWmClientLeader();
+    readResourceClass(resourceClassProperty);
+    readWindowRole(windowRoleProperty);
+    readWmClientLeader(clientLeaderProperty);
     getWmClientMachine();
-    getSyncCounter();
+    readSyncCounter(syncCounterProperty);
     // First only read the caption text, so that setupWindowRules() can use it for matching,
     // and only then really set the caption using setCaption(), which checks for duplicates etc.
     // and also relies on rules already existing
@@ -119,15 +130,15 @@ bool Client::manage(xcb_window_t w, bool isMapped)
     detectShape(window());
     detectNoBorder();
     fetchIconicName();
-    getWMHints(); // Needs to be done before readTransient() because of reading the group
+    readWMHints(wmHintsProperty); // Needs to be done before readTransient() because of reading the group
     modal = (info->state() & NET::Modal) != 0;   // Needs to be valid before handling groups
-    readTransient();
+    readTransient(transientForProperty);
     getIcons();
-    getWindowProtocols();
+    readWindowProtocols(protocolsProperty);
     getWmNormalHints(); // Get xSizeHint
-    getMotifHints();
-    getWmOpaqueRegion();
-    getSkipCloseAnimation();
+    readMotifHints(motifHintsProperty);
+    readWmOpaqueRegion(opaqueRegionProperty);
+    readSkipCloseAnimation(skipCloseAnimationProperty);
 
     // TODO: Try to obey all state information from info->state()
 
@@ -583,6 +594,10 @@ bool Client::manage(xcb_window_t w, bool isMapped)
 
     ungrabXServer();
 
+    kDebug(1212) << "Managed" << window() << "with" << (Xcb::roundTrips() - roundTrips)
+                 << "blocking property round trips and"
+                 << (XNextRequest(display()) - firstRequest) << "requests";
+
     client_rules.discardTemporary();
     applyWindowRules(); // Just in case
     RuleBook::self()->discardUsed(this, false);   // Remove ApplyNow rules
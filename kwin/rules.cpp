@@ -188,6 +188,15 @@ void Rules::readFromCfg(const KConfigGroup& cfg)
     READ_SET_RULE(shortcut, , QString());
     READ_FORCE_RULE(disableglobalshortcuts, , false);
     READ_SET_RULE(demandattention, , false);
+    compileMatches();
+}
+
+void Rules::compileMatches()
+{
+    wmclassregexp = wmclassmatch == RegExpMatch ? QRegExp(wmclass) : QRegExp();
+    windowroleregexp = windowrolematch == RegExpMatch ? QRegExp(windowrole) : QRegExp();
+    titleregexp = titlematch == RegExpMatch ? QRegExp(title) : QRegExp();
+    clientmachineregexp = clientmachinematch == RegExpMatch ? QRegExp(clientmachine) : QRegExp();
 }
 
 void Rules::loadRules(QList< Rules* >& rules)
@@ -422,10 +431,9 @@ bool Rules::matchType(NET::WindowType match_type) const
 bool Rules::matchWMClass(const QByteArray& match_class, const QByteArray& match_name) const
 {
     if (wmclassmatch != UnimportantMatch) {
-        // TODO optimize?
         QByteArray cwmclass = wmclasscomplete
                               ? match_name + ' ' + match_class : match_class;
-        if (wmclassmatch == RegExpMatch && QRegExp(wmclass).indexIn(cwmclass) == -1)
+        if (wmclassmatch == RegExpMatch && wmclassregexp.indexIn(cwmclass) == -1)
             return false;
         if (wmclassmatch == ExactMatch && wmclass != cwmclass)
             return false;
@@ -438,7 +446,7 @@ bool Rules::matchWMClass(const QByteArray& match_class, const QByteArray& match_
 bool Rules::matchRole(const QByteArray& match_role) const
 {
     if (windowrolematch != UnimportantMatch) {
-        if (windowrolematch == RegExpMatch && QRegExp(windowrole).indexIn(match_role) == -1)
+        if (windowrolematch == RegExpMatch && windowroleregexp.indexIn(match_role) == -1)
             return false;
         if (windowrolematch == ExactMatch && windowrole != match_role)
             return false;
@@ -451,7 +459,7 @@ bool Rules::matchRole(const QByteArray& match_role) const
 bool Rules::matchTitle(const QString& match_title) const
 {
     if (titlematch != UnimportantMatch) {
-        if (titlematch == RegExpMatch && QRegExp(title).indexIn(match_title) == -1)
+        if (titlematch == RegExpMatch && titleregexp.indexIn(match_title) == -1)
             return false;
         if (titlematch == ExactMatch && title != match_title)
             return false;
@@ -469,7 +477,7 @@ bool Rules::matchClientMachine(const QByteArray& match_machine, bool local) cons
                 && matchClientMachine("localhost", true))
             return true;
         if (clientmachinematch == RegExpMatch
-                && QRegExp(clientmachine).indexIn(match_machine) == -1)
+                && clientmachineregexp.indexIn(match_machine) == -1)
             return false;
         if (clientmachinematch == ExactMatch
                 && clientmachine != match_machine)
@@ -497,6 +505,14 @@ bool Rules::match(const Client* c) const
     return true;
 }
 
+QByteArray Rules::exactWMClass(bool* complete) const
+{
+    *complete = wmclasscomplete;
+    if (wmclassmatch != ExactMatch)
+        return QByteArray();
+    return wmclass;
+}
+
 #define NOW_REMEMBER(_T_, _V_) ((selection & _T_) && (_V_##rule == (SetRule)Remember))
 
 bool Rules::update(Client* c, int selection)
@@ -983,6 +999,7 @@ RuleBook::RuleBook(QObject *parent)
     : QObject(parent)
     , m_updateTimer(new QTimer(this))
     , m_updatesDisabled(false)
+    , m_indexDirty(true)
     , m_temporaryRulesMessages(new KXMessages("_KDE_NET_WM_TEMPORARY_RULES"))
 {
     connect(m_temporaryRulesMessages.data(), SIGNAL(gotMessage(QString)), SLOT(temporaryRulesMessage(QString)));
@@ -1001,29 +1018,63 @@ void RuleBook::deleteAll()
 {
     qDeleteAll(m_rules);
     m_rules.clear();
+    m_indexDirty = true;
+}
+
+void RuleBook::updateIndex()
+{
+    m_classIndex.clear();
+    m_completeClassIndex.clear();
+    m_anyClassRules.clear();
+    for (int i = 0; i < m_rules.count(); ++i) {
+        bool complete;
+        const QByteArray wmclass = m_rules.at(i)->exactWMClass(&complete);
+        if (wmclass.isEmpty())
+            m_anyClassRules.append(i);
+        else if (complete)
+            m_completeClassIndex[wmclass].append(i);
+        else
+            m_classIndex[wmclass].append(i);
+    }
+    m_indexDirty = false;
 }
 
 WindowRules RuleBook::find(const Client* c, bool ignore_temporary)
 {
+    if (m_indexDirty)
+        updateIndex();
+    // rules for another exact window class cannot match, the others are checked in their order
+    QVector<int> candidates = m_anyClassRules;
+    ClassIndex::ConstIterator it = m_classIndex.constFind(c->resourceClass());
+    if (it != m_classIndex.constEnd())
+        candidates += *it;
+    if (!m_completeClassIndex.isEmpty()) {
+        it = m_completeClassIndex.constFind(c->resourceName() + ' ' + c->resourceClass());
+        if (it != m_completeClassIndex.constEnd())
+            candidates += *it;
+    }
+    qSort(candidates);
+
     QVector< Rules* > ret;
-    for (QList< Rules* >::Iterator it = m_rules.begin();
-            it != m_rules.end();
-       ) {
-        if (ignore_temporary && (*it)->isTemporary()) {
-            ++it;
+    bool temporary = false;
+    foreach (int i, candidates) {
+        Rules* rule = m_rules.at(i);
+        if (ignore_temporary && rule->isTemporary())
             continue;
-        }
-        if ((*it)->match(c)) {
-            Rules* rule = *it;
+        if (rule->match(c)) {
             kDebug(1212) << "Rule found:" << rule << ":" << c;
             if (rule->isTemporary())
-                it = m_rules.erase(it);
-            else
-                ++it;
+                temporary = true;
             ret.append(rule);
-            continue;
         }
-        ++it;
+    }
+    if (temporary) {
+        // temporary rules are used only by the first window they match
+        foreach (Rules* rule, ret) {
+            if (rule->isTemporary())
+                m_rules.removeOne(rule);
+        }
+        m_indexDirty = true;
     }
     return WindowRules(ret);
 }
@@ -1060,6 +1111,7 @@ void RuleBook::temporaryRulesMessage(const QString& message)
             was_temporary = true;
     Rules* rule = new Rules(message, true);
     m_rules.prepend(rule);   // highest priority first
+    m_indexDirty = true;
     if (!was_temporary)
         QTimer::singleShot(60000, this, SLOT(cleanupTemporaryRules()));
 }
@@ -1072,6 +1124,7 @@ void RuleBook::cleanupTemporaryRules()
        ) {
         if ((*it)->discardTemporary(false)) { // deletes (*it)
             it = m_rules.erase(it);
+            m_indexDirty = true;
         } else {
             if ((*it)->isTemporary())
                 has_temporary = true;
@@ -1096,6 +1149,7 @@ void RuleBook::discardUsed(Client* c, bool withdrawn)
                 Rules* r = *it;
                 it = m_rules.erase(it);
                 delete r;
+                m_indexDirty = true;
                 continue;
             }
         }
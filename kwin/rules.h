@@ -23,7 +23,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
 #include <netwm_def.h>
+#include <QHash>
 #include <QRect>
+#include <QRegExp>
 #include <QTimer>
 #include <kconfiggroup.h>
 #include <kdebug.h>
@@ -124,6 +126,12 @@ public:
 #ifndef KCMRULES
     void discardUsed(bool withdrawn);
     bool match(const Client* c) const;
+    /**
+     * @returns The window class a window must have exactly for this rule to match, or an
+     * empty QByteArray if the rule can match windows of any class. @p complete is set if
+     * the class is to be compared with the resource name and class as "name class".
+     */
+    QByteArray exactWMClass(bool* complete) const;
     bool update(Client*, int selection);
     bool isTemporary() const;
     bool discardTemporary(bool force);   // removes if temporary and forced or too old
@@ -203,6 +211,7 @@ private:
     };
 
     void readFromCfg(const KConfigGroup& cfg);
+    void compileMatches();
     static SetRule readSetRule(const KConfigGroup&, const QString& key);
     static ForceRule readForceRule(const KConfigGroup&, const QString& key);
     static NET::WindowType readType(const KConfigGroup&, const QString& key);
@@ -225,6 +234,11 @@ private:
     StringMatch titlematch;
     QByteArray clientmachine;
     StringMatch clientmachinematch;
+    // the RegExpMatch patterns, compiled once when the rule is read
+    QRegExp wmclassregexp;
+    QRegExp windowroleregexp;
+    QRegExp titleregexp;
+    QRegExp clientmachineregexp;
     unsigned long types; // types for matching
     Placement::Policy placement;
     ForceRule placementrule;
@@ -318,9 +332,16 @@ private Q_SLOTS:
 
 private:
     void deleteAll();
+    void updateIndex();
     QTimer *m_updateTimer;
     bool m_updatesDisabled;
     QList<Rules*> m_rules;
+    // positions in m_rules of the rules which match only one exact window class and of all others
+    typedef QHash<QByteArray, QVector<int> > ClassIndex;
+    ClassIndex m_classIndex;
+    ClassIndex m_completeClassIndex;
+    QVector<int> m_anyClassRules;
+    bool m_indexDirty;
     QScopedPointer<KXMessages> m_temporaryRulesMessages;
 
     KWIN_SINGLETON(RuleBook)
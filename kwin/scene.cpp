@@ -59,6 +59,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
  finalPaintWindow() is called, which calls the window's performPaint() to
  do the actual painting.
 
+ Before any window is painted both of them run the occlusion culling pass,
+ cullOccludedWindows(), which removes the parts hidden by opaque windows
+ higher in the stacking order from the region of every window. Windows which
+ are transformed do not hide anything, and with a transformed screen
+ paintGenericScreen() does not cull at all.
+
  The post-paint can be used for cleanups and is also used for scheduling
  repaints during the next painting pass for animations. Effects wanting to
  repaint certain parts can manually damage them during post-paint and repaint
@@ -100,6 +106,24 @@ Scene::~Scene()
 {
 }
 
+// returns the nanoseconds since the timer was started and starts it again
+static qint64 restartTimer(QElapsedTimer &timer)
+{
+    const qint64 elapsed = timer.nsecsElapsed();
+    timer.restart();
+    return elapsed;
+}
+
+// returns the number of pixels in the region
+static qint64 regionArea(const QRegion &region)
+{
+    qint64 area = 0;
+    foreach (const QRect &rect, region.rects()) {
+        area += qint64(rect.width()) * rect.height();
+    }
+    return area;
+}
+
 // returns mask and possibly modified region
 void Scene::paintScreen(int* mask, const QRegion &damage, const QRegion &repaint,
                         QRegion *updateRegion, QRegion *validRegion)
@@ -107,6 +131,10 @@ void Scene::paintScreen(int* mask, const QRegion &damage, const QRegion &repaint
     const QRegion displayRegion(0, 0, displayWidth(), displayHeight());
     *mask = (damage == displayRegion) ? 0 : PAINT_SCREEN_REGION;
 
+    QElapsedTimer stageTimer;
+    stageTimer.start();
+    frame_timing = FrameTiming();
+
     updateTimeDiff();
     // preparation step
     static_cast<EffectsHandlerImpl*>(effects)->startPaint();
@@ -120,6 +148,7 @@ void Scene::paintScreen(int* mask, const QRegion &damage, const QRegion &repaint
     effects->prePaintScreen(pdata, time_diff);
     *mask = pdata.mask;
     region = pdata.paint;
+    frame_timing.prePaint = restartTimer(stageTimer);
 
     if (*mask & (PAINT_SCREEN_TRANSFORMED | PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS)) {
         // Region painting is not possible with transformations,
@@ -142,13 +171,18 @@ void Scene::paintScreen(int* mask, const QRegion &damage, const QRegion &repaint
     }
 
     ScreenPaintData data;
+    const qint64 screenPrePaint = frame_timing.prePaint;
     effects->paintScreen(*mask, region, data);
+    // the prePaintWindow() calls are done from within paintScreen(), they are added to
+    // prePaint by paintSimpleScreen() and paintGenericScreen()
+    frame_timing.paint = restartTimer(stageTimer) - (frame_timing.prePaint - screenPrePaint);
 
     foreach (Window *w, stacking_order) {
         effects->postPaintWindow(effectWindow(w));
     }
 
     effects->postPaintScreen();
+    frame_timing.postPaint = stageTimer.nsecsElapsed();
 
     // make sure not to go outside of the screen area
     *updateRegion = damaged_region;
@@ -199,10 +233,15 @@ void Scene::finalPaintScreen(int mask, QRegion region, ScreenPaintData& data)
 // It simply paints bottom-to-top.
 void Scene::paintGenericScreen(int orig_mask, ScreenPaintData)
 {
-    if (!(orig_mask & PAINT_SCREEN_BACKGROUND_FIRST)) {
+    // with a transformed screen the windows end up somewhere else, nothing can be culled
+    const bool cull = !(orig_mask & PAINT_SCREEN_TRANSFORMED);
+    if (!cull && !(orig_mask & PAINT_SCREEN_BACKGROUND_FIRST)) {
         paintBackground(infiniteRegion());
     }
+    QElapsedTimer stageTimer;
+    stageTimer.start();
     QList< Phase2Data > phase2;
+    bool opaqueFullscreen;
     foreach (Window * w, stacking_order) { // bottom to top
         Toplevel* topw = w->window();
 
@@ -215,7 +254,7 @@ void Scene::paintGenericScreen(int orig_mask, ScreenPaintData)
         data.mask = orig_mask | (w->isOpaque() ? PAINT_WINDOW_OPAQUE : PAINT_WINDOW_TRANSLUCENT);
         w->resetPaintingEnabled();
         data.paint = infiniteRegion(); // no clipping, so doesn't really matter
-        data.clip = QRegion();
+        data.clip = cull ? opaqueClip(w, &opaqueFullscreen) : QRegion();
         data.quads = w->buildQuads();
         // preparation step
         effects->prePaintWindow(effectWindow(w), data, time_diff);
@@ -233,9 +272,21 @@ void Scene::paintGenericScreen(int orig_mask, ScreenPaintData)
                              & (PAINT_WINDOW_TRANSLUCENT | PAINT_SCREEN_TRANSFORMED | PAINT_WINDOW_TRANSFORMED));
     }
 
+    if (cull) {
+        // transformed windows do not hide anything, but the ones which are not transformed
+        // still hide the parts of the screen below them
+        const QRegion allclips = cullOccludedWindows(phase2, QRegion(), true);
+        if (!(orig_mask & PAINT_SCREEN_BACKGROUND_FIRST)) {
+            paintBackground(QRegion(0, 0, displayWidth(), displayHeight()) - allclips);
+        }
+    }
+    frame_timing.prePaint += restartTimer(stageTimer);
+
     foreach (const Phase2Data & d, phase2) {
         paintWindow(d.window, d.mask, d.region, d.quads);
     }
+    frame_timing.windows += stageTimer.nsecsElapsed();
+    frame_timing.windowCount += phase2.count();
 
     damaged_region = QRegion(0, 0, displayWidth(), displayHeight());
 }
@@ -247,8 +298,10 @@ void Scene::paintSimpleScreen(int orig_mask, QRegion region)
 {
     assert((orig_mask & (PAINT_SCREEN_TRANSFORMED
                          | PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS)) == 0);
-    QList< QPair< Window*, Phase2Data > > phase2data;
+    QList< Phase2Data > phase2data;
 
+    QElapsedTimer stageTimer;
+    stageTimer.start();
     QRegion dirtyArea = region;
     bool opaqueFullscreen(false);
     foreach (Window *w, stacking_order) { // do prePaintWindow bottom to top
@@ -266,31 +319,7 @@ void Scene::paintSimpleScreen(int orig_mask, QRegion region)
         topw->resetRepaints();
 
         // Clip out the decoration for opaque windows; the decoration is drawn in the second pass
-        opaqueFullscreen = false; // TODO: do we care about unmanged windows here (maybe input windows?)
-        if (w->isOpaque()) {
-            Client *c = NULL;
-            if (topw->isClient()) {
-                c = static_cast<Client*>(topw);
-                opaqueFullscreen = c->isFullScreen();
-            }
-            // the window is fully opaque
-            if (c && c->decorationHasAlpha()) {
-                // decoration uses alpha channel, so we may not exclude it in clipping
-                data.clip = w->clientShape().translated(w->x(), w->y());
-            } else {
-                // decoration is fully opaque
-                if (c && c->isShade()) {
-                    data.clip = QRegion();
-                } else {
-                    data.clip = w->shape().translated(w->x(), w->y());
-                }
-            }
-        } else if (topw->hasAlpha() && topw->opacity() == 1.0) {
-            // the window is partially opaque
-            data.clip = (w->clientShape() & topw->opaqueRegion().translated(topw->clientPos())).translated(w->x(), w->y());
-        } else {
-            data.clip = QRegion();
-        }
+        data.clip = opaqueClip(w, &opaqueFullscreen);
         data.quads = w->buildQuads();
         // preparation step
         effects->prePaintWindow(effectWindow(w), data, time_diff);
@@ -305,11 +334,11 @@ void Scene::paintSimpleScreen(int orig_mask, QRegion region)
         }
         dirtyArea |= data.paint;
         // Schedule the window for painting
-        phase2data.append(QPair< Window*, Phase2Data >(w,Phase2Data(w, data.paint, data.clip,
-                                                                    data.mask, data.quads)));
+        phase2data.append(Phase2Data(w, data.paint, data.clip, data.mask, data.quads));
         // no transformations, but translucency requires window pixmap
         w->suspendUnredirect(data.mask & PAINT_WINDOW_TRANSLUCENT);
     }
+    frame_timing.prePaint += stageTimer.nsecsElapsed();
 
     // Save the part of the repaint region that's exclusively rendered to
     // bring a reused back buffer up to date. Then union the dirty region
@@ -324,35 +353,9 @@ void Scene::paintSimpleScreen(int orig_mask, QRegion region)
         fullRepaint = (dirtyArea == displayRegion);
     }
 
-    QRegion allclips, upperTranslucentDamage;
-    upperTranslucentDamage = repaint_region;
-
-    // This is the occlusion culling pass
-    for (int i = phase2data.count() - 1; i >= 0; --i) {
-        QPair< Window*, Phase2Data > *entry = &phase2data[i];
-        Phase2Data *data = &entry->second;
-
-        if (fullRepaint)
-            data->region = displayRegion;
-        else
-            data->region |= upperTranslucentDamage;
-
-        // subtract the parts which will possibly been drawn as part of
-        // a higher opaque window
-        data->region -= allclips;
-
-        // Here we rely on WindowPrePaintData::setTranslucent() to remove
-        // the clip if needed.
-        if (!data->clip.isEmpty() && !(data->mask & PAINT_WINDOW_TRANSFORMED)) {
-            // clip away the opaque regions for all windows below this one
-            allclips |= data->clip;
-            // extend the translucent damage for windows below this by remaining (translucent) regions
-            if (!fullRepaint)
-                upperTranslucentDamage |= data->region - data->clip;
-        } else if (!fullRepaint) {
-            upperTranslucentDamage |= data->region;
-        }
-    }
+    stageTimer.restart();
+    const QRegion allclips = cullOccludedWindows(phase2data, repaint_region, fullRepaint);
+    frame_timing.prePaint += stageTimer.nsecsElapsed();
 
     QRegion paintedArea;
     // Fill any areas of the root window not covered by opaque windows
@@ -362,8 +365,9 @@ void Scene::paintSimpleScreen(int orig_mask, QRegion region)
     }
 
     // Now walk the list bottom to top and draw the windows.
+    stageTimer.restart();
     for (int i = 0; i < phase2data.count(); ++i) {
-        Phase2Data *data = &phase2data[i].second;
+        Phase2Data *data = &phase2data[i];
 
         // add all regions which have been drawn so far
         paintedArea |= data->region;
@@ -371,6 +375,8 @@ void Scene::paintSimpleScreen(int orig_mask, QRegion region)
 
         paintWindow(data->window, data->mask, data->region, data->quads);
     }
+    frame_timing.windows += stageTimer.nsecsElapsed();
+    frame_timing.windowCount += phase2data.count();
 
     if (fullRepaint) {
         painted_region = displayRegion;
@@ -388,6 +394,79 @@ void Scene::paintSimpleScreen(int orig_mask, QRegion region)
     }
 }
 
+QRegion Scene::opaqueClip(Window *w, bool *opaqueFullscreen) const
+{
+    Toplevel* topw = w->window();
+    *opaqueFullscreen = false; // TODO: do we care about unmanged windows here (maybe input windows?)
+    if (w->isOpaque()) {
+        Client *c = NULL;
+        if (topw->isClient()) {
+            c = static_cast<Client*>(topw);
+            *opaqueFullscreen = c->isFullScreen();
+        }
+        // the window is fully opaque
+        if (c && c->decorationHasAlpha()) {
+            // decoration uses alpha channel, so we may not exclude it in clipping
+            return w->clientShape().translated(w->x(), w->y());
+        }
+        // decoration is fully opaque
+        if (c && c->isShade()) {
+            return QRegion();
+        }
+        return w->shape().translated(w->x(), w->y());
+    } else if (topw->hasAlpha() && topw->opacity() == 1.0) {
+        // the window is partially opaque
+        return (w->clientShape() & topw->opaqueRegion().translated(topw->clientPos())).translated(w->x(), w->y());
+    }
+    return QRegion();
+}
+
+QRegion Scene::cullOccludedWindows(QList<Phase2Data> &phase2, const QRegion &repaint, bool fullRepaint)
+{
+    const QRegion displayRegion(0, 0, displayWidth(), displayHeight());
+    QRegion allclips, upperTranslucentDamage;
+    upperTranslucentDamage = repaint;
+
+    for (int i = phase2.count() - 1; i >= 0; --i) {
+        Phase2Data *data = &phase2[i];
+
+        if (fullRepaint)
+            data->region = displayRegion;
+        else
+            data->region |= upperTranslucentDamage;
+
+        // subtract the parts which will possibly been drawn as part of
+        // a higher opaque window
+        if (!allclips.isEmpty()) {
+            if (!(data->mask & PAINT_WINDOW_TRANSFORMED)) {
+                // where a transformed window ends up is not known, only count the others
+                const QRegion visible = data->region & data->window->window()->visibleRect();
+                const QRegion culled = visible & allclips;
+                if (!culled.isEmpty()) {
+                    frame_timing.culledPixels += regionArea(culled);
+                    if (culled == visible) {
+                        frame_timing.culledWindows++;
+                    }
+                }
+            }
+            data->region -= allclips;
+        }
+
+        // Here we rely on WindowPrePaintData::setTranslucent() to remove
+        // the clip if needed.
+        if (!data->clip.isEmpty() && !(data->mask & PAINT_WINDOW_TRANSFORMED)) {
+            // clip away the opaque regions for all windows below this one
+            allclips |= data->clip;
+            // extend the translucent damage for windows below this by remaining (translucent) regions
+            if (!fullRepaint)
+                upperTranslucentDamage |= data->region - data->clip;
+        } else if (!fullRepaint) {
+            upperTranslucentDamage |= data->region;
+        }
+    }
+    return allclips;
+}
+
 static Scene::Window *s_recursionCheck = NULL;
 
 void Scene::paintWindow(Window* w, int mask, QRegion region, WindowQuadList quads)
@@ -407,7 +486,15 @@ void Scene::paintWindow(Window* w, int mask, QRegion region, WindowQuadList quad
 
     WindowPaintData data(w->window()->effectWindow());
     data.quads = quads;
+    QElapsedTimer timer;
+    timer.start();
     effects->paintWindow(effectWindow(w), mask, region, data);
+    const qint64 time = timer.nsecsElapsed();
+    w->addPaintTime(time);
+    if (time > frame_timing.slowestWindow) {
+        frame_timing.slowestWindow = time;
+        frame_timing.slowestWindowId = w->window()->window();
+    }
 }
 
 void Scene::paintDesktop(int desktop, int mask, const QRegion &region, ScreenPaintData &data)
@@ -450,6 +537,7 @@ Scene::Window::Window(Toplevel * c)
     , m_previousPixmap()
     , m_referencePixmapCounter(0)
     , disable_painting(0)
+    , m_averagePaintTime(-1)
     , shape_valid(false)
     , cached_quad_list(NULL)
 {
@@ -461,6 +549,21 @@ Scene::Window::~Window()
     delete m_shadow;
 }
 
+qint64 Scene::Window::averagePaintTime() const
+{
+    return m_averagePaintTime;
+}
+
+void Scene::Window::addPaintTime(qint64 time)
+{
+    // a moving average, so a single slow frame does not stick to the window forever
+    if (m_averagePaintTime < 0) {
+        m_averagePaintTime = time;
+    } else {
+        m_averagePaintTime += (time - m_averagePaintTime) / 8;
+    }
+}
+
 void Scene::Window::referencePreviousPixmap()
 {
     if (!m_previousPixmap.isNull() && m_previousPixmap->isDiscarded()) {
@@ -61,6 +61,10 @@ public:
     // returns the time since the last vblank signal - if there's one
     // ie. "what of this frame is lost to painting"
     virtual qint64 paint(QRegion damage, ToplevelList windows) = 0;
+    // the time spent in the stages of the last paint()
+    const FrameTiming &frameTiming() const {
+        return frame_timing;
+    }
 
     // Notification function - KWin core informs about changes.
     // Used to mainly discard cached data.
@@ -153,6 +157,11 @@ protected:
         int mask;
         WindowQuadList quads;
     };
+    // the opaque part of the window in screen coordinates, which hides the windows below it
+    QRegion opaqueClip(Window *w, bool *opaqueFullscreen) const;
+    // the occlusion culling pass, removes the parts hidden by opaque windows above from the
+    // regions of the windows in phase2 (bottom to top), returns the union of the opaque parts
+    QRegion cullOccludedWindows(QList<Phase2Data> &phase2, const QRegion &repaint, bool fullRepaint);
     // windows in their stacking order
     QVector< Window* > stacking_order;
     // The region which actually has been painted by paintScreen() and should be
@@ -168,6 +177,8 @@ protected:
     // time since last repaint
     int time_diff;
     QElapsedTimer last_time;
+    // the timing of the frame being painted, paint() has to set present and total
+    FrameTiming frame_timing;
 };
 
 // The base class for windows representations in composite backends
@@ -226,6 +237,10 @@ public:
     Shadow* shadow();
     void referencePreviousPixmap();
     void unreferencePreviousPixmap();
+    // the time spent painting the window in nanoseconds, weighted towards the last frames,
+    // -1 if the window has not been painted yet
+    qint64 averagePaintTime() const;
+    void addPaintTime(qint64 time);
 protected:
     WindowQuadList makeQuads(WindowQuadType type, const QRegion& reg) const;
     WindowQuadList makeDecorationQuads(const QRect *rects, const QRegion &region) const;
@@ -261,6 +276,7 @@ private:
     QScopedPointer<WindowPixmap> m_previousPixmap;
     int m_referencePixmapCounter;
     int disable_painting;
+    qint64 m_averagePaintTime;
     mutable QRegion shape_region;
     mutable bool shape_valid;
     mutable WindowQuadList* cached_quad_list;
@@ -50,6 +50,14 @@ namespace KWin
 
 xcb_render_picture_t SceneXrender::buffer = XCB_RENDER_PICTURE_NONE;
 ScreenPaintData SceneXrender::screen_paint;
+ShadowCache *SceneXrender::s_shadowCache = NULL;
+
+// the snapshots of the windows are updated at most 10 times per second
+static const int s_thumbnailInterval = 100;
+// snapshots which were not asked for that long are freed
+static const int s_thumbnailExpiry = 30 * 1000;
+// no snapshots smaller than that
+static const int s_minimumThumbnailSize = 16;
 
 static xcb_render_pictformat_t findFormatForVisual(xcb_visualid_t visual)
 {
@@ -102,6 +110,9 @@ SceneXrender::SceneXrender(Workspace* ws)
         kError(1212) << "No XFixes v3+ extension available";
         return;
     }
+    s_shadowCache = new ShadowCache();
+    m_thumbnailTimer.setSingleShot(true);
+    connect(&m_thumbnailTimer, SIGNAL(timeout()), SLOT(updateThumbnails()));
     initXRender(true);
 }
 
@@ -121,6 +132,79 @@ SceneXrender::~SceneXrender()
     foreach (Window * w, windows)
         delete w;
     delete m_overlayWindow;
+    // the shadows of the windows are gone, free the pictures they shared
+    delete s_shadowCache;
+    s_shadowCache = NULL;
+}
+
+ShadowCache *SceneXrender::shadowCache()
+{
+    return s_shadowCache;
+}
+
+xcb_render_picture_t SceneXrender::windowThumbnail(Toplevel *toplevel, const QSize &size, QSize *thumbnailSize,
+                                                   xcb_pixmap_t *pixmap)
+{
+    Window *w = windows.value(toplevel);
+    if (!w) {
+        return XCB_RENDER_PICTURE_NONE;
+    }
+    const xcb_pixmap_t previous = w->thumbnailPixmap();
+    const xcb_render_picture_t picture = w->thumbnail(size, thumbnailSize, pixmap);
+    if (previous != XCB_PIXMAP_NONE && previous != w->thumbnailPixmap()) {
+        // created again for the new size of the window
+        emit windowThumbnailDiscarded(toplevel);
+    }
+    return picture;
+}
+
+bool SceneXrender::hasWindowThumbnail(Toplevel *toplevel, const QSize &size) const
+{
+    Window *w = windows.value(toplevel);
+    return w && w->hasThumbnail(size);
+}
+
+void SceneXrender::windowDamaged(Toplevel *toplevel, const QRect &damage)
+{
+    Window *w = windows.value(toplevel);
+    if (!w || !w->hasThumbnail()) {
+        return;
+    }
+    w->addThumbnailDamage(damage);
+}
+
+void SceneXrender::updateThumbnails()
+{
+    if (m_thumbnailsUpdated.isValid() && m_thumbnailsUpdated.elapsed() < s_thumbnailInterval) {
+        // not that often, but do not miss the last damage either
+        if (!m_thumbnailTimer.isActive()) {
+            m_thumbnailTimer.start(s_thumbnailInterval - m_thumbnailsUpdated.elapsed());
+        }
+        return;
+    }
+    bool updated = false;
+    foreach (Window * w, windows) {
+        if (!w->hasThumbnail()) {
+            continue;
+        }
+        if (w->thumbnailUnused() > s_thumbnailExpiry) {
+            w->discardThumbnail();
+            emit windowThumbnailDiscarded(w->window());
+            continue;
+        }
+        if (w->isThumbnailDirty()) {
+            const xcb_pixmap_t previous = w->thumbnailPixmap();
+            w->updateThumbnail();
+            if (previous != w->thumbnailPixmap()) {
+                emit windowThumbnailDiscarded(w->window());
+            }
+            emit windowThumbnailUpdated(w->window());
+            updated = true;
+        }
+    }
+    if (updated) {
+        m_thumbnailsUpdated.start();
+    }
 }
 
 void SceneXrender::initXRender(bool createOverlay)
@@ -182,11 +266,18 @@ qint64 SceneXrender::paint(QRegion damage, ToplevelList toplevels)
 {
     QElapsedTimer renderTimer;
     renderTimer.start();
+    // the sequence numbers tell how many requests were sent in between
+    const unsigned int firstRequest = xcb_no_operation(connection()).sequence;
 
     foreach (Toplevel * c, toplevels) {
         assert(windows.contains(c));
         stacking_order.append(windows[ c ]);
     }
+    // the damage of this pass was fetched, it is reset by painting the windows
+    foreach (Window * w, windows) {
+        w->collectThumbnailDamage();
+    }
+    updateThumbnails();
 
     int mask = 0;
     QRegion updateRegion, validRegion;
@@ -195,19 +286,22 @@ qint64 SceneXrender::paint(QRegion damage, ToplevelList toplevels)
     if (m_overlayWindow->window())  // show the window only after the first pass, since
         m_overlayWindow->show();   // that pass may take long
 
+    const qint64 presentStart = renderTimer.nsecsElapsed();
     present(mask, updateRegion);
     // do cleanup
     stacking_order.clear();
 
-    return renderTimer.nsecsElapsed();
+    frame_timing.total = renderTimer.nsecsElapsed();
+    frame_timing.present = frame_timing.total - presentStart;
+    frame_timing.requests = xcb_no_operation(connection()).sequence - firstRequest - 1;
+    return frame_timing.total;
 }
 
 void SceneXrender::present(int mask, QRegion damage)
 {
     if (mask & PAINT_SCREEN_REGION) {
         // Use the damage region as the clip region for the root window
-        XFixesRegion frontRegion(damage);
-        xcb_xfixes_set_picture_clip_region(connection(), front, frontRegion, 0, 0);
+        xRenderSetPictureClip(front, damage);
         // copy composed buffer to the root window
         xcb_xfixes_set_picture_clip_region(connection(), buffer, XCB_XFIXES_REGION_NONE, 0, 0);
         xcb_render_composite(connection(), XCB_RENDER_PICT_OP_SRC, buffer, XCB_RENDER_PICTURE_NONE,
@@ -268,16 +362,26 @@ void SceneXrender::windowClosed(KWin::Toplevel* c, KWin::Deleted* deleted)
         }
         windows[ deleted ] = w;
     } else {
-        delete windows.take(c);
+        Window *w = windows.take(c);
+        const bool thumbnail = w->hasThumbnail();
+        delete w;
         c->effectWindow()->setSceneWindow(NULL);
+        if (thumbnail) {
+            emit windowThumbnailDiscarded(c);
+        }
     }
 }
 
 void SceneXrender::windowDeleted(Deleted* c)
 {
     assert(windows.contains(c));
-    delete windows.take(c);
+    Window *w = windows.take(c);
+    const bool thumbnail = w->hasThumbnail();
+    delete w;
     c->effectWindow()->setSceneWindow(NULL);
+    if (thumbnail) {
+        emit windowThumbnailDiscarded(c);
+    }
 }
 
 void SceneXrender::windowAdded(Toplevel* c)
@@ -286,6 +390,7 @@ void SceneXrender::windowAdded(Toplevel* c)
     windows[ c ] = new Window(c);
     connect(c, SIGNAL(geometryShapeChanged(KWin::Toplevel*,QRect)), SLOT(windowGeometryShapeChanged(KWin::Toplevel*)));
     connect(c, SIGNAL(windowClosed(KWin::Toplevel*,KWin::Deleted*)), SLOT(windowClosed(KWin::Toplevel*,KWin::Deleted*)));
+    connect(c, SIGNAL(damaged(KWin::Toplevel*,QRect)), SLOT(windowDamaged(KWin::Toplevel*,QRect)));
     c->effectWindow()->setSceneWindow(windows[ c ]);
     c->getShadow();
     windows[ c ]->updateShadow(c->shadow());
@@ -296,23 +401,27 @@ void SceneXrender::windowAdded(Toplevel* c)
 //****************************************
 
 XRenderPicture *SceneXrender::Window::s_tempPicture = 0;
+XRenderPictureState SceneXrender::Window::s_tempPictureState;
 QRect SceneXrender::Window::temp_visibleRect;
 
 SceneXrender::Window::Window(Toplevel* c)
     : Scene::Window(c)
     , format(findFormatForVisual(c->visual()->visualid))
+    , m_thumbnailDamagePending(false)
 {
 }
 
 SceneXrender::Window::~Window()
 {
     discardShape();
+    discardThumbnail();
 }
 
 void SceneXrender::Window::cleanup()
 {
     delete s_tempPicture;
     s_tempPicture = NULL;
+    s_tempPictureState.setPicture(XCB_RENDER_PICTURE_NONE);
 }
 
 // Maps window coordinates to screen coordinates
@@ -378,6 +487,7 @@ void SceneXrender::Window::prepareTempPixmap()
         xcb_pixmap_t pix = xcb_generate_id(connection());
         xcb_create_pixmap(connection(), 32, pix, rootWindow(), temp_visibleRect.width(), temp_visibleRect.height());
         s_tempPicture = new XRenderPicture(pix, 32);
+        s_tempPictureState.setPicture(*s_tempPicture);
         xcb_free_pixmap(connection(), pix);
     }
     const xcb_render_color_t transparent = {0, 0, 0, 0};
@@ -443,11 +553,7 @@ void SceneXrender::Window::performPaint(int mask, QRegion region, WindowPaintDat
         KWIN_DOUBLE_TO_FIXED(0), KWIN_DOUBLE_TO_FIXED(1), KWIN_DOUBLE_TO_FIXED(0),
         KWIN_DOUBLE_TO_FIXED(0), KWIN_DOUBLE_TO_FIXED(0), KWIN_DOUBLE_TO_FIXED(1)
     };
-    static xcb_render_transform_t identity = {
-        KWIN_DOUBLE_TO_FIXED(1), KWIN_DOUBLE_TO_FIXED(0), KWIN_DOUBLE_TO_FIXED(0),
-        KWIN_DOUBLE_TO_FIXED(0), KWIN_DOUBLE_TO_FIXED(1), KWIN_DOUBLE_TO_FIXED(0),
-        KWIN_DOUBLE_TO_FIXED(0), KWIN_DOUBLE_TO_FIXED(0), KWIN_DOUBLE_TO_FIXED(1)
-    };
+    const xcb_render_transform_t &identity = xRenderIdentityTransform();
 
     if (mask & PAINT_WINDOW_TRANSFORMED) {
         xscale = data.xScale();
@@ -499,8 +605,10 @@ void SceneXrender::Window::performPaint(int mask, QRegion region, WindowPaintDat
             renderTarget = *s_tempPicture;
         }
     } else {
-        xcb_render_set_picture_transform(connection(), pic, xform);
-        setPictureFilter(pic, filter);
+        // the state of the picture is remembered, an unscaled window costs no requests here
+        XRenderPictureState &state = pixmap->pictureState();
+        state.setTransform(xform);
+        state.setFilter(filterName(filter));
 
         //BEGIN OF STUPID RADEON HACK
         // This is needed to avoid hitting a fallback in the radeon driver.
@@ -513,9 +621,8 @@ void SceneXrender::Window::performPaint(int mask, QRegion region, WindowPaintDat
         // transformation matrix, and doesn't have an alpha channel.
         // Since we only scale the picture, we can work around this by setting
         // the repeat mode to RepeatPad.
-        if (!window()->hasAlpha()) {
-            const uint32_t values[] = {XCB_RENDER_REPEAT_PAD};
-            xcb_render_change_picture(connection(), pic, XCB_RENDER_CP_REPEAT, values);
+        if (!window()->hasAlpha() && scaled) {
+            state.setRepeat(XCB_RENDER_REPEAT_PAD);
         }
         //END OF STUPID RADEON HACK
     }
@@ -640,7 +747,7 @@ xcb_render_composite(connection(), XCB_RENDER_PICT_OP_OVER, m_xrenderShadow->pic
                             KWIN_DOUBLE_TO_FIXED(0), KWIN_DOUBLE_TO_FIXED(KWIN_FIXED_TO_DOUBLE(xform.matrix22) * previous->size().height() / pixmap->size().height()), KWIN_DOUBLE_TO_FIXED(0),
                             KWIN_DOUBLE_TO_FIXED(0), KWIN_DOUBLE_TO_FIXED(0), KWIN_DOUBLE_TO_FIXED(1)
                             };
-                        xcb_render_set_picture_transform(connection(), previous->picture(), xform2);
+                        previous->pictureState().setTransform(xform2);
                     }
 
                     xcb_render_composite(connection(), opaque ? XCB_RENDER_PICT_OP_OVER : XCB_RENDER_PICT_OP_ATOP,
@@ -648,7 +755,7 @@ xcb_render_composite(connection(), XCB_RENDER_PICT_OP_OVER, m_xrenderShadow->pic
                                          cr.x(), cr.y(), 0, 0, dr.x(), dr.y(), dr.width(), dr.height());
 
                     if (previous->size() != pixmap->size()) {
-                        xcb_render_set_picture_transform(connection(), previous->picture(), identity);
+                        previous->pictureState().setTransform(identity);
                     }
                 }
             }
@@ -695,62 +802,296 @@ xcb_render_composite(connection(), XCB_RENDER_PICT_OP_OVER, _PART_, decorationAl
         }
         if (blitInTempPixmap) {
             const QRect r = mapToScreen(mask, data, temp_visibleRect);
-            xcb_render_set_picture_transform(connection(), *s_tempPicture, xform);
-            setPictureFilter(*s_tempPicture, filter);
+            s_tempPictureState.setTransform(xform);
+            s_tempPictureState.setFilter(filterName(filter));
             xcb_render_composite(connection(), XCB_RENDER_PICT_OP_OVER, *s_tempPicture,
                                  XCB_RENDER_PICTURE_NONE, buffer,
                                  0, 0, 0, 0, r.x(), r.y(), r.width(), r.height());
-            xcb_render_set_picture_transform(connection(), *s_tempPicture, identity);
+            s_tempPictureState.setTransform(identity);
         }
     }
     if (scaled && !blitInTempPixmap) {
-        xcb_render_set_picture_transform(connection(), pic, identity);
+        XRenderPictureState &state = pixmap->pictureState();
+        state.setTransform(identity);
         if (!window()->hasAlpha()) {
-            const uint32_t values[] = {XCB_RENDER_REPEAT_NONE};
-            xcb_render_change_picture(connection(), pic, XCB_RENDER_CP_REPEAT, values);
+            state.setRepeat(XCB_RENDER_REPEAT_NONE);
         }
     }
     if (xRenderOffscreen())
         scene_setXRenderOffscreenTarget(*s_tempPicture);
 }
 
-void SceneXrender::Window::setPictureFilter(xcb_render_picture_t pic, Scene::ImageFilterType filter)
+const char *SceneXrender::Window::filterName(Scene::ImageFilterType filter)
 {
-    QByteArray filterName;
     switch (filter) {
-        case KWin::Scene::ImageFilterFast: {
-            filterName = QByteArray("fast");
-            break;
-        }
-        case KWin::Scene::ImageFilterGood: {
-            filterName = QByteArray("good");
-            break;
-        }
-        case KWin::Scene::ImageFilterBest: {
-            filterName = QByteArray("best");
-            break;
-        }
+        case KWin::Scene::ImageFilterFast:
+            return "fast";
+        case KWin::Scene::ImageFilterGood:
+            return "good";
+        case KWin::Scene::ImageFilterBest:
+            return "best";
         /* Filters included in 0.6 */
-        case KWin::Scene::ImageFilterNearest: {
-            filterName = QByteArray("nearest");
+        case KWin::Scene::ImageFilterNearest:
+            return "nearest";
+        case KWin::Scene::ImageFilterBilinear:
+            return "bilinear";
+        /* Filters included in 0.10 */
+        case KWin::Scene::ImageFilterConvolution:
+            return "convolution";
+    }
+    return "fast";
+}
+
+WindowPixmap* SceneXrender::Window::createWindowPixmap()
+{
+    return new XRenderWindowPixmap(this, format);
+}
+
+// the pixels of @p rect in a picture of half the size
+static QRect halfRect(const QRect &rect)
+{
+    return QRect(QPoint(rect.left() / 2, rect.top() / 2), QPoint(rect.right() / 2, rect.bottom() / 2));
+}
+
+// a transformation which samples a picture at twice the coordinates, offset by @p offset
+static xcb_render_transform_t halfTransform(const QPoint &offset = QPoint())
+{
+    const xcb_render_transform_t transform = {
+        KWIN_DOUBLE_TO_FIXED(2), KWIN_DOUBLE_TO_FIXED(0), KWIN_DOUBLE_TO_FIXED(offset.x()),
+        KWIN_DOUBLE_TO_FIXED(0), KWIN_DOUBLE_TO_FIXED(2), KWIN_DOUBLE_TO_FIXED(offset.y()),
+        KWIN_DOUBLE_TO_FIXED(0), KWIN_DOUBLE_TO_FIXED(0), KWIN_DOUBLE_TO_FIXED(1)
+    };
+    return transform;
+}
+
+// paints the part of @p source at @p offset, which is at the double coordinates, into @p rect
+static void paintHalf(xcb_render_picture_t source, const QPoint &offset, xcb_render_picture_t target, const QRect &rect)
+{
+    if (source == XCB_RENDER_PICTURE_NONE || rect.isEmpty()) {
+        return;
+    }
+    xcb_render_set_picture_transform(connection(), source, halfTransform(-offset));
+    xcb_render_composite(connection(), XCB_RENDER_PICT_OP_OVER, source, XCB_RENDER_PICTURE_NONE, target,
+                         rect.x(), rect.y(), 0, 0, rect.x(), rect.y(), rect.width(), rect.height());
+    xcb_render_set_picture_transform(connection(), source, xRenderIdentityTransform());
+}
+
+// the smallest snapshot which does not have to be scaled up, -1 if @p size is more than half
+// the size of the window
+int SceneXrender::Window::thumbnailLevel(const QSize &size) const
+{
+    int level = -1;
+    QSize levelSize = halfRect(QRect(0, 0, width(), height())).size();
+    for (int i = 0; levelSize.width() >= s_minimumThumbnailSize && levelSize.height() >= s_minimumThumbnailSize; ++i) {
+        if (levelSize.width() < size.width() || levelSize.height() < size.height()) {
             break;
         }
-        case KWin::Scene::ImageFilterBilinear: {
-            filterName = QByteArray("bilinear");
-            break;
+        level = i;
+        levelSize = halfRect(QRect(QPoint(0, 0), levelSize)).size();
+    }
+    return level;
+}
+
+xcb_render_picture_t SceneXrender::Window::thumbnail(const QSize &size, QSize *thumbnailSize, xcb_pixmap_t *pixmap)
+{
+    const int level = thumbnailLevel(size);
+    if (level == -1) {
+        return XCB_RENDER_PICTURE_NONE;
+    }
+    if (m_thumbnail.isEmpty() || m_thumbnail.first().size != halfRect(QRect(0, 0, width(), height())).size()) {
+        createThumbnail();
+    }
+    if (level >= m_thumbnail.count()) {
+        // the window cannot be painted
+        return XCB_RENDER_PICTURE_NONE;
+    }
+    m_thumbnailUsed.start();
+    ThumbnailLevel &thumbnail = m_thumbnail[level];
+    if (thumbnailSize) {
+        *thumbnailSize = thumbnail.size;
+    }
+    if (pixmap) {
+        *pixmap = thumbnail.pixmap;
+    }
+    return thumbnail.picture;
+}
+
+bool SceneXrender::Window::hasThumbnail() const
+{
+    return !m_thumbnail.isEmpty();
+}
+
+bool SceneXrender::Window::hasThumbnail(const QSize &size) const
+{
+    const int level = thumbnailLevel(size);
+    return level != -1 && level < m_thumbnail.count()
+        && m_thumbnail.first().size == halfRect(QRect(0, 0, width(), height())).size();
+}
+
+xcb_pixmap_t SceneXrender::Window::thumbnailPixmap() const
+{
+    return m_thumbnail.isEmpty() ? XCB_PIXMAP_NONE : m_thumbnail.first().pixmap;
+}
+
+bool SceneXrender::Window::isThumbnailDirty() const
+{
+    return !m_thumbnail.isEmpty() && !m_thumbnailDamage.isEmpty();
+}
+
+void SceneXrender::Window::addThumbnailDamage(const QRect &damage)
+{
+    if (m_thumbnail.isEmpty()) {
+        return;
+    }
+    if (damage.isEmpty()) {
+        m_thumbnailDamagePending = true;
+    } else {
+        m_thumbnailDamage |= damage;
+    }
+}
+
+void SceneXrender::Window::collectThumbnailDamage()
+{
+    if (m_thumbnailDamagePending) {
+        m_thumbnailDamage |= toplevel->damage();
+        m_thumbnailDamagePending = false;
+    }
+}
+
+qint64 SceneXrender::Window::thumbnailUnused() const
+{
+    return m_thumbnailUsed.isValid() ? m_thumbnailUsed.elapsed() : 0;
+}
+
+void SceneXrender::Window::createThumbnail()
+{
+    discardThumbnail();
+    XRenderWindowPixmap *pixmap = windowPixmap<XRenderWindowPixmap>();
+    if (!pixmap || !pixmap->isValid() || pixmap->picture() == XCB_RENDER_PICTURE_NONE) {
+        return;
+    }
+    static const char filter[] = "good";
+    QSize size = halfRect(QRect(0, 0, width(), height())).size();
+    while (size.width() >= s_minimumThumbnailSize && size.height() >= s_minimumThumbnailSize) {
+        ThumbnailLevel level;
+        level.pixmap = xcb_generate_id(connection());
+        xcb_create_pixmap(connection(), 32, level.pixmap, rootWindow(), size.width(), size.height());
+        level.picture = XRenderPicture(level.pixmap, 32);
+        level.size = size;
+        xcb_render_set_picture_filter(connection(), level.picture, qstrlen(filter), filter, 0, NULL);
+        m_thumbnail << level;
+        size = halfRect(QRect(QPoint(0, 0), size)).size();
+    }
+    addThumbnailDamage(QRect(0, 0, width(), height()));
+    updateThumbnail();
+}
+
+void SceneXrender::Window::discardThumbnail()
+{
+    foreach (const ThumbnailLevel &level, m_thumbnail) {
+        xcb_free_pixmap(connection(), level.pixmap);
+    }
+    m_thumbnail.clear();
+    m_thumbnailDamage = QRegion();
+    m_thumbnailDamagePending = false;
+}
+
+void SceneXrender::Window::updateThumbnail()
+{
+    if (m_thumbnail.isEmpty()) {
+        return;
+    }
+    if (m_thumbnail.first().size != halfRect(QRect(0, 0, width(), height())).size()) {
+        // resized, painted completely again
+        createThumbnail();
+        return;
+    }
+    QRegion damage = m_thumbnailDamage;
+    m_thumbnailDamage = QRegion();
+    // the decoration is not damaged, but the caption may have changed as well
+    QRect dlr, dtr, drr, dbr;
+    if (Client *client = qobject_cast<Client*>(toplevel)) {
+        if (!client->noBorder()) {
+            client->layoutDecorationRects(dlr, dtr, drr, dbr, Client::WindowRelative);
         }
-        /* Filters included in 0.10 */
-        case KWin::Scene::ImageFilterConvolution: {
-            filterName = QByteArray("convolution");
-            break;
+    } else if (Deleted *deleted = qobject_cast<Deleted*>(toplevel)) {
+        if (!deleted->noBorder()) {
+            deleted->layoutDecorationRects(dlr, dtr, drr, dbr);
+        }
+    }
+    damage = (damage | dtr) & QRect(0, 0, width(), height());
+    QVector<QRect> rects = damage.rects();
+    if (rects.count() > 8) {
+        rects = QVector<QRect>() << damage.boundingRect();
+    }
+    // each level is painted from the damaged parts of the one before, grown by a pixel
+    // because of the filter
+    for (int i = 0; i < m_thumbnail.count(); ++i) {
+        const QRect levelRect(QPoint(0, 0), m_thumbnail.at(i).size);
+        for (int j = 0; j < rects.count(); ++j) {
+            if (rects.at(j).isEmpty()) {
+                continue;
+            }
+            rects[j] = halfRect(rects.at(j)).adjusted(-1, -1, 1, 1) & levelRect;
+            paintThumbnailLevel(i, rects.at(j));
         }
     }
-    xcb_render_set_picture_filter(connection(), pic, filterName.length(), filterName.constData(), 0, NULL);
 }
 
-WindowPixmap* SceneXrender::Window::createWindowPixmap()
+void SceneXrender::Window::paintThumbnailLevel(int level, const QRect &rect)
 {
-    return new XRenderWindowPixmap(this, format);
+    if (rect.isEmpty()) {
+        return;
+    }
+    xcb_render_picture_t target = m_thumbnail[level].picture;
+    const xcb_rectangle_t clip = {int16_t(rect.x()), int16_t(rect.y()), uint16_t(rect.width()), uint16_t(rect.height())};
+    const xcb_render_color_t transparent = {0, 0, 0, 0};
+    xcb_render_fill_rectangles(connection(), XCB_RENDER_PICT_OP_SRC, target, transparent, 1, &clip);
+
+    if (level > 0) {
+        paintHalf(m_thumbnail[level - 1].picture, QPoint(), target, rect);
+        return;
+    }
+
+    // the window contents
+    Client *client = qobject_cast<Client*>(toplevel);
+    Deleted *deleted = qobject_cast<Deleted*>(toplevel);
+    XRenderWindowPixmap *pixmap = windowPixmap<XRenderWindowPixmap>();
+    if (pixmap && pixmap->isValid() && !(client && client->isShade())) {
+        const QRect cr = halfRect(QRect(toplevel->clientPos(), toplevel->clientSize())) & rect;
+        XRenderPictureState &state = pixmap->pictureState();
+        state.setTransform(halfTransform());
+        state.setFilter("good");
+        // see the radeon hack in performPaint()
+        if (!window()->hasAlpha()) {
+            state.setRepeat(XCB_RENDER_REPEAT_PAD);
+        }
+        xcb_render_composite(connection(), XCB_RENDER_PICT_OP_SRC, pixmap->picture(), XCB_RENDER_PICTURE_NONE,
+                             target, cr.x(), cr.y(), 0, 0, cr.x(), cr.y(), cr.width(), cr.height());
+        state.setTransform(xRenderIdentityTransform());
+        if (!window()->hasAlpha()) {
+            state.setRepeat(XCB_RENDER_REPEAT_NONE);
+        }
+    }
+
+    // the decoration
+    PaintRedirector *redirector = NULL;
+    QRect dlr, dtr, drr, dbr;
+    if (client && !client->noBorder()) {
+        redirector = client->decorationPaintRedirector();
+        client->layoutDecorationRects(dlr, dtr, drr, dbr, Client::WindowRelative);
+    }
+    if (deleted && !deleted->noBorder()) {
+        redirector = deleted->decorationPaintRedirector();
+        deleted->layoutDecorationRects(dlr, dtr, drr, dbr);
+    }
+    if (redirector) {
+        redirector->ensurePixmapsPainted();
+        paintHalf(redirector->topDecoPixmap(), dtr.topLeft(), target, halfRect(dtr) & rect);
+        paintHalf(redirector->leftDecoPixmap(), dlr.topLeft(), target, halfRect(dlr) & rect);
+        paintHalf(redirector->rightDecoPixmap(), drr.topLeft(), target, halfRect(drr) & rect);
+        paintHalf(redirector->bottomDecoPixmap(), dbr.topLeft(), target, halfRect(dbr) & rect);
+    }
 }
 
 void SceneXrender::screenGeometryChanged(const QSize &size)
@@ -788,6 +1129,7 @@ void XRenderWindowPixmap::create()
     }
     m_picture = xcb_generate_id(connection());
     xcb_render_create_picture(connection(), m_picture, pixmap(), m_format, 0, NULL);
+    m_pictureState.setPicture(m_picture);
 }
 
 //****************************************
@@ -1013,16 +1355,14 @@ void SceneXrender::EffectFrame::updateTextPicture()
 
 SceneXRenderShadow::SceneXRenderShadow(Toplevel *toplevel)
     :Shadow(toplevel)
+    , m_pictures(NULL)
 {
-    for (int i=0; i<ShadowElementsCount; ++i) {
-        m_pictures[i] = NULL;
-    }
 }
 
 SceneXRenderShadow::~SceneXRenderShadow()
 {
-    for (int i=0; i<ShadowElementsCount; ++i) {
-        delete m_pictures[i];
+    if (SceneXrender::shadowCache()) {
+        SceneXrender::shadowCache()->release(m_pictures);
     }
 }
 
@@ -1070,21 +1410,27 @@ void SceneXRenderShadow::buildQuads()
 
 bool SceneXRenderShadow::prepareBackend()
 {
-    const uint32_t values[] = {XCB_RENDER_REPEAT_NORMAL};
+    ShadowCache *cache = SceneXrender::shadowCache();
+    if (!cache) {
+        return false;
+    }
+    QImage images[ShadowElementsCount];
     for (int i=0; i<ShadowElementsCount; ++i) {
-        delete m_pictures[i];
-        m_pictures[i] = new XRenderPicture(shadowImage(ShadowElements(i)));
-        xcb_render_change_picture(connection(), *m_pictures[i], XCB_RENDER_CP_REPEAT, values);
+        images[i] = shadowImage(ShadowElements(i));
     }
+    // acquire first, so that the pictures are not freed if the shadow did not change
+    const ShadowCache::Pictures *pictures = cache->acquire(images);
+    cache->release(m_pictures);
+    m_pictures = pictures;
     return true;
 }
 
 xcb_render_picture_t SceneXRenderShadow::picture(Shadow::ShadowElements element) const
 {
-    if (!m_pictures[element]) {
+    if (!m_pictures) {
         return XCB_RENDER_PICTURE_NONE;
     }
-    return *m_pictures[element];
+    return m_pictures->picture(element);
 }
 
 } // namespace
@@ -25,6 +25,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "scene.h"
 #include "shadow.h"
+#include "shadowcache.h"
+#include "kwinxrenderutils.h"
+
+#include <QTimer>
 
 #ifdef KWIN_BUILD_COMPOSITE
 
@@ -52,6 +56,31 @@ public:
     virtual OverlayWindow *overlayWindow() {
         return m_overlayWindow;
     }
+    /**
+     * @returns The pictures of the shadows of all windows, @c NULL if there is no XRender scene.
+     **/
+    static ShadowCache *shadowCache();
+    /**
+     * @returns The snapshot of @p toplevel which is the smallest one at least @p size large,
+     * see SceneXrender::Window::thumbnail().
+     **/
+    xcb_render_picture_t windowThumbnail(Toplevel *toplevel, const QSize &size, QSize *thumbnailSize,
+                                         xcb_pixmap_t *pixmap = NULL);
+    /**
+     * @returns Whether windowThumbnail() would return the snapshot of @p toplevel which is there
+     * already. Unlike windowThumbnail() this neither creates nor updates the snapshots.
+     **/
+    bool hasWindowThumbnail(Toplevel *toplevel, const QSize &size) const;
+Q_SIGNALS:
+    /**
+     * Emitted when the snapshots of @p toplevel were updated from its damage.
+     **/
+    void windowThumbnailUpdated(KWin::Toplevel *toplevel);
+    /**
+     * Emitted when the snapshots of @p toplevel were freed, because nobody asked for them for
+     * a while or because they were created again for the new size of the window.
+     **/
+    void windowThumbnailDiscarded(KWin::Toplevel *toplevel);
 protected:
     virtual void paintBackground(QRegion region);
     virtual void paintGenericScreen(int mask, ScreenPaintData data);
@@ -60,6 +89,9 @@ public Q_SLOTS:
     virtual void windowOpacityChanged(KWin::Toplevel* c);
     virtual void windowGeometryShapeChanged(KWin::Toplevel* c);
     virtual void windowClosed(KWin::Toplevel* c, KWin::Deleted* deleted);
+private Q_SLOTS:
+    void updateThumbnails();
+    void windowDamaged(KWin::Toplevel *toplevel, const QRect &damage);
 private:
     void createBuffer();
     void present(int mask, QRegion damage);
@@ -72,6 +104,9 @@ private:
     QHash< Toplevel*, Window* > windows;
     OverlayWindow* m_overlayWindow;
     bool init_ok;
+    static ShadowCache *s_shadowCache;
+    QTimer m_thumbnailTimer;
+    QElapsedTimer m_thumbnailsUpdated;
 };
 
 class SceneXrender::Window
@@ -84,17 +119,73 @@ public:
     QRegion transformedShape() const;
     void setTransformedShape(const QRegion& shape);
     static void cleanup();
+    /**
+     * Painting a window as a small thumbnail scales the whole window in every frame, which is
+     * expensive and looks bad for large factors. Instead snapshots of the window including its
+     * decoration are kept at half, a quarter, ... of its size, each one downscaled from the
+     * previous one, and only their damaged parts are updated.
+     *
+     * @returns The smallest snapshot which is at least @p size large, its size is stored in
+     * @p thumbnailSize and its pixmap in @p pixmap. @c XCB_RENDER_PICTURE_NONE if the window
+     * is too small or cannot be painted.
+     **/
+    xcb_render_picture_t thumbnail(const QSize &size, QSize *thumbnailSize, xcb_pixmap_t *pixmap = NULL);
+    bool hasThumbnail() const;
+    /**
+     * Whether thumbnail() would return a snapshot which is there already.
+     **/
+    bool hasThumbnail(const QSize &size) const;
+    /**
+     * The pixmap of the largest snapshot, @c XCB_PIXMAP_NONE if there is none.
+     **/
+    xcb_pixmap_t thumbnailPixmap() const;
+    /**
+     * Whether the window was damaged since the snapshots were updated.
+     **/
+    bool isThumbnailDirty() const;
+    /**
+     * An empty @p damage is an XDamage notify, the damaged region of it is fetched by the next
+     * compositing pass and added by collectThumbnailDamage().
+     **/
+    void addThumbnailDamage(const QRect &damage);
+    /**
+     * Adds the damage fetched for the window since addThumbnailDamage(), has to be called before
+     * painting the window resets it.
+     **/
+    void collectThumbnailDamage();
+    /**
+     * Paints the damaged parts into the snapshots.
+     **/
+    void updateThumbnail();
+    void discardThumbnail();
+    /**
+     * The time since a snapshot was asked for the last time.
+     **/
+    qint64 thumbnailUnused() const;
 protected:
     virtual WindowPixmap* createWindowPixmap();
 private:
+    struct ThumbnailLevel {
+        xcb_pixmap_t pixmap;
+        XRenderPicture picture;
+        QSize size;
+    };
+    int thumbnailLevel(const QSize &size) const;
+    void createThumbnail();
+    void paintThumbnailLevel(int level, const QRect &rect);
     QRect mapToScreen(int mask, const WindowPaintData &data, const QRect &rect) const;
     QPoint mapToScreen(int mask, const WindowPaintData &data, const QPoint &point) const;
     void prepareTempPixmap();
-    void setPictureFilter(xcb_render_picture_t pic, ImageFilterType filter);
+    static const char *filterName(ImageFilterType filter);
     xcb_render_pictformat_t format;
     QRegion transformed_shape;
     static QRect temp_visibleRect;
     static XRenderPicture *s_tempPicture;
+    static XRenderPictureState s_tempPictureState;
+    QVector<ThumbnailLevel> m_thumbnail;
+    QRegion m_thumbnailDamage;
+    bool m_thumbnailDamagePending;
+    QElapsedTimer m_thumbnailUsed;
 };
 
 class XRenderWindowPixmap : public WindowPixmap
@@ -103,10 +194,12 @@ public:
     explicit XRenderWindowPixmap(Scene::Window *window, xcb_render_pictformat_t format);
     virtual ~XRenderWindowPixmap();
     xcb_render_picture_t picture() const;
+    XRenderPictureState &pictureState();
     virtual void create();
 private:
     xcb_render_picture_t m_picture;
     xcb_render_pictformat_t m_format;
+    XRenderPictureState m_pictureState;
 };
 
 class SceneXrender::EffectFrame
@@ -159,6 +252,12 @@ xcb_render_picture_t XRenderWindowPixmap::picture() const
     return m_picture;
 }
 
+inline
+XRenderPictureState &XRenderWindowPixmap::pictureState()
+{
+    return m_pictureState;
+}
+
 /**
  * @short XRender implementation of Shadow.
  *
@@ -194,7 +293,7 @@ protected:
     virtual void buildQuads();
     virtual bool prepareBackend();
 private:
-    XRenderPicture* m_pictures[ShadowElementsCount];
+    const ShadowCache::Pictures *m_pictures;
 };
 
 } // namespace
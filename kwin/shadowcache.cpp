@@ -0,0 +1,153 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "shadowcache.h"
+
+#include <kwinglobals.h>
+
+namespace KWin
+{
+
+ShadowCache::Pictures::Pictures()
+    : hash(0)
+    , refCount(0)
+    , bytes(0)
+{
+}
+
+xcb_render_picture_t ShadowCache::Pictures::picture(int element) const
+{
+    return pictures[element];
+}
+
+ShadowCache::ShadowCache()
+    : m_limit(DefaultLimit)
+    , m_bytes(0)
+    , m_unusedBytes(0)
+    , m_hits(0)
+    , m_misses(0)
+    , m_evictions(0)
+{
+}
+
+ShadowCache::~ShadowCache()
+{
+    foreach (Pictures *pictures, m_pictures) {
+        delete pictures;
+    }
+}
+
+uint ShadowCache::hashImages(const QImage *images)
+{
+    uint hash = 0;
+    for (int i = 0; i < ElementCount; ++i) {
+        const QImage &image = images[i];
+        hash = 31 * hash + qHash(QByteArray::fromRawData(reinterpret_cast<const char*>(image.constBits()),
+                                                         image.byteCount()));
+        hash = 31 * hash + uint(image.width()) * 65599u + uint(image.height());
+    }
+    return hash;
+}
+
+const ShadowCache::Pictures *ShadowCache::acquire(const QImage *images)
+{
+    const uint hash = hashImages(images);
+    QMultiHash<uint, Pictures*>::const_iterator it = m_pictures.constFind(hash);
+    for (; it != m_pictures.constEnd() && it.key() == hash; ++it) {
+        Pictures *pictures = it.value();
+        bool equal = true;
+        for (int i = 0; i < ElementCount && equal; ++i) {
+            equal = pictures->images[i] == images[i];
+        }
+        if (!equal) {
+            continue;
+        }
+        if (pictures->refCount == 0) {
+            m_unused.removeOne(pictures);
+            m_unusedBytes -= pictures->bytes;
+        }
+        pictures->refCount++;
+        m_hits++;
+        return pictures;
+    }
+
+    m_misses++;
+    Pictures *pictures = new Pictures();
+    pictures->hash = hash;
+    pictures->refCount = 1;
+    const uint32_t values[] = {XCB_RENDER_REPEAT_NORMAL};
+    for (int i = 0; i < ElementCount; ++i) {
+        pictures->images[i] = images[i];
+        pictures->pictures[i] = XRenderPicture(images[i]);
+        pictures->bytes += images[i].byteCount();
+        xcb_render_change_picture(connection(), pictures->pictures[i], XCB_RENDER_CP_REPEAT, values);
+    }
+    m_pictures.insert(hash, pictures);
+    m_bytes += pictures->bytes;
+    return pictures;
+}
+
+void ShadowCache::release(const Pictures *pictures)
+{
+    if (!pictures) {
+        return;
+    }
+    Pictures *released = const_cast<Pictures*>(pictures);
+    Q_ASSERT(released->refCount > 0);
+    if (--released->refCount > 0) {
+        return;
+    }
+    m_unused.prepend(released);
+    m_unusedBytes += released->bytes;
+    evict(m_limit);
+}
+
+void ShadowCache::clear()
+{
+    while (!m_unused.isEmpty()) {
+        Pictures *pictures = m_unused.takeLast();
+        m_unusedBytes -= pictures->bytes;
+        destroy(pictures);
+    }
+}
+
+void ShadowCache::setLimit(qint64 limit)
+{
+    m_limit = qMax(qint64(0), limit);
+    evict(m_limit);
+}
+
+void ShadowCache::evict(qint64 limit)
+{
+    while (m_unusedBytes > limit && !m_unused.isEmpty()) {
+        Pictures *pictures = m_unused.takeLast();
+        m_unusedBytes -= pictures->bytes;
+        m_evictions++;
+        destroy(pictures);
+    }
+}
+
+void ShadowCache::destroy(Pictures *pictures)
+{
+    m_pictures.remove(pictures->hash, pictures);
+    m_bytes -= pictures->bytes;
+    delete pictures;
+}
+
+} // namespace
@@ -0,0 +1,151 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_SHADOWCACHE_H
+#define KWIN_SHADOWCACHE_H
+
+#include <kwinxrenderutils.h>
+
+#include <QImage>
+#include <QList>
+#include <QMultiHash>
+
+namespace KWin
+{
+
+/**
+ * @brief The XRender pictures of the shadows, shared by all windows.
+ *
+ * Decorations give all windows in the same state the same shadow, yet every window used to
+ * upload its own copy of the shadow images to the X server. The cache looks the images up by
+ * their content and hands out the same pictures for all of them.
+ *
+ * The pictures are reference counted, pictures no window uses anymore are kept around in case
+ * a window with that shadow shows up again until they take more memory than the limit, then
+ * the least recently used ones are freed.
+ */
+class ShadowCache
+{
+public:
+    enum {
+        ElementCount = 8, ///< the elements of a Shadow
+        DefaultLimit = 4 * 1024 * 1024 ///< bytes of unused pictures which are kept
+    };
+    class Pictures
+    {
+    public:
+        xcb_render_picture_t picture(int element) const;
+
+    private:
+        friend class ShadowCache;
+        Pictures();
+        uint hash;
+        int refCount;
+        qint64 bytes;
+        QImage images[ElementCount];
+        mutable XRenderPicture pictures[ElementCount];
+    };
+
+    ShadowCache();
+    ~ShadowCache();
+
+    /**
+     * @returns The pictures of the shadow made of the @ref ElementCount @p images, they are
+     * created if no other window has the same shadow. Every call has to be paired with a call
+     * of release().
+     */
+    const Pictures *acquire(const QImage *images);
+    void release(const Pictures *pictures);
+    /**
+     * Frees the pictures which are not used anymore.
+     */
+    void clear();
+
+    qint64 limit() const;
+    void setLimit(qint64 limit);
+
+    /**
+     * @returns The number of different shadows, used or not.
+     */
+    int count() const;
+    /**
+     * @returns The size of the images of all the pictures in bytes.
+     */
+    qint64 bytes() const;
+    /**
+     * @returns The size of the images of the pictures no window uses in bytes.
+     */
+    qint64 unusedBytes() const;
+    quint64 hits() const;
+    quint64 misses() const;
+    quint64 evictions() const;
+
+private:
+    void evict(qint64 limit);
+    void destroy(Pictures *pictures);
+    static uint hashImages(const QImage *images);
+
+    QMultiHash<uint, Pictures*> m_pictures;
+    QList<Pictures*> m_unused; ///< most recently released first
+    qint64 m_limit;
+    qint64 m_bytes;
+    qint64 m_unusedBytes;
+    quint64 m_hits;
+    quint64 m_misses;
+    quint64 m_evictions;
+};
+
+inline qint64 ShadowCache::limit() const
+{
+    return m_limit;
+}
+
+inline int ShadowCache::count() const
+{
+    return m_pictures.count();
+}
+
+inline qint64 ShadowCache::bytes() const
+{
+    return m_bytes;
+}
+
+inline qint64 ShadowCache::unusedBytes() const
+{
+    return m_unusedBytes;
+}
+
+inline quint64 ShadowCache::hits() const
+{
+    return m_hits;
+}
+
+inline quint64 ShadowCache::misses() const
+{
+    return m_misses;
+}
+
+inline quint64 ShadowCache::evictions() const
+{
+    return m_evictions;
+}
+
+} // namespace
+
+#endif
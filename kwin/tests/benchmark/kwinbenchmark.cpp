@@ -0,0 +1,639 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "scenario.h"
+#include "statistics.h"
+// Qt
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusInterface>
+#include <QDBusReply>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QProcess>
+#include <QStringList>
+#include <QTextStream>
+#include <QTimer>
+// xcb
+#include <xcb/xcb.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace KWin
+{
+namespace Benchmark
+{
+
+// the compositor remembers the last 256 frames, fetch them well before they are overwritten
+static const int s_pollInterval = 2000;
+// how long the X server, kwin and the windows may take to show up
+static const int s_startTimeout = 15000;
+static const int s_firstDisplay = 90;
+static const int s_lastDisplay = 190;
+static const char s_wmClass[] = "kwin-benchmark\0kwin-benchmark";
+
+static const char s_compositingService[] = "org.kde.kwin.Compositing";
+static const char s_effectsService[] = "org.kde.kwin.Effects";
+static const char s_kwinService[] = "org.kde.KWin";
+static const char s_zoomInterface[] = "org.kde.kwin.Zoom";
+
+/**
+ * @brief Runs scenarios against a KWin on its own X server and reports how it did.
+ *
+ * Xvfb, a session bus and KWin are started once, every scenario creates its own client
+ * windows and destroys them at the end. The frame timings come from the Compositor over
+ * D-Bus, they are fetched regularly because the compositor only remembers the last frames.
+ */
+class Runner : public QObject
+{
+    Q_OBJECT
+public:
+    Runner();
+    virtual ~Runner();
+
+    bool start(const QString &kwin, const QSize &screen);
+    bool run(const Scenario &scenario);
+    const QString &errorString() const;
+
+private Q_SLOTS:
+    void poll();
+
+private:
+    bool startXServer(const QSize &screen);
+    bool startSessionBus();
+    bool startKWin(const QString &kwin);
+    bool runStep(const Step &step);
+    bool createWindows(int count);
+    void destroyWindows();
+    bool waitForClients();
+    void damage(int window, int iteration);
+    void move(int window, int dx, int dy);
+    void setPresentWindows(bool enable);
+    void setDesktops(int count);
+    void resetStatistics();
+    void report(const Scenario &scenario, qint64 elapsed);
+    void wait(int msec);
+    xcb_atom_t atom(const char *name);
+    bool call(const char *service, const char *path, const char *interface, const QString &method,
+              const QVariant &argument1 = QVariant(), const QVariant &argument2 = QVariant());
+    bool setError(const QString &error);
+
+    QSize m_screen;
+    QString m_display;
+    QString m_busAddress;
+    QProcess m_xserver;
+    QProcess m_bus;
+    QProcess m_kwin;
+    xcb_connection_t *m_connection;
+    xcb_window_t m_root;
+    xcb_gcontext_t m_gc;
+    QVector<xcb_window_t> m_windows;
+    QVector<QRect> m_geometries;
+    QDBusConnection m_dbus;
+    QTimer m_pollTimer;
+    FrameStatistics m_total;
+    FrameStatistics m_paint;
+    quint64 m_frames;
+    quint64 m_missedFrames;
+    quint64 m_requests;
+    QString m_errorString;
+};
+
+Runner::Runner()
+    : m_connection(NULL)
+    , m_root(XCB_WINDOW_NONE)
+    , m_gc(XCB_NONE)
+    , m_dbus(QString())
+    , m_frames(0)
+    , m_missedFrames(0)
+    , m_requests(0)
+{
+    m_pollTimer.setInterval(s_pollInterval);
+    connect(&m_pollTimer, SIGNAL(timeout()), SLOT(poll()));
+}
+
+Runner::~Runner()
+{
+    if (m_connection) {
+        xcb_disconnect(m_connection);
+    }
+    QDBusConnection::disconnectFromBus(QLatin1String("kwin-benchmark"));
+    QProcess *processes[] = { &m_kwin, &m_bus, &m_xserver };
+    for (uint i = 0; i < sizeof(processes) / sizeof(processes[0]); ++i) {
+        if (processes[i]->state() == QProcess::NotRunning) {
+            continue;
+        }
+        processes[i]->terminate();
+        if (!processes[i]->waitForFinished(5000)) {
+            processes[i]->kill();
+            processes[i]->waitForFinished();
+        }
+    }
+}
+
+const QString &Runner::errorString() const
+{
+    return m_errorString;
+}
+
+bool Runner::setError(const QString &error)
+{
+    m_errorString = error;
+    return false;
+}
+
+bool Runner::start(const QString &kwin, const QSize &screen)
+{
+    m_screen = screen;
+    return startXServer(screen) && startSessionBus() && startKWin(kwin);
+}
+
+bool Runner::startXServer(const QSize &screen)
+{
+    for (int i = s_firstDisplay; i < s_lastDisplay && m_display.isEmpty(); ++i) {
+        if (!QFile::exists(QString::fromLatin1("/tmp/.X%1-lock").arg(i))
+                && !QFile::exists(QString::fromLatin1("/tmp/.X11-unix/X%1").arg(i))) {
+            m_display = QLatin1Char(':') + QString::number(i);
+        }
+    }
+    if (m_display.isEmpty()) {
+        return setError(QLatin1String("no free display"));
+    }
+    const QString size = QString::fromLatin1("%1x%2x24").arg(screen.width()).arg(screen.height());
+    m_xserver.setProcessChannelMode(QProcess::ForwardedChannels);
+    m_xserver.start(QLatin1String("Xvfb"), QStringList() << m_display << QLatin1String("-screen")
+                    << QLatin1String("0") << size << QLatin1String("-nolisten") << QLatin1String("tcp")
+                    << QLatin1String("+extension") << QLatin1String("Composite"));
+    if (!m_xserver.waitForStarted()) {
+        return setError(QLatin1String("failed to start Xvfb: ") + m_xserver.errorString());
+    }
+
+    // the server takes a moment before it accepts connections
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < s_startTimeout && m_xserver.state() == QProcess::Running) {
+        m_connection = xcb_connect(m_display.toLatin1().constData(), NULL);
+        if (!xcb_connection_has_error(m_connection)) {
+            break;
+        }
+        xcb_disconnect(m_connection);
+        m_connection = NULL;
+        wait(100);
+    }
+    if (!m_connection) {
+        return setError(QLatin1String("Xvfb did not come up on ") + m_display);
+    }
+    m_root = xcb_setup_roots_iterator(xcb_get_setup(m_connection)).data->root;
+    m_gc = xcb_generate_id(m_connection);
+    xcb_create_gc(m_connection, m_gc, m_root, 0, NULL);
+    return true;
+}
+
+bool Runner::startSessionBus()
+{
+    // a bus of our own, a running KWin of the user must not be replaced
+    m_bus.start(QLatin1String("dbus-daemon"), QStringList() << QLatin1String("--session")
+                << QLatin1String("--nofork") << QLatin1String("--print-address"));
+    if (!m_bus.waitForStarted() || !m_bus.waitForReadyRead(s_startTimeout)) {
+        return setError(QLatin1String("failed to start dbus-daemon: ") + m_bus.errorString());
+    }
+    m_busAddress = QString::fromLatin1(m_bus.readLine().trimmed());
+    m_dbus = QDBusConnection::connectToBus(m_busAddress, QLatin1String("kwin-benchmark"));
+    if (!m_dbus.isConnected()) {
+        return setError(QLatin1String("failed to connect to ") + m_busAddress);
+    }
+    return true;
+}
+
+bool Runner::startKWin(const QString &kwin)
+{
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert(QLatin1String("DBUS_SESSION_BUS_ADDRESS"), m_busAddress);
+    environment.insert(QLatin1String("DISPLAY"), m_display);
+    environment.insert(QLatin1String("KWIN_COMPOSE"), QLatin1String("X"));
+    m_kwin.setProcessEnvironment(environment);
+    m_kwin.setProcessChannelMode(QProcess::ForwardedChannels);
+    m_kwin.start(kwin, QStringList());
+    if (!m_kwin.waitForStarted()) {
+        return setError(QLatin1String("failed to start ") + kwin + QLatin1String(": ") + m_kwin.errorString());
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < s_startTimeout && m_kwin.state() == QProcess::Running) {
+        if (m_dbus.interface()->isServiceRegistered(QLatin1String(s_compositingService))) {
+            QDBusInterface compositing(QLatin1String(s_compositingService), QLatin1String("/Compositor"),
+                                       QLatin1String(s_compositingService), m_dbus);
+            if (compositing.property("active").toBool()) {
+                return true;
+            }
+        }
+        wait(100);
+    }
+    if (m_kwin.state() != QProcess::Running) {
+        return setError(kwin + QLatin1String(" exited"));
+    }
+    QDBusInterface compositing(QLatin1String(s_compositingService), QLatin1String("/Compositor"),
+                               QLatin1String(s_compositingService), m_dbus);
+    return setError(QLatin1String("compositing is not active: ")
+                    + compositing.property("compositingNotPossibleReason").toString());
+}
+
+bool Runner::run(const Scenario &scenario)
+{
+    QElapsedTimer timer;
+    timer.start();
+    resetStatistics();
+    m_pollTimer.start();
+    bool ok = true;
+    foreach (const Step &step, scenario.steps()) {
+        if (step.type == Step::Measure) {
+            resetStatistics();
+            timer.restart();
+            continue;
+        }
+        if (!runStep(step)) {
+            m_errorString = scenario.name() + QLatin1Char(':') + QString::number(step.line)
+                            + QLatin1String(": ") + m_errorString;
+            ok = false;
+            break;
+        }
+        if (m_kwin.state() != QProcess::Running) {
+            ok = setError(scenario.name() + QLatin1String(": kwin exited"));
+            break;
+        }
+    }
+    poll();
+    m_pollTimer.stop();
+    if (ok) {
+        report(scenario, timer.elapsed());
+    }
+    destroyWindows();
+    return ok;
+}
+
+bool Runner::runStep(const Step &step)
+{
+    switch (step.type) {
+    case Step::Windows:
+        return createWindows(step.values.first());
+    case Step::Desktops:
+        setDesktops(step.values.first());
+        break;
+    case Step::LoadEffect: {
+        const QString name = step.argument.startsWith(QLatin1String("kwin4_effect_"))
+                             ? step.argument : QLatin1String("kwin4_effect_") + step.argument;
+        QDBusInterface effects(QLatin1String(s_effectsService), QLatin1String("/Effects"),
+                               QLatin1String(s_effectsService), m_dbus);
+        QDBusReply<bool> loaded = effects.call(QLatin1String("isEffectLoaded"), name);
+        if (loaded.isValid() && loaded.value()) {
+            break;
+        }
+        QDBusReply<bool> reply = effects.call(QLatin1String("loadEffect"), name);
+        if (!reply.isValid() || !reply.value()) {
+            return setError(QLatin1String("failed to load ") + name);
+        }
+        break;
+    }
+    case Step::Damage:
+        for (int i = 0; i < step.values.at(1); ++i) {
+            for (int j = 0; j < m_windows.count(); ++j) {
+                if (step.values.first() == Step::AllWindows || step.values.first() == j) {
+                    damage(j, i);
+                }
+            }
+            xcb_flush(m_connection);
+            wait(step.values.at(2));
+        }
+        break;
+    case Step::Move:
+        for (int i = 0; i < m_windows.count(); ++i) {
+            if (step.values.first() == Step::AllWindows || step.values.first() == i) {
+                move(i, step.values.at(1), step.values.at(2));
+            }
+        }
+        xcb_flush(m_connection);
+        break;
+    case Step::Wait:
+        wait(step.values.first());
+        break;
+    case Step::PresentWindows:
+        setPresentWindows(step.argument == QLatin1String("on"));
+        break;
+    case Step::Zoom:
+        if (step.argument == QLatin1String("in")) {
+            return call(s_effectsService, "/Effects/Zoom", s_zoomInterface, QLatin1String("zoomIn"));
+        } else if (step.argument == QLatin1String("out")) {
+            return call(s_effectsService, "/Effects/Zoom", s_zoomInterface, QLatin1String("zoomOut"));
+        }
+        return call(s_effectsService, "/Effects/Zoom", s_zoomInterface, QLatin1String("actualSize"));
+    case Step::Desktop:
+        return call(s_kwinService, "/KWin", s_kwinService, QLatin1String("setCurrentDesktop"), step.values.first());
+    case Step::Measure:
+        break;
+    }
+    return true;
+}
+
+bool Runner::call(const char *service, const char *path, const char *interface, const QString &method,
+                  const QVariant &argument1, const QVariant &argument2)
+{
+    QDBusInterface object(QLatin1String(service), QLatin1String(path), QLatin1String(interface), m_dbus);
+    QDBusMessage reply;
+    if (argument2.isValid()) {
+        reply = object.call(method, argument1, argument2);
+    } else if (argument1.isValid()) {
+        reply = object.call(method, argument1);
+    } else {
+        reply = object.call(method);
+    }
+    if (reply.type() == QDBusMessage::ErrorMessage) {
+        return setError(method + QLatin1String(" failed: ") + reply.errorMessage());
+    }
+    return true;
+}
+
+bool Runner::createWindows(int count)
+{
+    const int first = m_windows.count();
+    // the geometries of the earlier windows are the same, whatever steps added them
+    const QVector<QRect> geometries = Scenario::windowGeometries(first + count, m_screen);
+    for (int i = first; i < first + count; ++i) {
+        const QRect &geometry = geometries.at(i);
+        const xcb_window_t window = xcb_generate_id(m_connection);
+        const uint32_t values[] = { 0xff000000 | (0x9e3779b9u * (i + 1) >> 8) };
+        xcb_create_window(m_connection, XCB_COPY_FROM_PARENT, window, m_root,
+                          geometry.x(), geometry.y(), geometry.width(), geometry.height(), 0,
+                          XCB_WINDOW_CLASS_INPUT_OUTPUT, XCB_COPY_FROM_PARENT, XCB_CW_BACK_PIXEL, values);
+        const QByteArray name = "benchmark " + QByteArray::number(i);
+        xcb_change_property(m_connection, XCB_PROP_MODE_REPLACE, window, XCB_ATOM_WM_NAME,
+                            XCB_ATOM_STRING, 8, name.length(), name.constData());
+        xcb_change_property(m_connection, XCB_PROP_MODE_REPLACE, window, XCB_ATOM_WM_CLASS,
+                            XCB_ATOM_STRING, 8, sizeof(s_wmClass), s_wmClass);
+        xcb_map_window(m_connection, window);
+        m_windows << window;
+        m_geometries << geometry;
+    }
+    xcb_flush(m_connection);
+    return waitForClients();
+}
+
+void Runner::destroyWindows()
+{
+    foreach (xcb_window_t window, m_windows) {
+        xcb_destroy_window(m_connection, window);
+    }
+    m_windows.clear();
+    m_geometries.clear();
+    xcb_flush(m_connection);
+    // let the close animations end before the next scenario measures anything
+    wait(1000);
+}
+
+bool Runner::waitForClients()
+{
+    const xcb_atom_t clientList = atom("_NET_CLIENT_LIST");
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < s_startTimeout) {
+        xcb_get_property_cookie_t cookie = xcb_get_property(m_connection, false, m_root, clientList,
+                                                            XCB_ATOM_WINDOW, 0, 0x10000);
+        xcb_get_property_reply_t *reply = xcb_get_property_reply(m_connection, cookie, NULL);
+        int managed = 0;
+        if (reply) {
+            const xcb_window_t *clients = reinterpret_cast<xcb_window_t*>(xcb_get_property_value(reply));
+            const int length = xcb_get_property_value_length(reply) / sizeof(xcb_window_t);
+            for (int i = 0; i < length; ++i) {
+                if (m_windows.contains(clients[i])) {
+                    managed++;
+                }
+            }
+            free(reply);
+        }
+        if (managed == m_windows.count()) {
+            return true;
+        }
+        wait(100);
+    }
+    return setError(QLatin1String("the windows were not managed"));
+}
+
+void Runner::damage(int window, int iteration)
+{
+    // a quarter of the window in another color every time, like a busy application
+    static const uint32_t colors[] = { 0xffef2929, 0xff8ae234, 0xff729fcf, 0xfffce94f, 0xffad7fa8 };
+    const QRect &geometry = m_geometries.at(window);
+    const uint16_t width = geometry.width() / 2;
+    const uint16_t height = geometry.height() / 2;
+    const xcb_rectangle_t rect = {
+        int16_t((iteration % 2) * width), int16_t((iteration / 2 % 2) * height), width, height
+    };
+    const uint32_t color = colors[(window + iteration) % (sizeof(colors) / sizeof(colors[0]))];
+    xcb_change_gc(m_connection, m_gc, XCB_GC_FOREGROUND, &color);
+    xcb_poly_fill_rectangle(m_connection, m_windows.at(window), m_gc, 1, &rect);
+}
+
+void Runner::move(int window, int dx, int dy)
+{
+    QRect &geometry = m_geometries[window];
+    geometry.translate(dx, dy);
+    const uint32_t values[] = { uint32_t(geometry.x()), uint32_t(geometry.y()) };
+    xcb_configure_window(m_connection, m_windows.at(window), XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y, values);
+}
+
+void Runner::setPresentWindows(bool enable)
+{
+    if (m_windows.isEmpty()) {
+        return;
+    }
+    // the same property pagers set on their window, -1 for the windows of all desktops
+    const xcb_atom_t presentWindows = atom("_KDE_PRESENT_WINDOWS_DESKTOP");
+    if (enable) {
+        const int32_t desktop = -1;
+        xcb_change_property(m_connection, XCB_PROP_MODE_REPLACE, m_windows.first(), presentWindows,
+                            presentWindows, 32, 1, &desktop);
+    } else {
+        xcb_delete_property(m_connection, m_windows.first(), presentWindows);
+    }
+    xcb_flush(m_connection);
+}
+
+void Runner::setDesktops(int count)
+{
+    xcb_client_message_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.response_type = XCB_CLIENT_MESSAGE;
+    event.format = 32;
+    event.window = m_root;
+    event.type = atom("_NET_NUMBER_OF_DESKTOPS");
+    event.data.data32[0] = count;
+    xcb_send_event(m_connection, false, m_root,
+                   XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT | XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY,
+                   reinterpret_cast<const char*>(&event));
+    xcb_flush(m_connection);
+}
+
+xcb_atom_t Runner::atom(const char *name)
+{
+    xcb_intern_atom_reply_t *reply = xcb_intern_atom_reply(m_connection,
+        xcb_intern_atom(m_connection, false, strlen(name), name), NULL);
+    if (!reply) {
+        return XCB_ATOM_NONE;
+    }
+    const xcb_atom_t atom = reply->atom;
+    free(reply);
+    return atom;
+}
+
+void Runner::wait(int msec)
+{
+    QEventLoop loop;
+    QTimer::singleShot(msec, &loop, SLOT(quit()));
+    loop.exec();
+    // nothing is selected, only errors end up here
+    while (m_connection) {
+        xcb_generic_event_t *event = xcb_poll_for_event(m_connection);
+        if (!event) {
+            break;
+        }
+        free(event);
+    }
+}
+
+void Runner::poll()
+{
+    QDBusInterface compositing(QLatin1String(s_compositingService), QLatin1String("/Compositor"),
+                               QLatin1String(s_compositingService), m_dbus);
+    QDBusReply<QList<int> > total = compositing.call(QLatin1String("frameTimingHistogram"), QLatin1String("total"));
+    QDBusReply<QList<int> > paint = compositing.call(QLatin1String("frameTimingHistogram"), QLatin1String("paint"));
+    if (total.isValid()) {
+        m_total.add(total.value());
+    }
+    if (paint.isValid()) {
+        m_paint.add(paint.value());
+    }
+    m_frames += compositing.property("frames").toULongLong();
+    m_missedFrames += compositing.property("missedFrames").toULongLong();
+    m_requests += compositing.property("requests").toULongLong();
+    compositing.call(QLatin1String("resetFrameTimings"));
+}
+
+void Runner::resetStatistics()
+{
+    QDBusInterface compositing(QLatin1String(s_compositingService), QLatin1String("/Compositor"),
+                               QLatin1String(s_compositingService), m_dbus);
+    compositing.call(QLatin1String("resetFrameTimings"));
+    m_total.clear();
+    m_paint.clear();
+    m_frames = 0;
+    m_missedFrames = 0;
+    m_requests = 0;
+}
+
+static QString formatTime(const FrameStatistics &statistics, int time)
+{
+    if (time < 0) {
+        return QLatin1String("-");
+    }
+    return (statistics.isOverflow(time) ? QLatin1String(">=") : QString()) + QString::number(time);
+}
+
+static void reportStage(QTextStream &out, const char *stage, const FrameStatistics &statistics)
+{
+    out << "  " << stage << " ms: p50 " << formatTime(statistics, statistics.percentile(0.5))
+        << " p90 " << formatTime(statistics, statistics.percentile(0.9))
+        << " p99 " << formatTime(statistics, statistics.percentile(0.99))
+        << " max " << formatTime(statistics, statistics.maximum()) << endl;
+}
+
+void Runner::report(const Scenario &scenario, qint64 elapsed)
+{
+    QTextStream out(stdout);
+    out << scenario.name() << ": " << m_frames << " frames in " << elapsed << " ms, "
+        << m_missedFrames << " missed" << endl;
+    out << "  requests: " << m_requests << ", "
+        << (m_frames ? qreal(m_requests) / m_frames : qreal(0.0)) << " per frame" << endl;
+    reportStage(out, "total", m_total);
+    reportStage(out, "paint", m_paint);
+}
+
+} // namespace Benchmark
+} // namespace KWin
+
+using namespace KWin::Benchmark;
+
+static int usage()
+{
+    QTextStream(stderr) << "Usage: kwin-benchmark [--kwin <executable>] [--screen <width>x<height>] <scenario>..." << endl;
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList arguments = app.arguments();
+    arguments.removeFirst();
+
+    QString kwin = QLatin1String("kwin");
+    QSize screen(1920, 1080);
+    QList<Scenario> scenarios;
+    while (!arguments.isEmpty()) {
+        const QString argument = arguments.takeFirst();
+        if (argument == QLatin1String("--kwin") && !arguments.isEmpty()) {
+            kwin = arguments.takeFirst();
+        } else if (argument == QLatin1String("--screen") && !arguments.isEmpty()) {
+            const QStringList size = arguments.takeFirst().split(QLatin1Char('x'));
+            screen = size.count() == 2 ? QSize(size.first().toInt(), size.last().toInt()) : QSize();
+            if (screen.width() < 640 || screen.height() < 480) {
+                return usage();
+            }
+        } else if (argument.startsWith(QLatin1Char('-'))) {
+            return usage();
+        } else {
+            Scenario scenario;
+            if (!scenario.load(argument)) {
+                QTextStream(stderr) << scenario.errorString() << endl;
+                return 1;
+            }
+            scenarios << scenario;
+        }
+    }
+    if (scenarios.isEmpty()) {
+        return usage();
+    }
+
+    Runner runner;
+    if (!runner.start(kwin, screen)) {
+        QTextStream(stderr) << runner.errorString() << endl;
+        return 1;
+    }
+    int ret = 0;
+    foreach (const Scenario &scenario, scenarios) {
+        if (!runner.run(scenario)) {
+            QTextStream(stderr) << runner.errorString() << endl;
+            ret = 1;
+        }
+    }
+    return ret;
+}
+
+#include "kwinbenchmark.moc"
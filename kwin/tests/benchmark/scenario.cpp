@@ -0,0 +1,192 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "scenario.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <QTextStream>
+
+namespace KWin
+{
+namespace Benchmark
+{
+
+static const struct {
+    const char *name;
+    Step::Type type;
+    int values; ///< the number of numeric arguments
+    const char *words; ///< the allowed word arguments separated by |, * for any word
+} s_commands[] = {
+    { "windows", Step::Windows, 1, NULL },
+    { "desktops", Step::Desktops, 1, NULL },
+    { "load", Step::LoadEffect, 0, "*" },
+    { "measure", Step::Measure, 0, NULL },
+    { "damage", Step::Damage, 3, NULL },
+    { "move", Step::Move, 3, NULL },
+    { "wait", Step::Wait, 1, NULL },
+    { "present-windows", Step::PresentWindows, 0, "on|off" },
+    { "zoom", Step::Zoom, 0, "in|out|reset" },
+    { "desktop", Step::Desktop, 1, NULL }
+};
+
+Scenario::Scenario()
+    : m_windowCount(0)
+{
+}
+
+bool Scenario::load(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        m_errorString = fileName + QLatin1String(": ") + file.errorString();
+        return false;
+    }
+    m_name = QFileInfo(fileName).baseName();
+    if (!parse(&file)) {
+        m_errorString.prepend(fileName + QLatin1Char(':'));
+        return false;
+    }
+    return true;
+}
+
+bool Scenario::parse(QIODevice *device)
+{
+    m_steps.clear();
+    m_windowCount = 0;
+    m_errorString.clear();
+    QTextStream stream(device);
+    int lineNumber = 0;
+    while (!stream.atEnd()) {
+        const QString line = stream.readLine().trimmed();
+        lineNumber++;
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#'))) {
+            continue;
+        }
+        if (!parseLine(line, lineNumber)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Scenario::parseLine(const QString &line, int lineNumber)
+{
+    QStringList words = line.split(QLatin1Char(' '), QString::SkipEmptyParts);
+    const QString command = words.takeFirst();
+    int index = -1;
+    for (uint i = 0; i < sizeof(s_commands) / sizeof(s_commands[0]); ++i) {
+        if (command == QLatin1String(s_commands[i].name)) {
+            index = i;
+            break;
+        }
+    }
+    if (index == -1) {
+        return setError(lineNumber, QLatin1String("unknown command ") + command);
+    }
+
+    Step step;
+    step.type = s_commands[index].type;
+    step.line = lineNumber;
+    const int expected = s_commands[index].values + (s_commands[index].words ? 1 : 0);
+    if (words.count() != expected) {
+        return setError(lineNumber, command + QLatin1String(" takes ") + QString::number(expected)
+                                    + QLatin1String(" arguments"));
+    }
+    if (s_commands[index].words) {
+        const QString allowed = QLatin1String(s_commands[index].words);
+        step.argument = words.takeFirst();
+        if (allowed != QLatin1String("*") && !allowed.split(QLatin1Char('|')).contains(step.argument)) {
+            return setError(lineNumber, command + QLatin1String(" takes one of ") + allowed);
+        }
+    }
+    foreach (const QString &word, words) {
+        // the first argument of damage and move is a window
+        const bool window = step.values.isEmpty() && (step.type == Step::Damage || step.type == Step::Move);
+        if (window && word == QLatin1String("all")) {
+            step.values << Step::AllWindows;
+            continue;
+        }
+        bool ok = false;
+        const int value = word.toInt(&ok);
+        if (!ok) {
+            return setError(lineNumber, word + QLatin1String(" is not a number"));
+        }
+        if (window && (value < 0 || value >= m_windowCount)) {
+            return setError(lineNumber, QLatin1String("there is no window ") + word);
+        }
+        step.values << value;
+    }
+
+    switch (step.type) {
+    case Step::Windows:
+    case Step::Desktops:
+    case Step::Desktop:
+        if (step.values.first() < 1) {
+            return setError(lineNumber, command + QLatin1String(" needs a positive number"));
+        }
+        break;
+    case Step::Damage:
+        if (step.values.at(1) < 0 || step.values.at(2) < 0) {
+            return setError(lineNumber, command + QLatin1String(" needs positive numbers"));
+        }
+        break;
+    case Step::Wait:
+        if (step.values.first() < 0) {
+            return setError(lineNumber, command + QLatin1String(" needs a positive number"));
+        }
+        break;
+    default:
+        break;
+    }
+    if (step.type == Step::Windows) {
+        m_windowCount += step.values.first();
+    }
+    m_steps << step;
+    return true;
+}
+
+bool Scenario::setError(int lineNumber, const QString &error)
+{
+    m_errorString = QString::number(lineNumber) + QLatin1String(": ") + error;
+    return false;
+}
+
+QVector<QRect> Scenario::windowGeometries(int count, const QSize &screen)
+{
+    QVector<QRect> geometries;
+    geometries.reserve(count);
+    quint32 seed = 42;
+    for (int i = 0; i < count; ++i) {
+        seed = seed * 1103515245 + 12345;
+        const int width = qMin(screen.width(), 200 + int((seed >> 16) % 1000));
+        seed = seed * 1103515245 + 12345;
+        const int height = qMin(screen.height(), 150 + int((seed >> 16) % 600));
+        seed = seed * 1103515245 + 12345;
+        const int x = (seed >> 16) % (screen.width() - width + 1);
+        seed = seed * 1103515245 + 12345;
+        const int y = (seed >> 16) % (screen.height() - height + 1);
+        geometries << QRect(x, y, width, height);
+    }
+    return geometries;
+}
+
+} // namespace Benchmark
+} // namespace KWin
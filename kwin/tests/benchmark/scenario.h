@@ -0,0 +1,136 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_BENCHMARK_SCENARIO_H
+#define KWIN_BENCHMARK_SCENARIO_H
+
+#include <QList>
+#include <QRect>
+#include <QString>
+#include <QVector>
+
+class QIODevice;
+
+namespace KWin
+{
+namespace Benchmark
+{
+
+/**
+ * @brief One line of a Scenario.
+ */
+class Step
+{
+public:
+    enum Type {
+        Windows, ///< windows \<count\>: maps that many windows of different sizes
+        Desktops, ///< desktops \<count\>: changes the number of virtual desktops
+        LoadEffect, ///< load \<effect\>: loads the effect unless it is loaded already
+        Measure, ///< measure: forgets the frames painted so far
+        Damage, ///< damage \<window|all\> \<times\> \<interval\>: repaints parts of the window
+        Move, ///< move \<window|all\> \<dx\> \<dy\>: moves the window
+        Wait, ///< wait \<milliseconds\>
+        PresentWindows, ///< present-windows on|off
+        Zoom, ///< zoom in|out|reset
+        Desktop ///< desktop \<number\>: switches to the virtual desktop
+    };
+    enum {
+        AllWindows = -1
+    };
+    Type type;
+    /**
+     * The effect to load or the word argument of present-windows and zoom.
+     */
+    QString argument;
+    QList<int> values;
+    int line;
+};
+
+/**
+ * @brief A scripted sequence of client window updates and effect activations.
+ *
+ * A scenario is a text file with one Step per line, empty lines and lines starting with
+ * a # are ignored. Which windows exist is known while parsing, so a scenario referring to a
+ * window it did not create is rejected before anything runs.
+ */
+class Scenario
+{
+public:
+    Scenario();
+
+    bool load(const QString &fileName);
+    bool parse(QIODevice *device);
+
+    /**
+     * @returns The file name without the directory and the extension.
+     */
+    const QString &name() const;
+    void setName(const QString &name);
+    const QList<Step> &steps() const;
+    /**
+     * @returns The number of windows created by all the steps.
+     */
+    int windowCount() const;
+    const QString &errorString() const;
+
+    /**
+     * @returns The geometries of @p count windows fitting into @p screen, the same ones
+     * every time.
+     */
+    static QVector<QRect> windowGeometries(int count, const QSize &screen);
+
+private:
+    bool parseLine(const QString &line, int lineNumber);
+    bool setError(int lineNumber, const QString &error);
+
+    QString m_name;
+    QList<Step> m_steps;
+    int m_windowCount;
+    QString m_errorString;
+};
+
+inline const QString &Scenario::name() const
+{
+    return m_name;
+}
+
+inline void Scenario::setName(const QString &name)
+{
+    m_name = name;
+}
+
+inline const QList<Step> &Scenario::steps() const
+{
+    return m_steps;
+}
+
+inline int Scenario::windowCount() const
+{
+    return m_windowCount;
+}
+
+inline const QString &Scenario::errorString() const
+{
+    return m_errorString;
+}
+
+} // namespace Benchmark
+} // namespace KWin
+
+#endif
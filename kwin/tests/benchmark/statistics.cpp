@@ -0,0 +1,78 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "statistics.h"
+
+#include <qmath.h>
+
+namespace KWin
+{
+namespace Benchmark
+{
+
+FrameStatistics::FrameStatistics()
+    : m_count(0)
+{
+}
+
+void FrameStatistics::add(const QList<int> &histogram)
+{
+    if (m_buckets.count() < histogram.count()) {
+        m_buckets.resize(histogram.count());
+    }
+    for (int i = 0; i < histogram.count(); ++i) {
+        m_buckets[i] += histogram.at(i);
+        m_count += histogram.at(i);
+    }
+}
+
+void FrameStatistics::clear()
+{
+    m_buckets.clear();
+    m_count = 0;
+}
+
+int FrameStatistics::percentile(qreal fraction) const
+{
+    if (m_count == 0) {
+        return -1;
+    }
+    const int frames = qMax(1, qCeil(qBound(qreal(0.0), fraction, qreal(1.0)) * m_count));
+    int sum = 0;
+    for (int i = 0; i < m_buckets.count(); ++i) {
+        sum += m_buckets.at(i);
+        if (sum >= frames) {
+            return i;
+        }
+    }
+    return m_buckets.count() - 1;
+}
+
+int FrameStatistics::maximum() const
+{
+    for (int i = m_buckets.count() - 1; i >= 0; --i) {
+        if (m_buckets.at(i) > 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+} // namespace Benchmark
+} // namespace KWin
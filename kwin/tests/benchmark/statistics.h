@@ -0,0 +1,82 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_BENCHMARK_STATISTICS_H
+#define KWIN_BENCHMARK_STATISTICS_H
+
+#include <QList>
+#include <QVector>
+
+namespace KWin
+{
+namespace Benchmark
+{
+
+/**
+ * @brief The distribution of frame times over a whole scenario.
+ *
+ * The compositor only remembers the last frames, so the benchmark fetches its histograms
+ * every now and then and adds them up here.
+ */
+class FrameStatistics
+{
+public:
+    FrameStatistics();
+
+    /**
+     * Adds a histogram as returned by Compositor::frameTimingHistogram(), one bucket per
+     * millisecond, the last one counting all longer frames.
+     */
+    void add(const QList<int> &histogram);
+    void clear();
+
+    int count() const;
+    /**
+     * @returns The time in milliseconds @p fraction of the frames did not take longer than,
+     * @c -1 without frames.
+     */
+    int percentile(qreal fraction) const;
+    /**
+     * @returns The time of the longest frame in milliseconds, @c -1 without frames.
+     */
+    int maximum() const;
+    /**
+     * @returns Whether @p time is the last bucket, which stands for that time or longer.
+     */
+    bool isOverflow(int time) const;
+
+private:
+    QVector<int> m_buckets;
+    int m_count;
+};
+
+inline int FrameStatistics::count() const
+{
+    return m_count;
+}
+
+inline bool FrameStatistics::isOverflow(int time) const
+{
+    return time == m_buckets.count() - 1;
+}
+
+} // namespace Benchmark
+} // namespace KWin
+
+#endif
@@ -0,0 +1,162 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "benchmark/scenario.h"
+#include "benchmark/statistics.h"
+// Qt
+#include <QBuffer>
+#include <QtTest/QtTest>
+
+using namespace KWin::Benchmark;
+
+static bool parse(Scenario &scenario, const QByteArray &text)
+{
+    QBuffer buffer;
+    buffer.setData(text);
+    buffer.open(QIODevice::ReadOnly);
+    return scenario.parse(&buffer);
+}
+
+class TestBenchmarkScenario : public QObject
+{
+    Q_OBJECT
+private slots:
+    void parseSteps();
+    void invalid_data();
+    void invalid();
+    void windowGeometries();
+    void statistics();
+};
+
+void TestBenchmarkScenario::parseSteps()
+{
+    Scenario scenario;
+    QVERIFY(parse(scenario,
+                  "# a comment\n"
+                  "load presentwindows\n"
+                  "\n"
+                  "windows 4\n"
+                  "  windows 2\n"
+                  "measure\n"
+                  "damage all 10 16\n"
+                  "move 5 -20 30\n"
+                  "present-windows on\n"
+                  "zoom reset\n"
+                  "desktop 2\n"
+                  "wait 500\n"));
+    QCOMPARE(scenario.windowCount(), 6);
+    const QList<Step> &steps = scenario.steps();
+    QCOMPARE(steps.count(), 10);
+
+    QCOMPARE(steps.at(0).type, Step::LoadEffect);
+    QCOMPARE(steps.at(0).argument, QString("presentwindows"));
+    QCOMPARE(steps.at(0).line, 2);
+    QCOMPARE(steps.at(1).type, Step::Windows);
+    QCOMPARE(steps.at(1).values, QList<int>() << 4);
+    QCOMPARE(steps.at(2).line, 5);
+    QCOMPARE(steps.at(3).type, Step::Measure);
+    QCOMPARE(steps.at(4).type, Step::Damage);
+    QCOMPARE(steps.at(4).values, QList<int>() << Step::AllWindows << 10 << 16);
+    QCOMPARE(steps.at(5).type, Step::Move);
+    QCOMPARE(steps.at(5).values, QList<int>() << 5 << -20 << 30);
+    QCOMPARE(steps.at(6).type, Step::PresentWindows);
+    QCOMPARE(steps.at(6).argument, QString("on"));
+    QCOMPARE(steps.at(7).type, Step::Zoom);
+    QCOMPARE(steps.at(7).argument, QString("reset"));
+    QCOMPARE(steps.at(8).type, Step::Desktop);
+    QCOMPARE(steps.at(9).type, Step::Wait);
+    QCOMPARE(steps.at(9).values, QList<int>() << 500);
+
+    // parsing again starts from scratch
+    QVERIFY(parse(scenario, "measure\n"));
+    QCOMPARE(scenario.steps().count(), 1);
+    QCOMPARE(scenario.windowCount(), 0);
+}
+
+void TestBenchmarkScenario::invalid_data()
+{
+    QTest::addColumn<QByteArray>("text");
+    QTest::addColumn<QString>("error");
+
+    QTest::newRow("unknown") << QByteArray("windows 1\nexplode\n") << QString("2: unknown command explode");
+    QTest::newRow("arguments") << QByteArray("wait\n") << QString("1: wait takes 1 arguments");
+    QTest::newRow("too many") << QByteArray("measure now\n") << QString("1: measure takes 0 arguments");
+    QTest::newRow("number") << QByteArray("wait long\n") << QString("1: long is not a number");
+    QTest::newRow("word") << QByteArray("zoom far\n") << QString("1: zoom takes one of in|out|reset");
+    QTest::newRow("no window") << QByteArray("windows 2\ndamage 2 1 1\n") << QString("2: there is no window 2");
+    QTest::newRow("no windows yet") << QByteArray("move 0 1 1\nwindows 1\n") << QString("1: there is no window 0");
+    QTest::newRow("no desktop") << QByteArray("desktop 0\n") << QString("1: desktop needs a positive number");
+    QTest::newRow("negative wait") << QByteArray("wait -5\n") << QString("1: wait needs a positive number");
+}
+
+void TestBenchmarkScenario::invalid()
+{
+    QFETCH(QByteArray, text);
+    QFETCH(QString, error);
+
+    Scenario scenario;
+    QVERIFY(!parse(scenario, text));
+    QCOMPARE(scenario.errorString(), error);
+}
+
+void TestBenchmarkScenario::windowGeometries()
+{
+    const QSize screen(1024, 768);
+    const QVector<QRect> geometries = Scenario::windowGeometries(50, screen);
+    QCOMPARE(geometries.count(), 50);
+    foreach (const QRect &geometry, geometries) {
+        QVERIFY(geometry.isValid());
+        QVERIFY(QRect(QPoint(0, 0), screen).contains(geometry));
+    }
+    // the same windows every run, more windows do not change the first ones
+    QCOMPARE(Scenario::windowGeometries(50, screen), geometries);
+    QCOMPARE(Scenario::windowGeometries(10, screen), geometries.mid(0, 10));
+}
+
+void TestBenchmarkScenario::statistics()
+{
+    FrameStatistics statistics;
+    QCOMPARE(statistics.percentile(0.5), -1);
+    QCOMPARE(statistics.maximum(), -1);
+
+    // 90 frames of 2 ms, 9 of 5 ms and one which took too long
+    QList<int> histogram;
+    histogram << 0 << 0 << 45 << 0 << 0 << 4 << 0 << 1;
+    statistics.add(histogram);
+    histogram[5] = 5;
+    histogram[7] = 0;
+    histogram[2] = 45;
+    statistics.add(histogram);
+    QCOMPARE(statistics.count(), 100);
+    QCOMPARE(statistics.percentile(0.5), 2);
+    QCOMPARE(statistics.percentile(0.9), 2);
+    QCOMPARE(statistics.percentile(0.95), 5);
+    QCOMPARE(statistics.percentile(0.99), 5);
+    QCOMPARE(statistics.percentile(1.0), 7);
+    QCOMPARE(statistics.maximum(), 7);
+    QVERIFY(statistics.isOverflow(7));
+    QVERIFY(!statistics.isOverflow(5));
+
+    statistics.clear();
+    QCOMPARE(statistics.count(), 0);
+    QCOMPARE(statistics.percentile(0.5), -1);
+}
+
+QTEST_MAIN(TestBenchmarkScenario)
+#include "test_benchmark_scenario.moc"
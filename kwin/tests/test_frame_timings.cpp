@@ -0,0 +1,180 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../frametimings.h"
+// Qt
+#include <QtTest/QtTest>
+
+using namespace KWin;
+
+static const qint64 s_interval = 16 * 1000 * 1000;
+
+static FrameTiming frame(qint64 totalMs)
+{
+    FrameTiming timing;
+    timing.prePaint = totalMs * 1000 * 100;
+    timing.paint = totalMs * 1000 * 700;
+    timing.windows = totalMs * 1000 * 500;
+    timing.slowestWindow = totalMs * 1000 * 400;
+    timing.postPaint = totalMs * 1000 * 100;
+    timing.present = totalMs * 1000 * 100;
+    timing.total = totalMs * 1000 * 1000;
+    return timing;
+}
+
+class TestFrameTimings : public QObject
+{
+    Q_OBJECT
+private slots:
+    void empty();
+    void order();
+    void wrapAround();
+    void predictedCost();
+    void missedFrames();
+    void histogram();
+    void culledPixels();
+    void requests();
+};
+
+void TestFrameTimings::empty()
+{
+    FrameTimings timings;
+    QCOMPARE(timings.count(), 0);
+    QCOMPARE(timings.frames(), quint64(0));
+    QCOMPARE(timings.predictedCost(), qint64(-1));
+    QVERIFY(timings.timings(10).isEmpty());
+}
+
+void TestFrameTimings::order()
+{
+    FrameTimings timings;
+    for (int i = 1; i <= 3; ++i) {
+        timings.add(frame(i), s_interval);
+    }
+    QCOMPARE(timings.count(), 3);
+    QCOMPARE(timings.at(0).total, frame(3).total);
+    QCOMPARE(timings.at(2).total, frame(1).total);
+
+    const QVector<FrameTiming> last = timings.timings(2);
+    QCOMPARE(last.count(), 2);
+    QCOMPARE(last.at(0).total, frame(3).total);
+    QCOMPARE(last.at(1).total, frame(2).total);
+    QCOMPARE(timings.timings(100).count(), 3);
+}
+
+void TestFrameTimings::wrapAround()
+{
+    FrameTimings timings;
+    const int frames = FrameTimings::Capacity + 10;
+    for (int i = 0; i < frames; ++i) {
+        timings.add(frame(i % 20), s_interval);
+    }
+    QCOMPARE(timings.count(), int(FrameTimings::Capacity));
+    QCOMPARE(timings.frames(), quint64(frames));
+    QCOMPARE(timings.at(0).total, frame((frames - 1) % 20).total);
+    QCOMPARE(timings.at(FrameTimings::Capacity - 1).total, frame(10 % 20).total);
+
+    timings.clear();
+    QCOMPARE(timings.count(), 0);
+    QCOMPARE(timings.frames(), quint64(0));
+}
+
+void TestFrameTimings::predictedCost()
+{
+    FrameTimings timings;
+    timings.add(frame(12), s_interval);
+    QCOMPARE(timings.predictedCost(), frame(12).total);
+    // a cheap frame does not make the next one cheap
+    timings.add(frame(1), s_interval);
+    QCOMPARE(timings.predictedCost(), frame(12).total);
+    // but the expensive frame is forgotten after a while
+    for (int i = 0; i < 8; ++i) {
+        timings.add(frame(2), s_interval);
+    }
+    QCOMPARE(timings.predictedCost(), frame(2).total);
+}
+
+void TestFrameTimings::missedFrames()
+{
+    FrameTimings timings;
+    timings.add(frame(10), s_interval);
+    timings.add(frame(16), s_interval);
+    timings.add(frame(17), s_interval);
+    timings.add(frame(40), s_interval);
+    QCOMPARE(timings.frames(), quint64(4));
+    QCOMPARE(timings.missedFrames(), quint64(2));
+}
+
+void TestFrameTimings::histogram()
+{
+    FrameTimings timings;
+    timings.add(frame(0), s_interval);
+    timings.add(frame(3), s_interval);
+    timings.add(frame(3), s_interval);
+    timings.add(frame(200), s_interval);
+
+    const QList<int> total = timings.histogram(FrameTimings::TotalStage);
+    QCOMPARE(total.count(), int(FrameTimings::HistogramBuckets));
+    QCOMPARE(total.at(0), 1);
+    QCOMPARE(total.at(3), 2);
+    QCOMPARE(total.last(), 1);
+
+    // 3 ms frames spent 1.5 ms painting windows
+    const QList<int> windows = timings.histogram(FrameTimings::WindowsStage);
+    QCOMPARE(windows.at(0), 1);
+    QCOMPARE(windows.at(1), 2);
+    QCOMPARE(windows.last(), 1);
+
+    // and 1.2 ms of that on a single window
+    const QList<int> slowestWindow = timings.histogram(FrameTimings::SlowestWindowStage);
+    QCOMPARE(slowestWindow.at(0), 1);
+    QCOMPARE(slowestWindow.at(1), 2);
+    QCOMPARE(slowestWindow.last(), 1);
+}
+
+void TestFrameTimings::culledPixels()
+{
+    FrameTimings timings;
+    FrameTiming timing = frame(5);
+    timing.culledPixels = 1920 * 1080;
+    timings.add(timing, s_interval);
+    timings.add(frame(5), s_interval);
+    timings.add(timing, s_interval);
+    QCOMPARE(timings.culledPixels(), quint64(2 * 1920 * 1080));
+
+    timings.clear();
+    QCOMPARE(timings.culledPixels(), quint64(0));
+}
+
+void TestFrameTimings::requests()
+{
+    FrameTimings timings;
+    FrameTiming timing = frame(5);
+    timing.requests = 120;
+    timings.add(timing, s_interval);
+    timing.requests = 30;
+    timings.add(timing, s_interval);
+    QCOMPARE(timings.requests(), quint64(150));
+
+    timings.clear();
+    QCOMPARE(timings.requests(), quint64(0));
+}
+
+QTEST_MAIN(TestFrameTimings)
+#include "test_frame_timings.moc"
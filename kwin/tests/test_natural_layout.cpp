@@ -0,0 +1,138 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../effects/presentwindows/naturallayout.h"
+#include "benchmark/scenario.h"
+// Qt
+#include <QtTest/QtTest>
+
+using namespace KWin;
+
+static const QRect s_area(0, 0, 1920, 1080);
+
+// the windows kwin-benchmark maps, so the layouts measured here are the ones the
+// effect calculates while running its scenarios
+static QVector<QRect> createWindows(int count)
+{
+    return Benchmark::Scenario::windowGeometries(count, s_area.size());
+}
+
+class TestNaturalLayout : public QObject
+{
+    Q_OBJECT
+private slots:
+    void empty();
+    void noOverlap_data();
+    void noOverlap();
+    void cache();
+    void layout_data();
+    void layout();
+};
+
+void TestNaturalLayout::empty()
+{
+    QVERIFY(NaturalLayout::calculate(QVector<QRect>(), s_area, 20, true).isEmpty());
+}
+
+void TestNaturalLayout::noOverlap_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("fillGaps");
+
+    QTest::newRow("2") << 2 << false;
+    QTest::newRow("2 fill gaps") << 2 << true;
+    QTest::newRow("10") << 10 << false;
+    QTest::newRow("10 fill gaps") << 10 << true;
+    QTest::newRow("30") << 30 << false;
+    QTest::newRow("30 fill gaps") << 30 << true;
+}
+
+void TestNaturalLayout::noOverlap()
+{
+    QFETCH(int, count);
+    QFETCH(bool, fillGaps);
+
+    const QVector<QRect> windows = createWindows(count);
+    const QVector<QRect> targets = NaturalLayout::calculate(windows, s_area, 20, fillGaps);
+    QCOMPARE(targets.count(), windows.count());
+    for (int i = 0; i < targets.count(); ++i) {
+        QVERIFY(targets.at(i).isValid());
+        QVERIFY(s_area.contains(targets.at(i)));
+        for (int j = i + 1; j < targets.count(); ++j) {
+            QVERIFY(!targets.at(i).intersects(targets.at(j)));
+        }
+    }
+}
+
+void TestNaturalLayout::cache()
+{
+    NaturalLayout layout;
+    const QVector<QRect> windows = createWindows(20);
+    QVERIFY(!layout.isCached(windows, s_area));
+
+    const QVector<QRect> targets = layout.layout(windows, s_area);
+    QVERIFY(layout.isCached(windows, s_area));
+    QCOMPARE(layout.layout(windows, s_area), targets);
+    QCOMPARE(targets, NaturalLayout::calculate(windows, s_area, layout.accuracy(), layout.isFillGaps()));
+
+    // another screen or a moved window is laid out again
+    QVERIFY(!layout.isCached(windows, s_area.translated(1920, 0)));
+    QVector<QRect> moved = windows;
+    moved[3].translate(1, 0);
+    QVERIFY(!layout.isCached(moved, s_area));
+
+    // only the last layouts are remembered
+    for (int i = 1; i <= NaturalLayout::CacheSize; ++i) {
+        layout.layout(createWindows(i), s_area);
+    }
+    QVERIFY(!layout.isCached(windows, s_area));
+
+    // changing the settings changes the layout
+    layout.layout(windows, s_area);
+    layout.setAccuracy(40);
+    QVERIFY(!layout.isCached(windows, s_area));
+}
+
+void TestNaturalLayout::layout_data()
+{
+    QTest::addColumn<QString>("scenario");
+
+    QTest::newRow("presentwindows") << "presentwindows";
+    QTest::newRow("manywindows") << "manywindows";
+}
+
+void TestNaturalLayout::layout()
+{
+    QFETCH(QString, scenario);
+
+    Benchmark::Scenario benchmark;
+    QVERIFY2(benchmark.load(KDESRCDIR "benchmark/scenarios/" + scenario + ".scenario"),
+             qPrintable(benchmark.errorString()));
+    QVERIFY(benchmark.windowCount() > 0);
+
+    const QVector<QRect> windows = createWindows(benchmark.windowCount());
+    QVector<QRect> targets;
+    QBENCHMARK {
+        targets = NaturalLayout::calculate(windows, s_area, 20, true);
+    }
+    QCOMPARE(targets.count(), windows.count());
+}
+
+QTEST_MAIN(TestNaturalLayout)
+#include "test_natural_layout.moc"
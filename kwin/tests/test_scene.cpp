@@ -0,0 +1,230 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "testutils.h"
+// KWin
+#include <kwinxrenderutils.h>
+// Qt
+#include <QApplication>
+#include <QtTest/QtTest>
+// xcb
+#include <xcb/xcb.h>
+#include <xcb/render.h>
+#include <xcb/xfixes.h>
+
+using namespace KWin;
+
+/**
+ * The sequence number of the next request, the difference of two of them is the number of
+ * requests sent in between (plus the no-op itself).
+ **/
+static unsigned int nextSequence()
+{
+    return xcb_no_operation(connection()).sequence;
+}
+
+static XRenderPicture createPicture(int width, int height)
+{
+    xcb_pixmap_t pix = xcb_generate_id(connection());
+    xcb_create_pixmap(connection(), 32, pix, rootWindow(), width, height);
+    XRenderPicture picture(pix, 32);
+    xcb_free_pixmap(connection(), pix);
+    return picture;
+}
+
+static xcb_render_transform_t scaleTransform(double scale)
+{
+    const xcb_render_fixed_t one = 1 << 16;
+    const xcb_render_transform_t transform = {
+        xcb_render_fixed_t(one / scale), 0, 0,
+        0, xcb_render_fixed_t(one / scale), 0,
+        0, 0, one
+    };
+    return transform;
+}
+
+static void sync()
+{
+    free(xcb_get_input_focus_reply(connection(), xcb_get_input_focus_unchecked(connection()), NULL));
+}
+
+class TestScene : public QObject
+{
+    Q_OBJECT
+private slots:
+    void pictureState();
+    void blendPicture();
+    void pictureClip();
+    void paintWindows_data();
+    void paintWindows();
+};
+
+void TestScene::pictureState()
+{
+    XRenderPicture picture = createPicture(16, 16);
+    XRenderPictureState state(picture);
+    QCOMPARE(state.picture(), xcb_render_picture_t(picture));
+
+    // nothing is known about a new picture, so everything is sent once
+    unsigned int before = nextSequence();
+    state.setTransform(xRenderIdentityTransform());
+    state.setFilter("fast");
+    state.setRepeat(XCB_RENDER_REPEAT_NONE);
+    QCOMPARE(nextSequence() - before, 4u);
+
+    // setting the same state again is free
+    before = nextSequence();
+    for (int i = 0; i < 10; ++i) {
+        state.setTransform(xRenderIdentityTransform());
+        state.setFilter("fast");
+        state.setRepeat(XCB_RENDER_REPEAT_NONE);
+    }
+    QCOMPARE(nextSequence() - before, 1u);
+
+    // a scaled window changes it and goes back to the identity
+    before = nextSequence();
+    state.setTransform(scaleTransform(0.5));
+    state.setFilter("good");
+    state.setRepeat(XCB_RENDER_REPEAT_PAD);
+    state.setTransform(xRenderIdentityTransform());
+    state.setRepeat(XCB_RENDER_REPEAT_NONE);
+    state.setFilter("good");
+    QCOMPARE(nextSequence() - before, 6u);
+
+    // a new picture starts over
+    XRenderPicture other = createPicture(16, 16);
+    state.setPicture(other);
+    before = nextSequence();
+    state.setTransform(xRenderIdentityTransform());
+    QCOMPARE(nextSequence() - before, 2u);
+}
+
+void TestScene::blendPicture()
+{
+    XRenderPicture first = xRenderBlendPicture(0.5);
+    QVERIFY(first != XCB_RENDER_PICTURE_NONE);
+
+    unsigned int before = nextSequence();
+    for (int i = 0; i < 10; ++i) {
+        QCOMPARE(xcb_render_picture_t(xRenderBlendPicture(0.5)), xcb_render_picture_t(first));
+    }
+    QCOMPARE(nextSequence() - before, 1u);
+
+    // a different opacity refills the same picture
+    before = nextSequence();
+    QCOMPARE(xcb_render_picture_t(xRenderBlendPicture(0.75)), xcb_render_picture_t(first));
+    QCOMPARE(nextSequence() - before, 2u);
+}
+
+void TestScene::pictureClip()
+{
+    XRenderPicture picture = createPicture(64, 64);
+    const QRegion region = QRegion(0, 0, 64, 64) - QRegion(16, 16, 8, 8);
+
+    unsigned int before = nextSequence();
+    xRenderSetPictureClip(picture, region);
+    QCOMPARE(nextSequence() - before, 2u);
+
+    // the same clip through an XFixes region
+    before = nextSequence();
+    {
+        XFixesRegion fixesRegion(region);
+        xcb_xfixes_set_picture_clip_region(connection(), picture, fixesRegion, 0, 0);
+    }
+    QCOMPARE(nextSequence() - before, 4u);
+
+    sync();
+    QVERIFY(!xcb_connection_has_error(connection()));
+}
+
+void TestScene::paintWindows_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("direct 10") << 10 << false;
+    QTest::newRow("cached 10") << 10 << true;
+    QTest::newRow("direct 50") << 50 << false;
+    QTest::newRow("cached 50") << 50 << true;
+    QTest::newRow("direct 200") << 200 << false;
+    QTest::newRow("cached 200") << 200 << true;
+}
+
+void TestScene::paintWindows()
+{
+    QFETCH(int, count);
+    QFETCH(bool, cached);
+
+    XRenderPicture buffer = createPicture(640, 480);
+    QList<XRenderPicture> windows;
+    QVector<XRenderPictureState> states;
+    QVector<QRegion> clips;
+    for (int i = 0; i < count; ++i) {
+        windows << createPicture(64, 64);
+        states << XRenderPictureState(windows.last());
+        // each window is clipped by the paint region and its shape, like in PaintClipper
+        const QRect geometry((i * 64) % 640, (i * 8) % 480, 64, 64);
+        clips << (QRegion(geometry) - QRegion(geometry.adjusted(8, 8, -40, -40)));
+    }
+    const xcb_render_transform_t &identity = xRenderIdentityTransform();
+    static const char filter[] = "good";
+    sync();
+
+    // every window is painted unscaled, like most windows in most frames
+    if (cached) {
+        QBENCHMARK {
+            for (int i = 0; i < count; ++i) {
+                XRenderPictureState &state = states[i];
+                state.setTransform(identity);
+                state.setFilter(filter);
+                xRenderSetPictureClip(buffer, clips.at(i));
+                xcb_render_composite(connection(), XCB_RENDER_PICT_OP_OVER, windows[i],
+                                     xRenderBlendPicture(0.9), buffer,
+                                     0, 0, 0, 0, (i * 64) % 640, (i * 8) % 480, 64, 64);
+                xcb_xfixes_set_picture_clip_region(connection(), buffer, XCB_XFIXES_REGION_NONE, 0, 0);
+            }
+            sync();
+        }
+    } else {
+        // what SceneXrender::Window::performPaint() did for each window before, including
+        // refilling the blend picture on every call
+        xcb_render_color_t blendColor = {0, 0, 0, uint16_t(0.9 * 0xffff)};
+        XRenderPicture blend = xRenderFill(blendColor);
+        const xcb_rectangle_t blendRect = {0, 0, 1, 1};
+        QBENCHMARK {
+            for (int i = 0; i < count; ++i) {
+                const xcb_render_picture_t pic = windows[i];
+                xcb_render_set_picture_transform(connection(), pic, identity);
+                xcb_render_set_picture_filter(connection(), pic, qstrlen(filter), filter, 0, NULL);
+                xcb_render_fill_rectangles(connection(), XCB_RENDER_PICT_OP_SRC, blend, blendColor, 1, &blendRect);
+                XFixesRegion clip(clips.at(i));
+                xcb_xfixes_set_picture_clip_region(connection(), buffer, clip, 0, 0);
+                xcb_render_composite(connection(), XCB_RENDER_PICT_OP_OVER, pic,
+                                     blend, buffer,
+                                     0, 0, 0, 0, (i * 64) % 640, (i * 8) % 480, 64, 64);
+                xcb_xfixes_set_picture_clip_region(connection(), buffer, XCB_XFIXES_REGION_NONE, 0, 0);
+            }
+            sync();
+        }
+    }
+    QVERIFY(!xcb_connection_has_error(connection()));
+}
+
+KWIN_TEST_MAIN(TestScene)
+#include "test_scene.moc"
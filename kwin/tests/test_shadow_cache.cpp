@@ -0,0 +1,167 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "testutils.h"
+#include "../shadowcache.h"
+// Qt
+#include <QApplication>
+#include <QtTest/QtTest>
+
+using namespace KWin;
+
+// the images of a shadow, every shadow color gives a different shadow
+struct ShadowImages {
+    explicit ShadowImages(QRgb color, int size = 16) {
+        for (int i = 0; i < ShadowCache::ElementCount; ++i) {
+            images[i] = QImage(size, size, QImage::Format_ARGB32_Premultiplied);
+            images[i].fill(color);
+        }
+    }
+    qint64 bytes() const {
+        return ShadowCache::ElementCount * images[0].byteCount();
+    }
+    QImage images[ShadowCache::ElementCount];
+};
+
+class TestShadowCache : public QObject
+{
+    Q_OBJECT
+private slots:
+    void share();
+    void differentShadows();
+    void keepUnused();
+    void evict();
+    void clear();
+};
+
+void TestShadowCache::share()
+{
+    ShadowCache cache;
+    const ShadowImages shadow(qRgba(0, 0, 0, 128));
+    // the same content in other images is the same shadow
+    const ShadowImages copy(qRgba(0, 0, 0, 128));
+
+    const ShadowCache::Pictures *first = cache.acquire(shadow.images);
+    const ShadowCache::Pictures *second = cache.acquire(copy.images);
+    QCOMPARE(second, first);
+    QVERIFY(first->picture(0) != XCB_RENDER_PICTURE_NONE);
+    QCOMPARE(cache.count(), 1);
+    QCOMPARE(cache.bytes(), shadow.bytes());
+    QCOMPARE(cache.misses(), quint64(1));
+    QCOMPARE(cache.hits(), quint64(1));
+
+    cache.release(first);
+    QCOMPARE(cache.unusedBytes(), qint64(0));
+    cache.release(second);
+    QCOMPARE(cache.unusedBytes(), shadow.bytes());
+}
+
+void TestShadowCache::differentShadows()
+{
+    ShadowCache cache;
+    const ShadowImages active(qRgba(0, 0, 0, 128));
+    const ShadowImages inactive(qRgba(0, 0, 0, 64));
+    const ShadowImages larger(qRgba(0, 0, 0, 128), 32);
+
+    const ShadowCache::Pictures *a = cache.acquire(active.images);
+    const ShadowCache::Pictures *b = cache.acquire(inactive.images);
+    const ShadowCache::Pictures *c = cache.acquire(larger.images);
+    QVERIFY(a != b);
+    QVERIFY(a != c);
+    QVERIFY(a->picture(0) != b->picture(0));
+    QCOMPARE(cache.count(), 3);
+    QCOMPARE(cache.misses(), quint64(3));
+    QCOMPARE(cache.hits(), quint64(0));
+    cache.release(a);
+    cache.release(b);
+    cache.release(c);
+}
+
+void TestShadowCache::keepUnused()
+{
+    ShadowCache cache;
+    const ShadowImages shadow(qRgba(0, 0, 0, 128));
+
+    const ShadowCache::Pictures *pictures = cache.acquire(shadow.images);
+    const xcb_render_picture_t picture = pictures->picture(0);
+    cache.release(pictures);
+    QCOMPARE(cache.count(), 1);
+
+    // a window with the same shadow shows up again
+    pictures = cache.acquire(shadow.images);
+    QCOMPARE(pictures->picture(0), picture);
+    QCOMPARE(cache.unusedBytes(), qint64(0));
+    QCOMPARE(cache.hits(), quint64(1));
+    cache.release(pictures);
+}
+
+void TestShadowCache::evict()
+{
+    ShadowCache cache;
+    const ShadowImages first(qRgba(0, 0, 0, 32));
+    const ShadowImages second(qRgba(0, 0, 0, 64));
+    const ShadowImages third(qRgba(0, 0, 0, 96));
+    cache.setLimit(2 * first.bytes());
+
+    cache.release(cache.acquire(first.images));
+    cache.release(cache.acquire(second.images));
+    QCOMPARE(cache.count(), 2);
+    QCOMPARE(cache.evictions(), quint64(0));
+
+    // the least recently used one goes
+    cache.release(cache.acquire(third.images));
+    QCOMPARE(cache.count(), 2);
+    QCOMPARE(cache.evictions(), quint64(1));
+    QCOMPARE(cache.unusedBytes(), 2 * first.bytes());
+    cache.release(cache.acquire(second.images));
+    QCOMPARE(cache.hits(), quint64(1));
+    cache.release(cache.acquire(first.images));
+    QCOMPARE(cache.misses(), quint64(4));
+
+    // shadows in use are never freed
+    const ShadowCache::Pictures *used = cache.acquire(first.images);
+    cache.setLimit(0);
+    QCOMPARE(cache.count(), 1);
+    QCOMPARE(cache.bytes(), first.bytes());
+    QCOMPARE(cache.unusedBytes(), qint64(0));
+    cache.release(used);
+    QCOMPARE(cache.count(), 0);
+    QCOMPARE(cache.bytes(), qint64(0));
+}
+
+void TestShadowCache::clear()
+{
+    ShadowCache cache;
+    const ShadowImages first(qRgba(0, 0, 0, 32));
+    const ShadowImages second(qRgba(0, 0, 0, 64));
+
+    const ShadowCache::Pictures *used = cache.acquire(first.images);
+    cache.release(cache.acquire(second.images));
+    QCOMPARE(cache.count(), 2);
+
+    cache.clear();
+    QCOMPARE(cache.count(), 1);
+    QCOMPARE(cache.unusedBytes(), qint64(0));
+    QCOMPARE(cache.acquire(first.images), used);
+    cache.release(used);
+    cache.release(used);
+}
+
+KWIN_TEST_MAIN(TestShadowCache)
+#include "test_shadow_cache.moc"
@@ -0,0 +1,138 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../windowindex.h"
+// Qt
+#include <QtTest/QtTest>
+
+using namespace KWin;
+
+// Stands in for a Client or Unmanaged, the index only compares the pointers
+struct FakeWindow
+{
+    xcb_window_t window;
+    xcb_window_t wrapper;
+    xcb_window_t frame;
+    xcb_window_t input;
+    bool unmanaged;
+};
+
+static Toplevel *toplevel(FakeWindow *w)
+{
+    return reinterpret_cast<Toplevel*>(w);
+}
+
+class TestWindowIndex : public QObject
+{
+    Q_OBJECT
+private slots:
+    void insertFind();
+    void remove();
+    void roleOrder();
+    void ignoreNone();
+};
+
+void TestWindowIndex::insertFind()
+{
+    FakeWindow w = { 1, 2, 3, 4, false };
+    WindowIndex index;
+    index.insert(w.window, WindowIndex::WindowRole, toplevel(&w));
+    index.insert(w.wrapper, WindowIndex::WrapperRole, toplevel(&w));
+    index.insert(w.frame, WindowIndex::FrameRole, toplevel(&w));
+    index.insert(w.input, WindowIndex::InputRole, toplevel(&w));
+    QCOMPARE(index.count(), 4);
+
+    QCOMPARE(index.find(1, WindowIndex::WindowRole), toplevel(&w));
+    QCOMPARE(index.find(2, WindowIndex::WrapperRole), toplevel(&w));
+    QCOMPARE(index.find(3, WindowIndex::FrameRole), toplevel(&w));
+    QCOMPARE(index.find(4, WindowIndex::InputRole), toplevel(&w));
+    // a window is only found in its own role
+    QVERIFY(!index.find(1, WindowIndex::FrameRole));
+    QVERIFY(!index.find(3, WindowIndex::WindowRole));
+    QVERIFY(!index.find(5, WindowIndex::WindowRole));
+
+    WindowIndex::Role role;
+    QCOMPARE(index.find(3, &role), toplevel(&w));
+    QCOMPARE(role, WindowIndex::FrameRole);
+    QVERIFY(!index.find(5, &role));
+
+    // inserting the same role again replaces the entry
+    FakeWindow other = { 1, 0, 0, 0, false };
+    index.insert(1, WindowIndex::WindowRole, toplevel(&other));
+    QCOMPARE(index.count(), 4);
+    QCOMPARE(index.find(1, WindowIndex::WindowRole), toplevel(&other));
+}
+
+void TestWindowIndex::remove()
+{
+    FakeWindow w = { 1, 2, 3, 4, false };
+    FakeWindow other = { 1, 0, 0, 0, true };
+    WindowIndex index;
+    index.insert(w.window, WindowIndex::WindowRole, toplevel(&w));
+    index.insert(w.frame, WindowIndex::FrameRole, toplevel(&w));
+    index.insert(other.window, WindowIndex::UnmanagedRole, toplevel(&other));
+    QCOMPARE(index.count(), 3);
+
+    // only removed for the Toplevel it belongs to
+    index.remove(1, WindowIndex::WindowRole, toplevel(&other));
+    QCOMPARE(index.find(1, WindowIndex::WindowRole), toplevel(&w));
+    index.remove(1, WindowIndex::WindowRole, toplevel(&w));
+    QVERIFY(!index.find(1, WindowIndex::WindowRole));
+    QCOMPARE(index.find(1, WindowIndex::UnmanagedRole), toplevel(&other));
+    QCOMPARE(index.count(), 2);
+
+    index.remove(3, WindowIndex::FrameRole, toplevel(&w));
+    index.remove(1, WindowIndex::UnmanagedRole, toplevel(&other));
+    QCOMPARE(index.count(), 0);
+    // removing what is not there does nothing
+    index.remove(3, WindowIndex::FrameRole, toplevel(&w));
+    QCOMPARE(index.count(), 0);
+}
+
+void TestWindowIndex::roleOrder()
+{
+    // the same X window as managed and override redirect window, the managed one wins
+    // just like when the lists of the Workspace are searched in order
+    FakeWindow managed = { 1, 2, 3, 0, false };
+    FakeWindow unmanaged = { 1, 0, 1, 0, true };
+    WindowIndex index;
+    index.insert(unmanaged.window, WindowIndex::UnmanagedRole, toplevel(&unmanaged));
+    index.insert(managed.window, WindowIndex::WindowRole, toplevel(&managed));
+
+    WindowIndex::Role role;
+    QCOMPARE(index.find(1, &role), toplevel(&managed));
+    QCOMPARE(role, WindowIndex::WindowRole);
+
+    index.remove(1, WindowIndex::WindowRole, toplevel(&managed));
+    QCOMPARE(index.find(1, &role), toplevel(&unmanaged));
+    QCOMPARE(role, WindowIndex::UnmanagedRole);
+}
+
+void TestWindowIndex::ignoreNone()
+{
+    // clients without a decoration input window must not be found for XCB_WINDOW_NONE
+    FakeWindow w = { 1, 2, 3, XCB_WINDOW_NONE, false };
+    WindowIndex index;
+    index.insert(w.input, WindowIndex::InputRole, toplevel(&w));
+    QCOMPARE(index.count(), 0);
+    QVERIFY(!index.find(XCB_WINDOW_NONE, WindowIndex::InputRole));
+}
+
+QTEST_MAIN(TestWindowIndex)
+#include "test_window_index.moc"
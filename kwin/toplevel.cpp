@@ -20,8 +20,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "toplevel.h"
 
-#include <kxerrorhandler.h>
-
 #include "atoms.h"
 #include "client.h"
 #include "client_machine.h"
@@ -147,7 +145,18 @@ QRect Toplevel::visibleRect() const
 
 void Toplevel::getWindowRole()
 {
-    window_role = getStringProperty(window(), atoms->wm_window_role).toLower();
+    Xcb::Property property = fetchWindowRole();
+    readWindowRole(property);
+}
+
+Xcb::Property Toplevel::fetchWindowRole() const
+{
+    return Xcb::Property(window(), atoms->wm_window_role, XCB_ATOM_STRING, 10000);
+}
+
+void Toplevel::readWindowRole(Xcb::Property &property)
+{
+    window_role = property.toByteArray().toLower();
 }
 
 /*!
@@ -166,33 +175,22 @@ QByteArray Toplevel::staticWmCommand(WId w)
     return getStringProperty(w, XA_WM_COMMAND, ' ');
 }
 
-/*!
-  Returns WM_CLIENT_LEADER property for a given window.
- */
-Window Toplevel::staticWmClientLeader(WId w)
-{
-    Atom type;
-    int format, status;
-    unsigned long nitems = 0;
-    unsigned long extra = 0;
-    unsigned char *data = 0;
-    Window result = w;
-    KXErrorHandler err;
-    status = XGetWindowProperty(display(), w, atoms->wm_client_leader, 0, 10000,
-                                false, XA_WINDOW, &type, &format,
-                                &nitems, &extra, &data);
-    if (status == Success && !err.error(false)) {
-        if (data && nitems > 0)
-            result = *((Window*) data);
-        XFree(data);
-    }
-    return result;
+void Toplevel::getWmClientLeader()
+{
+    Xcb::Property property = fetchWmClientLeader();
+    readWmClientLeader(property);
 }
 
+Xcb::Property Toplevel::fetchWmClientLeader() const
+{
+    return Xcb::Property(window(), atoms->wm_client_leader, XCB_ATOM_WINDOW, 1);
+}
 
-void Toplevel::getWmClientLeader()
+void Toplevel::readWmClientLeader(Xcb::Property &property)
 {
-    wmClientLeaderWin = staticWmClientLeader(window());
+    uint32_t count = 0;
+    const xcb_window_t *leader = property.value<xcb_window_t>(32, &count);
+    wmClientLeaderWin = leader ? *leader : window();
 }
 
 /*!
@@ -254,14 +252,26 @@ Window Toplevel::wmClientLeader() const
 
 void Toplevel::getResourceClass()
 {
-    XClassHint classHint;
-    if (XGetClassHint(display(), window(), &classHint)) {
+    Xcb::Property property = fetchResourceClass();
+    readResourceClass(property);
+}
+
+Xcb::Property Toplevel::fetchResourceClass() const
+{
+    return Xcb::Property(window(), XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 2048);
+}
+
+void Toplevel::readResourceClass(Xcb::Property &property)
+{
+    uint32_t length = 0;
+    const char *classHint = property.value<char>(8, &length);
+    if (classHint) {
+        // the instance and the class name, both terminated by a null byte
+        const QList<QByteArray> names = QByteArray(classHint, length).split('\0');
         // Qt3.2 and older had this all lowercase, Qt3.3 capitalized resource class.
         // Force lowercase, so that workarounds listing resource classes still work.
-        resource_name = QByteArray(classHint.res_name).toLower();
-        resource_class = QByteArray(classHint.res_class).toLower();
-        XFree(classHint.res_name);
-        XFree(classHint.res_class);
+        resource_name = names.value(0).toLower();
+        resource_class = names.value(1).toLower();
     } else {
         resource_name = resource_class = QByteArray();
     }
@@ -400,38 +410,31 @@ const Shadow *Toplevel::shadow() const
 
 void Toplevel::getWmOpaqueRegion()
 {
-    const int length=32768;
-    unsigned long bytes_after_return=0;
-    QRegion new_opaque_region;
-    do {
-        unsigned long* data;
-        Atom type;
-        int rformat;
-        unsigned long nitems;
-        if (XGetWindowProperty(display(), client,
-                               atoms->net_wm_opaque_region, 0, length, false, XA_CARDINAL,
-                               &type, &rformat, &nitems, &bytes_after_return,
-                               reinterpret_cast< unsigned char** >(&data)) == Success) {
-            if (type != XA_CARDINAL || rformat != 32 || nitems%4) {
-                // it can happen, that the window does not provide this property
-                XFree(data);
-                break;
-            }
+    Xcb::Property property = fetchWmOpaqueRegion();
+    readWmOpaqueRegion(property);
+}
 
-            for (unsigned int i = 0; i < nitems;) {
-                const int x = data[i++];
-                const int y = data[i++];
-                const int w = data[i++];
-                const int h = data[i++];
+Xcb::Property Toplevel::fetchWmOpaqueRegion() const
+{
+    return Xcb::Property(client, atoms->net_wm_opaque_region, XCB_ATOM_CARDINAL, 32768);
+}
 
-                new_opaque_region += QRect(x,y,w,h);
-            }
-            XFree(data);
-        } else {
-            kWarning(1212) << "XGetWindowProperty failed";
-            break;
+void Toplevel::readWmOpaqueRegion(Xcb::Property &property)
+{
+    QRegion new_opaque_region;
+    uint32_t count = 0;
+    const uint32_t *data = property.value<uint32_t>(32, &count);
+    // it can happen, that the window does not provide this property
+    if (data && count % 4 == 0) {
+        for (uint32_t i = 0; i < count;) {
+            const int x = int32_t(data[i++]);
+            const int y = int32_t(data[i++]);
+            const int w = data[i++];
+            const int h = data[i++];
+
+            new_opaque_region += QRect(x,y,w,h);
         }
-    } while (bytes_after_return > 0);
+    }
 
     opaque_region = new_opaque_region;
 }
@@ -462,16 +465,20 @@ pid_t Toplevel::pid() const
 
 void Toplevel::getSkipCloseAnimation()
 {
-    xcb_get_property_cookie_t cookie = xcb_get_property_unchecked(connection(), false, window(), atoms->kde_skip_close_animation, XCB_ATOM_CARDINAL, 0, 1);
-    ScopedCPointer<xcb_get_property_reply_t> reply(xcb_get_property_reply(connection(), cookie, NULL));
-    bool newValue = false;
-    if (!reply.isNull()) {
-        if (reply->format == 32 && reply->type == XCB_ATOM_CARDINAL && reply->value_len == 1) {
-            const uint32_t value = *reinterpret_cast<uint32_t*>(xcb_get_property_value(reply.data()));
-            newValue = (value != 0);
-        }
-    }
-    setSkipCloseAnimation(newValue);
+    Xcb::Property property = fetchSkipCloseAnimation();
+    readSkipCloseAnimation(property);
+}
+
+Xcb::Property Toplevel::fetchSkipCloseAnimation() const
+{
+    return Xcb::Property(window(), atoms->kde_skip_close_animation, XCB_ATOM_CARDINAL, 1);
+}
+
+void Toplevel::readSkipCloseAnimation(Xcb::Property &property)
+{
+    uint32_t count = 0;
+    const uint32_t *value = property.value<uint32_t>(32, &count);
+    setSkipCloseAnimation(value && count == 1 && *value != 0);
 }
 
 bool Toplevel::skipsCloseAnimation() const
@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // kwin
 #include "utils.h"
 #include "virtualdesktops.h"
+#include "xcbutils.h"
 // KDE
 #include <NETWinInfo>
 // Qt
@@ -357,6 +358,8 @@ protected:
     void discardWindowPixmap();
     void addDamageFull();
     void getWmClientLeader();
+    Xcb::Property fetchWmClientLeader() const;
+    void readWmClientLeader(Xcb::Property &property);
     void getWmClientMachine();
     /**
      * @returns Whether there is a compositor and it is active.
@@ -368,10 +371,23 @@ protected:
      * Will only be called on corresponding property changes and for initialization.
      **/
     void getWmOpaqueRegion();
+    Xcb::Property fetchWmOpaqueRegion() const;
+    void readWmOpaqueRegion(Xcb::Property &property);
 
+    /**
+     * The get functions read a property right away, which costs a round trip each. When
+     * several properties are needed, e.g. while managing a window, they should be fetched
+     * first and only then be read.
+     **/
     void getResourceClass();
+    Xcb::Property fetchResourceClass() const;
+    void readResourceClass(Xcb::Property &property);
     void getWindowRole();
+    Xcb::Property fetchWindowRole() const;
+    void readWindowRole(Xcb::Property &property);
     void getSkipCloseAnimation();
+    Xcb::Property fetchSkipCloseAnimation() const;
+    void readSkipCloseAnimation(Xcb::Property &property);
     virtual void debug(QDebug& stream) const = 0;
     void copyToDeleted(Toplevel* c);
     void disownDataPassedToDeleted();
@@ -394,7 +410,6 @@ private:
     static QByteArray staticSessionId(WId);
     static QByteArray staticWmCommand(WId);
     static QByteArray staticWmClientMachine(WId);
-    static Window staticWmClientLeader(WId);
     // when adding new data members, check also copyToDeleted()
     Window client;
     Window frame;
@@ -63,6 +63,12 @@ bool Unmanaged::track(Window w)
     checkScreen();
     vis = attr.visual;
     bit_depth = attr.depth;
+    // fetch the properties at once, see Client::manage()
+    Xcb::Property resourceClassProperty = fetchResourceClass();
+    Xcb::Property windowRoleProperty = fetchWindowRole();
+    Xcb::Property clientLeaderProperty = fetchWmClientLeader();
+    Xcb::Property opaqueRegionProperty = fetchWmOpaqueRegion();
+    Xcb::Property skipCloseAnimationProperty = fetchSkipCloseAnimation();
     unsigned long properties[ 2 ];
     properties[ NETWinInfo::PROTOCOLS ] =
         NET::WMWindowType |
@@ -72,15 +78,15 @@ bool Unmanaged::track(Window w)
         NET::WM2Opacity |
         0;
     info = new NETWinInfo(display(), w, rootWindow(), properties, 2);
-    getResourceClass();
-    getWindowRole();
-    getWmClientLeader();
+    readResourceClass(resourceClassProperty);
+    readWindowRole(windowRoleProperty);
+    readWmClientLeader(clientLeaderProperty);
     getWmClientMachine();
     if (Xcb::Extensions::self()->isShapeAvailable())
         XShapeSelectInput(display(), w, ShapeNotifyMask);
     detectShape(w);
-    getWmOpaqueRegion();
-    getSkipCloseAnimation();
+    readWmOpaqueRegion(opaqueRegionProperty);
+    readSkipCloseAnimation(skipCloseAnimationProperty);
     setupCompositing();
     ungrabXServer();
     if (effects)
@@ -44,6 +44,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "atoms.h"
 #include "cursor.h"
 #include "workspace.h"
+#include "xcbutils.h"
 
 #endif
 
@@ -72,20 +73,13 @@ StrutRect::StrutRect(const StrutRect& other)
 // Motif
 //************************************
 
-void Motif::readFlags(xcb_window_t w, bool& got_noborder, bool& noborder,
+void Motif::readFlags(Xcb::Property &property, bool& got_noborder, bool& noborder,
                       bool& resize, bool& move, bool& minimize, bool& maximize, bool& close)
 {
-    Atom type;
-    int format;
-    unsigned long length, after;
-    unsigned char* data;
-    MwmHints* hints = 0;
-    if (XGetWindowProperty(display(), w, atoms->motif_wm_hints, 0, 5,
-                          false, atoms->motif_wm_hints, &type, &format,
-                          &length, &after, &data) == Success) {
-        if (data)
-            hints = (MwmHints*) data;
-    }
+    uint32_t count = 0;
+    const uint32_t *data = property.value<uint32_t>(32, &count);
+    // only flags, functions and decorations are of interest
+    const uint32_t *hints = (data && count >= 3) ? data : NULL;
     got_noborder = false;
     noborder = false;
     resize = true;
@@ -95,26 +89,27 @@ void Motif::readFlags(xcb_window_t w, bool& got_noborder, bool& noborder,
     close = true;
     if (hints) {
         // To quote from Metacity 'We support those MWM hints deemed non-stupid'
-        if (hints->flags & MWM_HINTS_FUNCTIONS) {
+        const uint32_t flags = hints[0];
+        const uint32_t functions = hints[1];
+        if (flags & MWM_HINTS_FUNCTIONS) {
             // if MWM_FUNC_ALL is set, other flags say what to turn _off_
-            bool set_value = ((hints->functions & MWM_FUNC_ALL) == 0);
+            bool set_value = ((functions & MWM_FUNC_ALL) == 0);
             resize = move = minimize = maximize = close = !set_value;
-            if (hints->functions & MWM_FUNC_RESIZE)
+            if (functions & MWM_FUNC_RESIZE)
                 resize = set_value;
-            if (hints->functions & MWM_FUNC_MOVE)
+            if (functions & MWM_FUNC_MOVE)
                 move = set_value;
-            if (hints->functions & MWM_FUNC_MINIMIZE)
+            if (functions & MWM_FUNC_MINIMIZE)
                 minimize = set_value;
-            if (hints->functions & MWM_FUNC_MAXIMIZE)
+            if (functions & MWM_FUNC_MAXIMIZE)
                 maximize = set_value;
-            if (hints->functions & MWM_FUNC_CLOSE)
+            if (functions & MWM_FUNC_CLOSE)
                 close = set_value;
         }
-        if (hints->flags & MWM_HINTS_DECORATIONS) {
+        if (flags & MWM_HINTS_DECORATIONS) {
             got_noborder = true;
-            noborder = !hints->decorations;
+            noborder = !hints[2];
         }
-        XFree(data);
     }
 }
 
@@ -65,6 +65,11 @@ const long ClientWinMask = XCB_EVENT_MASK_KEY_PRESS | XCB_EVENT_MASK_KEY_RELEASE
 
 const QPoint invalidPoint(INT_MIN, INT_MIN);
 
+namespace Xcb
+{
+class Property;
+}
+
 class Toplevel;
 class Client;
 class Unmanaged;
@@ -164,7 +169,7 @@ public:
     // property.  If it explicitly requests that decorations be shown
     // or hidden, 'got_noborder' is set to true and 'noborder' is set
     // appropriately.
-    static void readFlags(xcb_window_t w, bool& got_noborder, bool& noborder,
+    static void readFlags(Xcb::Property &property, bool& got_noborder, bool& noborder,
                           bool& resize, bool& move, bool& minimize, bool& maximize,
                           bool& close);
     struct MwmHints {
@@ -0,0 +1,143 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_WINDOWINDEX_H
+#define KWIN_WINDOWINDEX_H
+// Qt
+#include <QHash>
+// xcb
+#include <xcb/xcb.h>
+
+namespace KWin
+{
+// forward declarations
+class Toplevel;
+
+/**
+ * @brief Maps the X windows of the managed and unmanaged windows to their Toplevel.
+ *
+ * A Client owns several X windows: the client window itself, the wrapper, the frame and the
+ * input window of the decoration. Each of them is stored with the Role it has, so that an X
+ * event can be dispatched to its Toplevel without walking the window lists of the Workspace.
+ *
+ * The same X window may be stored for more than one Toplevel as long as the roles differ,
+ * e.g. while an override redirect window turns into a managed one.
+ */
+class WindowIndex
+{
+public:
+    /**
+     * The roles in the order in which Workspace::workspaceEvent() used to look them up.
+     */
+    enum Role {
+        WindowRole,
+        WrapperRole,
+        FrameRole,
+        InputRole,
+        UnmanagedRole
+    };
+
+    void insert(xcb_window_t window, Role role, Toplevel *toplevel);
+    /**
+     * Removes @p window with @p role, but only if it is stored for @p toplevel.
+     */
+    void remove(xcb_window_t window, Role role, Toplevel *toplevel);
+    /**
+     * @returns The Toplevel which has @p window with @p role or @c NULL
+     */
+    Toplevel *find(xcb_window_t window, Role role) const;
+    /**
+     * @returns The Toplevel which has @p window in the first matching role, which is stored
+     * in @p role, or @c NULL
+     */
+    Toplevel *find(xcb_window_t window, Role *role) const;
+    int count() const;
+    void clear();
+
+private:
+    struct Entry {
+        Toplevel *toplevel;
+        Role role;
+    };
+    typedef QHash<xcb_window_t, Entry> Entries;
+    Entries m_entries;
+};
+
+inline void WindowIndex::insert(xcb_window_t window, Role role, Toplevel *toplevel)
+{
+    if (window == XCB_WINDOW_NONE) {
+        return;
+    }
+    for (Entries::iterator it = m_entries.find(window); it != m_entries.end() && it.key() == window; ++it) {
+        if (it->role == role) {
+            it->toplevel = toplevel;
+            return;
+        }
+    }
+    Entry entry;
+    entry.toplevel = toplevel;
+    entry.role = role;
+    m_entries.insertMulti(window, entry);
+}
+
+inline void WindowIndex::remove(xcb_window_t window, Role role, Toplevel *toplevel)
+{
+    for (Entries::iterator it = m_entries.find(window); it != m_entries.end() && it.key() == window; ++it) {
+        if (it->role == role && it->toplevel == toplevel) {
+            m_entries.erase(it);
+            return;
+        }
+    }
+}
+
+inline Toplevel *WindowIndex::find(xcb_window_t window, Role role) const
+{
+    for (Entries::const_iterator it = m_entries.constFind(window); it != m_entries.constEnd() && it.key() == window; ++it) {
+        if (it->role == role) {
+            return it->toplevel;
+        }
+    }
+    return NULL;
+}
+
+inline Toplevel *WindowIndex::find(xcb_window_t window, Role *role) const
+{
+    Toplevel *found = NULL;
+    for (Entries::const_iterator it = m_entries.constFind(window); it != m_entries.constEnd() && it.key() == window; ++it) {
+        if (!found || it->role < *role) {
+            found = it->toplevel;
+            *role = it->role;
+        }
+    }
+    return found;
+}
+
+inline int WindowIndex::count() const
+{
+    return m_entries.count();
+}
+
+inline void WindowIndex::clear()
+{
+    m_entries.clear();
+}
+
+} // namespace
+
+#endif
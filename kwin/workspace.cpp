@@ -386,6 +386,9 @@ Workspace::~Workspace()
         if (!c) {
             continue;
         }
+        // findClient() looks the clients up in the index, remove the client while it
+        // still has its windows, see below
+        removeClientWindows(c);
         // Only release the window
         c->releaseWindow(true);
         // No removeClient() is called, it does more than just removing.
@@ -394,8 +397,11 @@ Workspace::~Workspace()
         clients.removeAll(c);
         desktops.removeAll(c);
     }
-    for (UnmanagedList::iterator it = unmanaged.begin(), end = unmanaged.end(); it != end; ++it)
+    for (UnmanagedList::iterator it = unmanaged.begin(), end = unmanaged.end(); it != end; ++it) {
+        m_windowIndex.remove((*it)->window(), WindowIndex::UnmanagedRole, *it);
         (*it)->release(true);
+    }
+    m_windowIndex.clear();
     XDeleteProperty(display(), rootWindow(), atoms->kwin_running);
 
     delete RuleBook::self();
@@ -470,6 +476,10 @@ void Workspace::addClient(Client* c)
         FocusChain::self()->update(c, FocusChain::Update);
         clients.append(c);
     }
+    m_windowIndex.insert(c->window(), WindowIndex::WindowRole, c);
+    m_windowIndex.insert(c->wrapperId(), WindowIndex::WrapperRole, c);
+    m_windowIndex.insert(c->frameId(), WindowIndex::FrameRole, c);
+    m_windowIndex.insert(c->inputId(), WindowIndex::InputRole, c);
     if (!unconstrained_stacking_order.contains(c))
         unconstrained_stacking_order.append(c);   // Raise if it hasn't got any stacking position yet
     if (!stacking_order.contains(c))    // It'll be updated later, and updateToolWindows() requires
@@ -494,6 +504,7 @@ void Workspace::addClient(Client* c)
 void Workspace::addUnmanaged(Unmanaged* c)
 {
     unmanaged.append(c);
+    m_windowIndex.insert(c->window(), WindowIndex::UnmanagedRole, c);
     x_stacking_dirty = true;
 }
 
@@ -523,6 +534,7 @@ void Workspace::removeClient(Client* c)
     // TODO: if marked client is removed, notify the marked list
     clients.removeAll(c);
     desktops.removeAll(c);
+    removeClientWindows(c);
     x_stacking_dirty = true;
     attention_chain.removeAll(c);
     showing_desktop_clients.removeAll(c);
@@ -546,10 +558,33 @@ void Workspace::removeClient(Client* c)
     updateClientArea();
 }
 
+void Workspace::removeClientWindows(Client* c)
+{
+    m_windowIndex.remove(c->window(), WindowIndex::WindowRole, c);
+    m_windowIndex.remove(c->wrapperId(), WindowIndex::WrapperRole, c);
+    m_windowIndex.remove(c->frameId(), WindowIndex::FrameRole, c);
+    m_windowIndex.remove(c->inputId(), WindowIndex::InputRole, c);
+}
+
+void Workspace::clientInputWindowChanged(Client* c, xcb_window_t oldInputWindow)
+{
+    if (m_windowIndex.find(c->window(), WindowIndex::WindowRole) != c)
+        return; // Not added yet, addClient() takes the current input window
+    m_windowIndex.remove(oldInputWindow, WindowIndex::InputRole, c);
+    m_windowIndex.insert(c->inputId(), WindowIndex::InputRole, c);
+}
+
+template<>
+Unmanaged* Workspace::findUnmanaged(WindowMatchPredicate predicate) const
+{
+    return static_cast<Unmanaged*>(m_windowIndex.find(predicate.value, WindowIndex::UnmanagedRole));
+}
+
 void Workspace::removeUnmanaged(Unmanaged* c)
 {
     assert(unmanaged.contains(c));
     unmanaged.removeAll(c);
+    m_windowIndex.remove(c->window(), WindowIndex::UnmanagedRole, c);
     x_stacking_dirty = true;
 }
 
@@ -28,6 +28,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "sm.h"
 #include "client.h"
 #include "utils.h"
+#include "windowindex.h"
 // Katie
 #include <QKeySequence>
 #include <QTimer>
@@ -245,6 +246,7 @@ public:
     void sendTakeActivity(Client* c, xcb_timestamp_t timestamp, long flags);   // Called from Client::takeActivity()
 
     void removeClient(Client*);   // Only called from Client::destroyClient() or Client::releaseWindow()
+    void clientInputWindowChanged(Client* c, xcb_window_t oldInputWindow);   // Called from Client when the decoration input window changes
     void setActiveClient(Client*);
     Group* findGroup(xcb_window_t leader) const;
     void addGroup(Group* group);
@@ -434,6 +436,7 @@ private:
     /// This is the right way to create a new client
     Client* createClient(xcb_window_t w, bool is_mapped);
     void addClient(Client* c);
+    void removeClientWindows(Client* c);   // Removes the X windows of the client from m_windowIndex
     Unmanaged* createUnmanaged(xcb_window_t w);
     void addUnmanaged(Unmanaged* c);
 
@@ -473,6 +476,7 @@ private:
     ClientList desktops;
     UnmanagedList unmanaged;
     DeletedList deleted;
+    WindowIndex m_windowIndex; // X windows of clients and unmanaged, kept in sync with the lists above
 
     ToplevelList unconstrained_stacking_order; // Topmost last
     ToplevelList stacking_order; // Topmost last
@@ -676,6 +680,31 @@ inline Client* Workspace::findClient(T predicate) const
     return NULL;
 }
 
+// The X windows of the clients are indexed, find them without walking the lists
+template<>
+inline Client* Workspace::findClient(WindowMatchPredicate predicate) const
+{
+    return static_cast<Client*>(m_windowIndex.find(predicate.value, WindowIndex::WindowRole));
+}
+
+template<>
+inline Client* Workspace::findClient(WrapperIdMatchPredicate predicate) const
+{
+    return static_cast<Client*>(m_windowIndex.find(predicate.value, WindowIndex::WrapperRole));
+}
+
+template<>
+inline Client* Workspace::findClient(FrameIdMatchPredicate predicate) const
+{
+    return static_cast<Client*>(m_windowIndex.find(predicate.value, WindowIndex::FrameRole));
+}
+
+template<>
+inline Client* Workspace::findClient(InputIdMatchPredicate predicate) const
+{
+    return static_cast<Client*>(m_windowIndex.find(predicate.value, WindowIndex::InputRole));
+}
+
 template< typename T1, typename T2 >
 inline void Workspace::forEachClient(T1 procedure, T2 predicate)
 {
@@ -699,6 +728,10 @@ inline Unmanaged* Workspace::findUnmanaged(T predicate) const
     return findUnmanagedInList(unmanaged, predicate);
 }
 
+// Unmanaged is incomplete here, defined in workspace.cpp
+template<>
+Unmanaged* Workspace::findUnmanaged(WindowMatchPredicate predicate) const;
+
 template< typename T1, typename T2 >
 inline void Workspace::forEachUnmanaged(T1 procedure, T2 predicate)
 {
@@ -45,6 +45,16 @@ static void setInputFocus(xcb_window_t window, uint8_t revertTo = XCB_INPUT_FOCU
 static void moveWindow(xcb_window_t window, const QPoint &pos);
 static void moveWindow(xcb_window_t window, uint32_t x, uint32_t y);
 
+/**
+ * @returns The number of replies the Wrappers had to wait for. A reply which already arrived
+ * when it was asked for, e.g. because it was requested together with others, is not counted.
+ **/
+inline quint64 &roundTrips()
+{
+    static quint64 s_roundTrips = 0;
+    return s_roundTrips;
+}
+
 template <typename Reply,
     typename Cookie,
     Reply *(*replyFunc)(xcb_connection_t*, Cookie, xcb_generic_error_t**),
@@ -129,11 +139,27 @@ public:
     }
 
 protected:
+    /**
+     * For requests which need more arguments than the window, the subclass sends the request.
+     **/
+    Wrapper(WindowId window, Cookie cookie)
+        : m_retrieved(false)
+        , m_cookie(cookie)
+        , m_window(window)
+        , m_reply(NULL)
+    {
+    }
     void getReply() {
         if (m_retrieved || !m_cookie.sequence) {
             return;
         }
-        m_reply = replyFunc(connection(), m_cookie, NULL);
+        void *reply = NULL;
+        if (xcb_poll_for_reply(connection(), m_cookie.sequence, &reply, NULL)) {
+            m_reply = static_cast<Reply*>(reply);
+        } else {
+            roundTrips()++;
+            m_reply = replyFunc(connection(), m_cookie, NULL);
+        }
         m_retrieved = true;
     }
 
@@ -218,6 +244,7 @@ class TransientFor : public Wrapper<xcb_get_property_reply_t, xcb_get_property_c
 {
 public:
     explicit TransientFor(WindowId window) : Wrapper<xcb_get_property_reply_t, xcb_get_property_cookie_t, &xcb_get_property_reply, &get_transient_for>(window) {}
+    TransientFor(const TransientFor &other) : Wrapper<xcb_get_property_reply_t, xcb_get_property_cookie_t, &xcb_get_property_reply, &get_transient_for>(other) {}
 
     /**
      * @brief Fill given window pointer with the WM_TRANSIENT_FOR property of a window.
@@ -238,6 +265,88 @@ public:
     }
 };
 
+inline xcb_get_property_cookie_t get_property_unused(xcb_connection_t*, xcb_window_t)
+{
+    // Property sends the request itself
+    xcb_get_property_cookie_t cookie;
+    cookie.sequence = 0;
+    return cookie;
+}
+
+/**
+ * @brief Any property of a window, the request is sent when the object is created.
+ *
+ * Creating the Property objects for all properties which are needed and only then accessing
+ * the values gets all of them in a single round trip.
+ **/
+class Property : public Wrapper<xcb_get_property_reply_t, xcb_get_property_cookie_t, &xcb_get_property_reply, &get_property_unused>
+{
+public:
+    Property()
+        : Wrapper<xcb_get_property_reply_t, xcb_get_property_cookie_t, &xcb_get_property_reply, &get_property_unused>()
+        , m_type(XCB_ATOM_NONE)
+    {
+    }
+    /**
+     * @param length The maximum length of the value in 32 bit units.
+     **/
+    Property(WindowId window, xcb_atom_t property, xcb_atom_t type, uint32_t length)
+        : Wrapper<xcb_get_property_reply_t, xcb_get_property_cookie_t, &xcb_get_property_reply, &get_property_unused>(window,
+            xcb_get_property_unchecked(connection(), false, window, property, type, 0, length))
+        , m_type(type)
+    {
+    }
+    Property(const Property &other)
+        : Wrapper<xcb_get_property_reply_t, xcb_get_property_cookie_t, &xcb_get_property_reply, &get_property_unused>(other)
+        , m_type(other.m_type)
+    {
+    }
+
+    /**
+     * @returns The value as an array of @p count items of @p format bits, or @c NULL if the
+     * window does not have the property with the requested type.
+     **/
+    template <typename T>
+    inline const T *value(uint8_t format, uint32_t *count) {
+        const xcb_get_property_reply_t *reply = data();
+        if (!reply || reply->type == XCB_ATOM_NONE || reply->format != format || reply->value_len == 0) {
+            return NULL;
+        }
+        if (m_type != XCB_ATOM_ANY && reply->type != m_type) {
+            return NULL;
+        }
+        *count = reply->value_len;
+        return reinterpret_cast<const T*>(xcb_get_property_value(reply));
+    }
+    /**
+     * @returns The value as a string, the strings of a list are joined with @p separator
+     * or only the first one is returned if it is @c 0.
+     **/
+    inline QByteArray toByteArray(char separator = 0) {
+        uint32_t length = 0;
+        const char *value = this->value<char>(8, &length);
+        if (!value) {
+            return QByteArray();
+        }
+        QByteArray ret(value, length);
+        if (separator) {
+            if (ret.endsWith('\0')) {
+                ret.chop(1);
+            }
+            ret.replace('\0', separator);
+        } else {
+            const int end = ret.indexOf('\0');
+            if (end != -1) {
+                ret.truncate(end);
+            }
+        }
+        return ret;
+    }
+
+private:
+    xcb_atom_t m_type;
+};
+
 class ExtensionData
 {
 public:
@@ -0,0 +1,409 @@
+/*  This file is part of the KDE project
+    Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License version 2, as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#include "konq_metadatacache.h"
+
+#include <KConfigGroup>
+#include <KDebug>
+#include <KGlobal>
+#include <KSharedConfig>
+#include <KStandardDirs>
+
+#include <QDataStream>
+#include <QFile>
+#include <QMutex>
+#include <qplatformdefs.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const quint32 CacheMagic = 0x4B4D4443; // "KMDC"
+    const quint32 CacheVersion = 2;
+    const int SlotSize = 512;
+    const int ProbeCount = 8;
+    const qint64 DefaultMaximumSize = 16 * 1024 * 1024;
+
+    // The header occupies the first slot of the file
+    struct CacheHeader
+    {
+        quint32 magic;
+        quint32 version;
+        quint32 slotCount;
+        quint32 padding;
+        quint64 clock;
+        quint64 hits;
+        quint64 misses;
+    };
+
+    struct CacheKey
+    {
+        quint64 device;
+        quint64 inode;
+        qint64 size;
+        qint64 mtime; // in nanoseconds, a file may be rewritten within a second
+        qint64 ctime; // in nanoseconds
+        quint64 role;
+    };
+
+    struct CacheSlot
+    {
+        CacheKey key;
+        quint64 stamp; // 0 if the slot is unused
+        quint32 valueSize;
+        quint32 padding;
+        char value[SlotSize - sizeof(CacheKey) - 16];
+    };
+
+    // Stable across processes, unlike qHash() which may be seeded
+    quint64 fnv1a(const char* data, int size)
+    {
+        quint64 hash = Q_UINT64_C(14695981039346656037);
+        for (int i = 0; i < size; ++i) {
+            hash ^= static_cast<uchar>(data[i]);
+            hash *= Q_UINT64_C(1099511628211);
+        }
+        return hash;
+    }
+}
+
+class KonqMetaDataCachePrivate
+{
+public:
+    KonqMetaDataCachePrivate();
+
+    bool open(const QString& fileName, qint64 size);
+    void close();
+
+    bool key(const QString& localPath, const QByteArray& role, CacheKey* key) const;
+
+    /**
+     * @return The slot storing @p key. If there is none and @p insert is
+     *         true the least recently used slot the key may be stored in.
+     */
+    CacheSlot* findSlot(const CacheKey& key, bool insert) const;
+
+    CacheHeader* header() const
+    {
+        return reinterpret_cast<CacheHeader*>(data);
+    }
+
+    CacheSlot* slot(quint32 index) const
+    {
+        return reinterpret_cast<CacheSlot*>(data + SlotSize * (index + 1));
+    }
+
+    // Serializes access of threads, flock() only does it for processes.
+    QMutex mutex;
+    QString fileName;
+    int fd;
+    char* data;
+    qint64 dataSize;
+};
+
+KonqMetaDataCachePrivate::KonqMetaDataCachePrivate() :
+    mutex(),
+    fileName(),
+    fd(-1),
+    data(0),
+    dataSize(0)
+{
+}
+
+bool KonqMetaDataCachePrivate::open(const QString& name, qint64 size)
+{
+    fileName = name;
+
+    fd = ::open(QFile::encodeName(fileName).constData(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd == -1) {
+        kWarning() << "Could not open" << fileName << qt_error_string(errno);
+        return false;
+    }
+
+    ::flock(fd, LOCK_EX);
+
+    QT_STATBUF statBuffer;
+    if (QT_FSTAT(fd, &statBuffer) == -1) {
+        kWarning() << "Could not stat" << fileName << qt_error_string(errno);
+        ::flock(fd, LOCK_UN);
+        close();
+        return false;
+    }
+
+    // The size of an existing file is never changed, other processes
+    // might have it mapped. recreate() replaces the file instead.
+    bool initialize = false;
+    dataSize = statBuffer.st_size;
+    if (dataSize < 2 * SlotSize) {
+        dataSize = qMax(size / SlotSize, qint64(2)) * SlotSize;
+        if (::ftruncate(fd, dataSize) == -1) {
+            kWarning() << "Could not resize" << fileName << qt_error_string(errno);
+            ::flock(fd, LOCK_UN);
+            close();
+            return false;
+        }
+        initialize = true;
+    }
+
+    void* mapping = ::mmap(0, dataSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        kWarning() << "Could not map" << fileName << qt_error_string(errno);
+        ::flock(fd, LOCK_UN);
+        close();
+        return false;
+    }
+    data = static_cast<char*>(mapping);
+
+    const quint32 slotCount = dataSize / SlotSize - 1;
+    CacheHeader* cacheHeader = header();
+    if (!initialize && (cacheHeader->magic != CacheMagic ||
+                        cacheHeader->version != CacheVersion ||
+                        cacheHeader->slotCount != slotCount)) {
+        kDebug() << "Resetting invalid cache" << fileName;
+        ::memset(data, 0, dataSize);
+        initialize = true;
+    }
+
+    if (initialize) {
+        // A new file is filled with zeros already
+        cacheHeader->magic = CacheMagic;
+        cacheHeader->version = CacheVersion;
+        cacheHeader->slotCount = slotCount;
+    }
+
+    ::flock(fd, LOCK_UN);
+    return true;
+}
+
+void KonqMetaDataCachePrivate::close()
+{
+    if (data) {
+        ::munmap(data, dataSize);
+        data = 0;
+        dataSize = 0;
+    }
+    if (fd != -1) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+bool KonqMetaDataCachePrivate::key(const QString& localPath, const QByteArray& role, CacheKey* key) const
+{
+    if (localPath.isEmpty()) {
+        return false;
+    }
+
+    QT_STATBUF statBuffer;
+    if (QT_STAT(QFile::encodeName(localPath).constData(), &statBuffer) == -1) {
+        return false;
+    }
+
+    ::memset(key, 0, sizeof(CacheKey));
+    key->device = statBuffer.st_dev;
+    key->inode = statBuffer.st_ino;
+    key->size = statBuffer.st_size;
+    key->mtime = qint64(statBuffer.st_mtim.tv_sec) * 1000000000 + statBuffer.st_mtim.tv_nsec;
+    key->ctime = qint64(statBuffer.st_ctim.tv_sec) * 1000000000 + statBuffer.st_ctim.tv_nsec;
+    key->role = fnv1a(role.constData(), role.size());
+    return true;
+}
+
+CacheSlot* KonqMetaDataCachePrivate::findSlot(const CacheKey& key, bool insert) const
+{
+    const quint32 slotCount = header()->slotCount;
+    quint32 index = fnv1a(reinterpret_cast<const char*>(&key), sizeof(CacheKey)) % slotCount;
+
+    CacheSlot* leastRecentlyUsed = 0;
+    for (int i = 0; i < ProbeCount; ++i) {
+        CacheSlot* cacheSlot = slot(index);
+        if (cacheSlot->stamp != 0 && ::memcmp(&cacheSlot->key, &key, sizeof(CacheKey)) == 0) {
+            return cacheSlot;
+        }
+
+        if (insert && (!leastRecentlyUsed || cacheSlot->stamp < leastRecentlyUsed->stamp)) {
+            leastRecentlyUsed = cacheSlot;
+        }
+        index = (index + 1) % slotCount;
+    }
+
+    return leastRecentlyUsed;
+}
+
+KonqMetaDataCache::KonqMetaDataCache(const QString& fileName, qint64 size) :
+    d(new KonqMetaDataCachePrivate())
+{
+    d->open(fileName.isEmpty() ? KonqMetaDataCache::fileName() : fileName,
+            size > 0 ? size : maximumSize());
+}
+
+KonqMetaDataCache::~KonqMetaDataCache()
+{
+    d->close();
+    delete d;
+}
+
+K_GLOBAL_STATIC(KonqMetaDataCache, s_metaDataCache)
+
+KonqMetaDataCache* KonqMetaDataCache::self()
+{
+    return s_metaDataCache;
+}
+
+bool KonqMetaDataCache::isValid() const
+{
+    return (d->data != 0);
+}
+
+QVariant KonqMetaDataCache::value(const QString& localPath, const QByteArray& role) const
+{
+    CacheKey key;
+    if (!d->data || !d->key(localPath, role, &key)) {
+        return QVariant();
+    }
+
+    QMutexLocker locker(&d->mutex);
+    ::flock(d->fd, LOCK_SH);
+
+    // The statistics and stamps are updated while holding a shared lock
+    // only, races between readers just make them a bit inaccurate.
+    QVariant result;
+    CacheHeader* cacheHeader = d->header();
+    CacheSlot* cacheSlot = d->findSlot(key, false);
+    if (cacheSlot && cacheSlot->valueSize <= sizeof(cacheSlot->value)) {
+        const QByteArray bytes = QByteArray::fromRawData(cacheSlot->value, cacheSlot->valueSize);
+        QDataStream stream(bytes);
+        stream >> result;
+        cacheSlot->stamp = ++cacheHeader->clock;
+        ++cacheHeader->hits;
+    } else {
+        ++cacheHeader->misses;
+    }
+
+    ::flock(d->fd, LOCK_UN);
+    return result;
+}
+
+bool KonqMetaDataCache::setValue(const QString& localPath, const QByteArray& role, const QVariant& value)
+{
+    CacheKey key;
+    if (!d->data || !value.isValid() || !d->key(localPath, role, &key)) {
+        return false;
+    }
+
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream << value;
+    if (bytes.size() > int(sizeof(CacheSlot::value))) {
+        return false;
+    }
+
+    QMutexLocker locker(&d->mutex);
+    ::flock(d->fd, LOCK_EX);
+
+    CacheHeader* cacheHeader = d->header();
+    CacheSlot* cacheSlot = d->findSlot(key, true);
+    cacheSlot->key = key;
+    cacheSlot->valueSize = bytes.size();
+    ::memcpy(cacheSlot->value, bytes.constData(), bytes.size());
+    cacheSlot->stamp = ++cacheHeader->clock;
+
+    ::flock(d->fd, LOCK_UN);
+    return true;
+}
+
+void KonqMetaDataCache::clear()
+{
+    if (!d->data) {
+        return;
+    }
+
+    QMutexLocker locker(&d->mutex);
+    ::flock(d->fd, LOCK_EX);
+
+    CacheHeader* cacheHeader = d->header();
+    ::memset(d->slot(0), 0, d->dataSize - SlotSize);
+    cacheHeader->clock = 0;
+    cacheHeader->hits = 0;
+    cacheHeader->misses = 0;
+
+    ::flock(d->fd, LOCK_UN);
+}
+
+bool KonqMetaDataCache::recreate()
+{
+    QMutexLocker locker(&d->mutex);
+    const QString name = d->fileName;
+    d->close();
+    if (QFile::exists(name) && !QFile::remove(name)) {
+        kWarning() << "Could not remove" << name;
+    }
+    return d->open(name, maximumSize());
+}
+
+KonqMetaDataCache::Statistics KonqMetaDataCache::statistics() const
+{
+    Statistics statistics;
+    statistics.size = d->dataSize;
+    statistics.capacity = 0;
+    statistics.count = 0;
+    statistics.hits = 0;
+    statistics.misses = 0;
+    if (!d->data) {
+        return statistics;
+    }
+
+    QMutexLocker locker(&d->mutex);
+    ::flock(d->fd, LOCK_SH);
+
+    const CacheHeader* cacheHeader = d->header();
+    statistics.capacity = cacheHeader->slotCount;
+    statistics.hits = cacheHeader->hits;
+    statistics.misses = cacheHeader->misses;
+    for (quint32 i = 0; i < cacheHeader->slotCount; ++i) {
+        if (d->slot(i)->stamp != 0) {
+            ++statistics.count;
+        }
+    }
+
+    ::flock(d->fd, LOCK_UN);
+    return statistics;
+}
+
+QString KonqMetaDataCache::fileName()
+{
+    return KStandardDirs::locateLocal("cache", QLatin1String("konq-metadata.cache"));
+}
+
+qint64 KonqMetaDataCache::maximumSize()
+{
+    const KConfigGroup group(KSharedConfig::openConfig("konqrc"), "MetaDataCache");
+    return group.readEntry("MaximumSize", DefaultMaximumSize);
+}
+
+void KonqMetaDataCache::setMaximumSize(qint64 size)
+{
+    KConfigGroup group(KSharedConfig::openConfig("konqrc"), "MetaDataCache");
+    group.writeEntry("MaximumSize", size);
+    group.sync();
+}
@@ -0,0 +1,119 @@
+/*  This file is part of the KDE project
+    Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License version 2, as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KONQ_METADATACACHE_H
+#define KONQ_METADATACACHE_H
+
+#include <konq_export.h>
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+
+class KonqMetaDataCachePrivate;
+
+/**
+ * Per-user cache for metadata of local files which is expensive to
+ * determine, e.g. the mimetype comment of a file or the number of items
+ * in a directory.
+ *
+ * The cache is a file mapped into memory and shared by all processes of
+ * the user. Values are keyed by the device, inode, size, modification and
+ * change time of the file plus a role name, so modifying a file invalidates
+ * its values implicitly. Values depending on the language or on options
+ * should include them in the role name, e.g. "type/de".
+ *
+ * The cache has a fixed size. When it is full the least recently used
+ * values are replaced. Values that do not fit into a slot of the cache
+ * are not stored.
+ */
+class KONQ_EXPORT KonqMetaDataCache
+{
+public:
+    struct Statistics
+    {
+        qint64 size;     // Size of the cache file in bytes.
+        int capacity;    // Maximum number of values.
+        int count;       // Number of stored values.
+        qint64 hits;
+        qint64 misses;
+    };
+
+    /**
+     * Opens the cache stored in @p fileName, creating it with a size of
+     * @p size bytes if required. An empty file name or a size of 0
+     * stand for the values of fileName() and maximumSize().
+     */
+    explicit KonqMetaDataCache(const QString& fileName = QString(), qint64 size = 0);
+    ~KonqMetaDataCache();
+
+    /**
+     * @return The cache shared by the whole process.
+     */
+    static KonqMetaDataCache* self();
+
+    /**
+     * @return True if the cache file could be opened.
+     */
+    bool isValid() const;
+
+    /**
+     * @return The value stored for @p role of the local file @p localPath,
+     *         or an invalid QVariant if there is none.
+     */
+    QVariant value(const QString& localPath, const QByteArray& role) const;
+
+    /**
+     * Stores @p value for @p role of the local file @p localPath.
+     * @return True if the value has been stored.
+     */
+    bool setValue(const QString& localPath, const QByteArray& role, const QVariant& value);
+
+    /**
+     * Removes all values from the cache.
+     */
+    void clear();
+
+    /**
+     * Removes the cache file and creates a new one with the size
+     * given by maximumSize(). Processes which have the old file
+     * opened keep using it until they are restarted.
+     */
+    bool recreate();
+
+    Statistics statistics() const;
+
+    /**
+     * @return Default location of the cache file.
+     */
+    static QString fileName();
+
+    /**
+     * Maximum size of the cache file in bytes as configured
+     * in the "MetaDataCache" group of konqrc.
+     */
+    static qint64 maximumSize();
+    static void setMaximumSize(qint64 size);
+
+private:
+    KonqMetaDataCachePrivate* const d;
+
+    Q_DISABLE_COPY(KonqMetaDataCache)
+};
+
+#endif
@@ -0,0 +1,81 @@
+/*  This file is part of the KDE project
+    Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License version 2, as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#include <kcmdlineargs.h>
+#include <kcomponentdata.h>
+#include <kdeversion.h>
+#include <klocale.h>
+#include <konq_metadatacache.h>
+#include <QCoreApplication>
+
+#include <stdio.h>
+
+int main(int argc, char **argv)
+{
+    KCmdLineArgs::init(argc, argv, "konqmetadatacache", 0, ki18n("Metadata Cache"),
+        KDE_VERSION_STRING, ki18n("Maintains the cache for metadata of files shown by the file manager"));
+
+    KCmdLineOptions options;
+    options.add("stats", ki18n("Show the size and usage of the cache"));
+    options.add("clear", ki18n("Remove all values from the cache"));
+    options.add("max-size <MiB>", ki18n("Set the maximum size of the cache and recreate it"));
+    KCmdLineArgs::addCmdLineOptions(options);
+
+    QCoreApplication app(argc, argv);
+    KComponentData instance("konqmetadatacache");
+
+    KCmdLineArgs *args = KCmdLineArgs::parsedArgs();
+    if (!args->isSet("stats") && !args->isSet("clear") && !args->isSet("max-size")) {
+        KCmdLineArgs::usage();
+    }
+
+    KonqMetaDataCache cache;
+    if (args->isSet("max-size")) {
+        bool ok = false;
+        const qint64 size = args->getOption("max-size").toLongLong(&ok);
+        if (!ok || size <= 0) {
+            fprintf(stderr, "Invalid size: %s\n", qPrintable(args->getOption("max-size")));
+            return 1;
+        }
+        KonqMetaDataCache::setMaximumSize(size * 1024 * 1024);
+        if (!cache.recreate()) {
+            fprintf(stderr, "Could not recreate %s\n", qPrintable(KonqMetaDataCache::fileName()));
+            return 1;
+        }
+    }
+
+    if (!cache.isValid()) {
+        fprintf(stderr, "Could not open %s\n", qPrintable(KonqMetaDataCache::fileName()));
+        return 1;
+    }
+
+    if (args->isSet("clear")) {
+        cache.clear();
+    }
+
+    if (args->isSet("stats")) {
+        const KonqMetaDataCache::Statistics statistics = cache.statistics();
+        printf("file: %s\n", qPrintable(KonqMetaDataCache::fileName()));
+        printf("size: %lld bytes\n", statistics.size);
+        printf("values: %d of %d\n", statistics.count, statistics.capacity);
+        printf("hits: %lld\n", statistics.hits);
+        printf("misses: %lld\n", statistics.misses);
+    }
+
+    return 0;
+}
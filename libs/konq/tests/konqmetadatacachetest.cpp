@@ -0,0 +1,150 @@
+/*  This file is part of the KDE project
+    Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License version 2, as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#include <qtest_kde.h>
+
+#include <ktempdir.h>
+#include <konq_metadatacache.h>
+#include "konqmetadatacachetest.h"
+
+#include <QFile>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "moc_konqmetadatacachetest.cpp"
+
+QTEST_KDEMAIN(KonqMetaDataCacheTest, NoGUI)
+
+void KonqMetaDataCacheTest::init()
+{
+    m_tempDir = new KTempDir();
+}
+
+void KonqMetaDataCacheTest::cleanup()
+{
+    delete m_tempDir;
+    m_tempDir = 0;
+}
+
+void KonqMetaDataCacheTest::writeFile(const QString& name, const QByteArray& content)
+{
+    QFile file(m_tempDir->name() + name);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(content);
+}
+
+void KonqMetaDataCacheTest::testValue()
+{
+    writeFile("a.txt", "a");
+    const QString path = m_tempDir->name() + "a.txt";
+
+    KonqMetaDataCache cache(m_tempDir->name() + "cache", 64 * 1024);
+    QVERIFY(cache.isValid());
+
+    QVERIFY(!cache.value(path, "type").isValid());
+    QVERIFY(cache.setValue(path, "type", QString("Plain text document")));
+    QVERIFY(cache.setValue(path, "size", 42));
+    QCOMPARE(cache.value(path, "type").toString(), QString("Plain text document"));
+    QCOMPARE(cache.value(path, "size").toInt(), 42);
+    QVERIFY(!cache.value(path, "other").isValid());
+
+    // Values not fitting into a slot and files which do not exist are not stored
+    QVERIFY(!cache.setValue(path, "large", QByteArray(1024, 'x')));
+    QVERIFY(!cache.setValue(m_tempDir->name() + "b.txt", "type", QString("Plain text document")));
+
+    const KonqMetaDataCache::Statistics statistics = cache.statistics();
+    QCOMPARE(statistics.size, qint64(64 * 1024));
+    QCOMPARE(statistics.count, 2);
+    QCOMPARE(statistics.hits, qint64(2));
+    QCOMPARE(statistics.misses, qint64(2));
+}
+
+void KonqMetaDataCacheTest::testInvalidation()
+{
+    writeFile("a.txt", "a");
+    const QString path = m_tempDir->name() + "a.txt";
+
+    KonqMetaDataCache cache(m_tempDir->name() + "cache", 64 * 1024);
+    QVERIFY(cache.setValue(path, "type", QString("Plain text document")));
+
+    // Changing the size changes the key of the file
+    writeFile("a.txt", "ab");
+    QVERIFY(!cache.value(path, "type").isValid());
+
+    // So does rewriting it with the same size within the same second
+    const QByteArray encodedPath = QFile::encodeName(path);
+    struct timespec times[2];
+    times[0].tv_sec = times[1].tv_sec = 1000000000;
+    times[0].tv_nsec = times[1].tv_nsec = 100;
+    QCOMPARE(::utimensat(AT_FDCWD, encodedPath.constData(), times, 0), 0);
+    QVERIFY(cache.setValue(path, "type", QString("Plain text document")));
+    times[0].tv_nsec = times[1].tv_nsec = 200;
+    QCOMPARE(::utimensat(AT_FDCWD, encodedPath.constData(), times, 0), 0);
+    QVERIFY(!cache.value(path, "type").isValid());
+}
+
+void KonqMetaDataCacheTest::testSharing()
+{
+    writeFile("a.txt", "a");
+    const QString path = m_tempDir->name() + "a.txt";
+
+    KonqMetaDataCache cache(m_tempDir->name() + "cache", 64 * 1024);
+    QVERIFY(cache.setValue(path, "type", QString("Plain text document")));
+
+    // The size of an existing cache is kept
+    KonqMetaDataCache otherCache(m_tempDir->name() + "cache", 128 * 1024);
+    QCOMPARE(otherCache.statistics().size, qint64(64 * 1024));
+    QCOMPARE(otherCache.value(path, "type").toString(), QString("Plain text document"));
+
+    QVERIFY(otherCache.setValue(path, "size", 1));
+    QCOMPARE(cache.value(path, "size").toInt(), 1);
+}
+
+void KonqMetaDataCacheTest::testEviction()
+{
+    writeFile("a.txt", "a");
+    const QString path = m_tempDir->name() + "a.txt";
+
+    // Room for 3 values only
+    KonqMetaDataCache cache(m_tempDir->name() + "cache", 4 * 512);
+    QCOMPARE(cache.statistics().capacity, 3);
+
+    for (int i = 0; i < 10; ++i) {
+        QVERIFY(cache.setValue(path, QByteArray::number(i), i));
+    }
+
+    QCOMPARE(cache.statistics().count, 3);
+    for (int i = 7; i < 10; ++i) {
+        QCOMPARE(cache.value(path, QByteArray::number(i)).toInt(), i);
+    }
+    QVERIFY(!cache.value(path, "0").isValid());
+}
+
+void KonqMetaDataCacheTest::testClear()
+{
+    writeFile("a.txt", "a");
+    const QString path = m_tempDir->name() + "a.txt";
+
+    KonqMetaDataCache cache(m_tempDir->name() + "cache", 64 * 1024);
+    QVERIFY(cache.setValue(path, "type", QString("Plain text document")));
+    cache.clear();
+
+    QVERIFY(!cache.value(path, "type").isValid());
+    QCOMPARE(cache.statistics().count, 0);
+}
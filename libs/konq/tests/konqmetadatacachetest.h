@@ -0,0 +1,45 @@
+/*  This file is part of the KDE project
+    Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License version 2, as published by the Free Software Foundation.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KONQMETADATACACHETEST_H
+#define KONQMETADATACACHETEST_H
+
+#include <QObject>
+
+class KTempDir;
+
+class KonqMetaDataCacheTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init();
+    void cleanup();
+
+    void testValue();
+    void testInvalidation();
+    void testSharing();
+    void testEviction();
+    void testClear();
+
+private:
+    void writeFile(const QString& name, const QByteArray& content);
+
+    KTempDir* m_tempDir;
+};
+
+#endif
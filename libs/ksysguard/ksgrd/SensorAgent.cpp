@@ -25,6 +25,8 @@
 #include <klocale.h>
 #include <kglobal.h>
 
+#include <QtCore/QTimer>
+
 #include "SensorClient.h"
 #include "SensorManager.h"
 
@@ -38,12 +40,81 @@
 
 static const KCatalogLoader loader("ksgrd");
 
+/**
+  Frames of the binary protocol consist of the payload length and the
+  tag as 32 bit big endian values around the frame type, followed by
+  the payload. See ksysguardd/Porting-HOWTO.
+*/
+static const int FrameHeaderSize = 9;
+static const char QueryFrame = 'Q';
+static const char SubscribeFrame = 'S';
+static const char UnsubscribeFrame = 'U';
+static const char AnswerFrame = 'A';
+static const char PushFrame = 'P';
+
+/**
+  Number of requests that may be sent to the daemon with the binary
+  protocol before their answers have been received.
+*/
+static const int MaximumPendingRequests = 64;
+
+static quint32 decodeUInt32( const char *data )
+{
+  const uchar *p = reinterpret_cast<const uchar*>( data );
+  return ( quint32( p[ 0 ] ) << 24 ) | ( quint32( p[ 1 ] ) << 16 ) |
+         ( quint32( p[ 2 ] ) << 8 ) | quint32( p[ 3 ] );
+}
+
+static void encodeUInt32( char *data, quint32 value )
+{
+  data[ 0 ] = char( value >> 24 );
+  data[ 1 ] = char( value >> 16 );
+  data[ 2 ] = char( value >> 8 );
+  data[ 3 ] = char( value );
+}
+
+static QByteArray frame( char type, quint32 tag, const QByteArray &payload )
+{
+  char header[ FrameHeaderSize ];
+  encodeUInt32( header, payload.size() );
+  header[ 4 ] = type;
+  encodeUInt32( header + 5, tag );
+
+  QByteArray result;
+  result.reserve( FrameHeaderSize + payload.size() );
+  result.append( header, FrameHeaderSize );
+  result.append( payload );
+  return result;
+}
+
+namespace KSGRD {
+
+/**
+  A request whose answer is delivered periodically, either pushed by
+  the daemon or, with the text protocol, requested by a timer.
+*/
+class SensorSubscription
+{
+  public:
+    QString request;
+    SensorClient *client;
+    int id;
+    int interval;
+    quint32 tag;
+    QTimer *timer;
+};
+
+}
+
 using namespace KSGRD;
 
 SensorAgent::SensorAgent( SensorManager *sm ) : QObject(sm)
 {
   mSensorManager = sm;
   mDaemonOnLine = false;
+  mProtocol = UnknownProtocol;
+  mNegotiationRequest = 0;
+  mNextTag = 1;
 }
 
 SensorAgent::~SensorAgent()
@@ -52,6 +123,8 @@ SensorAgent::~SensorAgent()
     delete mInputFIFO.takeAt(i);
   for(int i = mProcessingFIFO.size()-1; i >= 0; --i)
     delete mProcessingFIFO.takeAt(i);
+  qDeleteAll(mPendingRequests);
+  qDeleteAll(mSubscriptions);
 }
 
 void SensorAgent::sendRequest( const QString &req, SensorClient *client, int id )
@@ -69,6 +142,10 @@ void SensorAgent::sendRequest( const QString &req, SensorClient *client, int id
     if(id == sensorreq->id() && client == sensorreq->client() && req == sensorreq->request())
       return; //don't bother to resend the same request if we have already sent the request to client and just waiting for an answer
   }
+  foreach(sensorreq, mPendingRequests) {
+    if(id == sensorreq->id() && client == sensorreq->client() && req == sensorreq->request())
+      return;
+  }
 
   /* The request is registered with the FIFO so that the answer can be
    * routed back to the requesting client. */
@@ -81,8 +158,206 @@ void SensorAgent::sendRequest( const QString &req, SensorClient *client, int id
   executeCommand();
 }
 
+void SensorAgent::subscribe( const QString &req, SensorClient *client, int id, int interval )
+{
+  unsubscribe( client, id );
+
+  SensorSubscription *subscription = new SensorSubscription;
+  subscription->request = req;
+  subscription->client = client;
+  subscription->id = id;
+  subscription->interval = interval;
+  subscription->tag = mNextTag++;
+  subscription->timer = 0;
+  mSubscriptions.append( subscription );
+
+  startSubscription( subscription );
+}
+
+void SensorAgent::unsubscribe( SensorClient *client, int id )
+{
+  for ( int i = 0; i < mSubscriptions.size(); ++i ) {
+    SensorSubscription *subscription = mSubscriptions.at( i );
+    if ( subscription->client == client && subscription->id == id ) {
+      stopSubscription( subscription );
+      delete mSubscriptions.takeAt( i );
+      return;
+    }
+  }
+}
+
+void SensorAgent::startSubscription( SensorSubscription *subscription )
+{
+  if ( mProtocol == BinaryProtocol ) {
+    QByteArray payload = QByteArray::number( subscription->interval ) + '\t' + subscription->request.toLatin1();
+    if ( !writeFrame( SubscribeFrame, subscription->tag, payload ) )
+      kDebug(1215) << "SensorAgent::writeFrame() failed";
+    return;
+  }
+
+  // Until the binary protocol has been negotiated the answers are
+  // requested periodically.
+  if ( !subscription->timer ) {
+    subscription->timer = new QTimer( this );
+    connect( subscription->timer, SIGNAL(timeout()), SLOT(subscriptionTimeout()) );
+  }
+  subscription->timer->start( subscription->interval );
+  sendRequest( subscription->request, subscription->client, subscription->id );
+}
+
+void SensorAgent::stopSubscription( SensorSubscription *subscription )
+{
+  if ( subscription->timer ) {
+    delete subscription->timer;
+    subscription->timer = 0;
+  } else if ( mProtocol == BinaryProtocol ) {
+    writeFrame( UnsubscribeFrame, subscription->tag, QByteArray() );
+  }
+}
+
+void SensorAgent::subscriptionTimeout()
+{
+  foreach ( SensorSubscription *subscription, mSubscriptions ) {
+    if ( subscription->timer == sender() ) {
+      sendRequest( subscription->request, subscription->client, subscription->id );
+      return;
+    }
+  }
+}
+
+QByteArray SensorAgent::quitMessage() const
+{
+  if ( mProtocol == BinaryProtocol )
+    return frame( QueryFrame, 0, "quit" );
+
+  return "quit\n";
+}
+
+bool SensorAgent::writeFrame( char type, quint32 tag, const QByteArray &payload )
+{
+  const QByteArray data = frame( type, tag, payload );
+  return writeMsg( data.constData(), data.size() );
+}
+
+void SensorAgent::processMessage( const QString &message )
+{
+  if ( message.startsWith(QLatin1String("RECONFIGURE")) ) {
+    emit reconfigure( this );
+  }
+  else {
+    /* We just received the end of an error message, so we
+     * can display it. */
+    SensorMgr->notify( i18nc( "%1 is a host name", "Message from %1:\n%2",
+                       mHostName ,
+                       message ) );
+  }
+}
+
+void SensorAgent::switchToBinaryProtocol( const QByteArray &leftOver )
+{
+#if SA_TRACE
+  kDebug(1215) << "Switching to the binary protocol";
+#endif
+  mProtocol = BinaryProtocol;
+  mLeftOverBuffer.clear();
+  mFrameBuffer = leftOver;
+
+  // Requests sent before the switch have been answered already, since
+  // sending is held back during the negotiation.
+  foreach ( SensorSubscription *subscription, mSubscriptions ) {
+    delete subscription->timer;
+    subscription->timer = 0;
+    startSubscription( subscription );
+  }
+
+  processFrames();
+}
+
+void SensorAgent::processFrames()
+{
+  int offset = 0;
+  while ( mFrameBuffer.size() - offset >= FrameHeaderSize ) {
+    const char *data = mFrameBuffer.constData() + offset;
+    const int length = decodeUInt32( data );
+    if ( mFrameBuffer.size() - offset - FrameHeaderSize < length )
+      break; // Wait for the rest of the frame
+
+    const char type = data[ 4 ];
+    const quint32 tag = decodeUInt32( data + 5 );
+    const QByteArray payload = QByteArray::fromRawData( data + FrameHeaderSize, length );
+    offset += FrameHeaderSize + length;
+
+    if ( type == AnswerFrame ) {
+      SensorRequest *req = mPendingRequests.take( tag );
+      if ( !req ) {
+        kDebug(1215) << "ERROR: Received answer but have no pending "
+                     << "request!";
+        continue;
+      }
+      deliverAnswer( req->client(), req->id(), req->request(), payload );
+      delete req;
+    } else if ( type == PushFrame ) {
+      foreach ( SensorSubscription *subscription, mSubscriptions ) {
+        if ( subscription->tag == tag ) {
+          deliverAnswer( subscription->client, subscription->id, subscription->request, payload );
+          break;
+        }
+      }
+    } else {
+      kDebug(1215) << "ERROR: Received unknown frame type" << int( type );
+    }
+  }
+
+  mFrameBuffer.remove( 0, offset );
+}
+
+void SensorAgent::deliverAnswer( SensorClient *client, int id, const QString &request, const QByteArray &payload )
+{
+  // Messages enclosed in ESC characters can be anywhere in the answer.
+  QByteArray answer = payload;
+  int startOfMessage;
+  while ( ( startOfMessage = answer.indexOf( '\033' ) ) != -1 ) {
+    const int endOfMessage = answer.indexOf( '\033', startOfMessage + 1 );
+    if ( endOfMessage == -1 )
+      break;
+    processMessage( QString::fromUtf8( answer.constData() + startOfMessage + 1, endOfMessage - startOfMessage - 1 ) );
+    answer.remove( startOfMessage, endOfMessage - startOfMessage + 1 );
+  }
+
+  if ( !client ) {
+    /* The client has disappeared before receiving the answer
+     * to his request. */
+    return;
+  }
+
+  QList<QByteArray> lines;
+  if ( answer.endsWith( '\n' ) )
+    answer.chop( 1 );
+  if ( !answer.isEmpty() )
+    lines = answer.split( '\n' );
+
+#if SA_TRACE
+  kDebug(1215) << "<= " << lines;
+#endif
+  if ( !lines.isEmpty() && lines[0] == "UNKNOWN COMMAND" ) {
+    /* Notify client that the sensor seems to be no longer available. */
+    kDebug(1215) << "Received UNKNOWN COMMAND for: " << request;
+    client->sensorLost( id );
+  } else {
+    // Notify client of newly arrived answer.
+    client->answerReceived( id, lines );
+  }
+}
+
 void SensorAgent::processAnswer( const char *buf, int buflen )
 {
+  if ( mProtocol == BinaryProtocol ) {
+    mFrameBuffer.append( buf, buflen );
+    processFrames();
+    executeCommand();
+    return;
+  }
+
   //It is possible for an answer/error message  to be split across multiple processAnswer calls.  This makes our life more difficult
   //We have to keep track of the state we are in.  Any characters that we have not parsed yet we put in
   //mLeftOverBuffer
@@ -103,16 +378,7 @@ void SensorAgent::processAnswer( const char *buf, int buflen )
       while(++i < buffer.size()) {
         if(buffer.at(i) == '\033') {
 	  QString error = QString::fromUtf8(buffer.constData() + startOfError+1, i-startOfError-1);
-	  if ( error.startsWith(QLatin1String("RECONFIGURE")) ) {
-            emit reconfigure( this );
- 	  }
-          else {
-            /* We just received the end of an error message, so we
-             * can display it. */
-            SensorMgr->notify( i18nc( "%1 is a host name", "Message from %1:\n%2",
-                               mHostName ,
-                               error ) );
-          }
+	  processMessage( error );
           found = true;
 	  break;
 	}
@@ -170,6 +436,21 @@ void SensorAgent::processAnswer( const char *buf, int buflen )
 		
 	SensorRequest *req = mProcessingFIFO.dequeue();
 	// we are now responsible for the memory of req - we must delete it!
+	if ( req == mNegotiationRequest ) {
+		const bool binary = !mAnswerBuffer.isEmpty() && mAnswerBuffer[0] == "OK";
+		mNegotiationRequest = 0;
+		delete req;
+		mAnswerBuffer.clear();
+		if ( binary ) {
+			// Everything after this answer is framed already
+			switchToBinaryProtocol( startOfAnswer < buffer.size() ? buffer.mid( startOfAnswer ) : QByteArray() );
+			executeCommand();
+			return;
+		}
+		mProtocol = TextProtocol;
+		continue;
+	}
+
 	if ( !req->client() ) {
 		/* The client has disappeared before receiving the answer
 		 * to his request. */
@@ -204,7 +485,40 @@ void SensorAgent::executeCommand()
    * command to pass to the daemon. But the command may only be sent
    * if the daemon is online and there is no other command currently
    * being sent. */
-  if ( mDaemonOnLine && !mInputFIFO.isEmpty() ) {
+  if ( !mDaemonOnLine )
+    return;
+
+  if ( mProtocol == UnknownProtocol ) {
+    // Ask for the binary protocol, daemons that do not support it
+    // answer with UNKNOWN COMMAND. Nothing else is sent until the
+    // answer has arrived.
+    mProtocol = NegotiatingProtocol;
+    mNegotiationRequest = new SensorRequest( "binary", 0, 0 );
+    if ( !writeMsg( "binary\n", sizeof( "binary\n" ) - 1 ) )
+      kDebug(1215) << "SensorAgent::writeMsg() failed";
+    mProcessingFIFO.enqueue( mNegotiationRequest );
+    return;
+  }
+
+  if ( mProtocol == NegotiatingProtocol )
+    return;
+
+  if ( mProtocol == BinaryProtocol ) {
+    while ( !mInputFIFO.isEmpty() && mPendingRequests.count() < MaximumPendingRequests ) {
+      SensorRequest *req = mInputFIFO.dequeue();
+      const quint32 tag = mNextTag++;
+#if SA_TRACE
+      kDebug(1215) << ">> " << tag << req->request().toAscii() << "(" << mInputFIFO.count()
+                    << "/" << mPendingRequests.count() << ")";
+#endif
+      if ( !writeFrame( QueryFrame, tag, req->request().toLatin1() ) )
+        kDebug(1215) << "SensorAgent::writeFrame() failed";
+      mPendingRequests.insert( tag, req );
+    }
+    return;
+  }
+
+  if ( !mInputFIFO.isEmpty() ) {
     SensorRequest *req = mInputFIFO.dequeue();
 
 #if SA_TRACE
@@ -230,7 +544,15 @@ void SensorAgent::disconnectClient( SensorClient *client )
   for (int i = 0; i < mProcessingFIFO.size(); ++i)
     if ( mProcessingFIFO[i]->client() == client )
       mProcessingFIFO[i]->setClient( 0 );
-  
+  foreach ( SensorRequest *req, mPendingRequests )
+    if ( req->client() == client )
+      req->setClient( 0 );
+  for (int i = mSubscriptions.size() - 1; i >= 0; --i) {
+    if ( mSubscriptions[i]->client == client ) {
+      stopSubscription( mSubscriptions[i] );
+      delete mSubscriptions.takeAt( i );
+    }
+  }
 }
 
 SensorManager *SensorAgent::sensorManager()
@@ -25,6 +25,7 @@
 #include <QtCore/QObject>
 #include <QtCore/QQueue>
 #include <QtCore/QPointer>
+#include <QtCore/QHash>
 
 #include <kdemacros.h>
 
@@ -35,14 +36,21 @@ namespace KSGRD {
 class SensorClient;
 class SensorManager;
 class SensorRequest;
+class SensorSubscription;
 
 /**
   The SensorAgent depending on the type of requested connection
   starts a ksysguardd process or connects through a tcp connection to
   a running ksysguardd and handles the asynchronous communication. It
   keeps a list of pending requests that have not been answered yet by
-  ksysguardd. The current implementation only allowes one pending
-  requests. Incoming requests are queued in an input FIFO.
+  ksysguardd. Incoming requests are queued in an input FIFO.
+
+  Once the daemon is online the agent asks it to switch to the binary
+  protocol. In that mode requests are sent as length prefixed frames
+  tagged with an id, many of them can be in flight at once and the
+  daemon pushes the answers of subscribed requests by itself. Daemons
+  that do not know the binary protocol are served with the line based
+  text protocol, which allows only one pending request.
 */
 class KDE_EXPORT SensorAgent : public QObject
 {
@@ -69,6 +77,15 @@ class KDE_EXPORT SensorAgent : public QObject
      */
     void sendRequest( const QString &req, SensorClient *client, int id = 0 );
 
+    /**
+      Like sendRequest(), but the answer is delivered to 'client' every
+      'interval' milliseconds until unsubscribe() is called. Daemons that
+      support the binary protocol push the answers by themselves,
+      otherwise the request is sent periodically.
+     */
+    void subscribe( const QString &req, SensorClient *client, int id, int interval );
+    void unsubscribe( SensorClient *client, int id );
+
     virtual void hostInfo( QString &sh, QString &cmd, int &port ) const = 0;
 
     void disconnectClient( SensorClient *client );
@@ -85,6 +102,11 @@ class KDE_EXPORT SensorAgent : public QObject
     void processAnswer( const char *buf, int buflen );
     void executeCommand();
 
+    /**
+      @return The message to send to the daemon to end the connection.
+     */
+    QByteArray quitMessage() const;
+
     SensorManager *sensorManager();
 
     void setDaemonOnLine( bool value );
@@ -92,8 +114,26 @@ class KDE_EXPORT SensorAgent : public QObject
     void setHostName( const QString &hostName );
     void setReasonForOffline(const QString &reasonForOffline);
 
+  private Q_SLOTS:
+    void subscriptionTimeout();
+
   private:
+    enum Protocol {
+      UnknownProtocol,
+      NegotiatingProtocol,
+      TextProtocol,
+      BinaryProtocol
+    };
+
     virtual bool writeMsg( const char *msg, int len ) = 0;
+    bool writeFrame( char type, quint32 tag, const QByteArray &payload );
+    void switchToBinaryProtocol( const QByteArray &leftOver );
+    void processFrames();
+    void processMessage( const QString &message );
+    void deliverAnswer( SensorClient *client, int id, const QString &request, const QByteArray &payload );
+    void startSubscription( SensorSubscription *subscription );
+    void stopSubscription( SensorSubscription *subscription );
+
     QString mReasonForOffline;
 
     QQueue< SensorRequest* > mInputFIFO;
@@ -102,6 +142,13 @@ class KDE_EXPORT SensorAgent : public QObject
     QString mErrorBuffer;
     QByteArray mLeftOverBuffer; ///Any data read in but not terminated is copied into here, awaiting the next load of data
 
+    Protocol mProtocol;
+    SensorRequest *mNegotiationRequest; ///The "binary" request, owned by mProcessingFIFO while pending
+    quint32 mNextTag;
+    QHash<quint32, SensorRequest*> mPendingRequests; ///Requests sent with the binary protocol by their tag
+    QList<SensorSubscription*> mSubscriptions;
+    QByteArray mFrameBuffer; ///Incomplete frame of the binary protocol
+
     QPointer<SensorManager> mSensorManager;
 
     bool mDaemonOnLine;
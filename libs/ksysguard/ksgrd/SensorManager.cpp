@@ -346,6 +346,30 @@ bool SensorManager::sendRequest( const QString &hostName, const QString &req,
   return false;
 }
 
+bool SensorManager::subscribe( const QString &hostName, const QString &req,
+                               SensorClient *client, int id, int interval )
+{
+  SensorAgent *agent = mAgents.value( hostName );
+  if ( !agent && hostName == "localhost") {
+    //we should always be able to reconnect to localhost
+    engage("localhost", "", "ksysguardd", -1);
+    agent = mAgents.value( hostName );
+  }
+  if ( agent ) {
+    agent->subscribe( req, client, id, interval );
+    return true;
+  }
+
+  return false;
+}
+
+void SensorManager::unsubscribe( const QString &hostName, SensorClient *client, int id )
+{
+  SensorAgent *agent = mAgents.value( hostName );
+  if ( agent )
+    agent->unsubscribe( client, id );
+}
+
 const QString SensorManager::hostName( const SensorAgent *agent ) const
 {
   return mAgents.key( const_cast<SensorAgent*>( agent ) );
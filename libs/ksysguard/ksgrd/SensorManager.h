@@ -81,6 +81,14 @@ class KDE_EXPORT SensorManager : public QObject
     bool sendRequest( const QString &hostName, const QString &request,
                       SensorClient *client, int id = 0 );
 
+    /**
+      Delivers the answer of the request to the client every 'interval'
+      milliseconds, see SensorAgent::subscribe().
+     */
+    bool subscribe( const QString &hostName, const QString &request,
+                    SensorClient *client, int id, int interval );
+    void unsubscribe( const QString &hostName, SensorClient *client, int id );
+
     const QString hostName( const SensorAgent *sensor ) const;
     bool hostInfo( const QString &host, QString &shell,
                    QString &command, int &port );
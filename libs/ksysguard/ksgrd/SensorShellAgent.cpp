@@ -38,7 +38,7 @@ SensorShellAgent::SensorShellAgent( SensorManager *sm )
 SensorShellAgent::~SensorShellAgent()
 {
   if ( mDaemon ) {
-    mDaemon->write( "quit\n", sizeof( "quit\n" )-1 );
+    mDaemon->write( quitMessage() );
     mDaemon->disconnect();
     mDaemon->waitForFinished();
     delete mDaemon;
@@ -36,10 +36,8 @@ class SensorManager;
 
 /**
   The SensorShellAgent starts a ksysguardd process and handles the
-  asynchronous communication. It keeps a list of pending requests
-  that have not been answered yet by ksysguard. The current
-  implementation only allowes one pending requests. Incoming requests
-  are queued in an input FIFO.
+  asynchronous communication over its standard input and output. The
+  protocol and the pending requests are handled by SensorAgent.
  */
 class SensorShellAgent : public SensorAgent
 {
@@ -43,7 +43,7 @@ SensorSocketAgent::SensorSocketAgent( SensorManager *sm )
 
 SensorSocketAgent::~SensorSocketAgent()
 {
-  mSocket.write( "quit\n", sizeof( "quit\n" ) );
+  mSocket.write( quitMessage() );
   mSocket.flush();
 }
 	
@@ -33,10 +33,8 @@ namespace KSGRD {
 
 /**
   The SensorSocketAgent connects to a ksysguardd via a TCP
-  connection. It keeps a list of pending requests that have not been
-  answered yet by ksysguard. The current implementation only allowes
-  one pending requests. Incoming requests are queued in an input
-  FIFO.
+  connection. The protocol and the pending requests are handled by
+  SensorAgent.
  */
 class SensorSocketAgent : public SensorAgent
 {
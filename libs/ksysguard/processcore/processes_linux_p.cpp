@@ -24,11 +24,13 @@
 
 #include <klocale.h>
 
+#include <QAtomicInt>
 #include <QFile>
 #include <QHash>
+#include <QList>
 #include <QSet>
 #include <QByteArray>
-#include <QTextStream>
+#include <QThread>
 
 //for sysconf
 #include <unistd.h>
@@ -38,7 +40,9 @@
 #include <signal.h>
 #include <sys/resource.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <stdlib.h>
+#include <string.h>
 //for getsched
 #include <sched.h>
 
@@ -47,228 +51,671 @@
 namespace KSysGuard
 {
 
+namespace {
+    // From this number of processes on, /proc is read by several threads
+    const int ParallelScanThreshold = 1024;
+    const int MaximumScanThreads = 4;
+
+    // Descriptors kept open per process: /proc/<pid>, stat, status and statm
+    const int KeptDescriptorsPerProcess = 4;
+    // The select() based event loop can not handle descriptors beyond FD_SETSIZE,
+    // so only a part of the descriptors available is kept open
+    const int MaximumKeptDescriptors = 512;
+
+    const int StatBufferSize = 1024;
+    const int StatusBufferSize = 8192;
+
+    inline const char* skipSpaces(const char *text)
+    {
+        while (*text == ' ' || *text == '\t') {
+            ++text;
+        }
+        return text;
+    }
+
+    // atoll() and friends are locale aware and do not tell where the number ends
+    inline bool parseNumber(const char **text, qlonglong *number)
+    {
+        const char *p = skipSpaces(*text);
+        const bool negative = (*p == '-');
+        if (negative) {
+            ++p;
+        }
+        if (*p < '0' || *p > '9') {
+            return false;
+        }
+        qlonglong value = 0;
+        while (*p >= '0' && *p <= '9') {
+            value = value * 10 + (*p - '0');
+            ++p;
+        }
+        *number = negative ? -value : value;
+        *text = p;
+        return true;
+    }
+
+    inline char* formatNumber(long number, char *buffer)
+    {
+        char digits[24];
+        int count = 0;
+        do {
+            digits[count++] = '0' + number % 10;
+            number /= 10;
+        } while (number > 0);
+        while (count > 0) {
+            *buffer++ = digits[--count];
+        }
+        *buffer = '\0';
+        return buffer;
+    }
+}
+
+/**
+ * Information about a process read from /proc/<pid> by the last scan,
+ * plus the parts which are kept between the scans.
+ */
+struct ProcState
+{
+    explicit ProcState(long pid);
+
+    long pid;
+
+    // Kept open between the scans if the budget allows it, otherwise -1
+    int dirFd;
+    int statFd;
+    int statusFd;
+    int statmFd;
+    bool triedKeeping;
+
+    // Set by the scan, cleared once the values have been applied to a Process
+    bool valid;
+    // Set if the pid belongs to another process than during the last scan
+    bool replaced;
+
+    // from stat
+    char status;
+    long ppid;
+    int ttyNo;
+    qlonglong userTime;
+    qlonglong sysTime;
+    int niceLevel;
+    qlonglong startTime; // identifies the process together with the pid
+    qlonglong vmSize;
+    qlonglong vmRSS;
+
+    // from status
+    bool hasStatus;
+    QByteArray name;
+    qlonglong uids[4];
+    qlonglong gids[4];
+    qlonglong tracerpid;
+    int numThreads;
+
+    // from statm
+    bool hasStatm;
+    qlonglong sharedPages;
+
+    // from io
+    bool hasIo;
+    qlonglong io[6];
+
+    // from sched_getscheduler()
+    bool hasScheduler;
+    int scheduler;
+    int schedPriority;
+
+    // from cmdline, only read once per process
+    bool hasCommand;
+    QString command;
+    QString commandName;
+};
+
+ProcState::ProcState(long _pid)
+    : pid(_pid),
+      dirFd(-1), statFd(-1), statusFd(-1), statmFd(-1), triedKeeping(false),
+      valid(false), replaced(false),
+      status('\0'), ppid(0), ttyNo(0), userTime(0), sysTime(0), niceLevel(0), startTime(-1), vmSize(0), vmRSS(0),
+      hasStatus(false), tracerpid(-1), numThreads(0),
+      hasStatm(false), sharedPages(0),
+      hasIo(false),
+      hasScheduler(false), scheduler(SCHED_OTHER), schedPriority(0),
+      hasCommand(false)
+{
+    memset(uids, 0, sizeof(uids));
+    memset(gids, 0, sizeof(gids));
+    memset(io, 0, sizeof(io));
+}
+
+/**
+ * Buffers reused for reading the files of many processes.
+ */
+struct ProcScanBuffer
+{
+    char stat[StatBufferSize];
+    char status[StatusBufferSize];
+    QByteArray cmdline;
+};
+
 class ProcessesLocal::Private
 {
 public:
-    Private() { mProcDir = ::opendir( "/proc" );}
+    class ScanThread;
+
+    Private();
     ~Private();
-    inline bool readProcStatus(const QString &dir, Process *process);
-    inline bool readProcStat(const QString &dir, Process *process);
-    inline bool readProcStatm(const QString &dir, Process *process);
-    inline bool readProcCmdline(const QString &dir, Process *process);
-    inline bool getNiceness(long pid, Process *process);
-    inline bool getIOStatistics(const QString &dir, Process *process);
+
+    /**
+     * Reads /proc/<pid> of all processes, in several threads if there are many.
+     */
+    void scan(bool readIo);
+
+    /**
+     * @return The state of the process read by the last scan. If it has been
+     *         applied to a Process already or the pid was not scanned, the
+     *         process is read again. 0 if the process does not exist.
+     */
+    ProcState* processState(long pid);
+
+    void scanProcesses(ProcScanBuffer *buffer, int first, int step);
+    bool scanProcess(ProcState *state, ProcScanBuffer *buffer);
+    bool readProcStat(ProcState *state, ProcScanBuffer *buffer);
+    bool readProcStatus(ProcState *state, ProcScanBuffer *buffer);
+    bool readProcStatm(ProcState *state, ProcScanBuffer *buffer);
+    bool readProcCmdline(ProcState *state, ProcScanBuffer *buffer);
+    bool getIOStatistics(ProcState *state, ProcScanBuffer *buffer);
+    void getScheduler(ProcState *state);
+
+    void keepDescriptors(ProcState *state);
+    /** @return False if no descriptors were kept for the process */
+    bool closeDescriptors(ProcState *state);
+    int openProcFile(ProcState *state, const char *name) const;
+    int readProcFile(ProcState *state, const char *name, int *keptFd, char *buffer, int size);
+
+    void applyStat(ProcState *state, Process *process);
+    void applyStatus(ProcState *state, Process *process);
+    void applyStatm(ProcState *state, Process *process);
+    void applyCmdline(ProcState *state, Process *process);
+    void applyNiceness(ProcState *state, Process *process);
+    void applyIOStatistics(ProcState *state, Process *process);
+
     QFile mFile;
     char mBuffer[PROCESS_BUFFER_SIZE+1]; //used as a buffer to read data into
     DIR* mProcDir;
+    int mProcFd;
+    long mPageSizeKiB;
+
+    QHash<long, ProcState*> mStates;
+    QList<ProcState*> mScanStates;
+    ProcScanBuffer mScanBuffer;
+    bool mReadIo;
+    QAtomicInt mKeptDescriptors;
+    int mMaximumKeptDescriptors;
 };
 
+/**
+ * Scans every step-th process of ProcessesLocal::Private::mScanStates.
+ */
+class ProcessesLocal::Private::ScanThread : public QThread
+{
+public:
+    ScanThread(ProcessesLocal::Private *d, int first, int step)
+        : m_d(d), m_first(first), m_step(step) {}
+
+protected:
+    void run()
+    {
+        m_d->scanProcesses(&m_buffer, m_first, m_step);
+    }
+
+private:
+    ProcessesLocal::Private *m_d;
+    int m_first;
+    int m_step;
+    ProcScanBuffer m_buffer;
+};
+
+ProcessesLocal::Private::Private()
+    : mProcDir(::opendir("/proc")),
+      mProcFd(-1),
+      mPageSizeKiB(sysconf(_SC_PAGESIZE) / 1024),
+      mReadIo(false),
+      mKeptDescriptors(0),
+      mMaximumKeptDescriptors(0)
+{
+    if (mProcDir) {
+        mProcFd = ::dirfd(mProcDir);
+    }
+
+    struct rlimit limit;
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        mMaximumKeptDescriptors = qMin<rlim_t>(limit.rlim_cur / 4, MaximumKeptDescriptors);
+    }
+}
+
 ProcessesLocal::Private::~Private()
 {
-    ::closedir(mProcDir);
+    Q_FOREACH (ProcState *state, mStates) {
+        closeDescriptors(state);
+        delete state;
+    }
+    if (mProcDir) {
+        ::closedir(mProcDir);
+    }
 }
 
 ProcessesLocal::ProcessesLocal() : d(new Private())
 {
 }
 
-bool ProcessesLocal::Private::readProcStatus(const QString &dir, Process *process)
+void ProcessesLocal::Private::scan(bool readIo)
 {
-    mFile.setFileName(dir + "status");
-    if (!mFile.open(QIODevice::ReadOnly)) {
-        return false; // process has terminated in the meantime
+    mScanStates.clear();
+    if (mProcDir == NULL) {
+        return; // there's not much we can do without /proc
     }
 
-    process->uid = 0;
-    process->gid = 0;
-    process->tracerpid = -1;
-    process->numThreads = 0;
+    QHash<long, ProcState*> states;
+    states.reserve(mStates.count());
 
-    int size;
-    int found = 0; // count how many fields we found
-    while ((size = mFile.readLine( mBuffer, sizeof(mBuffer))) > 0) { // -1 indicates an error
-        switch(mBuffer[0]) {
-            case 'N': {
-                if((unsigned int)size > sizeof("Name:") && qstrncmp(mBuffer, "Name:", sizeof("Name:")-1) == 0) {
-                    if(process->command.isEmpty())
-                        process->setName(QString::fromLocal8Bit(mBuffer + sizeof("Name:")-1, size-sizeof("Name:")+1).trimmed());
-                    if(++found == 5) goto finish;
-                }
-                break;
-            }
-            case 'U': {
-                if((unsigned int)size > sizeof("Uid:") && qstrncmp(mBuffer, "Uid:", sizeof("Uid:")-1) == 0) {
-                    sscanf(mBuffer + sizeof("Uid:") -1, "%lld %lld %lld %lld", &process->uid, &process->euid, &process->suid, &process->fsuid);
-                    if(++found == 5) goto finish;
-                }
-                break;
-            }
-            case 'G': {
-                if((unsigned int)size > sizeof("Gid:") && qstrncmp(mBuffer, "Gid:", sizeof("Gid:")-1) == 0) {
-                    sscanf(mBuffer + sizeof("Gid:")-1, "%lld %lld %lld %lld", &process->gid, &process->egid, &process->sgid, &process->fsgid);
-                    if(++found == 5) goto finish;
-                }
-                break;
-            }
-            case 'T': {
-                if((unsigned int)size > sizeof("TracerPid:") && qstrncmp(mBuffer, "TracerPid:", sizeof("TracerPid:")-1) == 0) {
-                    process->tracerpid = atol(mBuffer + sizeof("TracerPid:")-1);
-                    if (process->tracerpid == 0)
-                        process->tracerpid = -1;
-                    if(++found == 5) goto finish;
-                } else if((unsigned int)size > sizeof("Threads:") && qstrncmp(mBuffer, "Threads:", sizeof("Threads:")-1) == 0) {
-                    process->setNumThreads(atol(mBuffer + sizeof("Threads:")-1));
-                    if(++found == 5) goto finish;
-                }
-                break;
-            }
-            default: {
-                break;
+    struct dirent* entry;
+    rewinddir(mProcDir);
+    while ((entry = ::readdir(mProcDir))) {
+        if (entry->d_name[0] >= '0' && entry->d_name[0] <= '9') {
+            const long pid = atol(entry->d_name);
+            ProcState *state = mStates.take(pid);
+            if (!state) {
+                state = new ProcState(pid);
             }
+            states.insert(pid, state);
+            mScanStates.append(state);
         }
     }
 
-finish:
-    mFile.close();
+    // The remaining processes have ended
+    Q_FOREACH (ProcState *state, mStates) {
+        closeDescriptors(state);
+        delete state;
+    }
+    mStates = states;
+    mReadIo = readIo;
+
+    const int count = mScanStates.count();
+    const int threadCount = (count >= ParallelScanThreshold) ? qBound(1, QThread::idealThreadCount(), MaximumScanThreads) : 1;
+
+    QList<ScanThread*> threads;
+    for (int i = 1; i < threadCount; ++i) {
+        ScanThread *thread = new ScanThread(this, i, threadCount);
+        thread->start();
+        threads.append(thread);
+    }
+
+    scanProcesses(&mScanBuffer, 0, threadCount);
+
+    Q_FOREACH (ScanThread *thread, threads) {
+        thread->wait();
+        delete thread;
+    }
+}
+
+ProcState* ProcessesLocal::Private::processState(long pid)
+{
+    ProcState *state = mStates.value(pid);
+    if (state && state->valid) {
+        return state;
+    }
+
+    if (pid <= 0 || mProcDir == NULL) {
+        return 0;
+    }
+
+    if (!state) {
+        state = new ProcState(pid);
+        mStates.insert(pid, state);
+    }
+
+    return scanProcess(state, &mScanBuffer) ? state : 0;
+}
+
+void ProcessesLocal::Private::scanProcesses(ProcScanBuffer *buffer, int first, int step)
+{
+    // Interleaved, so that processes with many threads or long command lines
+    // do not end up in the range of a single thread
+    const int count = mScanStates.count();
+    for (int i = first; i < count; i += step) {
+        scanProcess(mScanStates.at(i), buffer);
+    }
+}
+
+bool ProcessesLocal::Private::scanProcess(ProcState *state, ProcScanBuffer *buffer)
+{
+    state->valid = false;
+    state->replaced = false;
+
+    keepDescriptors(state);
+    if (!readProcStat(state, buffer)) {
+        // The kept descriptors refer to an ended process if the pid has been reused
+        if (!closeDescriptors(state)) {
+            return false; // process has terminated in the meantime
+        }
+        keepDescriptors(state);
+        if (!readProcStat(state, buffer)) {
+            return false;
+        }
+    }
+
+    state->hasStatus = readProcStatus(state, buffer);
+    state->hasStatm = readProcStatm(state, buffer);
+    if (!state->hasCommand) {
+        readProcCmdline(state, buffer);
+    }
+    getScheduler(state);
+    state->hasIo = mReadIo && getIOStatistics(state, buffer);
+
+    state->valid = true;
     return true;
 }
 
-long ProcessesLocal::getParentPid(long pid) {
-    if (pid <= 0) {
-        return -1;
+void ProcessesLocal::Private::keepDescriptors(ProcState *state)
+{
+    if (state->triedKeeping) {
+        return;
     }
-    d->mFile.setFileName("/proc/" + QString::number(pid) + "/stat");
-    if (!d->mFile.open(QIODevice::ReadOnly)) {
-        return -1; // process has terminated in the meantime
+    state->triedKeeping = true;
+
+    if (mKeptDescriptors.fetchAndAddRelaxed(KeptDescriptorsPerProcess) + KeptDescriptorsPerProcess > mMaximumKeptDescriptors) {
+        mKeptDescriptors.fetchAndAddRelaxed(-KeptDescriptorsPerProcess);
+        return;
+    }
+
+    char name[24];
+    formatNumber(state->pid, name);
+    state->dirFd = ::openat(mProcFd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (state->dirFd == -1) {
+        mKeptDescriptors.fetchAndAddRelaxed(-KeptDescriptorsPerProcess);
+    }
+}
+
+bool ProcessesLocal::Private::closeDescriptors(ProcState *state)
+{
+    const bool kept = (state->dirFd != -1);
+    if (kept) {
+        ::close(state->dirFd);
+        mKeptDescriptors.fetchAndAddRelaxed(-KeptDescriptorsPerProcess);
     }
+    if (state->statFd != -1) {
+        ::close(state->statFd);
+    }
+    if (state->statusFd != -1) {
+        ::close(state->statusFd);
+    }
+    if (state->statmFd != -1) {
+        ::close(state->statmFd);
+    }
+    state->dirFd = state->statFd = state->statusFd = state->statmFd = -1;
+    state->triedKeeping = false;
+    return kept;
+}
+
+int ProcessesLocal::Private::openProcFile(ProcState *state, const char *name) const
+{
+    if (state->dirFd != -1) {
+        return ::openat(state->dirFd, name, O_RDONLY | O_CLOEXEC);
+    }
+
+    char path[64];
+    char *end = formatNumber(state->pid, path);
+    *end++ = '/';
+    qstrncpy(end, name, sizeof(path) - (end - path));
+    return ::openat(mProcFd, path, O_RDONLY | O_CLOEXEC);
+}
 
-    int size = d->mFile.readLine(d->mBuffer, sizeof(d->mBuffer));
-    if (size <= 0) { // -1 indicates nothing read
-        d->mFile.close();
+int ProcessesLocal::Private::readProcFile(ProcState *state, const char *name, int *keptFd, char *buffer, int size)
+{
+    ssize_t count;
+    if (keptFd && state->dirFd != -1) {
+        if (*keptFd == -1) {
+            *keptFd = openProcFile(state, name);
+            if (*keptFd == -1) {
+                return -1;
+            }
+        }
+        // Reading a /proc file from the start generates its content again
+        count = ::pread(*keptFd, buffer, size - 1, 0);
+    } else {
+        const int fd = openProcFile(state, name);
+        if (fd == -1) {
+            return -1;
+        }
+        count = ::read(fd, buffer, size - 1);
+        ::close(fd);
+    }
+
+    if (count < 0) {
         return -1;
     }
+    buffer[count] = '\0';
+    return count;
+}
+
+bool ProcessesLocal::Private::readProcStat(ProcState *state, ProcScanBuffer *buffer)
+{
+    if (readProcFile(state, "stat", &state->statFd, buffer->stat, sizeof(buffer->stat)) <= 0) {
+        return false; // process has terminated in the meantime
+    }
 
-    d->mFile.close();
-    char *word = d->mBuffer;
     // the command name is the second parameter, and this ends with a closing bracket so find the
     // last closing bracket and start from there
-    word = strrchr(word, ')');
-    if (!word) {
-        return -1;
+    const char *word = strrchr(buffer->stat, ')');
+    if (!word || word[1] != ' ') {
+        return false;
     }
-    word++; // nove to the space after the last ")"
-    int current_word = 1;
+    word += 2;
+    state->status = *word++; // look at the first letter of the status
 
-    while (true) {
-        if(word[0] == ' ') {
-            if(++current_word == 3) {
-                break;
-            }
-        } else if(word[0] == 0) {
-            return -1; // end of data - serious problem
+    // fields 4 (ppid) to 24 (rss) of proc(5)
+    qlonglong fields[21];
+    for (int i = 0; i < 21; ++i) {
+        if (!parseNumber(&word, &fields[i])) {
+            return false; // end of data - serious problem
         }
-        word++;
     }
-    long ppid = atol(++word);
-    if (ppid == 0) {
-        return -1;
+
+    state->ppid = fields[0];
+    state->ttyNo = fields[3];
+    state->userTime = fields[10];
+    state->sysTime = fields[11];
+    state->niceLevel = fields[15];
+    state->vmSize = fields[19];
+    state->vmRSS = fields[20];
+
+    const qlonglong startTime = fields[18];
+    if (state->startTime != startTime) {
+        // The pid has been reused, the command line is the one of another process
+        state->replaced = (state->startTime != -1);
+        state->startTime = startTime;
+        state->hasCommand = false;
     }
-    return ppid;
+    return true;
 }
 
-bool ProcessesLocal::Private::readProcStat(const QString &dir, Process *ps)
+bool ProcessesLocal::Private::readProcStatus(ProcState *state, ProcScanBuffer *buffer)
 {
-    QString filename = dir + "stat";
-    // As an optimization, if the last file read in was stat, then we already have this info in memory
-    if (mFile.fileName() != filename) {
-        mFile.setFileName(filename);
-        if(!mFile.open(QIODevice::ReadOnly)) {
-            return false; // process has terminated in the meantime
+    if (readProcFile(state, "status", &state->statusFd, buffer->status, sizeof(buffer->status)) <= 0) {
+        return false; // process has terminated in the meantime
+    }
+
+    memset(state->uids, 0, sizeof(state->uids));
+    memset(state->gids, 0, sizeof(state->gids));
+    state->tracerpid = -1;
+    state->numThreads = 0;
+
+    int found = 0; // count how many fields we found
+    const char *line = buffer->status;
+    while (*line && found < 5) {
+        const char *end = strchr(line, '\n');
+        if (qstrncmp(line, "Name:", sizeof("Name:")-1) == 0) {
+            const char *name = line + sizeof("Name:")-1;
+            const int length = end ? end - name : qstrlen(name);
+            if (state->name != QByteArray::fromRawData(name, length)) {
+                state->name = QByteArray(name, length);
+            }
+            ++found;
+        } else if (qstrncmp(line, "Uid:", sizeof("Uid:")-1) == 0) {
+            const char *word = line + sizeof("Uid:")-1;
+            for (int i = 0; i < 4 && parseNumber(&word, &state->uids[i]); ++i) {
+            }
+            ++found;
+        } else if (qstrncmp(line, "Gid:", sizeof("Gid:")-1) == 0) {
+            const char *word = line + sizeof("Gid:")-1;
+            for (int i = 0; i < 4 && parseNumber(&word, &state->gids[i]); ++i) {
+            }
+            ++found;
+        } else if (qstrncmp(line, "TracerPid:", sizeof("TracerPid:")-1) == 0) {
+            const char *word = line + sizeof("TracerPid:")-1;
+            if (parseNumber(&word, &state->tracerpid) && state->tracerpid == 0) {
+                state->tracerpid = -1;
+            }
+            ++found;
+        } else if (qstrncmp(line, "Threads:", sizeof("Threads:")-1) == 0) {
+            const char *word = line + sizeof("Threads:")-1;
+            qlonglong threads = 0;
+            parseNumber(&word, &threads);
+            state->numThreads = threads;
+            ++found;
         }
-        if(mFile.readLine( mBuffer, sizeof(mBuffer)) <= 0) { // -1 indicates nothing read
-            mFile.close();
-            return false;
+
+        if (!end) {
+            break;
         }
-        mFile.close();
+        line = end + 1;
     }
 
-    char *word = mBuffer;
-    // the command name is the second parameter, and this ends with a closing bracket so find the
-    // last closing bracket and start from there
-    word = strrchr(word, ')');
-    if (!word) {
+    return true;
+}
+
+bool ProcessesLocal::Private::readProcStatm(ProcState *state, ProcScanBuffer *buffer)
+{
+    if (readProcFile(state, "statm", &state->statmFd, buffer->stat, sizeof(buffer->stat)) <= 0) {
+        return false; // process has terminated in the meantime
+    }
+
+    // size, resident and shared pages
+    const char *word = buffer->stat;
+    qlonglong size, resident;
+    return parseNumber(&word, &size) && parseNumber(&word, &resident) && parseNumber(&word, &state->sharedPages);
+}
+
+bool ProcessesLocal::Private::readProcCmdline(ProcState *state, ProcScanBuffer *buffer)
+{
+    const int fd = openProcFile(state, "cmdline");
+    if (fd == -1) {
+        return false; // process has terminated in the meantime
+    }
+
+    QByteArray &cmdline = buffer->cmdline;
+    cmdline.resize(0);
+    ssize_t count;
+    do {
+        const int size = cmdline.size();
+        cmdline.resize(size + 4096);
+        count = ::read(fd, cmdline.data() + size, 4096);
+        cmdline.resize(size + qMax<ssize_t>(count, 0));
+    } while (count > 0);
+    ::close(fd);
+
+    if (count < 0) {
         return false;
     }
-    word++; // nove to the space after the last ")"
-    int current_word = 1; // skipped the process ID and now at the end of the command name
-    char status= '\0';
-    unsigned long long vmSize = 0;
-    unsigned long long vmRSS = 0;
-    while (current_word < 23) {
-        if (word[0] == ' ' ) {
-            ++current_word;
-            switch(current_word) {
-                case 2: { // status
-                    status=word[1];  // look at the first letter of the status.
-                    // analyze this after the while loop
-                    break;
-                }
-                case 6: { // ttyNo
-                    int ttyNo = atoi(word+1);
-                    int major = ttyNo >> 8;
-                    int minor = ttyNo & 0xff;
-                    switch(major) {
-                        case 136: {
-                            ps->setTty(QByteArray("pts/") + QByteArray::number(minor));
-                            break;
-                        }
-                        case 5: {
-                            ps->setTty(QByteArray("tty"));
-                        }
-                        case 4: {
-                            if(minor < 64) {
-                                ps->setTty(QByteArray("tty") + QByteArray::number(minor));
-                            } else {
-                                ps->setTty(QByteArray("ttyS") + QByteArray::number(minor-64));
-                            }
-                            break;
-                        }
-                        default: {
-                            ps->setTty(QByteArray());
-                        }
-                    }
-                    break;
-                }
-                case 13: { // userTime
-                    ps->setUserTime(atoll(word+1));
-                    break;
-                }
-                case 14: { // sysTime
-                    ps->setSysTime(atoll(word+1));
-                    break;
-                }
-                case 18: { // niceLevel
-                    ps->setNiceLevel(atoi(word+1)); // or should we use getPriority instead?
-                    break;
-                }
-                case 22: { // vmSize
-                    vmSize = atoll(word+1);
-                    break;
-                }
-                case 23: { // vmRSS
-                    vmRSS = atoll(word+1);
-                    break;
-                }
-                default: {
-                    break;
-                }
+
+    // cmdline separates parameters with the NULL character
+    state->command = QString::fromLocal8Bit(cmdline.constData(), cmdline.size());
+    state->commandName.clear();
+    if (!state->command.isEmpty()) {
+        //extract non-truncated name from cmdline
+        int zeroIndex = state->command.indexOf(QChar('\0'));
+        int processNameStart = state->command.lastIndexOf(QChar('/'), zeroIndex);
+        if(processNameStart == -1) {
+            processNameStart = 0;
+        } else {
+            processNameStart++;
+        }
+        state->commandName = state->command.mid(processNameStart, zeroIndex - processNameStart);
+        state->command.replace('\0', ' ');
+    } else {
+        // kernel threads have no command line, do not read it again
+        state->command = QLatin1String("");
+    }
+
+    state->hasCommand = true;
+    return true;
+}
+
+void ProcessesLocal::Private::getScheduler(ProcState *state)
+{
+    state->scheduler = sched_getscheduler(state->pid);
+    state->hasScheduler = true;
+    if (state->scheduler == SCHED_FIFO || state->scheduler == SCHED_RR) {
+        struct sched_param param;
+        if (sched_getparam(state->pid, &param) == 0) {
+            state->schedPriority = param.sched_priority;
+        } else {
+            state->schedPriority = 0;  // error getting scheduler parameters.
+            state->hasScheduler = false;
+        }
+    }
+}
+
+bool ProcessesLocal::Private::getIOStatistics(ProcState *state, ProcScanBuffer *buffer)
+{
+    if (readProcFile(state, "io", 0, buffer->stat, sizeof(buffer->stat)) <= 0) {
+        return false; // process has terminated in the meantime, or it is not ours
+    }
+
+    // rchar, wchar, syscr, syscw, read_bytes and write_bytes, one per line
+    const char *line = buffer->stat;
+    for (int i = 0; i < 6; ++i) {
+        const char *value = strchr(line, ':');
+        if (!value) {
+            return false;
+        }
+        ++value;
+        if (!parseNumber(&value, &state->io[i])) {
+            return false;
+        }
+        line = value;
+    }
+    return true;
+}
+
+void ProcessesLocal::Private::applyStat(ProcState *state, Process *ps)
+{
+    const int major = state->ttyNo >> 8;
+    const int minor = state->ttyNo & 0xff;
+    switch(major) {
+        case 136: {
+            ps->setTty(QByteArray("pts/") + QByteArray::number(minor));
+            break;
+        }
+        case 5: {
+            ps->setTty(QByteArray("tty"));
+        }
+        case 4: {
+            if(minor < 64) {
+                ps->setTty(QByteArray("tty") + QByteArray::number(minor));
+            } else {
+                ps->setTty(QByteArray("ttyS") + QByteArray::number(minor-64));
             }
-        } else if (word[0] == 0) {
-            return false; // end of data - serious problem
+            break;
+        }
+        default: {
+            ps->setTty(QByteArray());
         }
-        word++;
     }
 
+    ps->setUserTime(state->userTime);
+    ps->setSysTime(state->sysTime);
+    ps->setNiceLevel(state->niceLevel); // or should we use getPriority instead?
+
     /* there was a "(ps->vmRss+3) * sysconf(_SC_PAGESIZE)" here in the original ksysguard code.
      * I have no idea why!  after comparing it to meminfo and other tools, this means we report the
      * RSS by 12 bytes differently compared to them.  So I'm removing the +3 to be consistent.
@@ -277,10 +724,10 @@ bool ProcessesLocal::Private::readProcStat(const QString &dir, Process *ps)
      *   update: I think I now know why - the kernel allocates 3 pages for tracking information
      *           about each the process. this memory isn't included in vmRSS..
     */
-    ps->setVmRSS(vmRSS * (sysconf(_SC_PAGESIZE) / 1024)); // convert to KiB
-    ps->setVmSize(vmSize / 1024); // convert to KiB
+    ps->setVmRSS(state->vmRSS * mPageSizeKiB); // convert to KiB
+    ps->setVmSize(state->vmSize / 1024); // convert to KiB
 
-    switch(status) {
+    switch(state->status) {
         case 'R': {
             ps->setStatus(Process::Running);
             break;
@@ -310,81 +757,47 @@ bool ProcessesLocal::Private::readProcStat(const QString &dir, Process *ps)
             break;
         }
     }
-    return true;
 }
 
-bool ProcessesLocal::Private::readProcStatm(const QString &dir, Process *process)
+void ProcessesLocal::Private::applyStatus(ProcState *state, Process *process)
 {
-    mFile.setFileName(dir + "statm");
-    if (!mFile.open(QIODevice::ReadOnly)) {
-        return false; // process has terminated in the meantime
-    }
-
-    if( mFile.readLine( mBuffer, sizeof(mBuffer)) <= 0) { // -1 indicates nothing read
-        mFile.close();
-        return false;
+    if(process->command.isEmpty()) {
+        process->setName(QString::fromLocal8Bit(state->name).trimmed());
     }
-    mFile.close();
-
-    int current_word = 0;
-    char *word = mBuffer;
-
-    while(true) {
-        if (word[0] == ' ' ) {
-            if (++current_word == 2) { // number of pages that are shared
-                break;
-            }
-        } else if (word[0] == 0) {
-            return false; // end of data - serious problem
-        }
-        word++;
-    }
-    long shared = atol(word+1);
+    process->setUid(state->uids[0]);
+    process->setEuid(state->uids[1]);
+    process->setSuid(state->uids[2]);
+    process->setFsuid(state->uids[3]);
+    process->setGid(state->gids[0]);
+    process->setEgid(state->gids[1]);
+    process->setSgid(state->gids[2]);
+    process->setFsgid(state->gids[3]);
+    process->setTracerpid(state->tracerpid);
+    process->setNumThreads(state->numThreads);
+}
 
+void ProcessesLocal::Private::applyStatm(ProcState *state, Process *process)
+{
     /* we use the rss - shared  to find the amount of memory just this app uses */
-    process->vmURSS = process->vmRSS - (shared * sysconf(_SC_PAGESIZE) / 1024);
-    return true;
+    process->vmURSS = process->vmRSS - (state->sharedPages * mPageSizeKiB);
 }
 
-
-bool ProcessesLocal::Private::readProcCmdline(const QString &dir, Process *process)
+void ProcessesLocal::Private::applyCmdline(ProcState *state, Process *process)
 {
+    // only parse the cmdline once, this function takes up 25% of the CPU time :-/
     if (!process->command.isNull()) {
-        return true; // only parse the cmdline once, this function takes up 25% of the CPU time :-/
+        return;
     }
-    mFile.setFileName(dir + "cmdline");
-    if (!mFile.open(QIODevice::ReadOnly)) {
-        return false; // process has terminated in the meantime
-    }
-
-    QTextStream in(&mFile);
-    process->command = in.readAll();
-
-    // cmdline separates parameters with the NULL character
-    if (!process->command.isEmpty()) {
-        //extract non-truncated name from cmdline
-        int zeroIndex = process->command.indexOf(QChar('\0'));
-        int processNameStart = process->command.lastIndexOf(QChar('/'), zeroIndex);
-        if(processNameStart == -1) {
-            processNameStart = 0;
-        } else {
-            processNameStart++;
-        }
-        QString nameFromCmdLine = process->command.mid(processNameStart, zeroIndex - processNameStart);
-        if (nameFromCmdLine.startsWith(process->name)) {
-            process->setName(nameFromCmdLine);
-        }
 
-        process->command.replace('\0', ' ');
+    process->command = state->command;
+    if (!state->commandName.isEmpty() && state->commandName.startsWith(process->name)) {
+        process->setName(state->commandName);
     }
-
-    mFile.close();
-    return true;
 }
 
-bool ProcessesLocal::Private::getNiceness(long pid, Process *process) {
-    int sched = sched_getscheduler(pid);
-    switch(sched) {
+void ProcessesLocal::Private::applyNiceness(ProcState *state, Process *process)
+{
+    switch(state->scheduler) {
         case SCHED_OTHER: {
             process->scheduler = KSysGuard::Process::Other;
             break;
@@ -413,107 +826,86 @@ bool ProcessesLocal::Private::getNiceness(long pid, Process *process) {
             process->scheduler = KSysGuard::Process::Other;
         }
     }
-    if (sched == SCHED_FIFO || sched == SCHED_RR) {
-        struct sched_param param;
-        if (sched_getparam(pid, &param) == 0) {
-            process->setNiceLevel(param.sched_priority);
-        } else {
-            process->setNiceLevel(0);  // error getting scheduler parameters.
-            return false;
-        }
+    if (state->scheduler == SCHED_FIFO || state->scheduler == SCHED_RR) {
+        process->setNiceLevel(state->schedPriority);
     }
-    return true;
 }
 
-bool ProcessesLocal::Private::getIOStatistics(const QString &dir, Process *process)
+void ProcessesLocal::Private::applyIOStatistics(ProcState *state, Process *process)
 {
-    QString filename = dir + "io";
-    // As an optimization, if the last file read in was io, then we already have this info in memory
-    mFile.setFileName(filename);
-    if (!mFile.open(QIODevice::ReadOnly)) {
-        return false; // process has terminated in the meantime
-    }
-    if (mFile.read( mBuffer, sizeof(mBuffer)) <= 0) { // -1 indicates nothing read
-        mFile.close();
-        return false;
-    }
-    mFile.close();
-
-    int current_word = 0;  //count from 0
-    char *word = mBuffer;
-    while (current_word < 6 && word[0] != 0) {
-        if (word[0] == ' ' ) {
-            qlonglong number = atoll(word+1);
-            switch(current_word++) {
-                case 0: { // rchar - characters read
-                    process->setIoCharactersRead(number);
-                    break;
-                }
-                case 1: { // wchar - characters written
-                    process->setIoCharactersWritten(number);
-                    break;
-                }
-                case 2: { // syscr - read syscall
-                    process->setIoReadSyscalls(number);
-                    break;
-                }
-                case 3: { // syscw - write syscall
-                    process->setIoWriteSyscalls(number);
-                    break;
-                }
-                case 4: { // read_bytes - bytes actually read from I/O
-                    process->setIoCharactersActuallyRead(number);
-                    break;
-                }
-                case 5: { // write_bytes - bytes actually written to I/O
-                    process->setIoCharactersActuallyWritten(number);
-                    break;
-                }
-                default:
-                    break;
-            }
-        }
-        word++;
+    process->setIoCharactersRead(state->io[0]);
+    process->setIoCharactersWritten(state->io[1]);
+    process->setIoReadSyscalls(state->io[2]);
+    process->setIoWriteSyscalls(state->io[3]);
+    process->setIoCharactersActuallyRead(state->io[4]);
+    process->setIoCharactersActuallyWritten(state->io[5]);
+}
+
+long ProcessesLocal::getParentPid(long pid) {
+    ProcState *state = d->processState(pid);
+    if (!state || state->ppid == 0) {
+        return -1;
     }
-    return true;
+    return state->ppid;
 }
+
 bool ProcessesLocal::updateProcessInfo( long pid, Process *process)
 {
-    bool success = true;
-    QString dir = "/proc/" + QString::number(pid) + '/';
-    if (!d->readProcStat(dir, process)) {
-        success = false;
+    ProcState *state = d->processState(pid);
+    if (!state) {
+        return false; // process has terminated in the meantime
     }
-    if (!d->readProcStatus(dir, process)) {
-        success = false;
+
+    // Read the process again if this is called once more before the next scan
+    state->valid = false;
+
+    if (state->replaced) {
+        // The pid has been reused since the process was read the last time
+        process->command = QString();
     }
-    if (!d->readProcStatm(dir, process)) {
+
+    bool success = true;
+    d->applyStat(state, process);
+    if (state->hasStatus) {
+        d->applyStatus(state, process);
+    } else {
         success = false;
     }
-    if (!d->readProcCmdline(dir, process)) {
+    if (state->hasStatm) {
+        d->applyStatm(state, process);
+    } else {
         success = false;
     }
-    if (!d->getNiceness(pid, process)) {
+    if (state->hasCommand) {
+        d->applyCmdline(state, process);
+    } else {
         success = false;
     }
-    if (mUpdateFlags.testFlag(Processes::IOStatistics) && !d->getIOStatistics(dir, process)) {
+    d->applyNiceness(state, process);
+    if (!state->hasScheduler) {
+        process->setNiceLevel(0);  // error getting scheduler parameters.
         success = false;
     }
+    if (mUpdateFlags.testFlag(Processes::IOStatistics)) {
+        if (state->hasIo) {
+            d->applyIOStatistics(state, process);
+        } else {
+            success = false;
+        }
+    }
 
     return success;
 }
 
 QSet<long> ProcessesLocal::getAllPids( )
 {
+    d->scan(mUpdateFlags.testFlag(Processes::IOStatistics));
+
     QSet<long> pids;
-    if (d->mProcDir == NULL) {
-        return pids; // there's not much we can do without /proc
-    }
-    struct dirent* entry;
-    rewinddir(d->mProcDir);
-    while ((entry = ::readdir(d->mProcDir))) {
-        if (entry->d_name[0] >= '0' && entry->d_name[0] <= '9') {
-            pids.insert(atol(entry->d_name));
+    pids.reserve(d->mScanStates.count());
+    Q_FOREACH (ProcState *state, d->mScanStates) {
+        if (state->valid) {
+            pids.insert(state->pid);
         }
     }
     return pids;
@@ -0,0 +1,610 @@
+/*  This file is part of the KDE project
+
+    Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+
+*/
+
+#include "processsampler.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QHash>
+#include <QtCore/QThread>
+#include <QtCore/QVector>
+#include <QtCore/qalgorithms.h>
+
+#ifdef Q_OS_LINUX
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Enough for 2.5 seconds at the highest rate, or 10 seconds at the default rate
+    const int RingSize = 512;
+
+    const int DefaultRate = 50;
+
+    class Sample
+    {
+    public:
+        long pid;
+        qint64 time;        ///< CLOCK_MONOTONIC, in nanoseconds
+        qint64 runTime;     ///< Nanoseconds spent on a CPU
+        qint64 waitTime;    ///< Nanoseconds spent waiting for a CPU, -1 if not known
+        qint64 readBytes;   ///< -1 if /proc/<pid>/io can not be read
+        qint64 writeBytes;
+        qint64 rss;         ///< In KiB
+    };
+
+    /** The schedstat of a thread of a watched process */
+    class ThreadTimes
+    {
+    public:
+        ThreadTimes()
+            : fd(-1), runTime(0), waitTime(0), generation(0) {}
+
+        int fd;
+        qint64 runTime;
+        qint64 waitTime;
+        uint generation;    ///< The last sample the thread was seen in
+    };
+
+    /**
+     * The ring buffer of a watched process.  The sampling thread is the only one writing the samples
+     * and mWritten, the thread calling takeStatistics() is the only one changing mRead and mPid.
+     */
+    class Slot
+    {
+    public:
+        Slot()
+            : mPid(0), mWritten(0), mRead(0),
+              sampledPid(0), taskDir(0), statFd(-1), ioFd(-1), statmFd(-1),
+              generation(0), runTime(0), waitTime(0),
+              hasPrevious(false) {}
+
+        QAtomicInt mPid;
+        QAtomicInt mWritten;
+        QAtomicInt mRead;
+        Sample samples[RingSize];
+
+        // Only used by the sampling thread
+        long sampledPid;
+        DIR *taskDir;       ///< /proc/<pid>/task, to sum the schedstat of all threads
+        int statFd;
+        int ioFd;
+        int statmFd;
+        QHash<long, ThreadTimes> threads;
+        uint generation;
+        qint64 runTime;     ///< Sum of the times of all threads seen so far
+        qint64 waitTime;
+
+        // Only used by takeStatistics()
+        Sample previous;
+        bool hasPrevious;
+    };
+
+    inline int load(const QAtomicInt &value)
+    {
+        return const_cast<QAtomicInt &>(value).fetchAndAddAcquire(0);
+    }
+
+    qreal percentile(const QVector<qreal> &sorted, int percent)
+    {
+        // Nearest rank
+        const int index = (sorted.count() * percent + 99) / 100 - 1;
+        return sorted.at(qBound(0, index, sorted.count() - 1));
+    }
+
+    KSysGuard::ProcessSampler::Distribution distribution(QVector<qreal> &values)
+    {
+        KSysGuard::ProcessSampler::Distribution result;
+        if (values.isEmpty()) {
+            return result;
+        }
+        qSort(values);
+        result.median = percentile(values, 50);
+        result.p90 = percentile(values, 90);
+        result.p99 = percentile(values, 99);
+        result.maximum = values.last();
+        return result;
+    }
+
+#ifdef Q_OS_LINUX
+    int openProcFile(long pid, const char *name)
+    {
+        char path[64];
+        ::snprintf(path, sizeof(path), "/proc/%ld/%s", pid, name);
+        return ::open(path, O_RDONLY | O_CLOEXEC);
+    }
+
+    void closeFile(int &fd)
+    {
+        if (fd != -1) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    DIR *openTaskDir(long pid)
+    {
+        char path[64];
+        ::snprintf(path, sizeof(path), "/proc/%ld/task", pid);
+        return ::opendir(path);
+    }
+
+    /** Reads the whole file again, without reopening it */
+    bool readFile(int fd, char *buffer, int size)
+    {
+        if (fd == -1) {
+            return false;
+        }
+        const ssize_t length = ::pread(fd, buffer, size - 1, 0);
+        if (length <= 0) {
+            return false;
+        }
+        buffer[length] = '\0';
+        return true;
+    }
+
+    const char *readNumber(const char *text, qint64 &value)
+    {
+        while (*text == ' ') {
+            ++text;
+        }
+        value = 0;
+        while (*text >= '0' && *text <= '9') {
+            value = value * 10 + (*text - '0');
+            ++text;
+        }
+        return text;
+    }
+
+    const char *skipFields(const char *text, int count)
+    {
+        while (count > 0 && *text) {
+            while (*text == ' ') {
+                ++text;
+            }
+            while (*text && *text != ' ') {
+                ++text;
+            }
+            --count;
+        }
+        return text;
+    }
+
+    qint64 monotonicTime()
+    {
+        struct timespec now;
+        ::clock_gettime(CLOCK_MONOTONIC, &now);
+        return qint64(now.tv_sec) * 1000000000 + now.tv_nsec;
+    }
+#endif
+}
+
+namespace KSysGuard
+{
+
+ProcessSampler::Distribution::Distribution()
+    : median(0), p90(0), p99(0), maximum(0)
+{
+}
+
+ProcessSampler::Statistics::Statistics()
+    : samples(0)
+{
+}
+
+class ProcessSampler::Private : public QThread
+{
+public:
+    Private();
+    ~Private();
+
+    Slot *findSlot(long pid) const;
+
+    Slot *mSlots;
+    QAtomicInt mInterval; ///< Nanoseconds between the samples
+    QAtomicInt mStop;
+
+protected:
+    void run();
+
+private:
+#ifdef Q_OS_LINUX
+    void sample(Slot &slot);
+    bool sampleThreads(Slot &slot);
+    void closeFiles(Slot &slot);
+
+    const long mPageSizeKiB;
+    const long mClockTicks;
+#endif
+};
+
+ProcessSampler::Private::Private()
+    : mSlots(new Slot[MaximumWatched]),
+      mInterval(1000000000 / DefaultRate),
+      mStop(0)
+#ifdef Q_OS_LINUX
+      , mPageSizeKiB(::sysconf(_SC_PAGESIZE) / 1024),
+      mClockTicks(::sysconf(_SC_CLK_TCK))
+#endif
+{
+}
+
+ProcessSampler::Private::~Private()
+{
+    delete [] mSlots;
+}
+
+Slot *ProcessSampler::Private::findSlot(long pid) const
+{
+    for (int i = 0; i < MaximumWatched; ++i) {
+        if (load(mSlots[i].mPid) == pid) {
+            return &mSlots[i];
+        }
+    }
+    return 0;
+}
+
+void ProcessSampler::Private::run()
+{
+#ifdef Q_OS_LINUX
+    struct timespec next;
+    ::clock_gettime(CLOCK_MONOTONIC, &next);
+    while (!load(mStop)) {
+        for (int i = 0; i < MaximumWatched; ++i) {
+            sample(mSlots[i]);
+        }
+
+        // Sleep until the next period starts, skipping the ones that have been missed
+        const qint64 interval = load(mInterval);
+        qint64 nextTime = qint64(next.tv_sec) * 1000000000 + next.tv_nsec + interval;
+        const qint64 now = monotonicTime();
+        if (nextTime < now) {
+            nextTime = now + interval;
+        }
+        next.tv_sec = nextTime / 1000000000;
+        next.tv_nsec = nextTime % 1000000000;
+        while (::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, 0) == EINTR) {
+        }
+    }
+
+    for (int i = 0; i < MaximumWatched; ++i) {
+        closeFiles(mSlots[i]);
+        mSlots[i].sampledPid = 0;
+    }
+#endif
+}
+
+#ifdef Q_OS_LINUX
+void ProcessSampler::Private::closeFiles(Slot &slot)
+{
+    if (slot.taskDir) {
+        ::closedir(slot.taskDir);
+        slot.taskDir = 0;
+    }
+    for (QHash<long, ThreadTimes>::iterator it = slot.threads.begin(); it != slot.threads.end(); ++it) {
+        closeFile(it->fd);
+    }
+    slot.threads.clear();
+    closeFile(slot.statFd);
+    closeFile(slot.ioFd);
+    closeFile(slot.statmFd);
+}
+
+/**
+ * /proc/<pid>/schedstat only covers the main thread, the times of all the threads are summed.  The
+ * sums only grow: a thread that started since the previous sample adds all its time, a thread that
+ * ended is left out from then on.
+ */
+bool ProcessSampler::Private::sampleThreads(Slot &slot)
+{
+    if (!slot.taskDir) {
+        return false;
+    }
+    const bool first = slot.generation == 0;
+    ++slot.generation;
+    bool found = false;
+    char buffer[128];
+    ::rewinddir(slot.taskDir);
+    while (struct dirent *entry = ::readdir(slot.taskDir)) {
+        char *end;
+        const long tid = ::strtol(entry->d_name, &end, 10);
+        if (*end != '\0' || tid <= 0) {
+            continue;
+        }
+        ThreadTimes &thread = slot.threads[tid];
+        if (thread.fd == -1) {
+            char path[64];
+            ::snprintf(path, sizeof(path), "%ld/schedstat", tid);
+            thread.fd = ::openat(::dirfd(slot.taskDir), path, O_RDONLY | O_CLOEXEC);
+        }
+        qint64 runTime, waitTime;
+        if (!readFile(thread.fd, buffer, sizeof(buffer))) {
+            continue;
+        }
+        // Time spent on the CPU and waiting on a run queue, in nanoseconds
+        readNumber(readNumber(buffer, runTime), waitTime);
+        if (!first) {
+            slot.runTime += qMax(runTime - thread.runTime, qint64(0));
+            slot.waitTime += qMax(waitTime - thread.waitTime, qint64(0));
+        } else {
+            slot.runTime += runTime;
+            slot.waitTime += waitTime;
+        }
+        thread.runTime = runTime;
+        thread.waitTime = waitTime;
+        thread.generation = slot.generation;
+        found = true;
+    }
+
+    // Forget the threads that have ended
+    for (QHash<long, ThreadTimes>::iterator it = slot.threads.begin(); it != slot.threads.end();) {
+        if (it->generation != slot.generation) {
+            closeFile(it->fd);
+            it = slot.threads.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (!found && first) {
+        // No schedstat in this kernel, /proc/<pid>/stat is used instead
+        ::closedir(slot.taskDir);
+        slot.taskDir = 0;
+    }
+    return found;
+}
+
+void ProcessSampler::Private::sample(Slot &slot)
+{
+    const long pid = load(slot.mPid);
+    if (pid != slot.sampledPid) {
+        // The files are kept open, so that every sample only costs a pread() per file
+        closeFiles(slot);
+        slot.sampledPid = pid;
+        slot.generation = 0;
+        slot.runTime = slot.waitTime = 0;
+        if (pid != 0) {
+            slot.taskDir = openTaskDir(pid);
+            slot.statFd = openProcFile(pid, "stat");
+            slot.ioFd = openProcFile(pid, "io");
+            slot.statmFd = openProcFile(pid, "statm");
+        }
+    }
+    if (pid == 0) {
+        return;
+    }
+
+    Sample sample;
+    sample.pid = pid;
+    sample.time = monotonicTime();
+
+    char buffer[1024];
+    if (slot.taskDir) {
+        if (!sampleThreads(slot)) {
+            // The process has ended
+            return;
+        }
+        sample.runTime = slot.runTime;
+        sample.waitTime = slot.waitTime;
+    } else if (readFile(slot.statFd, buffer, sizeof(buffer))) {
+        // Without schedstat only the user and system time in clock ticks are available, they
+        // include the threads too
+        const char *text = ::strrchr(buffer, ')');
+        if (!text) {
+            return;
+        }
+        qint64 userTime, systemTime;
+        text = readNumber(skipFields(text + 1, 11), userTime);
+        readNumber(text, systemTime);
+        sample.runTime = (userTime + systemTime) * 1000000000 / mClockTicks;
+        sample.waitTime = -1;
+    } else {
+        // The process has ended
+        return;
+    }
+
+    sample.readBytes = sample.writeBytes = -1;
+    if (readFile(slot.ioFd, buffer, sizeof(buffer))) {
+        const char *text = ::strstr(buffer, "\nread_bytes:");
+        if (text) {
+            readNumber(text + 12, sample.readBytes);
+        }
+        text = ::strstr(buffer, "\nwrite_bytes:");
+        if (text) {
+            readNumber(text + 13, sample.writeBytes);
+        }
+    }
+
+    sample.rss = 0;
+    if (readFile(slot.statmFd, buffer, sizeof(buffer))) {
+        qint64 pages;
+        readNumber(readNumber(buffer, pages), pages);
+        sample.rss = pages * mPageSizeKiB;
+    }
+
+    // If the ring buffer is full the sample is dropped, takeStatistics() is not keeping up
+    const int written = load(slot.mWritten);
+    if (uint(written) - uint(load(slot.mRead)) >= uint(RingSize)) {
+        return;
+    }
+    slot.samples[uint(written) % RingSize] = sample;
+    slot.mWritten.fetchAndStoreRelease(int(uint(written) + 1));
+}
+#endif
+
+ProcessSampler::ProcessSampler()
+    : d(new Private())
+{
+}
+
+ProcessSampler::~ProcessSampler()
+{
+    stop();
+    delete d;
+}
+
+bool ProcessSampler::isSupported()
+{
+#ifdef Q_OS_LINUX
+    return ::access("/proc/self/stat", R_OK) == 0;
+#else
+    return false;
+#endif
+}
+
+void ProcessSampler::setRate(int samplesPerSecond)
+{
+    d->mInterval.fetchAndStoreRelaxed(1000000000 / qBound(10, samplesPerSecond, 200));
+}
+
+int ProcessSampler::rate() const
+{
+    return 1000000000 / load(d->mInterval);
+}
+
+bool ProcessSampler::watch(long pid)
+{
+    if (pid <= 0) {
+        return false;
+    }
+    if (d->findSlot(pid)) {
+        return true;
+    }
+    Slot *slot = d->findSlot(0);
+    if (!slot) {
+        return false;
+    }
+    // Samples of the previously watched process might still be written, they are skipped by their pid
+    slot->mRead.fetchAndStoreRelease(load(slot->mWritten));
+    slot->hasPrevious = false;
+    slot->mPid.fetchAndStoreRelease(pid);
+    return true;
+}
+
+void ProcessSampler::unwatch(long pid)
+{
+    if (pid <= 0) {
+        return;
+    }
+    Slot *slot = d->findSlot(pid);
+    if (slot) {
+        slot->mPid.fetchAndStoreRelease(0);
+    }
+}
+
+void ProcessSampler::setWatched(const QList<long> &pids)
+{
+    foreach (long pid, watched()) {
+        if (!pids.contains(pid)) {
+            unwatch(pid);
+        }
+    }
+    foreach (long pid, pids) {
+        if (!watch(pid)) {
+            break;
+        }
+    }
+}
+
+QList<long> ProcessSampler::watched() const
+{
+    QList<long> pids;
+    for (int i = 0; i < MaximumWatched; ++i) {
+        const long pid = load(d->mSlots[i].mPid);
+        if (pid != 0) {
+            pids << pid;
+        }
+    }
+    return pids;
+}
+
+void ProcessSampler::start()
+{
+    if (isSupported() && !d->isRunning()) {
+        d->start();
+    }
+}
+
+void ProcessSampler::stop()
+{
+    if (d->isRunning()) {
+        d->mStop.fetchAndStoreRelease(1);
+        d->wait();
+        d->mStop.fetchAndStoreRelease(0);
+    }
+}
+
+bool ProcessSampler::isRunning() const
+{
+    return d->isRunning();
+}
+
+ProcessSampler::Statistics ProcessSampler::takeStatistics(long pid)
+{
+    Statistics statistics;
+    Slot *slot = pid > 0 ? d->findSlot(pid) : 0;
+    if (!slot) {
+        return statistics;
+    }
+
+    QVector<qreal> cpuUsage, cpuWait, readRate, writeRate, rss;
+    const int written = load(slot->mWritten);
+    for (int read = load(slot->mRead); read != written; read = int(uint(read) + 1)) {
+        const Sample &sample = slot->samples[uint(read) % RingSize];
+        if (sample.pid != pid) {
+            continue;
+        }
+        rss << sample.rss;
+
+        // The rates are calculated from the previous sample, which may be from the previous call
+        const Sample &previous = slot->previous;
+        const qint64 elapsed = sample.time - previous.time;
+        if (slot->hasPrevious && elapsed > 0) {
+            cpuUsage << (sample.runTime - previous.runTime) * qreal(100) / elapsed;
+            if (sample.waitTime >= 0 && previous.waitTime >= 0) {
+                cpuWait << (sample.waitTime - previous.waitTime) * qreal(100) / elapsed;
+            }
+            if (sample.readBytes >= 0 && previous.readBytes >= 0) {
+                readRate << (sample.readBytes - previous.readBytes) * qreal(1000000000) / elapsed;
+                writeRate << (sample.writeBytes - previous.writeBytes) * qreal(1000000000) / elapsed;
+            }
+        }
+        slot->previous = sample;
+        slot->hasPrevious = true;
+    }
+    // Only now the samples may be overwritten
+    slot->mRead.fetchAndStoreRelease(written);
+
+    statistics.samples = rss.count();
+    statistics.cpuUsage = distribution(cpuUsage);
+    statistics.cpuWait = distribution(cpuWait);
+    statistics.readRate = distribution(readRate);
+    statistics.writeRate = distribution(writeRate);
+    statistics.rss = distribution(rss);
+    return statistics;
+}
+
+}
@@ -0,0 +1,127 @@
+/*  This file is part of the KDE project
+
+    Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+
+*/
+
+#ifndef PROCESSSAMPLER_H_
+#define PROCESSSAMPLER_H_
+
+#include <kdemacros.h>
+
+#include <QtCore/QList>
+
+namespace KSysGuard
+{
+    /**
+     * Samples a few processes many times per second, to catch short spikes in the CPU usage,
+     * I/O and memory usage which are missed by Processes::updateAllProcesses().
+     *
+     * The samples are taken in a separate thread, which writes them into a ring buffer for every
+     * watched process without any locking.  Call takeStatistics() on every update to get the
+     * distribution of the samples taken since the previous call.
+     *
+     * \code
+     *   KSysGuard::ProcessSampler sampler;
+     *   sampler.watch(pid);
+     *   sampler.start();
+     *   ...
+     *   KSysGuard::ProcessSampler::Statistics statistics = sampler.takeStatistics(pid);
+     *   kDebug() << "CPU usage peaked at" << statistics.cpuUsage.maximum << "%";
+     * \endcode
+     *
+     * This is only supported for processes on the local machine, on Linux.
+     */
+    class KDE_EXPORT ProcessSampler
+    {
+    public:
+        /** The maximum number of processes that can be watched at the same time */
+        enum { MaximumWatched = 16 };
+
+        /** Percentiles of a set of samples */
+        class KDE_EXPORT Distribution
+        {
+        public:
+            Distribution();
+            qreal median;
+            qreal p90;
+            qreal p99;
+            qreal maximum;
+        };
+
+        class KDE_EXPORT Statistics
+        {
+        public:
+            Statistics();
+            int samples;             ///< The number of samples taken, 0 if there are none
+            Distribution cpuUsage;   ///< CPU usage of all threads in percent of a single core, may exceed 100
+            Distribution cpuWait;    ///< Time all threads spent waiting for a CPU while runnable, in percent
+            Distribution readRate;   ///< Bytes read from storage per second
+            Distribution writeRate;  ///< Bytes written to storage per second
+            Distribution rss;        ///< Resident memory in KiB
+        };
+
+        ProcessSampler();
+        ~ProcessSampler();
+
+        /**
+         *  @return True if the processes can be sampled on this system.
+         */
+        static bool isSupported();
+
+        /**
+         *  Set the number of samples taken per second, between 10 and 200.  The default is 50.
+         */
+        void setRate(int samplesPerSecond);
+        int rate() const;
+
+        /**
+         *  Start sampling @p pid.  Returns false if MaximumWatched processes are watched already.
+         */
+        bool watch(long pid);
+        void unwatch(long pid);
+
+        /**
+         *  Watch the given processes instead of the current ones.  Only the first MaximumWatched
+         *  processes are watched.
+         */
+        void setWatched(const QList<long> &pids);
+        QList<long> watched() const;
+
+        /**
+         *  Start or stop the sampling thread.  The thread is stopped when the sampler is deleted.
+         */
+        void start();
+        void stop();
+        bool isRunning() const;
+
+        /**
+         *  Return the statistics of the samples of @p pid taken since the previous call, and drop
+         *  those samples.  If the thread was not able to keep up, or this is not called often
+         *  enough, some samples are missing.
+         */
+        Statistics takeStatistics(long pid);
+
+    private:
+        class Private;
+        Private * const d;
+        Q_DISABLE_COPY(ProcessSampler)
+    };
+}
+
+#endif
@@ -39,9 +39,11 @@
 #include <QList>
 #include <QMimeData>
 #include <QTextDocument>
+#include <QVector>
 
 #define HEADING_X_ICON_SIZE 16
 #define MILLISECONDS_TO_SHOW_RED_FOR_KILLED_PROCESS 2000
+#define COLUMN(heading) (1u << (heading))
 #define GET_OWN_ID
 
 #ifdef GET_OWN_ID
@@ -123,10 +125,15 @@ ProcessModelPrivate::ProcessModelPrivate() :  mBlankPixmap(HEADING_X_ICON_SIZE,1
     mMovingRow = false;
     mRemovingRow = false;
     mInsertingRow = false;
+    mPendingChangesQueued = false;
+    mUpdating = false;
+    mHiddenColumns = 0;
+    mSampler = NULL;
 }
 
 ProcessModelPrivate::~ProcessModelPrivate()
 {
+    delete mSampler;
 #ifdef Q_WS_X11
     qDeleteAll(mPidToWindowInfo);
 #endif
@@ -467,6 +474,7 @@ void ProcessModelPrivate::setupProcesses() {
 #endif
         delete mProcesses;
         mProcesses = 0;
+        mPendingChanges.clear();
         q->reset();
     }
 
@@ -569,9 +577,22 @@ void ProcessModelPrivate::updateWindowInfo(WId wid, unsigned int properties, boo
 void ProcessModel::update(long updateDurationMSecs, KSysGuard::Processes::UpdateFlags updateFlags) {
 //    kDebug() << "update all processes: " << QTime::currentTime().toString("hh:mm:ss.zzz");
     if(updateFlags != KSysGuard::Processes::XMemory) {
+        //Collect the changes of all the processes, and emit them in one go
+        d->mUpdating = true;
         d->mProcesses->updateAllProcesses(updateDurationMSecs, updateFlags);
+        d->mUpdating = false;
+        d->emitPendingChanges();
         if(d->mMemTotal <= 0)
             d->mMemTotal = d->mProcesses->totalPhysicalMemory();
+
+        if(d->mSampler) {
+            d->mSamplingStatistics.clear();
+            foreach(long pid, d->mSampler->watched()) {
+                const KSysGuard::ProcessSampler::Statistics statistics = d->mSampler->takeStatistics(pid);
+                if(statistics.samples > 0)
+                    d->mSamplingStatistics.insert(pid, statistics);
+            }
+        }
     }
 
 //    kDebug() << "finished:             " << QTime::currentTime().toString("hh:mm:ss.zzz");
@@ -689,93 +710,265 @@ bool ProcessModel::isSimpleMode() const
 
 void ProcessModelPrivate::processChanged(KSysGuard::Process *process, bool onlyTotalCpu)
 {
-    int row;
-    if(mSimple)
-        row = process->index;
-    else
-        row = process->parent->children.indexOf(process);
-
+    uint columns = 0;
     if (process->timeKillWasSent.isValid()) {
         qint64 elapsed = process->timeKillWasSent.elapsed();
         if (elapsed < MILLISECONDS_TO_SHOW_RED_FOR_KILLED_PROCESS) {
             if (!mPidsToUpdate.contains(process->pid))
                 mPidsToUpdate.append(process->pid);
-            QModelIndex index1 = q->createIndex(row, 0, process);
-            QModelIndex index2 = q->createIndex(row, mHeadings.count()-1, process);
-            emit q->dataChanged(index1, index2);
+            columns = ~0u;
             if (!mHaveTimer) {
                 mHaveTimer = true;
                 mTimerId = startTimer(100);
             }
         }
     }
-    Q_ASSERT(row != -1);  //Something has gone very wrong
     if(onlyTotalCpu) {
         if(mShowChildTotals) {
             //Only the total cpu usage changed, so only update that
-            QModelIndex index = q->createIndex(row, ProcessModel::HeadingCPUUsage, process);
-            emit q->dataChanged(index, index);
-        }
-        return;
-    } else {
-        if(process->changes == KSysGuard::Process::Nothing) {
-            return; //Nothing changed
+            columns |= COLUMN(ProcessModel::HeadingCPUUsage);
         }
+    } else if(process->changes != KSysGuard::Process::Nothing) {
         if(process->changes & KSysGuard::Process::Uids) {
-            QModelIndex index = q->createIndex(row, ProcessModel::HeadingUser, process);
-            emit q->dataChanged(index, index);
+            columns |= COLUMN(ProcessModel::HeadingUser);
         }
         if(process->changes & KSysGuard::Process::Tty) {
-            QModelIndex index = q->createIndex(row, ProcessModel::HeadingTty, process);
-            emit q->dataChanged(index, index);
+            columns |= COLUMN(ProcessModel::HeadingTty);
         }
         if(process->changes & (KSysGuard::Process::Usage | KSysGuard::Process::Status) || (process->changes & KSysGuard::Process::TotalUsage && mShowChildTotals)) {
-            QModelIndex index = q->createIndex(row, ProcessModel::HeadingCPUUsage, process);
-            emit q->dataChanged(index, index);
-            index = q->createIndex(row, ProcessModel::HeadingCPUTime, process);
-            emit q->dataChanged(index, index);
+            columns |= COLUMN(ProcessModel::HeadingCPUUsage) | COLUMN(ProcessModel::HeadingCPUTime);
             //Because of our sorting, changing usage needs to also invalidate the User column
-            index = q->createIndex(row, ProcessModel::HeadingUser, process);
-            emit q->dataChanged(index, index);
+            columns |= COLUMN(ProcessModel::HeadingUser);
         }
         if(process->changes & KSysGuard::Process::NiceLevels) {
-            QModelIndex index = q->createIndex(row, ProcessModel::HeadingNiceness, process);
-            emit q->dataChanged(index, index);
+            columns |= COLUMN(ProcessModel::HeadingNiceness);
         }
         if(process->changes & KSysGuard::Process::VmSize) {
-            QModelIndex index = q->createIndex(row, ProcessModel::HeadingVmSize, process);
-            emit q->dataChanged(index, index);
+            columns |= COLUMN(ProcessModel::HeadingVmSize);
         }
         if(process->changes & (KSysGuard::Process::VmSize | KSysGuard::Process::VmRSS | KSysGuard::Process::VmURSS)) {
-            QModelIndex index = q->createIndex(row, ProcessModel::HeadingMemory, process);
-            emit q->dataChanged(index, index);
-            QModelIndex index2 = q->createIndex(row, ProcessModel::HeadingSharedMemory, process);
-            emit q->dataChanged(index2, index2);
+            columns |= COLUMN(ProcessModel::HeadingMemory) | COLUMN(ProcessModel::HeadingSharedMemory);
             //Because of our sorting, changing usage needs to also invalidate the User column
-            index = q->createIndex(row, ProcessModel::HeadingUser, process);
-            emit q->dataChanged(index, index);
+            columns |= COLUMN(ProcessModel::HeadingUser);
         }
         if(process->changes & KSysGuard::Process::Name) {
-            QModelIndex index = q->createIndex(row, ProcessModel::HeadingName, process);
-            emit q->dataChanged(index, index);
+            columns |= COLUMN(ProcessModel::HeadingName);
         }
         if(process->changes & KSysGuard::Process::Command) {
-            QModelIndex index = q->createIndex(row, ProcessModel::HeadingCommand, process);
-            emit q->dataChanged(index, index);
+            columns |= COLUMN(ProcessModel::HeadingCommand);
         }
         if(process->changes & KSysGuard::Process::Login) {
-            QModelIndex index = q->createIndex(row, ProcessModel::HeadingUser, process);
-            emit q->dataChanged(index, index);
+            columns |= COLUMN(ProcessModel::HeadingUser);
         }
         if(process->changes & KSysGuard::Process::IO) {
-            QModelIndex index = q->createIndex(row, ProcessModel::HeadingIoRead, process);
-            emit q->dataChanged(index, index);
-            index = q->createIndex(row, ProcessModel::HeadingIoWrite, process);
-            emit q->dataChanged(index, index);
+            columns |= COLUMN(ProcessModel::HeadingIoRead) | COLUMN(ProcessModel::HeadingIoWrite);
+        }
+    }
+    if(columns)
+        addPendingChanges(process, columns);
+}
+
+void ProcessModelPrivate::addPendingChanges(KSysGuard::Process *process, uint columns)
+{
+    mPendingChanges[process] |= columns;
+    if(!mUpdating && !mPendingChangesQueued) {
+        //The changes did not come from update(), e.g. from a remote host.  Emit them once the event loop is reached.
+        mPendingChangesQueued = true;
+        QMetaObject::invokeMethod(this, "emitPendingChanges", Qt::QueuedConnection);
+    }
+}
+
+namespace {
+    struct ChangedRow {
+        int row;
+        uint columns;
+        KSysGuard::Process *process;
+    };
+    bool changedRowLessThan(const ChangedRow &left, const ChangedRow &right) {
+        return left.row < right.row;
+    }
+}
+
+void ProcessModelPrivate::emitPendingChanges()
+{
+    mPendingChangesQueued = false;
+    if(mPendingChanges.isEmpty())
+        return;
+
+    //Group the changed processes by their parent.  In simple mode there is just one parent
+    QHash<KSysGuard::Process *, QVector<ChangedRow> > changedRows;
+    QHash<KSysGuard::Process *, uint>::const_iterator it;
+    if(mSimple) {
+        QVector<ChangedRow> &rows = changedRows[0];
+        rows.reserve(mPendingChanges.size());
+        for(it = mPendingChanges.constBegin(); it != mPendingChanges.constEnd(); ++it) {
+            ChangedRow changedRow = { it.key()->index, it.value(), it.key() };
+            rows.append(changedRow);
+        }
+        qSort(rows.begin(), rows.end(), changedRowLessThan);
+    } else {
+        QSet<KSysGuard::Process *> parents;
+        for(it = mPendingChanges.constBegin(); it != mPendingChanges.constEnd(); ++it)
+            parents.insert(it.key()->parent);
+        //Walk through the children of each parent once, instead of looking up the row of every process.  This gives sorted rows as well
+        foreach(KSysGuard::Process *parent, parents) {
+            QVector<ChangedRow> &rows = changedRows[parent];
+            const int count = parent->children.count();
+            for(int row = 0; row < count; ++row) {
+                KSysGuard::Process *child = parent->children.at(row);
+                it = mPendingChanges.constFind(child);
+                if(it != mPendingChanges.constEnd()) {
+                    ChangedRow changedRow = { row, it.value(), child };
+                    rows.append(changedRow);
+                }
+            }
+        }
+    }
+    mPendingChanges.clear();
+
+    const int columnCount = mHeadings.count();
+    QHash<KSysGuard::Process *, QVector<ChangedRow> >::const_iterator parentIt;
+    for(parentIt = changedRows.constBegin(); parentIt != changedRows.constEnd(); ++parentIt) {
+        const QVector<ChangedRow> &rows = parentIt.value();
+        for(int column = 0; column < columnCount; ++column) {
+            const uint bit = COLUMN(column);
+            if(mHiddenColumns & bit)
+                continue;
+            const ChangedRow *first = 0;
+            const ChangedRow *last = 0;
+            for(int i = 0; i < rows.count(); ++i) {
+                const ChangedRow &changedRow = rows.at(i);
+                if(!(changedRow.columns & bit))
+                    continue;
+                if(last && changedRow.row == last->row + 1) {
+                    last = &changedRow;
+                    continue;
+                }
+                if(first)
+                    emit q->dataChanged(q->createIndex(first->row, column, first->process), q->createIndex(last->row, column, last->process));
+                first = last = &changedRow;
+            }
+            if(first)
+                emit q->dataChanged(q->createIndex(first->row, column, first->process), q->createIndex(last->row, column, last->process));
         }
     }
 }
 
+void ProcessModelPrivate::emitColumnChanged(KSysGuard::Process *parent, int column)
+{
+    const int count = parent->children.count();
+    if(count == 0)
+        return;
+    emit q->dataChanged(q->createIndex(0, column, parent->children.first()), q->createIndex(count - 1, column, parent->children.last()));
+    foreach(KSysGuard::Process *child, parent->children)
+        emitColumnChanged(child, column);
+}
+
+void ProcessModel::setColumnHidden(int column, bool hidden)
+{
+    if(column < 0 || column >= 32)
+        return;
+    const uint bit = COLUMN(column);
+    if(hidden == bool(d->mHiddenColumns & bit))
+        return;
+    if(hidden) {
+        d->mHiddenColumns |= bit;
+        return;
+    }
+    d->mHiddenColumns &= ~bit;
+    if(column >= columnCount() || !d->mProcesses)
+        return;
+
+    //We have not told anyone about the changes while it was hidden
+    if(d->mSimple) {
+        const int count = d->mProcesses->processCount();
+        if(count > 0)
+            emit dataChanged(index(0, column), index(count - 1, column));
+    } else {
+        d->emitColumnChanged(d->mProcesses->getProcess(-1), column);
+    }
+}
+
+bool ProcessModel::isColumnHidden(int column) const
+{
+    if(column < 0 || column >= 32)
+        return false;
+    return d->mHiddenColumns & COLUMN(column);
+}
+
+void ProcessModel::setHighFrequencySampling(bool enable)
+{
+    if(enable == (d->mSampler != NULL))
+        return;
+    if(!enable) {
+        delete d->mSampler;
+        d->mSampler = NULL;
+        d->mSamplingStatistics.clear();
+        return;
+    }
+    if(!d->mIsLocalhost || !KSysGuard::ProcessSampler::isSupported())
+        return;
+    d->mSampler = new KSysGuard::ProcessSampler;
+    d->mSampler->setWatched(d->mSampledPids);
+    d->mSampler->start();
+}
+
+bool ProcessModel::isHighFrequencySampling() const
+{
+    return d->mSampler != NULL;
+}
+
+void ProcessModel::setSampledProcesses(const QList<long> &pids)
+{
+    d->mSampledPids = pids;
+    if(d->mSampler)
+        d->mSampler->setWatched(pids);
+}
+
+QString ProcessModelPrivate::getSamplingTooltip(long pid, int column) const
+{
+    QHash<long, KSysGuard::ProcessSampler::Statistics>::const_iterator it = mSamplingStatistics.constFind(pid);
+    if(it == mSamplingStatistics.constEnd())
+        return QString();
+    const KSysGuard::ProcessSampler::Statistics &statistics = it.value();
+    QString tooltip = i18np("<br /><br />Sampled once since the last update:", "<br /><br />Sampled %1 times since the last update:", statistics.samples);
+    switch(column) {
+        case ProcessModel::HeadingCPUUsage:
+        case ProcessModel::HeadingCPUTime: {
+            int divideby = (mNormalizeCPUUsage?mNumProcessorCores:1);
+            tooltip += ki18n("<br />CPU usage: %1% median, %2% 90th percentile, %3% 99th percentile, %4% peak<br />"
+                        "Waiting for a CPU: %5% median, %6% peak")
+                        .subs(statistics.cpuUsage.median / divideby, 0, 'f', 1)
+                        .subs(statistics.cpuUsage.p90 / divideby, 0, 'f', 1)
+                        .subs(statistics.cpuUsage.p99 / divideby, 0, 'f', 1)
+                        .subs(statistics.cpuUsage.maximum / divideby, 0, 'f', 1)
+                        .subs(statistics.cpuWait.median / divideby, 0, 'f', 1)
+                        .subs(statistics.cpuWait.maximum / divideby, 0, 'f', 1)
+                        .toString();
+            break;
+        }
+        case ProcessModel::HeadingMemory:
+            tooltip += i18n("<br />RSS memory usage: %1 median, %2 peak",
+                        KGlobal::locale()->formatByteSize(statistics.rss.median * 1024),
+                        KGlobal::locale()->formatByteSize(statistics.rss.maximum * 1024));
+            break;
+        case ProcessModel::HeadingIoRead:
+        case ProcessModel::HeadingIoWrite:
+            tooltip += i18n("<br />Actual bytes read: %1/s median, %2/s 90th percentile, %3/s peak<br />"
+                        "Actual bytes written: %4/s median, %5/s 90th percentile, %6/s peak",
+                        KGlobal::locale()->formatByteSize(statistics.readRate.median),
+                        KGlobal::locale()->formatByteSize(statistics.readRate.p90),
+                        KGlobal::locale()->formatByteSize(statistics.readRate.maximum),
+                        KGlobal::locale()->formatByteSize(statistics.writeRate.median),
+                        KGlobal::locale()->formatByteSize(statistics.writeRate.p90),
+                        KGlobal::locale()->formatByteSize(statistics.writeRate.maximum));
+            break;
+        default:
+            return QString();
+    }
+    return tooltip;
+}
+
 void ProcessModelPrivate::beginInsertRow( KSysGuard::Process *process)
 {
     Q_ASSERT(process);
@@ -816,6 +1009,7 @@ void ProcessModelPrivate::beginRemoveRow( KSysGuard::Process *process )
     Q_ASSERT(!mInsertingRow);
     Q_ASSERT(!mMovingRow);
     mRemovingRow = true;
+    mPendingChanges.remove(process);
 
     if(mSimple) {
         return q->beginRemoveRows(QModelIndex(), process->index, process->index);
@@ -1465,6 +1659,7 @@ QVariant ProcessModel::data(const QModelIndex &index, int role) const
                         .toString();
             if(process->niceLevel != 0)
                 tooltip += i18n("<br />Nice level: %1 (%2)", process->niceLevel, process->niceLevelAsString() );
+            tooltip += d->getSamplingTooltip(process->pid, index.column());
 
             if(!tracer.isEmpty())
                 return QString(tooltip + "<br />" + tracer);
@@ -1486,6 +1681,7 @@ QVariant ProcessModel::data(const QModelIndex &index, int role) const
                 tooltip += i18n("RSS Memory usage: %1 out of %2  (%3 %)", KGlobal::locale()->formatByteSize(process->vmRSS * 1024), KGlobal::locale()->formatByteSize(d->mMemTotal*1024), process->vmRSS*100/d->mMemTotal);
             else
                 tooltip += i18n("RSS Memory usage: %1", KGlobal::locale()->formatByteSize(process->vmRSS * 1024));
+            tooltip += d->getSamplingTooltip(process->pid, index.column());
             return tooltip;
         }
         case HeadingSharedMemory: {
@@ -1519,6 +1715,7 @@ QVariant ProcessModel::data(const QModelIndex &index, int role) const
                 .subs(KGlobal::locale()->formatByteSize(process->ioCharactersActuallyWritten))
                 .subs(QString::number(process->ioCharactersActuallyWrittenRate/1024))
                 .toString();
+            tooltip += d->getSamplingTooltip(process->pid, index.column());
             return tooltip;
         }
         case HeadingXTitle: {
@@ -2057,19 +2254,12 @@ void ProcessModelPrivate::timerEvent( QTimerEvent * event )
         const long pid = it.next();
         KSysGuard::Process *process = mProcesses->getProcess(pid);
         if (process && process->timeKillWasSent.isValid() && process->timeKillWasSent.elapsed() < MILLISECONDS_TO_SHOW_RED_FOR_KILLED_PROCESS) {
-            int row;
-            if(mSimple)
-                row = process->index;
-            else
-                row = process->parent->children.indexOf(process);
-
-            QModelIndex index1 = q->createIndex(row, 0, process);
-            QModelIndex index2 = q->createIndex(row, mHeadings.count()-1, process);
-            emit q->dataChanged(index1, index2);
+            mPendingChanges[process] |= ~0u;
         } else {
             it.remove();
         }
     }
+    emitPendingChanges();
 
     if (mPidsToUpdate.isEmpty()) {
         mHaveTimer = false;
@@ -170,6 +170,23 @@ class KSYSGUARD_EXPORT ProcessModel : public QAbstractItemModel
         /** Retranslate the GUI, for when the system language changes */
         void retranslateUi();
 
+        /** Set whether a column is hidden in the views of this model.  Changes to hidden columns
+         *  are not announced with dataChanged(), which saves work for the views and proxy models
+         *  on every update.  When the column is shown again, dataChanged() is emitted for all of it.
+         */
+        void setColumnHidden(int column, bool hidden);
+        /** Whether a column is hidden.  @see setColumnHidden */
+        bool isColumnHidden(int column) const;
+
+        /** Sample the processes given with setSampledProcesses() many times per second in a separate thread.
+         *  The tooltips then also show the distribution of the samples taken since the previous update, so that
+         *  short spikes are not missed.  This is only possible for the local machine, on Linux.
+         */
+        void setHighFrequencySampling(bool enable);
+        bool isHighFrequencySampling() const;
+        /** The processes to sample when high frequency sampling is enabled.  @see setHighFrequencySampling */
+        void setSampledProcesses(const QList<long> &pids);
+
     public Q_SLOTS:
         /** Whether to show the total cpu for the process plus all of its children */
         void setShowTotals(bool showTotals);
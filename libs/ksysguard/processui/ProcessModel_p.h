@@ -23,6 +23,7 @@
 #define PROCESSMODEL_P_H_
 
 #include "processcore/process.h"
+#include "processcore/processsampler.h"
 #include "ProcessModel.h"
 
 #include <kapplication.h>
@@ -109,6 +110,11 @@ class ProcessModelPrivate : public QObject
          */
         void endMoveRow();
 
+        /** Emit dataChanged() for the cells collected in mPendingChanges.  Neighbouring rows
+         *  of a column are coalesced into a single range, and hidden columns are skipped.
+         */
+        void emitPendingChanges();
+
     public:
         /** Connects to the host */
         void setupProcesses();
@@ -147,6 +153,11 @@ class ProcessModelPrivate : public QObject
 #endif
 #endif
         virtual void timerEvent ( QTimerEvent * event ); ///< Call dataChanged() for all the processes in mPidsToUpdate
+        /** Remember that the given columns of a process have changed.  @p columns is a bitmask with one bit per heading.
+         *  If this is not called from ProcessModel::update(), the changes are emitted from the event loop. */
+        void addPendingChanges(KSysGuard::Process *process, uint columns);
+        /** Emit dataChanged() for a column of all the children of @p parent, recursively in tree mode */
+        void emitColumnChanged(KSysGuard::Process *parent, int column);
         /** @see setIsLocalhost */
         bool mIsLocalhost;
 
@@ -203,6 +214,17 @@ class ProcessModelPrivate : public QObject
         int mTimerId;
         QList<long> mPidsToUpdate;  ///< A list of pids that we need to emit dataChanged() for regularly
 
+        QHash<KSysGuard::Process *, uint> mPendingChanges; ///< The changed columns of processes, which dataChanged() has not been emitted for yet
+        bool mPendingChangesQueued; ///< True if emitPendingChanges() will be called from the event loop
+        bool mUpdating; ///< True while ProcessModel::update() runs, which emits the pending changes itself
+        uint mHiddenColumns; ///< Columns which are not shown, one bit per heading.  @see ProcessModel::setColumnHidden
+
+        /** Returns the lines to add to the tooltip of the column for the high frequency samples of the process */
+        QString getSamplingTooltip(long pid, int column) const;
+        KSysGuard::ProcessSampler *mSampler; ///< NULL unless high frequency sampling is enabled
+        QList<long> mSampledPids;
+        QHash<long, KSysGuard::ProcessSampler::Statistics> mSamplingStatistics; ///< The statistics of the samples taken during the last update
+
 #ifdef HAVE_XRES
         bool mHaveXRes; ///< True if the XRes extension is available at run time
         QMap<qlonglong, XID> mXResClientResources;
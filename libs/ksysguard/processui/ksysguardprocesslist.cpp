@@ -56,6 +56,7 @@
 #include <KWindowSystem>
 
 #include "ReniceDlg.h"
+#include "processcore/processsampler.h"
 #include "ui_ProcessWidgetUI.h"
 
 #include <sys/types.h>
@@ -386,6 +387,12 @@ int KSysGuardProcessListPrivate::totalRowCount(const QModelIndex &parent ) const
 
 void KSysGuardProcessList::selectionChanged()
 {
+    //Sample the selected processes when high frequency sampling is enabled
+    QList<long> pids;
+    foreach(KSysGuard::Process *process, selectedProcesses())
+        pids << process->pid;
+    d->mModel.setSampledProcesses(pids);
+
     int numSelected =  d->mUi->treeView->selectionModel()->selectedRows().size();
     if(numSelected == d->mNumItemsSelected)
         return;
@@ -613,6 +620,7 @@ void KSysGuardProcessList::showColumnContextMenu(const QPoint &point){
     QAction *actionShowCmdlineOptions = NULL;
     QAction *actionShowTooltips = NULL;
     QAction *actionNormalizeCPUUsage = NULL;
+    QAction *actionHighFrequencySampling = NULL;
 
     QAction *actionIoCharacters = NULL;
     QAction *actionIoSyscalls = NULL;
@@ -698,6 +706,13 @@ void KSysGuardProcessList::showColumnContextMenu(const QPoint &point){
         actionNormalizeCPUUsage->setCheckable(true);
         actionNormalizeCPUUsage->setChecked(d->mModel.isNormalizedCPUUsage());
         menu.addAction(actionNormalizeCPUUsage);
+        if(d->mModel.isLocalhost() && KSysGuard::ProcessSampler::isSupported()) {
+            actionHighFrequencySampling = new QAction(&menu);
+            actionHighFrequencySampling->setText(i18n("Sample selected processes at high frequency"));
+            actionHighFrequencySampling->setCheckable(true);
+            actionHighFrequencySampling->setChecked(d->mModel.isHighFrequencySampling());
+            menu.addAction(actionHighFrequencySampling);
+        }
     }
 
     if(index == ProcessModel::HeadingIoRead || index == ProcessModel::HeadingIoWrite) {
@@ -786,6 +801,9 @@ void KSysGuardProcessList::showColumnContextMenu(const QPoint &point){
     } else if(result == actionNormalizeCPUUsage) {
         d->mModel.setNormalizedCPUUsage(actionNormalizeCPUUsage->isChecked());
         return;
+    } else if(result == actionHighFrequencySampling) {
+        d->mModel.setHighFrequencySampling(actionHighFrequencySampling->isChecked());
+        return;
     } else if(result == actionShowTooltips) {
         d->mModel.setShowingTooltips(actionShowTooltips->isChecked());
         return;
@@ -931,6 +949,13 @@ void KSysGuardProcessList::updateList()
             updateFlags |= KSysGuard::Processes::IOStatistics;
         if(!d->mUi->treeView->isColumnHidden(ProcessModel::HeadingXMemory))
             updateFlags |= KSysGuard::Processes::XMemory;
+        //There is no need to tell the view about changes in the columns it does not show.  The proxy still
+        //has to hear about the column it sorts by, and about all of them while filtering as the filter text
+        //is matched against every column
+        const int sortColumn = d->mUi->treeView->header()->sortIndicatorSection();
+        const bool filtering = !d->mFilterModel.filterRegExp().isEmpty();
+        for(int i = 0; i < d->mModel.columnCount(); ++i)
+            d->mModel.setColumnHidden(i, !filtering && i != sortColumn && d->mUi->treeView->isColumnHidden(i));
         d->mModel.update(d->mUpdateIntervalMSecs, updateFlags);
         if(d->mUpdateTimer)
             d->mUpdateTimer->start(d->mUpdateIntervalMSecs);
@@ -1266,6 +1291,7 @@ void KSysGuardProcessList::saveSettings(KConfigGroup &cg) {
     cg.writeEntry("ioInformation", (int)(d->mModel.ioInformation()));
     cg.writeEntry("showCommandLineOptions", d->mModel.isShowCommandLineOptions());
     cg.writeEntry("normalizeCPUUsage", d->mModel.isNormalizedCPUUsage());
+    cg.writeEntry("highFrequencySampling", d->mModel.isHighFrequencySampling());
     cg.writeEntry("showTooltips", d->mModel.isShowingTooltips());
     cg.writeEntry("showTotals", showTotals());
     cg.writeEntry("filterState", (int)(state()));
@@ -1283,6 +1309,7 @@ void KSysGuardProcessList::loadSettings(const KConfigGroup &cg) {
     d->mModel.setIoInformation((ProcessModel::IoInformation) cg.readEntry("ioInformation", (int)ProcessModel::ActualBytesRate));
     d->mModel.setShowCommandLineOptions(cg.readEntry("showCommandLineOptions", false));
     d->mModel.setNormalizedCPUUsage(cg.readEntry("normalizeCPUUsage", true));
+    d->mModel.setHighFrequencySampling(cg.readEntry("highFrequencySampling", false));
     d->mModel.setShowingTooltips(cg.readEntry("showTooltips", true));
     setShowTotals(cg.readEntry("showTotals", true));
     setStateInt(cg.readEntry("filterState", (int)ProcessFilter::AllProcesses));
@@ -66,12 +66,9 @@ void KSignalPlotter::setUnit(const KLocalizedString &unit) {
 
 void KSignalPlotter::addBeam( const QColor &color )
 {
-    QList< QList<qreal> >::Iterator it;
     //When we add a new beam, go back and set the data for this beam to NaN for all the other times, to pad it out.
     //This is because it makes it easier for moveSensors
-    for(it = d->mBeamData.begin(); it != d->mBeamData.end(); ++it) {
-        (*it).append( std::numeric_limits<qreal>::quiet_NaN() );
-    }
+    d->mSamples.insert(d->mSamples.size(), d->mSampleCapacity, std::numeric_limits<qreal>::quiet_NaN());
     d->mBeamColors.append(color);
     d->mBeamColorsLight.append(color.lighter());
 }
@@ -124,15 +121,27 @@ void KSignalPlotter::removeBeam( int index )
     d->mBeamColors.removeAt( index );
     d->mBeamColorsLight.removeAt(index);
 
-    QList< QList<qreal> >::Iterator i;
-    for(i = d->mBeamData.begin(); i != d->mBeamData.end(); ++i) {
-        if( (*i).size() >= index)
-            (*i).removeAt(index);
-    }
+    d->mSamples.remove(index * d->mSampleCapacity, d->mSampleCapacity);
+    if(d->mSamples.isEmpty())
+        d->mSampleCount = 0;
     if(d->mUseAutoRange)
         d->rescale();
 }
 
+void KSignalPlotter::clearSamples()
+{
+    d->mSampleCount = 0;
+    d->mNewestIndex = 0;
+    d->mMinValue = d->mMaxValue = std::numeric_limits<qreal>::quiet_NaN();
+    d->rescale();
+#ifdef USE_QIMAGE
+    d->mScrollableImage = QImage();
+#else
+    d->mScrollableImage = QPixmap();
+#endif
+    update();
+}
+
 void KSignalPlotter::setScaleDownBy( qreal value )
 {
     if(d->mScaleDownBy == value) return;
@@ -382,10 +391,15 @@ void KSignalPlotter::resizeEvent( QResizeEvent* event )
     d->updateDataBuffers();
 }
 
-KSignalPlotterPrivate::KSignalPlotterPrivate(KSignalPlotter *q_ptr_) : q(q_ptr_)
+KSignalPlotterPrivate::KSignalPlotterPrivate(KSignalPlotter *q_ptr_) : mMinQueue(false), mMaxQueue(true), q(q_ptr_)
 {
     mPrecision = 0;
     mMaxSamples = NUM_SAMPLES_WHEN_INVISIBLE;
+    mSampleCapacity = 0;
+    mSampleCount = 0;
+    mNewestIndex = 0;
+    mSampleTime = 0;
+    setSampleCapacity(NUM_SAMPLES_WHEN_INVISIBLE);
     mMinValue = mMaxValue = std::numeric_limits<qreal>::quiet_NaN();
     mUserMinValue = mUserMaxValue = 0.0;
     mNiceMinValue = mNiceMaxValue = 0.0;
@@ -406,7 +420,6 @@ KSignalPlotterPrivate::KSignalPlotterPrivate(KSignalPlotter *q_ptr_) : q(q_ptr_)
     mScrollOffset = 0;
     mStackBeams = false;
     mFillOpacity = 20;
-    mRescaleTime = 0;
     mUnit = ki18n("%1");
     mAxisTextOverlapsPlotter = false;
     mActualAxisTextWidth = 0;
@@ -415,59 +428,103 @@ KSignalPlotterPrivate::KSignalPlotterPrivate(KSignalPlotter *q_ptr_) : q(q_ptr_)
     mGraphWidget->setVisible(false);
 }
 
-void KSignalPlotterPrivate::recalculateMaxMinValueForSample(const QList<qreal>&sampleBuf, int time )
+void KSignalPlotterPrivate::pushMaxMinValueForSample( int age )
 {
+    const int beams = mBeamColors.count();
+    qreal minValue = std::numeric_limits<qreal>::quiet_NaN();
+    qreal maxValue = minValue;
     if(mStackBeams) {
         qreal value=0;
-        for(int i = sampleBuf.count()-1; i>= 0; i--) {
-            qreal newValue = sampleBuf[i];
+        for(int i = beams-1; i>= 0; i--) {
+            qreal newValue = sample(age, i);
             if( !std::isinf(newValue) && !std::isnan(newValue) )
                 value += newValue;
         }
-        if(std::isnan(mMinValue) || mMinValue > value) mMinValue = value;
-        if(std::isnan(mMaxValue) || mMaxValue < value) mMaxValue = value;
-        if(value > 0.7*mMaxValue)
-            mRescaleTime = time;
+        minValue = maxValue = value;
     } else {
         qreal value;
-        for(int i = sampleBuf.count()-1; i>= 0; i--) {
-            value = sampleBuf[i];
+        for(int i = beams-1; i>= 0; i--) {
+            value = sample(age, i);
             if( !std::isinf(value) && !std::isnan(value) ) {
-                if(std::isnan(mMinValue) || mMinValue > value) mMinValue = value;
-                if(std::isnan(mMaxValue) || mMaxValue < value) mMaxValue = value;
-                if(value > 0.7*mMaxValue)
-                    mRescaleTime = time;
+                if(std::isnan(minValue) || minValue > value) minValue = value;
+                if(std::isnan(maxValue) || maxValue < value) maxValue = value;
             }
         }
+        if(std::isnan(minValue))
+            return;
     }
+    const quint64 time = mSampleTime - age;
+    mMinQueue.push(time, minValue);
+    mMaxQueue.push(time, maxValue);
 }
 
 void KSignalPlotterPrivate::rescale() {
-    mMaxValue = mMinValue = std::numeric_limits<qreal>::quiet_NaN();
-    for(int i = mBeamData.count()-1; i >= 0; i--) {
-        recalculateMaxMinValueForSample(mBeamData[i], i);
+    mMinQueue.reset(mSampleCapacity + 1);
+    mMaxQueue.reset(mSampleCapacity + 1);
+    if(!mBeamColors.isEmpty()) {
+        for(int i = mSampleCount-1; i >= 0; i--)
+            pushMaxMinValueForSample(i);
     }
+    mMinValue = mMinQueue.value();
+    mMaxValue = mMaxQueue.value();
     calculateNiceRange();
 }
 
+void KSignalPlotterPrivate::setSampleCapacity( int capacity )
+{
+    if(capacity == mSampleCapacity)
+        return;
+
+    //Keep the newest samples of each beam, and move them to the start of their new block
+    const int beams = mBeamColors.count();
+    const int count = qMin(mSampleCount, capacity);
+    QVector<qreal> samples(beams * capacity, std::numeric_limits<qreal>::quiet_NaN());
+    for(int beam = 0; beam < beams; beam++) {
+        for(int age = 0; age < count; age++)
+            samples[beam * capacity + count - 1 - age] = sample(age, beam);
+    }
+    mSamples = samples;
+    mSampleCapacity = capacity;
+    mSampleCount = count;
+    mNewestIndex = qMax(count - 1, 0);
+
+    //The queues may hold a value for every sample, plus the one being expired
+    mMinQueue.reset(capacity + 1);
+    mMaxQueue.reset(capacity + 1);
+    if(beams != 0) {
+        for(int i = count-1; i >= 0; i--)
+            pushMaxMinValueForSample(i);
+    }
+}
+
 void KSignalPlotterPrivate::addSample( const QList<qreal>& sampleBuf )
 {
     if(sampleBuf.count() != mBeamColors.count()) {
         kDebug(1215) << "Sample data discarded - contains wrong number of beams";
         return;
     }
-    mBeamData.prepend(sampleBuf);
-    if((unsigned int)mBeamData.size() > mMaxSamples) {
-        mBeamData.removeLast(); // we have too many.  Remove the last item
-        if((unsigned int)mBeamData.size() > mMaxSamples)
-            mBeamData.removeLast(); // If we still have too many, then we have resized the widget.  Remove one more.  That way we will slowly resize to the new size
-    }
+    if(mSampleCapacity == 0)
+        return;
 
-    if(mUseAutoRange) {
-        recalculateMaxMinValueForSample(sampleBuf, 0);
+    mNewestIndex = (mNewestIndex + 1) % mSampleCapacity;
+    if(mSampleCount < mSampleCapacity)
+        mSampleCount++;
+    mSampleTime++;
+    qreal *data = mSamples.data() + mNewestIndex;
+    for(int i = 0; i < sampleBuf.count(); i++)
+        data[i * mSampleCapacity] = sampleBuf.at(i);
 
-        if(mRescaleTime++ > mMaxSamples)
-            rescale();
+    //Update the running minimum and maximum.  The oldest sample has just been overwritten
+    pushMaxMinValueForSample(0);
+    bool expired = mMinQueue.expire(mSampleTime - mSampleCount + 1);
+    expired = mMaxQueue.expire(mSampleTime - mSampleCount + 1) || expired;
+
+    if(mUseAutoRange) {
+        mMinValue = mMinQueue.value();
+        mMaxValue = mMaxQueue.value();
+        //The extremum has scrolled out of the window, so shrink the range to what is left
+        if(expired)
+            calculateNiceRange();
         else if(mMinValue < mNiceMinValue || mMaxValue > mNiceMaxValue || (mMaxValue > mUserMaxValue && mNiceRange != 1 && mMaxValue < (mNiceRange*0.75 + mNiceMinValue)) || mNiceRange == 0)
             calculateNiceRange();
     } else {
@@ -486,19 +543,14 @@ void KSignalPlotterPrivate::reorderBeams( const QList<int>& newOrder )
     if(newOrder.count() != mBeamColors.count()) {
         return;
     }
-    QList< QList<qreal> >::Iterator it;
-    for(it = mBeamData.begin(); it != mBeamData.end(); ++it) {
-        if(newOrder.count() != (*it).count()) {
-            kWarning(1215) << "Serious problem in move sample.  beamdata[i] has " << (*it).count() << " and neworder has " << newOrder.count();
-        } else {
-            QList<qreal> newBeam;
-            for(int i = 0; i < newOrder.count(); i++) {
-                int newIndex = newOrder[i];
-                newBeam.append((*it).at(newIndex));
-            }
-            (*it) = newBeam;
-        }
+    //Every beam has its own block of samples, so just move the blocks around
+    QVector<qreal> newSamples(mSamples.size());
+    for(int i = 0; i < newOrder.count(); i++) {
+        int newIndex = newOrder[i];
+        qCopy(mSamples.constBegin() + newIndex * mSampleCapacity, mSamples.constBegin() + (newIndex + 1) * mSampleCapacity,
+              newSamples.begin() + i * mSampleCapacity);
     }
+    mSamples = newSamples;
     QList< QColor > newBeamColors;
     QList< QColor > newBeamColorsDark;
     for(int i = 0; i < newOrder.count(); i++) {
@@ -525,6 +577,7 @@ void KSignalPlotterPrivate::updateDataBuffers()
         mMaxSamples = uint(q->size().width() / mHorizontalScale + 4);
     else //If it's not visible, we can't rely on sensible values for width.  Store some minimum number of data points
         mMaxSamples = qMin((uint)(q->size().width() / mHorizontalScale + 4), NUM_SAMPLES_WHEN_INVISIBLE);
+    setSampleCapacity(mMaxSamples);
 }
 
 void KSignalPlotter::paintEvent( QPaintEvent* event)
@@ -646,18 +699,18 @@ void KSignalPlotterPrivate::redrawScrollableImage()
 
     mScrollOffset = 0;
     mVerticalLinesOffset = mVerticalLinesDistance - mHorizontalScale+1; // mVerticalLinesDistance - alignedWidth % mVerticalLinesDistance;
+    //Only the columns which fit into the image are drawn, older ones would be overwritten straight away
+    int columns = qMin(mSampleCount-1, alignedWidth / (int)mHorizontalScale - 1);
     //We need to draw the background for areas without a beam
-    int withoutBeamWidth = qMax(mBeamData.size()-1, 0) * mHorizontalScale;
+    int withoutBeamWidth = qMax(columns, 0) * mHorizontalScale;
     QPainter pCache(&mScrollableImage);
     if(withoutBeamWidth < mScrollableImage.width())
         drawBackground(&pCache, QRect(withoutBeamWidth, 0, alignedWidth - withoutBeamWidth, mScrollableImage.height()));
 
     /* Draw scope-like grid vertical lines */
     mVerticalLinesOffset = 0;
-    if(mBeamData.size() > 2) {
-        for(int i = mBeamData.size()-2; i >= 0; i--)
-            drawBeamToScrollableImage(&pCache, i);
-    }
+    for(int i = columns-1; i >= 0; i--)
+        drawBeamToScrollableImage(&pCache, i);
 }
 
 void KSignalPlotterPrivate::drawThinFrame(QPainter *p, const QRect &boundingBox)
@@ -780,13 +833,11 @@ void KSignalPlotterPrivate::drawBeam(QPainter *p, const QRect &boundingBox, int
     pen.setCapStyle(Qt::FlatCap);
 
     qreal scaleFac = (boundingBox.height()-2) / mNiceRange;
-    if(mBeamData.size() - 1 <= index )
+    if(mSampleCount - 1 <= index )
         return;  // Something went wrong?
 
-    const QList<qreal> &datapoints = mBeamData[index];
-    const QList<qreal> &prev_datapoints = mBeamData[index+1];
-    bool hasPrevPrevDatapoints = (index +2 < mBeamData.size()); //used for bezier curve gradient calculation
-    const QList<qreal> &prev_prev_datapoints = hasPrevPrevDatapoints?mBeamData[index+2]:prev_datapoints;
+    bool hasPrevPrevDatapoints = (index +2 < mSampleCount); //used for bezier curve gradient calculation
+    const int prevPrevIndex = hasPrevPrevDatapoints?index+2:index+1;
 
     qreal x0 = boundingBox.right();
     qreal x1 = qMax(boundingBox.right() - horizontalScale, 0);
@@ -795,7 +846,7 @@ void KSignalPlotterPrivate::drawBeam(QPainter *p, const QRect &boundingBox, int
     if( mNiceMinValue < 0)
        xaxis = qMax(qreal(xaxis + mNiceMinValue*scaleFac), qreal(boundingBox.top()));
 
-    const int count = qMin(datapoints.size(), mBeamColors.size());
+    const int count = mBeamColors.size();
     QVector<QPainterPath> paths(count);
     QPointF previous_c0;
     QPointF previous_c1;
@@ -806,12 +857,12 @@ void KSignalPlotterPrivate::drawBeam(QPainter *p, const QRect &boundingBox, int
     qreal previous_point2 = 0;
     bool firstLine = true;
     for (int j = 0; j < count; ++j) {
-        qreal point0 = datapoints[j];
+        qreal point0 = sample(index, j);
         if( std::isnan(point0) )
             continue; //Just do not draw points with nans. skip them
 
-        qreal point1 = prev_datapoints[j];
-        qreal point2 = prev_prev_datapoints[j];
+        qreal point1 = sample(index+1, j);
+        qreal point2 = sample(prevPrevIndex, j);
 
         if(std::isnan(point1))
             point1 = point0;
@@ -928,13 +979,14 @@ int KSignalPlotter::currentAxisPrecision() const
 
 qreal KSignalPlotter::lastValue( int i) const
 {
-    if(d->mBeamData.isEmpty() || d->mBeamData.first().size() <= i) return std::numeric_limits<qreal>::quiet_NaN();
-    return d->mBeamData.first().at(i);
+    if(d->mSampleCount == 0 || i < 0 || d->mBeamColors.size() <= i) return std::numeric_limits<qreal>::quiet_NaN();
+    return d->sample(0, i);
 }
 QString KSignalPlotter::lastValueAsString( int i, int precision) const
 {
-    if(d->mBeamData.isEmpty() || d->mBeamData.first().size() <= i || std::isnan(d->mBeamData.first().at(i))) return QString();
-    return valueAsString(d->mBeamData.first().at(i), precision); //retrieve the newest value for this beam
+    qreal value = lastValue(i);
+    if(std::isnan(value)) return QString();
+    return valueAsString(value, precision); //retrieve the newest value for this beam
 }
 QString KSignalPlotter::valueAsString( qreal value, int precision) const
 {
@@ -987,6 +1039,7 @@ bool KSignalPlotter::stackGraph() const
 void KSignalPlotter::setStackGraph(bool stack)
 {
     d->mStackBeams = stack;
+    d->rescale(); //The range is calculated from the sum of the beams when stacking
 #ifdef USE_QIMAGE
     d->mScrollableImage = QImage();
 #else
@@ -1015,6 +1068,52 @@ QSize KSignalPlotter::sizeHint() const
     return QSize(200,200); //Just a random size which would usually look okay
 }
 
+KSignalPlotterExtremum::KSignalPlotterExtremum( bool maximum ) : mMaximum(maximum), mHead(0), mCount(0)
+{
+}
+
+void KSignalPlotterExtremum::reset( int capacity )
+{
+    mTimes.resize(capacity);
+    mValues.resize(capacity);
+    mHead = 0;
+    mCount = 0;
+}
+
+void KSignalPlotterExtremum::push( quint64 time, qreal value )
+{
+    const int capacity = mTimes.size();
+    while(mCount > 0) {
+        const qreal back = mValues.at((mHead + mCount - 1) % capacity);
+        if(mMaximum ? back > value : back < value)
+            break;
+        mCount--;
+    }
+    Q_ASSERT(mCount < capacity);
+    const int index = (mHead + mCount) % capacity;
+    mTimes[index] = time;
+    mValues[index] = value;
+    mCount++;
+}
+
+bool KSignalPlotterExtremum::expire( quint64 oldestTime )
+{
+    bool expired = false;
+    while(mCount > 0 && mTimes.at(mHead) < oldestTime) {
+        mHead = (mHead + 1) % mTimes.size();
+        mCount--;
+        expired = true;
+    }
+    return expired;
+}
+
+qreal KSignalPlotterExtremum::value() const
+{
+    if(mCount == 0)
+        return std::numeric_limits<qreal>::quiet_NaN();
+    return mValues.at(mHead);
+}
+
 GraphWidget::GraphWidget(QWidget *parent) : QWidget(parent)
 {
     setAttribute(Qt::WA_NoSystemBackground);
@@ -151,6 +151,14 @@ class KDE_EXPORT KSignalPlotter : public QWidget
      */
     void removeBeam( int index );
 
+    /** \brief Removes all the samples, keeping the beams.
+     *
+     * This can be used to replace the displayed data, for example with
+     * samples that have been recorded earlier, by adding them again with
+     * addSample().
+     */
+    void clearSamples();
+
     /** \brief Get the color of the beam at the specified index.
      *
      * For example:
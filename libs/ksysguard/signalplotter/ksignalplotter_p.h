@@ -25,11 +25,35 @@
 //#define USE_QIMAGE
 
 #include <QWidget>
+#include <QVector>
 #include <QtGui/qevent.h>
 
 class GraphWidget;
 class KSignalPlotter;
 
+/* Running minimum or maximum of the samples in the ring buffer.  This is a
+ * monotonic queue: a new value drops all the values at the back that it
+ * dominates, so the front always holds the extremum of the window and every
+ * sample is pushed and popped at most once. */
+class KSignalPlotterExtremum {
+public:
+    explicit KSignalPlotterExtremum( bool maximum );
+
+    void reset( int capacity );
+    void push( quint64 time, qreal value );
+    /** Drop the values of samples older than @p oldestTime.  Returns true if the extremum changed */
+    bool expire( quint64 oldestTime );
+    /** The extremum of the window, NaN if it is empty */
+    qreal value() const;
+
+private:
+    bool mMaximum;
+    QVector<quint64> mTimes;
+    QVector<qreal> mValues;
+    int mHead;
+    int mCount;
+};
+
 class KSignalPlotterPrivate {
 public:
     KSignalPlotterPrivate( KSignalPlotter * q_ptr );
@@ -46,9 +70,18 @@ public:
     void redrawScrollableImage();
     void reorderBeams( const QList<int>& newOrder );
 
-    void recalculateMaxMinValueForSample(const QList<qreal>&sampleBuf, int time );
+    void pushMaxMinValueForSample( int age );
     void rescale();
     void updateDataBuffers();
+    void setSampleCapacity( int capacity );
+
+    /** Return the value of @p beam in the sample added @p age samples ago */
+    inline qreal sample( int age, int beam ) const {
+        int index = mNewestIndex - age;
+        if(index < 0)
+            index += mSampleCapacity;
+        return mSamples.at(beam * mSampleCapacity + index);
+    }
     void setupStyle();
 
     /** Return the given value as a string, with the given precision */
@@ -67,7 +100,8 @@ public:
 
     qreal mUserMinValue;		///The minimum value (unscaled) set by changeRange().  This is the _maximum_ value that the range will start from.
     qreal mUserMaxValue;		///The maximum value (unscaled) set by changeRange().  This is the _minimum_ value that the range will reach to.
-    unsigned int mRescaleTime;		///The number of data points passed since a value that is within 70% of the current maximum was found.  This is for scaling the graph
+    KSignalPlotterExtremum mMinQueue;	///The minimum of the stored samples, mMinValue follows it when using the auto range
+    KSignalPlotterExtremum mMaxQueue;	///The maximum of the stored samples, mMaxValue follows it when using the auto range
 
     qreal mNiceMinValue;	///The minimum value rounded down to a 'nice' value
     qreal mNiceMaxValue;	///The maximum value rounded up to a 'nice' value.  The idea is to round the value, say, 93 to 100.
@@ -94,12 +128,15 @@ public:
 
     bool mShowAxis;
 
-    QList < QList<qreal> > mBeamData; // Every item in the linked list contains a set of data points to plot.  The first item is the newest
-    QList< QColor> mBeamColors;  //These colors match up against the QList<qreal>  in mBeamData
-    QList< QColor> mBeamColorsLight;  //These colors match up against the QList<qreal> in mBeamData, and are lighter than mBeamColors.  Done for gradient effects
+    QVector<qreal> mSamples; // Ring buffer of the data points to plot.  Every beam has a contiguous block of mSampleCapacity values, use sample() to read them
+    int mSampleCapacity; // The number of samples stored per beam when full.  This follows mMaxSamples
+    int mSampleCount; // The number of samples stored per beam
+    int mNewestIndex; // The index inside a block of the newest sample added.  newestIndex-1 is the second newest, and so on, wrapping around
+    quint64 mSampleTime; // The number of samples added so far.  Used to expire values from mMinQueue and mMaxQueue
+    QList< QColor> mBeamColors;  //These colors match up against the blocks in mSamples
+    QList< QColor> mBeamColorsLight;  //These colors match up against the blocks in mSamples, and are lighter than mBeamColors.  Done for gradient effects
 
-    unsigned int mMaxSamples; //This is what mBeamData.size() should equal when full.  When we start off and have no data then mSamples will be higher.  If we resize the widget so it's smaller, then for a short while this will be smaller
-    int mNewestIndex; //The index to the newest item added.  newestIndex+1   is the second newest, and so on
+    unsigned int mMaxSamples; //The number of samples needed to fill the width of the widget
 
     KLocalizedString mUnit;
 
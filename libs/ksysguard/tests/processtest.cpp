@@ -21,6 +21,7 @@
 #include <QtTest>
 #include <QtCore>
 #include <QTreeView>
+#include <QLineEdit>
 
 #include <klocale.h>
 #include <qtest_kde.h>
@@ -29,11 +30,17 @@
 #include "processcore/processes.h"
 #include "processcore/process.h"
 #include "processcore/processes_base_p.h"
+#include "processcore/processsampler.h"
 
 #include "processui/ksysguardprocesslist.h"
+#include "processui/ProcessModel.h"
 
 #include "processtest.h"
 
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+
 void testProcess::testProcesses() {
     KSysGuard::Processes *processController = new KSysGuard::Processes();
     processController->updateAllProcesses();
@@ -130,6 +137,79 @@ void testProcess::testTimeToUpdateAllProcesses() {
     delete processController;
 }
 
+void testProcess::testTimeToUpdateAllProcessesIO() {
+    KSysGuard::Processes *processController = new KSysGuard::Processes();
+    QBENCHMARK {
+        processController->updateAllProcesses(0, KSysGuard::Processes::IOStatistics);
+    }
+    delete processController;
+}
+
+void testProcess::testTimeToUpdateManyProcesses_data() {
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("500 processes") << 500;
+    //More than ParallelScanThreshold, so /proc is read by several threads
+    QTest::newRow("1500 processes") << 1500;
+}
+
+namespace {
+    /** Kills and reaps the forked children when going out of scope, also when a check fails and returns early */
+    class ChildProcesses {
+        public:
+            ~ChildProcesses() {
+                Q_FOREACH(pid_t pid, pids) {
+                    ::kill(pid, SIGKILL);
+                    ::waitpid(pid, 0, 0);
+                }
+            }
+            QList<pid_t> pids;
+    };
+}
+
+void testProcess::testTimeToUpdateManyProcesses() {
+    QFETCH(int, count);
+
+    //Start enough processes to make reading /proc the bottleneck
+    ChildProcesses children;
+    for(int i = 0; i < count; i++) {
+        const pid_t pid = ::fork();
+        if(pid == 0) {
+            ::pause();
+            ::_exit(0);
+        }
+        if(pid < 0) {
+            break;
+        }
+        children.pids.append(pid);
+    }
+    if(children.pids.size() < count) {
+        QSKIP("Could not start enough processes", SkipSingle);
+    }
+
+    KSysGuard::Processes processController;
+    QBENCHMARK {
+        processController.updateAllProcesses();
+    }
+    QVERIFY(processController.processCount() > children.pids.size());
+}
+
+void testProcess::testOwnProcess() {
+    KSysGuard::Processes *processController = new KSysGuard::Processes();
+    //The second update is served from the kept state of the first one
+    for(int i = 0; i < 2; i++) {
+        processController->updateAllProcesses();
+        KSysGuard::Process *process = processController->getProcess(::getpid());
+        QVERIFY(process);
+        QCOMPARE(process->pid, long(::getpid()));
+        QCOMPARE(process->parent_pid, long(::getppid()));
+        QCOMPARE(process->uid, qlonglong(::getuid()));
+        QVERIFY(process->command.contains("processtest"));
+        QVERIFY(process->command.contains(process->name));
+    }
+    delete processController;
+}
+
 void testProcess::testTimeToUpdateModel() {
     KSysGuardProcessList *processList = new KSysGuardProcessList;
     processList->treeView()->setColumnHidden(13, false);
@@ -143,6 +223,65 @@ void testProcess::testTimeToUpdateModel() {
     delete processList;
 }
 
+void DataChangedRecorder::dataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+    count++;
+    if(topLeft.column() != bottomRight.column() || topLeft.parent() != bottomRight.parent() || topLeft.row() > bottomRight.row())
+        valid = false;
+    columns.insert(topLeft.column());
+}
+
+void testProcess::testTimeToUpdateModelTree() {
+    ProcessModel model;
+    model.setSimpleMode(false);
+    model.update();
+    model.setColumnHidden(ProcessModel::HeadingCPUTime, true);
+    QVERIFY(model.isColumnHidden(ProcessModel::HeadingCPUTime));
+
+    DataChangedRecorder recorder;
+    connect(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex)), &recorder, SLOT(dataChanged(QModelIndex,QModelIndex)));
+    QBENCHMARK {
+        model.update();
+    }
+    //The changes are emitted as ranges of a single column, and never for hidden columns
+    QVERIFY(recorder.valid);
+    QVERIFY(!recorder.columns.contains(ProcessModel::HeadingCPUTime));
+
+    //Showing the column again updates all of it
+    recorder.columns.clear();
+    model.setColumnHidden(ProcessModel::HeadingCPUTime, false);
+    QVERIFY(recorder.valid);
+    QCOMPARE(recorder.columns, QSet<int>() << ProcessModel::HeadingCPUTime);
+}
+
+void testProcess::testHiddenSortColumn() {
+    KSysGuardProcessList *processList = new KSysGuardProcessList;
+    processList->show();
+    QTest::qWaitForWindowShown(processList);
+    QTreeView *view = processList->treeView();
+    ProcessModel *model = processList->processModel();
+
+    //Hiding the column the list is sorted by still announces its changes, so the order stays right
+    view->sortByColumn(ProcessModel::HeadingCPUTime, Qt::DescendingOrder);
+    view->setColumnHidden(ProcessModel::HeadingCPUTime, true);
+    view->setColumnHidden(ProcessModel::HeadingNiceness, true);
+    processList->updateList();
+    QVERIFY(!model->isColumnHidden(ProcessModel::HeadingCPUTime));
+    QVERIFY(model->isColumnHidden(ProcessModel::HeadingNiceness));
+
+    //Once sorted by another column it is left out again
+    view->sortByColumn(ProcessModel::HeadingName, Qt::AscendingOrder);
+    processList->updateList();
+    QVERIFY(model->isColumnHidden(ProcessModel::HeadingCPUTime));
+
+    //The filter text is matched against all columns
+    processList->filterLineEdit()->setText("kded");
+    processList->updateList();
+    QVERIFY(!model->isColumnHidden(ProcessModel::HeadingCPUTime));
+    QVERIFY(!model->isColumnHidden(ProcessModel::HeadingNiceness));
+
+    delete processList;
+}
+
 void testProcess::testUpdateOrAddProcess() {
     KSysGuard::Processes *processController = new KSysGuard::Processes();
     processController->updateAllProcesses();
@@ -160,6 +299,57 @@ void testProcess::testUpdateOrAddProcess() {
     delete processController;
 }
 
+void testProcess::testProcessSampler() {
+    if(!KSysGuard::ProcessSampler::isSupported())
+        QSKIP("High frequency sampling is not supported on this system", SkipSingle);
+
+    KSysGuard::ProcessSampler sampler;
+    sampler.setRate(100);
+    QCOMPARE(sampler.rate(), 100);
+    long pid = getpid();
+    long parentPid = getppid();
+    QVERIFY(sampler.watch(pid));
+    QVERIFY(sampler.watch(parentPid));
+    QVERIFY(sampler.watch(pid));
+    QCOMPARE(sampler.watched(), QList<long>() << pid << parentPid);
+    QVERIFY(!sampler.watch(0));
+    sampler.start();
+    QVERIFY(sampler.isRunning());
+    QTest::qWait(500);
+
+    //Only the watched processes are sampled, each one on its own
+    KSysGuard::ProcessSampler::Statistics statistics = sampler.takeStatistics(pid);
+    QVERIFY(statistics.samples > 0);
+    QVERIFY(statistics.rss.median > 0);
+    KSysGuard::ProcessSampler::Statistics parentStatistics = sampler.takeStatistics(parentPid);
+    QVERIFY(parentStatistics.samples > 0);
+    QVERIFY(parentStatistics.rss.median > 0);
+    QCOMPARE(sampler.takeStatistics(pid + parentPid).samples, 0);
+
+    //The percentiles are ordered, whatever the load of the system was
+    QList<KSysGuard::ProcessSampler::Distribution> distributions;
+    distributions << statistics.cpuUsage << statistics.cpuWait << statistics.readRate
+                  << statistics.writeRate << statistics.rss
+                  << parentStatistics.cpuUsage << parentStatistics.rss;
+    foreach(const KSysGuard::ProcessSampler::Distribution &distribution, distributions) {
+        QVERIFY(distribution.median >= 0);
+        QVERIFY(distribution.median <= distribution.p90);
+        QVERIFY(distribution.p90 <= distribution.p99);
+        QVERIFY(distribution.p99 <= distribution.maximum);
+    }
+
+    //The samples have been taken
+    QVERIFY(sampler.takeStatistics(pid).samples < statistics.samples);
+
+    sampler.unwatch(parentPid);
+    QCOMPARE(sampler.watched(), QList<long>() << pid);
+    sampler.setWatched(QList<long>());
+    QVERIFY(sampler.watched().isEmpty());
+    QCOMPARE(sampler.takeStatistics(pid).samples, 0);
+    sampler.stop();
+    QVERIFY(!sampler.isRunning());
+}
+
 QTEST_KDEMAIN(testProcess,GUI)
 
 #include "moc_processtest.cpp"
@@ -21,10 +21,24 @@
 #define TESTPROCESS_H
 
 #include <QtCore/QObject>
+#include <QtCore/QModelIndex>
+#include <QtCore/QSet>
 namespace KSysGuard
 {
     class Process;
 }
+/** Records the dataChanged() signals of a model */
+class DataChangedRecorder : public QObject
+{
+    Q_OBJECT
+    public:
+        DataChangedRecorder() : count(0), valid(true) {}
+        int count;
+        bool valid; ///< False if any range spanned more than a column or had different parents
+        QSet<int> columns;
+    public slots:
+        void dataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+};
 class testProcess : public QObject
 {
     Q_OBJECT
@@ -32,11 +46,18 @@ class testProcess : public QObject
         unsigned long countNumChildren(KSysGuard::Process *p);
     private slots:
         void testTimeToUpdateAllProcesses();
+        void testTimeToUpdateAllProcessesIO();
+        void testTimeToUpdateManyProcesses_data();
+        void testTimeToUpdateManyProcesses();
+        void testOwnProcess();
         void testTimeToUpdateModel();
+        void testTimeToUpdateModelTree();
+        void testHiddenSortColumn();
         void testProcesses();
         void testProcessesTreeStructure();
         void testProcessesModification();
         void testUpdateOrAddProcess();
+        void testProcessSampler();
 };
 #endif
 
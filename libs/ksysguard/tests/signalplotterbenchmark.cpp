@@ -65,6 +65,35 @@ void BenchmarkSignalPlotter::addDataWhenHidden()
     }
 
 }
+void BenchmarkSignalPlotter::addDataManyBeams()
+{
+    // 64 beams, e.g. one per cpu core, updated at 10Hz.  Every sample has to
+    // be plotted well within the 100ms between two updates.
+    const int beams = 64;
+    for(int i = 0; i < beams; i++)
+        s->addBeam(QColor::fromHsv(i * 360 / beams, 255, 255));
+    s->show();
+    s->setMaxAxisTextWidth(5);
+    s->resize(1000,500);
+    QTest::qWaitForWindowShown(s);
+
+    // Fill the whole window first, so that old samples scroll out of it
+    QList< QList<qreal> > samples;
+    for(int i = 0; i < 1000; i++) {
+        QList<qreal> sample;
+        for(int j = 0; j < beams; j++)
+            sample << KRandom::randomMax(100);
+        samples << sample;
+        s->addSample(sample);
+    }
+    qApp->processEvents();
+
+    int i = 0;
+    QBENCHMARK {
+        s->addSample(samples.at(i++ % samples.count()));
+        qApp->processEvents();
+    }
+}
 
 QTEST_KDEMAIN(BenchmarkSignalPlotter, GUI)
 
@@ -13,6 +13,7 @@ class BenchmarkSignalPlotter : public QObject
         void addData();
         void stackedData();
         void addDataWhenHidden();
+        void addDataManyBeams();
     private:
         KSignalPlotter *s;
 };
@@ -31,6 +31,7 @@
 #include <KLocale>
 #include <KIO/PreviewJob>
 #include <Plasma/ToolTipManager>
+#include <konq_metadatacache.h>
 
 
 ToolTipWidget::ToolTipWidget(AbstractItemView *parent)
@@ -85,6 +86,16 @@ QString ToolTipWidget::metaInfo() const
         return QString();
     }
 
+    // Extracting the metadata requires reading the file, the text of
+    // unchanged local files is taken from the cache shared with Dolphin.
+    // It is stored as UTF-8 so that more of it fits into the cache.
+    const QString localPath = m_item.localPath();
+    const QByteArray cacheRole = "folderview-metainfo/" + KGlobal::locale()->language().toLatin1();
+    const QVariant cachedText = KonqMetaDataCache::self()->value(localPath, cacheRole);
+    if (cachedText.isValid()) {
+        return QString::fromUtf8(cachedText.toByteArray());
+    }
+
     const KFileMetaInfo info(m_item.url());
     const QStringList preferredinfo = info.preferredKeys();
     QString text = "<p><table border='0' cellspacing='0' cellpadding='0'>";
@@ -97,6 +108,7 @@ QString ToolTipWidget::metaInfo() const
     }
     text += "</table>";
 
+    KonqMetaDataCache::self()->setValue(localPath, cacheRole, text.toUtf8());
     return text;
 }
 
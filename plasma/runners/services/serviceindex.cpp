@@ -0,0 +1,310 @@
+/*
+ *   Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "serviceindex.h"
+
+#include <QSet>
+#include <QtAlgorithms>
+
+#include <KServiceTypeTrader>
+
+#include <algorithm>
+
+// three characters of a lower case text
+static quint64 trigram(const QChar *text)
+{
+    return (quint64(text[0].unicode()) << 32) | (quint64(text[1].unicode()) << 16) | quint64(text[2].unicode());
+}
+
+static void addTrigrams(const QString &text, QVector<quint64> *trigrams)
+{
+    for (int i = 0; i + 3 <= text.length(); ++i) {
+        trigrams->append(trigram(text.constData() + i));
+    }
+}
+
+// sorted without duplicates, which is the order the trader returned the services in
+static QVector<int> uniqueEntries(QVector<int> entries)
+{
+    qSort(entries);
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+    return entries;
+}
+
+static QVector<int> intersect(const QVector<int> &first, const QVector<int> &second)
+{
+    QVector<int> result;
+    int i = 0;
+    int j = 0;
+    while (i < first.count() && j < second.count()) {
+        if (first.at(i) < second.at(j)) {
+            ++i;
+        } else if (second.at(j) < first.at(i)) {
+            ++j;
+        } else {
+            result.append(first.at(i));
+            ++i;
+            ++j;
+        }
+    }
+    return result;
+}
+
+static bool containsInAny(const QStringList &texts, const QString &term)
+{
+    foreach (const QString &text, texts) {
+        if (text.contains(term)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+ServiceIndex::Entry::Entry()
+    : application(false)
+    , isApplication(false)
+    , kcmodule(false)
+    , noDisplay(false)
+    , notShowInKDE(false)
+    , showInKDE(true)
+{
+}
+
+ServiceIndex::Entry ServiceIndex::Entry::fromService(const KService::Ptr &service, bool application)
+{
+    Entry entry;
+    entry.storageId = service->storageId();
+    entry.desktopEntryName = service->desktopEntryName();
+    entry.name = service->name();
+    entry.genericName = service->genericName();
+    entry.comment = service->comment();
+    entry.icon = service->icon();
+    entry.exec = service->exec();
+    entry.keywords = service->keywords();
+    entry.categories = service->categories();
+    entry.application = application;
+    entry.isApplication = service->isApplication();
+    entry.kcmodule = service->serviceTypes().contains("KCModule");
+    entry.noDisplay = service->noDisplay();
+    entry.notShowInKDE = service->property("NotShowIn", QVariant::String).toString() == QLatin1String("KDE");
+    entry.showInKDE = service->showInKDE();
+    return entry;
+}
+
+ServiceIndex::Match::Match()
+    : entry(-1)
+    , relevance(0)
+{
+}
+
+ServiceIndex::Match::Match(int entry, qreal relevance)
+    : entry(entry)
+    , relevance(relevance)
+{
+}
+
+ServiceIndex::ServiceIndex(const QList<Entry> &entries)
+    : m_entries(entries.toVector())
+    , m_texts(entries.count())
+{
+    m_prefixes.reserve(2 * m_entries.count());
+    QVector<quint64> trigrams;
+    for (int i = 0; i < m_entries.count(); ++i) {
+        const Entry &entry = m_entries.at(i);
+        Texts &texts = m_texts[i];
+        texts.name = entry.name.toLower();
+        texts.genericName = entry.genericName.toLower();
+        texts.exec = entry.exec.toLower();
+        foreach (const QString &keyword, entry.keywords) {
+            texts.keywords.append(keyword.toLower());
+        }
+
+        m_names[texts.name].append(i);
+        m_prefixes.append(qMakePair(entry.desktopEntryName, i));
+        m_prefixes.append(qMakePair(entry.exec, i));
+
+        trigrams.clear();
+        addTrigrams(texts.name, &trigrams);
+        addTrigrams(texts.genericName, &trigrams);
+        addTrigrams(texts.exec, &trigrams);
+        foreach (const QString &keyword, texts.keywords) {
+            addTrigrams(keyword, &trigrams);
+        }
+        qSort(trigrams);
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+        foreach (quint64 key, trigrams) {
+            m_trigrams[key].append(i);
+        }
+
+        if (entry.application) {
+            foreach (const QString &category, entry.categories) {
+                m_categories[category.toLower()].append(i);
+            }
+        }
+    }
+    qSort(m_prefixes);
+}
+
+ServiceIndex *ServiceIndex::fromSycoca()
+{
+    QList<Entry> entries;
+    QSet<QString> ids;
+    foreach (const KService::Ptr &service, KServiceTypeTrader::self()->query("Application", "exist Exec")) {
+        entries.append(Entry::fromService(service, true));
+        ids.insert(service->storageId());
+    }
+    foreach (const KService::Ptr &service, KServiceTypeTrader::self()->query("KCModule", "exist Exec")) {
+        if (!ids.contains(service->storageId())) {
+            entries.append(Entry::fromService(service, false));
+        }
+    }
+    return new ServiceIndex(entries);
+}
+
+QVector<int> ServiceIndex::prefixMatches(const QString &term) const
+{
+    QVector<int> result;
+    QVector<QPair<QString, int> >::const_iterator it = qLowerBound(m_prefixes.constBegin(), m_prefixes.constEnd(),
+                                                                   qMakePair(term, -1));
+    for (; it != m_prefixes.constEnd() && it->first.startsWith(term); ++it) {
+        result.append(it->second);
+    }
+    return uniqueEntries(result);
+}
+
+QVector<int> ServiceIndex::trigramMatches(const QString &term) const
+{
+    // every trigram of the term has to be in one of the texts, start with the rarest one
+    QList<const QVector<int>*> postings;
+    for (int i = 0; i + 3 <= term.length(); ++i) {
+        QHash<quint64, QVector<int> >::const_iterator it = m_trigrams.constFind(trigram(term.constData() + i));
+        if (it == m_trigrams.constEnd()) {
+            return QVector<int>();
+        }
+        postings.append(&it.value());
+    }
+    int rarest = 0;
+    for (int i = 1; i < postings.count(); ++i) {
+        if (postings.at(i)->count() < postings.at(rarest)->count()) {
+            rarest = i;
+        }
+    }
+    QVector<int> result = *postings.at(rarest);
+    for (int i = 0; i < postings.count() && !result.isEmpty(); ++i) {
+        if (i != rarest) {
+            result = intersect(result, *postings.at(i));
+        }
+    }
+    return result;
+}
+
+QVector<int> ServiceIndex::categoryMatches(const QString &term) const
+{
+    // there are only a few hundred different categories
+    QVector<int> result;
+    QHash<QString, QVector<int> >::const_iterator it = m_categories.constBegin();
+    for (; it != m_categories.constEnd(); ++it) {
+        if (it.key().contains(term)) {
+            result += it.value();
+        }
+    }
+    return uniqueEntries(result);
+}
+
+QList<ServiceIndex::Match> ServiceIndex::match(const QString &term) const
+{
+    QList<Match> matches;
+    if (term.isEmpty()) {
+        return matches;
+    }
+    const QString lowerTerm = term.toLower();
+    QSet<QString> seen;
+
+    // applications which are named exactly like the term
+    if (term.length() > 1) {
+        foreach (int i, m_names.value(lowerTerm)) {
+            const Entry &entry = m_entries.at(i);
+            if (entry.application && !entry.noDisplay && !entry.notShowInKDE) {
+                matches.append(Match(i, 1));
+                seen.insert(entry.storageId);
+                seen.insert(entry.exec);
+            }
+        }
+    }
+
+    // If the term length is < 3, no real point searching the Keywords and GenericName, and
+    // if it is NOT at the beginning of the desktop entry name or the command, then chances
+    // are the user doesn't want that app.
+    const QVector<int> candidates = term.length() < 3 ? prefixMatches(term) : trigramMatches(lowerTerm);
+    foreach (int i, candidates) {
+        const Entry &entry = m_entries.at(i);
+        const Texts &texts = m_texts.at(i);
+        const bool nameMatches = texts.name.contains(lowerTerm);
+        const bool genericNameMatches = texts.genericName.contains(lowerTerm);
+        if (term.length() < 3) {
+            if (!nameMatches && !texts.exec.contains(lowerTerm)) {
+                continue;
+            }
+        } else if (!nameMatches && !genericNameMatches && !texts.exec.contains(lowerTerm)
+                   && !containsInAny(texts.keywords, lowerTerm)) {
+            continue;
+        }
+        if (entry.noDisplay || seen.contains(entry.storageId) || seen.contains(entry.exec)) {
+            continue;
+        }
+        seen.insert(entry.storageId);
+        seen.insert(entry.exec);
+
+        qreal relevance = 0.6;
+        if (term.length() < 3) {
+            relevance = 0.9;
+        } else if (nameMatches) {
+            relevance = 0.8;
+            if (texts.name.startsWith(lowerTerm)) {
+                relevance += 0.1;
+            }
+        } else if (genericNameMatches) {
+            relevance = 0.7;
+            if (texts.genericName.startsWith(lowerTerm)) {
+                relevance += 0.1;
+            }
+        }
+        if ((entry.categories.contains("KDE") || entry.kcmodule) && !entry.storageId.startsWith("kde-")) {
+            relevance += 0.1;
+        }
+        matches.append(Match(i, relevance));
+    }
+
+    // applications whose categories contain the term
+    foreach (int i, categoryMatches(lowerTerm)) {
+        const Entry &entry = m_entries.at(i);
+        if (entry.noDisplay || seen.contains(entry.storageId) || seen.contains(entry.exec)) {
+            continue;
+        }
+        qreal relevance = 0.6;
+        if (entry.categories.contains("X-KDE-More") || !entry.showInKDE) {
+            relevance = 0.5;
+        }
+        if (entry.isApplication) {
+            relevance += .4;
+        }
+        matches.append(Match(i, relevance));
+    }
+
+    return matches;
+}
@@ -0,0 +1,138 @@
+/*
+ *   Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SERVICEINDEX_H
+#define SERVICEINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QStringList>
+#include <QVector>
+
+#include <KService>
+
+/**
+ * An in-memory index of the services the ServiceRunner can start.
+ *
+ * Asking the service type trader walks all the services of sycoca and parses the constraint
+ * again for every query, several times per keystroke. The index is built once and looks the
+ * services up by their names, by the beginning of their desktop entry name and command and by
+ * the trigrams of the texts searched for substrings. The matches and their relevance are the
+ * same the trader queries gave.
+ */
+class ServiceIndex
+{
+public:
+    /**
+     * What the runner needs to know about a service.
+     */
+    class Entry
+    {
+    public:
+        Entry();
+
+        /**
+         * @param application whether the service was found as an Application, the
+         * KCModules are only searched by their names and commands
+         */
+        static Entry fromService(const KService::Ptr &service, bool application);
+
+        QString storageId;
+        QString desktopEntryName;
+        QString name;
+        QString genericName;
+        QString comment;
+        QString icon;
+        QString exec;
+        QStringList keywords;
+        QStringList categories;
+        bool application; ///< found as an Application rather than a KCModule
+        bool isApplication; ///< KService::isApplication()
+        bool kcmodule;
+        bool noDisplay;
+        bool notShowInKDE; ///< NotShowIn=KDE
+        bool showInKDE;
+    };
+
+    class Match
+    {
+    public:
+        Match();
+        Match(int entry, qreal relevance);
+
+        int entry;
+        qreal relevance;
+    };
+
+    /**
+     * Indexes the @p entries, the Applications first, in the order the trader returns them.
+     * Services without a command must not be part of it.
+     */
+    explicit ServiceIndex(const QList<Entry> &entries);
+
+    /**
+     * @returns An index of the Applications and KCModules in sycoca.
+     */
+    static ServiceIndex *fromSycoca();
+
+    int count() const;
+    const Entry &entry(int index) const;
+
+    /**
+     * @returns The services matching @p term in the order of the trader queries: the
+     * applications named like the term, then the other matches in the order of the index,
+     * then the applications in a category named like the term. They are not sorted by
+     * relevance, the RunnerManager does that.
+     */
+    QList<Match> match(const QString &term) const;
+
+private:
+    // the lower case texts searched for substrings
+    class Texts
+    {
+    public:
+        QString name;
+        QString genericName;
+        QString exec;
+        QStringList keywords;
+    };
+
+    QVector<int> prefixMatches(const QString &term) const;
+    QVector<int> trigramMatches(const QString &term) const;
+    QVector<int> categoryMatches(const QString &term) const;
+
+    QVector<Entry> m_entries;
+    QVector<Texts> m_texts;
+    QHash<QString, QVector<int> > m_names;
+    QVector<QPair<QString, int> > m_prefixes; ///< sorted desktop entry names and commands
+    QHash<quint64, QVector<int> > m_trigrams;
+    QHash<QString, QVector<int> > m_categories;
+};
+
+inline int ServiceIndex::count() const
+{
+    return m_entries.count();
+}
+
+inline const ServiceIndex::Entry &ServiceIndex::entry(int index) const
+{
+    return m_entries.at(index);
+}
+
+#endif
@@ -25,7 +25,7 @@
 #include <KLocale>
 #include <KToolInvocation>
 #include <KService>
-#include <KServiceTypeTrader>
+#include <KSycoca>
 #include <KUrl>
 
 ServiceRunner::ServiceRunner(QObject *parent, const QVariantList &args)
@@ -37,6 +37,8 @@ ServiceRunner::ServiceRunner(QObject *parent, const QVariantList &args)
     setPriority(AbstractRunner::HighestPriority);
 
     addSyntax(Plasma::RunnerSyntax(":q:", i18n("Finds applications whose name or description match :q:")));
+
+    connect(KSycoca::self(), SIGNAL(databaseChanged(QStringList)), this, SLOT(databaseChanged(QStringList)));
 }
 
 ServiceRunner::~ServiceRunner()
@@ -46,146 +48,19 @@ ServiceRunner::~ServiceRunner()
 void ServiceRunner::match(Plasma::RunnerContext &context)
 {
     const QString term = context.query();
-
-    QList<Plasma::QueryMatch> matches;
-    QSet<QString> seen;
-    QString query;
-
-    if (term.length() > 1) {
-        // Search for applications which are executable and case-insensitively match the search term
-        query = QString("exist Exec and ('%1' =~ Name)").arg(term);
-        KService::List services = KServiceTypeTrader::self()->query("Application", query);
-
-        if (!services.isEmpty()) {
-            // kDebug() << service->name() << "is an exact match!" << service->storageId() << service->exec();
-            foreach (const KService::Ptr &service, services) {
-                if (!service->noDisplay() && service->property("NotShowIn", QVariant::String) != "KDE") {
-                    Plasma::QueryMatch match(this);
-                    setupMatch(service, match);
-                    match.setRelevance(1);
-                    matches << match;
-                    seen.insert(service->storageId());
-                    seen.insert(service->exec());
-                }
-            }
-        }
-    }
-
+    const QSharedPointer<const ServiceIndex> services = index();
     if (!context.isValid()) {
         return;
     }
 
-    // If the term length is < 3, no real point searching the Keywords and GenericName
-    if (term.length() < 3) {
-        query = QString("exist Exec and ( (exist Name and '%1' ~~ Name) or ('%1' ~~ Exec) )").arg(term);
-    } else {
-        // Search for applications which are executable and the term case-insensitive matches any of
-        // * a substring of one of the keywords
-        // * a substring of the GenericName field
-        // * a substring of the Name field
-        // Note that before asking for the content of e.g. Keywords and GenericName we need to ask if
-        // they exist to prevent a tree evaluation error if they are not defined.
-        query = QString("exist Exec and ( (exist Keywords and '%1' ~subin Keywords) or (exist GenericName and '%1' ~~ GenericName) or (exist Name and '%1' ~~ Name) or ('%1' ~~ Exec) )").arg(term);
-    }
-
-    KService::List services = KServiceTypeTrader::self()->query("Application", query);
-    services += KServiceTypeTrader::self()->query("KCModule", query);
-
-    // kDebug() << "got " << services.count() << " services from " << query;
-    foreach (const KService::Ptr &service, services) {
-        if (!context.isValid()) {
-            return;
-        }
-
-        if (service->noDisplay()) {
-            continue;
-        }
-
-        const QString id = service->storageId();
-        const QString name = service->desktopEntryName();
-        const QString exec = service->exec();
-
-        if (seen.contains(id) || seen.contains(exec)) {
-            // kDebug() << "already seen" << id << exec;
-            continue;
-        }
-
-        // kDebug() << "haven't seen" << id << "so processing now";
-        seen.insert(id);
-        seen.insert(exec);
-
+    QList<Plasma::QueryMatch> matches;
+    foreach (const ServiceIndex::Match &serviceMatch, services->match(term)) {
         Plasma::QueryMatch match(this);
-        setupMatch(service, match);
-        qreal relevance = 0.6;
-
-        // If the term was < 3 chars and NOT at the beginning of the App's name or Exec, then
-        // chances are the user doesn't want that app.
-        if (term.length() < 3) {
-            if (name.startsWith(term) || exec.startsWith(term)) {
-                relevance = 0.9;
-            } else {
-                continue;
-            }
-        } else if (service->name().contains(term, Qt::CaseInsensitive)) {
-            relevance = 0.8;
-
-            if (service->name().startsWith(term, Qt::CaseInsensitive)) {
-                relevance += 0.1;
-            }
-        } else if (service->genericName().contains(term, Qt::CaseInsensitive)) {
-            relevance = 0.7;
-
-            if (service->genericName().startsWith(term, Qt::CaseInsensitive)) {
-                relevance += 0.1;
-            }
-        }
-
-        if (service->categories().contains("KDE") || service->serviceTypes().contains("KCModule")) {
-            // kDebug() << "found a kde thing" << id << match.subtext() << relevance;
-            if (!id.startsWith("kde-")) {
-                relevance += 0.1;
-            }
-        }
-
-        // kDebug() << service->name() << "is this relevant:" << relevance;
-        match.setRelevance(relevance);
+        setupMatch(services->entry(serviceMatch.entry), match);
+        match.setRelevance(serviceMatch.relevance);
         matches << match;
     }
 
-    //search for applications whose categories contains the query
-    query = QString("exist Exec and (exist Categories and '%1' ~subin Categories)").arg(term);
-    services = KServiceTypeTrader::self()->query("Application", query);
-
-    // kDebug() << service->name() << "is an exact match!" << service->storageId() << service->exec();
-    foreach (const KService::Ptr &service, services) {
-        if (!context.isValid()) {
-            return;
-        }
-
-        if (!service->noDisplay()) {
-            QString id = service->storageId();
-            QString exec = service->exec();
-            if (seen.contains(id) || seen.contains(exec)) {
-                // kDebug() << "already seen" << id << exec;
-                continue;
-            }
-            Plasma::QueryMatch match(this);
-            setupMatch(service, match);
-
-            qreal relevance = 0.6;
-            if (service->categories().contains("X-KDE-More") || !service->showInKDE()) {
-                relevance = 0.5;
-            }
-
-            if (service->isApplication()) {
-                relevance += .4;
-            }
-
-            match.setRelevance(relevance);
-            matches << match;
-        }
-    }
-
     context.addMatches(matches);
 }
 
@@ -208,21 +83,40 @@ QMimeData * ServiceRunner::mimeDataForMatch(const Plasma::QueryMatch &match)
     return nullptr;
 }
 
-void ServiceRunner::setupMatch(const KService::Ptr &service, Plasma::QueryMatch &match)
+void ServiceRunner::setupMatch(const ServiceIndex::Entry &entry, Plasma::QueryMatch &match)
 {
-    const QString name = service->name();
+    const QString name = entry.name;
 
     match.setText(name);
-    match.setData(service->storageId());
+    match.setData(entry.storageId);
+
+    if (!entry.genericName.isEmpty() && entry.genericName != name) {
+        match.setSubtext(entry.genericName);
+    } else if (!entry.comment.isEmpty()) {
+        match.setSubtext(entry.comment);
+    }
 
-    if (!service->genericName().isEmpty() && service->genericName() != name) {
-        match.setSubtext(service->genericName());
-    } else if (!service->comment().isEmpty()) {
-        match.setSubtext(service->comment());
+    if (!entry.icon.isEmpty()) {
+        match.setIcon(KIcon(entry.icon));
     }
+}
+
+QSharedPointer<const ServiceIndex> ServiceRunner::index()
+{
+    QMutexLocker locker(&m_indexMutex);
+    if (!m_index) {
+        m_index = QSharedPointer<const ServiceIndex>(ServiceIndex::fromSycoca());
+        kDebug() << "indexed" << m_index->count() << "services";
+    }
+    return m_index;
+}
 
-    if (!service->icon().isEmpty()) {
-        match.setIcon(KIcon(service->icon()));
+void ServiceRunner::databaseChanged(const QStringList &resources)
+{
+    if (resources.contains("services") || resources.contains("apps") || resources.contains("xdgdata-apps")) {
+        // matches still running keep the old index
+        QMutexLocker locker(&m_indexMutex);
+        m_index.clear();
     }
 }
 
@@ -20,10 +20,15 @@
 #define SERVICERUNNER_H
 
 
+#include <QMutex>
+#include <QSharedPointer>
+
 #include <KService>
 
 #include <Plasma/AbstractRunner>
 
+#include "serviceindex.h"
+
 
 /**
  * This class looks for matches in the set of .desktop files installed by
@@ -45,7 +50,17 @@ public:
     QMimeData* mimeDataForMatch(const Plasma::QueryMatch &match);
 
 protected:
-    void setupMatch(const KService::Ptr &service, Plasma::QueryMatch &action);
+    void setupMatch(const ServiceIndex::Entry &entry, Plasma::QueryMatch &action);
+
+private Q_SLOTS:
+    void databaseChanged(const QStringList &resources);
+
+private:
+    QSharedPointer<const ServiceIndex> index();
+
+    QMutex m_indexMutex;
+    // built on the first match after sycoca changed, the matching threads share it
+    QSharedPointer<const ServiceIndex> m_index;
 };
 
 K_EXPORT_PLASMA_RUNNER(services, ServiceRunner)
@@ -0,0 +1,175 @@
+/*
+ *   Copyright (C) 2024 Ivailo Monev <xakepa10@gmail.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "serviceindex.h"
+
+#include <qtest_kde.h>
+
+#include <QScopedPointer>
+
+Q_DECLARE_METATYPE(QList<ServiceIndex::Match>)
+
+static ServiceIndex::Entry application(const QString &id, const QString &name, const QString &exec,
+                                       const QString &genericName = QString(),
+                                       const QStringList &keywords = QStringList(),
+                                       const QStringList &categories = QStringList())
+{
+    ServiceIndex::Entry entry;
+    entry.storageId = id + QLatin1String(".desktop");
+    entry.desktopEntryName = id;
+    entry.name = name;
+    entry.exec = exec;
+    entry.genericName = genericName;
+    entry.keywords = keywords;
+    entry.categories = categories;
+    entry.application = true;
+    entry.isApplication = true;
+    return entry;
+}
+
+static QList<ServiceIndex::Entry> entries()
+{
+    QList<ServiceIndex::Entry> entries;
+    entries << application("dolphin", "Dolphin", "dolphin %u", "File Manager",
+                           QStringList() << "files" << "browser",
+                           QStringList() << "Qt" << "KDE" << "System" << "FileManager");
+    entries << application("kate", "Kate", "kate -b %U", "Advanced Text Editor",
+                           QStringList() << "text" << "editor",
+                           QStringList() << "Qt" << "KDE" << "Utility" << "TextEditor");
+    entries << application("firefox", "Firefox", "firefox %u", "Web Browser",
+                           QStringList() << "internet" << "www",
+                           QStringList() << "Network" << "WebBrowser");
+    entries << application("kde-konsole", "Konsole", "konsole", "Terminal", QStringList(),
+                           QStringList() << "Qt" << "KDE" << "System" << "TerminalEmulator");
+    ServiceIndex::Entry hidden = application("hidden", "Hidden Browser", "hidden", QString(), QStringList(),
+                                             QStringList() << "Network");
+    hidden.noDisplay = true;
+    entries << hidden;
+    // the same command as firefox
+    entries << application("firefox-esr", "Firefox ESR", "firefox %u", QString(), QStringList(),
+                           QStringList() << "Network");
+    ServiceIndex::Entry kcm = application("kcm_desktop", "Desktop Effects", "kcmshell4 kwincompositing",
+                                          QString(), QStringList(), QStringList() << "Settings");
+    kcm.application = false;
+    kcm.isApplication = false;
+    kcm.kcmodule = true;
+    entries << kcm;
+    entries << application("extras", "Extras", "extras", QString(), QStringList(),
+                           QStringList() << "X-KDE-More" << "Game");
+    return entries;
+}
+
+class TestServiceIndex : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void match_data();
+    void match();
+    void empty();
+    void benchmarkIndex();
+    void benchmarkMatch_data();
+    void benchmarkMatch();
+};
+
+void TestServiceIndex::match_data()
+{
+    typedef QList<ServiceIndex::Match> Matches;
+    QTest::addColumn<QString>("term");
+    QTest::addColumn<Matches>("expected");
+
+    QTest::newRow("exact name") << QString("kate") << (Matches() << ServiceIndex::Match(1, 1));
+    QTest::newRow("exact name, case") << QString("KATE") << (Matches() << ServiceIndex::Match(1, 1));
+    QTest::newRow("short") << QString("ka") << (Matches() << ServiceIndex::Match(1, 1));
+    // the beginning of the desktop entry name or the command is case sensitive
+    QTest::newRow("short, case") << QString("Ka") << Matches();
+    QTest::newRow("name prefix") << QString("fire") << (Matches() << ServiceIndex::Match(2, 0.9));
+    QTest::newRow("name") << QString("olph") << (Matches() << ServiceIndex::Match(0, 0.9));
+    QTest::newRow("generic name") << QString("browser")
+        << (Matches() << ServiceIndex::Match(0, 0.7) << ServiceIndex::Match(2, 0.7));
+    QTest::newRow("generic name prefix") << QString("advanced") << (Matches() << ServiceIndex::Match(1, 0.9));
+    QTest::newRow("generic name, kde- id") << QString("term") << (Matches() << ServiceIndex::Match(3, 0.8));
+    QTest::newRow("keyword") << QString("www") << (Matches() << ServiceIndex::Match(2, 0.6));
+    QTest::newRow("command") << QString("kwincompo") << (Matches() << ServiceIndex::Match(6, 0.7));
+    QTest::newRow("kcmodule") << QString("desktop effects") << (Matches() << ServiceIndex::Match(6, 1));
+    QTest::newRow("categories") << QString("system")
+        << (Matches() << ServiceIndex::Match(0, 1) << ServiceIndex::Match(3, 1));
+    QTest::newRow("more") << QString("game") << (Matches() << ServiceIndex::Match(7, 0.9));
+    QTest::newRow("hidden") << QString("hidden") << Matches();
+    QTest::newRow("nothing") << QString("zzz") << Matches();
+}
+
+void TestServiceIndex::match()
+{
+    QFETCH(QString, term);
+    QFETCH(QList<ServiceIndex::Match>, expected);
+
+    const ServiceIndex index(entries());
+    const QList<ServiceIndex::Match> matches = index.match(term);
+    QCOMPARE(matches.count(), expected.count());
+    for (int i = 0; i < matches.count(); ++i) {
+        QCOMPARE(index.entry(matches.at(i).entry).storageId, index.entry(expected.at(i).entry).storageId);
+        QCOMPARE(matches.at(i).relevance, expected.at(i).relevance);
+    }
+}
+
+void TestServiceIndex::empty()
+{
+    const ServiceIndex index((QList<ServiceIndex::Entry>()));
+    QCOMPARE(index.count(), 0);
+    QVERIFY(index.match("kate").isEmpty());
+    QVERIFY(ServiceIndex(entries()).match(QString()).isEmpty());
+}
+
+void TestServiceIndex::benchmarkIndex()
+{
+    // the services installed on this system, like the runner indexes them
+    if (QScopedPointer<ServiceIndex>(ServiceIndex::fromSycoca())->count() == 0) {
+        QSKIP("No services are installed", SkipSingle);
+    }
+    QBENCHMARK {
+        delete ServiceIndex::fromSycoca();
+    }
+}
+
+void TestServiceIndex::benchmarkMatch_data()
+{
+    QTest::addColumn<QString>("term");
+
+    QTest::newRow("short") << QString("ka");
+    QTest::newRow("name") << QString("konsole");
+    QTest::newRow("substring") << QString("edit");
+    QTest::newRow("category") << QString("system");
+    QTest::newRow("nothing") << QString("xyzzy");
+}
+
+void TestServiceIndex::benchmarkMatch()
+{
+    QFETCH(QString, term);
+
+    QScopedPointer<ServiceIndex> index(ServiceIndex::fromSycoca());
+    if (index->count() == 0) {
+        QSKIP("No services are installed", SkipSingle);
+    }
+    QBENCHMARK {
+        index->match(term);
+    }
+}
+
+QTEST_KDEMAIN(TestServiceIndex, NoGUI)
+
+#include "testserviceindex.moc"
@@ -18,7 +18,7 @@
  ***************************************************************************/
 #include "windowsrunner.h"
 
-#include <QTimer>
+#include <QMutexLocker>
 
 #include <KDebug>
 #include <KIcon>
@@ -49,14 +49,55 @@ WindowsRunner::WindowsRunner(QObject* parent, const QVariantList& args)
                                    "activate, close, min(imize), max(imize), fullscreen, shade, keep above and keep below.")));
     addSyntax(Plasma::RunnerSyntax(i18nc("Note this is a KRunner keyword", "desktop"),
                                    i18n("Lists all other desktops and allows to switch to them.")));
+
+    connect(KWindowSystem::self(), SIGNAL(windowAdded(WId)), this, SLOT(windowAdded(WId)));
+    connect(KWindowSystem::self(), SIGNAL(windowRemoved(WId)), this, SLOT(windowRemoved(WId)));
+    connect(KWindowSystem::self(), SIGNAL(windowChanged(WId,uint)), this, SLOT(windowChanged(WId,uint)));
+    connect(KWindowSystem::self(), SIGNAL(numberOfDesktopsChanged(int)), this, SLOT(desktopsChanged()));
+    connect(KWindowSystem::self(), SIGNAL(desktopNamesChanged()), this, SLOT(desktopsChanged()));
+
+    foreach (const WId w, KWindowSystem::windows()) {
+        m_changedWindows.insert(w);
+    }
 }
 
-void WindowsRunner::match(Plasma::RunnerContext& context)
+void WindowsRunner::windowAdded(WId w)
 {
+    QMutexLocker locker(&m_mutex);
+    m_changedWindows.insert(w);
+}
+
+void WindowsRunner::windowRemoved(WId w)
+{
+    QMutexLocker locker(&m_mutex);
+    m_windows.remove(w);
+    m_changedWindows.remove(w);
+    m_icons.remove(w);
+}
+
+void WindowsRunner::windowChanged(WId w, unsigned int properties)
+{
+    QMutexLocker locker(&m_mutex);
+    if (properties & NET::WMIcon) {
+        m_icons.remove(w);
+    }
+    // the allowed actions, class and role are not part of the properties
+    if (properties != NET::WMIcon) {
+        m_changedWindows.insert(w);
+    }
+}
+
+void WindowsRunner::desktopsChanged()
+{
+    QMutexLocker locker(&m_mutex);
     m_desktopNames.clear();
-    m_icons.clear();
-    m_windows.clear();
-    foreach (const WId w, KWindowSystem::windows()) {
+}
+
+void WindowsRunner::updateWindows()
+{
+    // the windows which changed since the last match only, titles change a lot more often
+    // than windows are searched for
+    foreach (const WId w, m_changedWindows) {
         KWindowInfo info = KWindowSystem::windowInfo(
             w,
             NET::WMWindowType | NET::WMDesktop |
@@ -64,32 +105,49 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
             NET::WMName,
             NET::WM2WindowClass | NET::WM2WindowRole | NET::WM2AllowedActions
         );
-        if (info.valid()) {
-            // ignore NET::Tool and other special window types
-            NET::WindowType wType = info.windowType(
-                NET::NormalMask | NET::DesktopMask | NET::DockMask |
-                NET::ToolbarMask | NET::MenuMask | NET::DialogMask |
-                NET::UtilityMask | NET::SplashMask
-            );
-
-            if (wType != NET::Normal && wType != NET::Unknown &&
-                wType != NET::Dialog && wType != NET::Utility) {
-                continue;
-            }
-            m_windows.insert(w, info);
-            m_icons.insert(w, QIcon(KWindowSystem::icon(w)));
+        if (!info.valid()) {
+            m_windows.remove(w);
+            m_icons.remove(w);
+            continue;
         }
+        // ignore NET::Tool and other special window types
+        NET::WindowType wType = info.windowType(
+            NET::NormalMask | NET::DesktopMask | NET::DockMask |
+            NET::ToolbarMask | NET::MenuMask | NET::DialogMask |
+            NET::UtilityMask | NET::SplashMask
+        );
+        if (wType != NET::Normal && wType != NET::Unknown &&
+            wType != NET::Dialog && wType != NET::Utility) {
+            m_windows.remove(w);
+            m_icons.remove(w);
+            continue;
+        }
+        Window &window = m_windows[w];
+        window.info = info;
+        window.name = info.name().toLower();
+        window.className = QString::fromUtf8(info.windowClassName()).toLower();
+        window.windowClass = window.className + QLatin1Char(' ') + QString::fromUtf8(info.windowClassClass()).toLower();
+        window.role = QString::fromUtf8(info.windowRole()).toLower();
     }
+    m_changedWindows.clear();
 
-    for (int i = 1; i<=KWindowSystem::numberOfDesktops(); i++) {
-        m_desktopNames << KWindowSystem::desktopName(i);
+    if (m_desktopNames.isEmpty()) {
+        for (int i = 1; i <= KWindowSystem::numberOfDesktops(); i++) {
+            m_desktopNames << KWindowSystem::desktopName(i);
+        }
     }
+}
 
+void WindowsRunner::match(Plasma::RunnerContext& context)
+{
     QString term = context.query();
     if (term.length() < 3) {
         return;
     }
 
+    QMutexLocker locker(&m_mutex);
+    updateWindows();
+
     const QString activatel10n = i18nc("Note this is a KRunner keyword", "activate");
     const QString closel10n = i18nc("Note this is a KRunner keyword", "close");
     const QString minl10n = i18nc("Note this is a KRunner keyword", "min");
@@ -170,7 +228,7 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
     // the list can be restricted to windows matching a given name, class, role or desktop
     if (term.startsWith(i18nc("Note this is a KRunner keyword", "window"), Qt::CaseInsensitive) ||
         term.startsWith(QLatin1String("window"), Qt::CaseInsensitive)) {
-        const QStringList keywords = term.split(" ");
+        const QStringList keywords = term.toLower().split(" ");
         QString windowName;
         QString windowClass;
         QString windowRole;
@@ -203,24 +261,19 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
                 }
             }
         }
-        QHashIterator<WId, KWindowInfo> it(m_windows);
+        QHashIterator<WId, Window> it(m_windows);
         while(it.hasNext()) {
             it.next();
-            WId w = it.key();
-            KWindowInfo info = it.value();
-            QString windowClassCompare = QString::fromUtf8(info.windowClassName()) + " " +
-                                         QString::fromUtf8(info.windowClassClass());
+            const Window &window = it.value();
+            const KWindowInfo &info = window.info;
             // exclude not matching windows
-            if (!KWindowSystem::hasWId(w)) {
+            if (!windowName.isEmpty() && !window.name.contains(windowName)) {
                 continue;
             }
-            if (!windowName.isEmpty() && !info.name().contains(windowName, Qt::CaseInsensitive)) {
+            if (!windowClass.isEmpty() && !window.windowClass.contains(windowClass)) {
                 continue;
             }
-            if (!windowClass.isEmpty() && !windowClassCompare.contains(windowClass, Qt::CaseInsensitive)) {
-                continue;
-            }
-            if (!windowRole.isEmpty() && !QString::fromUtf8(info.windowRole()).contains(windowRole, Qt::CaseInsensitive)) {
+            if (!windowRole.isEmpty() && !window.role.contains(windowRole)) {
                 continue;
             }
             if (desktop != -1 && !info.isOnDesktop(desktop)) {
@@ -229,10 +282,10 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
             // check for windows when no keywords were used
             // check the name, class and role for containing the query without the keyword
             if (windowName.isEmpty() && windowClass.isEmpty() && windowRole.isEmpty() && desktop == -1) {
-                const QString& test = term.mid(keywords[0].length() + 1);
-                if (!info.name().contains(test, Qt::CaseInsensitive) &&
-                    !windowClassCompare.contains(test, Qt::CaseInsensitive) &&
-                    !QString::fromUtf8(info.windowRole()).contains(test, Qt::CaseInsensitive)) {
+                const QString test = term.mid(keywords[0].length() + 1).toLower();
+                if (!window.name.contains(test) &&
+                    !window.windowClass.contains(test) &&
+                    !window.role.contains(test)) {
                     continue;
                 }
             }
@@ -275,21 +328,18 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
     }
 
     // check for matches without keywords
-    QHashIterator<WId, KWindowInfo> it(m_windows);
+    const QString lowerTerm = term.toLower();
+    QHashIterator<WId, Window> it(m_windows);
     while (it.hasNext()) {
         it.next();
-        WId w = it.key();
-        if (!KWindowSystem::hasWId(w)) {
-            continue;
-        }
         // check if window name, class or role contains the query
-        KWindowInfo info = it.value();
-        QString className = QString::fromUtf8(info.windowClassName());
-        if (info.name().startsWith(term, Qt::CaseInsensitive) ||
-            className.startsWith(term, Qt::CaseInsensitive)) {
+        const Window &window = it.value();
+        const KWindowInfo &info = window.info;
+        if (window.name.startsWith(lowerTerm) ||
+            window.className.startsWith(lowerTerm)) {
             matches << windowMatch(info, action, 0.8);
-        } else if ((info.name().contains(term, Qt::CaseInsensitive) ||
-            className.contains(term, Qt::CaseInsensitive)) &&
+        } else if ((window.name.contains(lowerTerm) ||
+            window.className.contains(lowerTerm)) &&
             actionSupported(info, action)) {
             matches << windowMatch(info, action, 0.7);
         }
@@ -306,10 +356,10 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
             }
 
             // search for windows on desktop and list them with less relevance
-            QHashIterator<WId, KWindowInfo> it(m_windows);
+            QHashIterator<WId, Window> it(m_windows);
             while (it.hasNext()) {
                 it.next();
-                KWindowInfo info = it.value();
+                const KWindowInfo &info = it.value().info;
                 if (info.isOnDesktop(desktop) && actionSupported(info, action)) {
                     matches << windowMatch(info, action, 0.5);
                 }
@@ -333,7 +383,8 @@ void WindowsRunner::run(const Plasma::QueryMatch &match)
     const QStringList parts = match.data().toString().split("_");
     WindowAction action = WindowAction(parts[0].toInt());
     WId w = WId(parts[1].toULong());
-    KWindowInfo info = m_windows[w];
+    // the state may have changed since the match
+    KWindowInfo info = KWindowSystem::windowInfo(w, NET::WMState | NET::XAWMState);
     switch (action) {
         case ActivateAction: {
             KWindowSystem::forceActiveWindow(w);
@@ -417,7 +468,12 @@ Plasma::QueryMatch WindowsRunner::windowMatch(const KWindowInfo& info, WindowAct
 {
     Plasma::QueryMatch match(this);
     match.setData(QString::number((int)action) + QLatin1String("_") + QString::number(info.win()));
-    match.setIcon(m_icons[info.win()]);
+    // the icons are converted only for the windows which match
+    QHash<WId, QIcon>::iterator it = m_icons.find(info.win());
+    if (it == m_icons.end()) {
+        it = m_icons.insert(info.win(), QIcon(KWindowSystem::icon(info.win())));
+    }
+    match.setIcon(it.value());
     match.setText(info.name());
     QString desktopName;
     int desktop = info.desktop();
@@ -19,9 +19,11 @@
 #ifndef WINDOWSRUNNER_H
 #define WINDOWSRUNNER_H
 
-#include <Plasma/AbstractRunner>
+#include <QMutex>
+#include <QSet>
 
-class KWindowInfo;
+#include <Plasma/AbstractRunner>
+#include <KWindowSystem>
 
 class WindowsRunner : public Plasma::AbstractRunner
 {
@@ -32,6 +34,12 @@ public:
     void match(Plasma::RunnerContext &context) final;
     void run(const Plasma::QueryMatch &match) final;
 
+private Q_SLOTS:
+    void windowAdded(WId w);
+    void windowRemoved(WId w);
+    void windowChanged(WId w, unsigned int properties);
+    void desktopsChanged();
+
 private:
     enum WindowAction {
         ActivateAction,
@@ -43,12 +51,27 @@ private:
         KeepAboveAction,
         KeepBelowAction
     };
+    // a window and its lower case texts the query is matched against
+    class Window
+    {
+    public:
+        KWindowInfo info;
+        QString name;
+        QString className; ///< WM_CLASS name
+        QString windowClass; ///< WM_CLASS name and class
+        QString role;
+    };
+
+    void updateWindows();
     Plasma::QueryMatch desktopMatch(int desktop, qreal relevance);
     Plasma::QueryMatch windowMatch(const KWindowInfo &info, WindowAction action, qreal relevance);
     bool actionSupported(const KWindowInfo& info, WindowAction action);
 
-    QHash<WId, KWindowInfo> m_windows;
-    QHash<WId, QIcon> m_icons;
+    // the slots are called from the main thread while matching is done in other threads
+    QMutex m_mutex;
+    QHash<WId, Window> m_windows;
+    QSet<WId> m_changedWindows; ///< windows to fetch again before the next match
+    QHash<WId, QIcon> m_icons; ///< icons of the windows matched so far
     QStringList m_desktopNames;
 };
 